@@ -0,0 +1,89 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Measures validation of requests against fragmented register map, with the
+// access bitmaps and with a sorted list of mapped ranges
+
+#include "MB/modbusAccessMap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+struct Range {
+    uint32_t first;
+    uint32_t last; // Exclusive
+    bool writable;
+};
+
+// Range list check, with binary search for the first range
+bool readable(const std::vector<Range> &ranges, uint32_t address, uint32_t count) {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), address,
+                               [](uint32_t value, const Range &range) {
+                                   return value < range.last;
+                               });
+    const uint32_t end = address + count;
+    while (address < end) {
+        if (it == ranges.end() || it->first > address)
+            return false;
+        address = it->last;
+        it++;
+    }
+    return true;
+}
+} // namespace
+
+int main() {
+    constexpr int Checks = 10'000'000;
+
+    // Blocks of 1-16 registers, with gaps of 0-3, some of them read-only
+    uint32_t seed = 12345;
+    const auto random = [&seed](uint32_t max) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % max;
+    };
+    std::vector<Range> ranges;
+    MB::ModbusAccessMap map;
+    for (uint32_t address = 0; address < 0xF000;) {
+        const auto count    = 1 + random(16);
+        const bool writable = random(4) != 0;
+        // Adjacent blocks are kept separate, as in device documentation
+        ranges.push_back({address, address + count, writable});
+        map.map(MB::utils::HoldingRegisters, static_cast<uint16_t>(address), count,
+                writable ? MB::ModbusAccessMap::ReadWrite : MB::ModbusAccessMap::Read);
+        address += count + random(4);
+    }
+
+    std::vector<std::pair<uint16_t, uint16_t>> requests;
+    for (int i = 0; i < 1024; i++) {
+        const auto count = static_cast<uint16_t>(i % 2 ? 125 : 1 + random(10));
+        requests.emplace_back(static_cast<uint16_t>(random(0xF000 - count)), count);
+    }
+
+    std::size_t allowed[2] = {0, 0};
+    double elapsed[2]      = {0, 0};
+    for (int method = 0; method < 2; method++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < Checks; i++) {
+            const auto &[address, count] = requests[i % requests.size()];
+            allowed[method] += method == 0 ? map.readable(MB::utils::HoldingRegisters,
+                                                          address, count)
+                                           : readable(ranges, address, count);
+        }
+        elapsed[method] = std::chrono::duration<double, std::nano>(
+                              std::chrono::steady_clock::now() - start)
+                              .count() /
+                          Checks;
+    }
+
+    std::cout << "Mapped ranges:  " << ranges.size() << "\n"
+              << "Allowed:        " << allowed[0] << " / " << allowed[1] << "\n"
+              << "Bitmaps:        " << elapsed[0] << " ns per check\n"
+              << "Range list:     " << elapsed[1] << " ns per check" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Measures Modbus ASCII encoding and decoding speed, on the biggest frames
+
+#include "MB/modbusAscii.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+int main() {
+    constexpr int Iterations = 200000;
+
+    // Read response with 125 registers
+    std::vector<uint8_t> raw = {0x11, 0x03, 250};
+    for (int i = 0; i < 250; i++)
+        raw.push_back(static_cast<uint8_t>(i * 7));
+
+    std::size_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < Iterations; i++) {
+        raw[3]           = static_cast<uint8_t>(i);
+        const auto frame = MB::ascii::encodeFrame(raw);
+        checksum += frame[7];
+    }
+    const auto encoding = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    const auto frame = MB::ascii::encodeFrame(raw);
+    start            = std::chrono::steady_clock::now();
+    for (int i = 0; i < Iterations; i++) {
+        const auto decoded = MB::ascii::decodeFrame(frame);
+        checksum += decoded[3];
+    }
+    const auto decoding = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    const double megabytes = static_cast<double>(frame.size()) * Iterations / (1024 * 1024);
+    std::cout << "Frame size:  " << frame.size() << " characters\n"
+              << "Encoding:    " << megabytes / encoding.count() << " MiB/s\n"
+              << "Decoding:    " << megabytes / decoding.count() << " MiB/s\n"
+              << "Checksum:    " << checksum << std::endl;
+
+    return 0;
+}
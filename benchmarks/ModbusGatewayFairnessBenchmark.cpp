@@ -0,0 +1,120 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Measures latency of polling clients of the gateway, while one client floods
+// the same serial line, with all clients in one FIFO queue and with per-client
+// deficit round-robin
+
+#include "MB/modbusGateway.hpp"
+#include "MB/modbusUtils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t Clients     = 4;
+constexpr std::size_t FloodWindow = 64;
+constexpr auto BusTime            = std::chrono::milliseconds(1);
+constexpr auto PollInterval       = std::chrono::milliseconds(5);
+constexpr auto Duration           = std::chrono::seconds(2);
+
+std::vector<uint8_t> mbap(uint16_t transactionId) {
+    const auto pdu =
+        MB::ModbusRequest(1, MB::utils::ReadAnalogOutputHoldingRegisters, 0, 10).toRaw();
+    std::vector<uint8_t> frame;
+    MB::utils::pushUint16(frame, transactionId);
+    MB::utils::pushUint16(frame, 0x0000);
+    MB::utils::pushUint16(frame, static_cast<uint16_t>(pdu.size()));
+    frame.insert(frame.end(), pdu.begin(), pdu.end());
+    return frame;
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(fraction * (values.size() - 1))];
+}
+
+void run(bool fair) {
+    // Flooder keeps its window of requests queued all the time, it has to
+    // outlive the gateway, that answers requests left in queues
+    std::atomic<bool> flooding    = true;
+    std::atomic<uint64_t> flooded = 0;
+    MB::ModbusGateway::Reply flood;
+
+    MB::ModbusGateway gateway;
+    gateway.addLine(
+        [](const MB::ModbusRequest &request) {
+            std::this_thread::sleep_for(BusTime);
+            return MB::ModbusResponse(request.slaveID(), request.functionCode(),
+                                      request.registerAddress(),
+                                      request.numberOfRegisters(),
+                                      std::vector<MB::ModbusCell>(
+                                          request.numberOfRegisters(),
+                                          MB::ModbusCell::initReg(0)));
+        },
+        {1});
+    // FIFO puts everyone into a single queue, big enough for all requests
+    gateway.setClientQueueLimit(fair ? FloodWindow : FloodWindow + Clients);
+    const auto clientId = [fair](std::size_t client) -> MB::ModbusGateway::ClientId {
+        return fair ? client : 0;
+    };
+
+    flood = [&](std::vector<uint8_t>) {
+        flooded++;
+        if (flooding)
+            gateway.handle(mbap(0), flood, clientId(Clients));
+    };
+    for (std::size_t i = 0; i < FloodWindow; i++)
+        gateway.handle(mbap(0), flood, clientId(Clients));
+
+    std::vector<std::vector<double>> latencies(Clients);
+    std::vector<std::thread> threads;
+    const auto end = Clock::now() + Duration;
+    for (std::size_t client = 0; client < Clients; client++) {
+        threads.emplace_back([&, client]() {
+            uint16_t transactionId = 0;
+            while (Clock::now() < end) {
+                std::promise<void> done;
+                const auto start = Clock::now();
+                gateway.handle(mbap(transactionId++),
+                               [&done](std::vector<uint8_t>) { done.set_value(); },
+                               clientId(client));
+                done.get_future().wait();
+                latencies[client].push_back(
+                    std::chrono::duration<double, std::milli>(Clock::now() - start)
+                        .count());
+                std::this_thread::sleep_for(PollInterval);
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    flooding = false;
+
+    std::cout << (fair ? "Deficit round-robin" : "FIFO") << ":\n";
+    for (std::size_t client = 0; client < Clients; client++) {
+        std::cout << "  Client " << client << ": " << latencies[client].size()
+                  << " requests, p50 " << percentile(latencies[client], 0.5)
+                  << " ms, p99 " << percentile(latencies[client], 0.99) << " ms\n";
+    }
+    std::cout << "  Flooder:  " << flooded << " requests\n"
+              << "  Rejected: " << gateway.metrics(0).rejected << std::endl;
+}
+} // namespace
+
+int main() {
+    run(false);
+    run(true);
+    return 0;
+}
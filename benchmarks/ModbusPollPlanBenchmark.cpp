@@ -0,0 +1,74 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Measures how many transactions per scan the poll planner saves, on scattered
+// tag lists of several devices, and how long planning takes
+
+#include "MB/modbusPollPlan.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <vector>
+
+int main() {
+    constexpr int Devices       = 16;
+    constexpr int TagsPerDevice = 1000;
+    constexpr int Iterations    = 50;
+
+    // Scattered tags with gaps of 0-15 addresses, some of them 32-bit values
+    std::vector<MB::ModbusTag> tags;
+    std::map<uint8_t, MB::ModbusDeviceLimits> limits;
+    uint32_t seed = 12345;
+    const auto random = [&seed](uint32_t max) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % max;
+    };
+    for (int device = 1; device <= Devices; device++) {
+        const auto slaveId = static_cast<uint8_t>(device);
+        // Every second device has a hole in its map
+        if (device % 2 == 0)
+            limits[slaveId].forbidden = {{MB::utils::HoldingRegisters, 2000, 500}};
+
+        uint16_t address = 0;
+        for (int i = 0; i < TagsPerDevice; i++) {
+            const auto table = i % 4 == 0 ? MB::utils::OutputCoils
+                                          : MB::utils::HoldingRegisters;
+            const auto count = static_cast<uint16_t>(random(3) == 0 ? 2 : 1);
+            tags.push_back({slaveId, table, address, count});
+            address = static_cast<uint16_t>(address + count + random(16));
+        }
+    }
+
+    std::size_t naiveBytes = 0;
+    for (const auto &tag : tags) {
+        const bool coils = tag.table == MB::utils::OutputCoils;
+        naiveBytes += MB::ModbusDeviceLimits().transactionOverhead +
+                      (coils ? (tag.count + 7) / 8 : tag.count * 2);
+    }
+
+    std::size_t checksum = 0;
+    const auto start     = std::chrono::steady_clock::now();
+    for (int i = 0; i < Iterations; i++) {
+        const MB::ModbusPollPlan plan(tags, limits);
+        checksum += plan.transactions();
+    }
+    const auto planning =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    const MB::ModbusPollPlan plan(tags, limits);
+    const double reduction =
+        1.0 - static_cast<double>(plan.transactions()) / static_cast<double>(tags.size());
+    std::cout << "Tags:                 " << tags.size() << "\n"
+              << "Transactions / scan:  " << plan.transactions() << "\n"
+              << "Reduction:            " << reduction * 100 << " %\n"
+              << "Bytes / scan, naive:  " << naiveBytes << "\n"
+              << "Bytes / scan, plan:   " << plan.wireBytes() << "\n"
+              << "Planning:             " << planning.count() / Iterations * 1000
+              << " ms\n"
+              << "Checksum:             " << checksum << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Measures offline decoding speed of the sniffer, on a capture made of
+// typical polling traffic with some line noise
+
+#include "MB/crc.hpp"
+#include "MB/modbusSniffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+void appendFrame(std::vector<uint8_t> &capture, std::vector<uint8_t> frame) {
+    const auto crc = MB::CRC::calculateCRC(frame);
+    frame.push_back(static_cast<uint8_t>(crc & 0xFF));
+    frame.push_back(static_cast<uint8_t>(crc >> 8));
+    capture.insert(capture.end(), frame.begin(), frame.end());
+}
+
+std::vector<uint8_t> makeCapture(std::size_t size) {
+    std::mt19937 random(42);
+    std::vector<uint8_t> capture;
+    capture.reserve(size + 512);
+
+    while (capture.size() < size) {
+        const auto slave = static_cast<uint8_t>(1 + random() % 32);
+        const auto count = static_cast<uint8_t>(1 + random() % 60);
+
+        appendFrame(capture, {slave, 0x03, 0x00, 0x10, 0x00, count});
+
+        std::vector<uint8_t> response = {slave, 0x03, static_cast<uint8_t>(2 * count)};
+        for (int i = 0; i < 2 * count; i++)
+            response.push_back(static_cast<uint8_t>(random()));
+        appendFrame(capture, response);
+
+        // Occasional burst of noise between transactions
+        if (random() % 100 == 0)
+            for (int i = 0; i < 8; i++)
+                capture.push_back(static_cast<uint8_t>(random()));
+    }
+
+    return capture;
+}
+} // namespace
+
+int main() {
+    constexpr std::size_t CaptureSize = 64 * 1024 * 1024;
+    constexpr std::size_t ChunkSize   = 4096;
+
+    const auto capture = makeCapture(CaptureSize);
+
+    std::size_t paired = 0;
+    MB::ModbusSniffer sniffer([&paired](const MB::ModbusSniffer::Transaction &t) {
+        if (t.request.has_value() && t.response.has_value())
+            paired++;
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t offset = 0; offset < capture.size(); offset += ChunkSize)
+        sniffer.feed(capture.data() + offset, std::min(ChunkSize, capture.size() - offset));
+    sniffer.finish();
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    const auto &statistics = sniffer.statistics();
+    std::cout << "Capture size:     " << capture.size() / (1024 * 1024) << " MiB\n"
+              << "Frames:           " << statistics.frames << "\n"
+              << "Paired:           " << paired << "\n"
+              << "Discarded bytes:  " << statistics.discardedBytes << "\n"
+              << "Throughput:       " << capture.size() / elapsed.count() / (1024 * 1024)
+              << " MiB/s" << std::endl;
+
+    return 0;
+}
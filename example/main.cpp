@@ -2,6 +2,7 @@
 // Copyright (c) 2020 Mateusz Mazur aka Mazurel
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
+#include "MB/modbusClient.hpp"
 #include "MB/modbusException.hpp"
 #include "MB/modbusRequest.hpp"
 #include "MB/modbusResponse.hpp"
@@ -77,11 +78,9 @@ int main() {
 
     MB::ModbusRequest request_status(1, MB::utils::ReadDiscreteInputContacts, 0, 2);
     MB::ModbusRequest request_measure(1, MB::utils::WriteSingleAnalogOutputRegister, 0x100, 1, {MB::ModbusCell::initReg(0x00)});
-    MB::ModbusRequest request_result(1, MB::utils::ReadAnalogInputRegisters, 0x1000, 1024);
 
     std::cout << "Request status: " << request_status.toString() << std::endl;
     std::cout << "Request measure: " << request_measure.toString() << std::endl;
-    std::cout << "Request result: " << request_result.toString() << std::endl;
 
     try {
         conn.connect("COM46");
@@ -113,10 +112,14 @@ int main() {
             }
         }
 
-        conn.sendRequest(request_result);
-        auto tuple = conn.awaitResponse();
-        auto result = std::get<0>(tuple);
-        std::cout << "Result: " << result.toString() << std::endl;
+        // 1024 registers do not fit in single request, client splits them
+        MB::ModbusClient client([&conn](const MB::ModbusRequest &request) {
+            conn.sendRequest(request);
+            return std::get<0>(conn.awaitResponse());
+        });
+        auto result = client.readInputRegisters(1, 0x1000, 1024);
+        std::cout << "Result: " << result.size() << " registers, first: " << result.front()
+                  << std::endl;
 
     } catch(MB::ModbusException &ex) {
         std::cerr << ex.toString() << std::endl;
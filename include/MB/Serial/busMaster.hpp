@@ -0,0 +1,59 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "connection.hpp"
+#include "MB/modbusTransactionQueue.hpp"
+
+namespace MB::Serial {
+/**
+ * Bus master, that owns serial connection and schedules transactions on it.
+ * Transactions are put into priority classes and dispatched one at a time
+ * from separate thread, so urgent writes only wait for the frame that is
+ * currently on the bus.
+ */
+class BusMaster {
+  private:
+    Connection _connection;
+    MB::ModbusTransactionQueue _queue;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _stop = false;
+    std::thread _thread;
+
+    void run();
+    void dispatch(MB::ModbusTransactionQueue::Transaction &transaction);
+
+  public:
+    explicit BusMaster(Connection &&connection);
+    BusMaster(const BusMaster &) = delete;
+    BusMaster &operator=(const BusMaster &) = delete;
+
+    //! Stops dispatching, all transactions left in the queue are failed
+    ~BusMaster();
+
+    /**
+     * @brief Schedules request on the bus
+     * @note Broadcast request is fulfilled with response made from the request,
+     * as soon as it is sent
+     * @return Future with the response, it rethrows ModbusException on error
+     */
+    std::future<MB::ModbusResponse>
+    submit(const MB::ModbusRequest &request,
+           MB::ModbusPriority priority = MB::ModbusPriority::Poll);
+
+    //! Returns queue depth and wait time statistics of the priority class
+    [[nodiscard]] MB::ModbusTransactionQueue::Metrics
+    metrics(MB::ModbusPriority priority) const;
+
+    void setAgingStep(MB::ModbusTransactionQueue::Clock::duration agingStep);
+};
+} // namespace MB::Serial
@@ -4,17 +4,23 @@
 
 #pragma once
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#endif
+#include <chrono>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <tuple>
 #include <vector>
 
+#include "MB/modbusAdaptiveTimeouts.hpp"
 #include "MB/modbusException.hpp"
 #include "MB/modbusRequest.hpp"
 #include "MB/modbusResponse.hpp"
+#include "MB/modbusSniffer.hpp"
 #include "MB/modbusUtils.hpp"
 
 namespace MB::Serial {
@@ -25,10 +31,31 @@ class Connection {
   public:
     // Pretty high timeout
     static const unsigned int DefaultSerialTimeout = 1000;
+    // Time given to slaves for processing broadcast, before next transaction
+    static const unsigned int DefaultTurnaroundDelay = 100;
+
+    //! Encoding of the frames on the line
+    enum class Framing {
+        RTU,
+        ASCII
+    };
 
   private:
     SerialPortImpl *_impl = nullptr;
     int _timeout = Connection::DefaultSerialTimeout;
+    int _turnaroundDelay = Connection::DefaultTurnaroundDelay;
+    std::chrono::steady_clock::time_point _busFreeAt;
+    Framing _framing = Framing::RTU;
+    // Response timeouts by slave id, instead of the fixed one
+    std::shared_ptr<MB::ModbusAdaptiveTimeouts> _adaptiveTimeouts;
+    uint8_t _requestSlave = 0;
+    std::chrono::steady_clock::time_point _requestSentAt;
+
+    // Reads single ASCII frame, from ':' up to LF
+    std::vector<uint8_t> awaitAsciiFrame(int timeout);
+    // Reads whatever comes within the timeout
+    std::vector<uint8_t> readRaw(int timeout);
+    std::tuple<MB::ModbusResponse, std::vector<uint8_t>> readResponse(int timeout);
 
   public:
     enum class Parity {
@@ -62,19 +89,38 @@ class Connection {
     std::vector<uint8_t> sendResponse(const MB::ModbusResponse &response);
     std::vector<uint8_t> sendException(const MB::ModbusException &exception);
 
+    /**
+     * @brief Sends write request to all slaves, without waiting for response
+     * @note Next transaction is delayed by the turnaround delay
+     * @throws ModbusException - IllegalFunction if request cannot be broadcasted
+     */
+    std::vector<uint8_t> sendBroadcast(const MB::ModbusRequest &request);
+
     /**
      * @brief Sends data through the serial
-     * @param data - Vectorized data
+     * @param data - Vectorized data, CRC or ASCII encoding is added depending
+     * on framing
      */
     std::vector<uint8_t> send(std::vector<uint8_t> data);
 
     void clearInput();
 
+    /**
+     * @brief Waits for response of the slave of the last request, responses of
+     * other slaves (e.g. late ones to earlier requests) are dropped
+     */
     [[nodiscard]] std::tuple<MB::ModbusResponse, std::vector<uint8_t>> awaitResponse();
     [[nodiscard]] std::tuple<MB::ModbusRequest, std::vector<uint8_t>> awaitRequest();
 
     [[nodiscard]] std::vector<uint8_t> awaitRawMessage();
 
+    /**
+     * @brief Passively reads bytes from the bus and feeds them to the sniffer,
+     * nothing is sent
+     * @return Number of bytes read, 0 if nothing came within the timeout
+     */
+    std::size_t sniff(MB::ModbusSniffer &sniffer);
+
     void setParity(Parity parity);
 
     void setStopBits(StopBits stopBits);
@@ -86,5 +132,29 @@ class Connection {
     int getTimeout() const { return _timeout; }
 
     void setTimeout(int timeout) { _timeout = timeout; }
+
+    int getTurnaroundDelay() const { return _turnaroundDelay; }
+
+    void setTurnaroundDelay(int turnaroundDelay) { _turnaroundDelay = turnaroundDelay; }
+
+    Framing getFraming() const { return _framing; }
+
+    /**
+     * @brief Switches between RTU and ASCII frames
+     * @note ASCII devices usually use 7 data bits and even parity
+     */
+    void setFraming(Framing framing) { _framing = framing; }
+
+    /**
+     * @brief Uses timeouts estimated per slave id for awaitResponse, instead
+     * of the fixed timeout, nullptr turns it off
+     */
+    void setAdaptiveTimeouts(std::shared_ptr<MB::ModbusAdaptiveTimeouts> timeouts) {
+        _adaptiveTimeouts = std::move(timeouts);
+    }
+
+    const std::shared_ptr<MB::ModbusAdaptiveTimeouts> &getAdaptiveTimeouts() const {
+        return _adaptiveTimeouts;
+    }
 };
 } // namespace MB::Serial
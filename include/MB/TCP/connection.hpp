@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <type_traits>
+#include <vector>
 
 #include <cerrno>
 #include <libnet.h>
@@ -13,6 +15,7 @@
 #include <poll.h>
 #include <sys/socket.h>
 
+#include "MB/modbusAdaptiveTimeouts.hpp"
 #include "MB/modbusException.hpp"
 #include "MB/modbusRequest.hpp"
 #include "MB/modbusResponse.hpp"
@@ -21,11 +24,29 @@ namespace MB::TCP {
 class Connection {
   public:
     static const unsigned int DefaultTCPTimeout = 500;
+    // Waiting for request longer than this means the connection has died
+    static const unsigned int DefaultRequestTimeout = 60 * 1000;
+    // Number of requests that may wait for response at the same time
+    static const std::size_t DefaultPipelineWindow = 16;
 
   private:
     int _sockfd         = -1;
     uint16_t _messageID = 0;
+    // Message ID of the last request sent
+    uint16_t _requestID = 0;
     int _timeout        = Connection::DefaultTCPTimeout;
+    int _requestTimeout = Connection::DefaultRequestTimeout;
+    // Bytes received after the last complete frame
+    std::vector<uint8_t> _rxBuffer;
+    // Response timeouts by unit id, instead of the fixed one
+    std::shared_ptr<MB::ModbusAdaptiveTimeouts> _adaptiveTimeouts;
+    uint8_t _requestSlave = 0;
+    std::chrono::steady_clock::time_point _requestSentAt;
+
+    std::vector<uint8_t> sendFrame(uint16_t messageID, const std::vector<uint8_t> &dat);
+    std::vector<uint8_t> receiveFrame(int timeout, MB::utils::MBErrorCode onTimeout);
+    // Decodes response frame, its message id was already checked
+    MB::ModbusResponse parseResponse(std::vector<uint8_t> r);
 
   public:
     explicit Connection() noexcept : _sockfd(-1), _messageID(0) {};
@@ -39,9 +60,16 @@ class Connection {
         if (_sockfd != -1 && _sockfd != other._sockfd)
             ::close(_sockfd);
 
-        _sockfd       = other._sockfd;
-        _messageID    = other._messageID;
-        other._sockfd = -1;
+        _sockfd           = other._sockfd;
+        _messageID        = other._messageID;
+        _requestID        = other._requestID;
+        _timeout          = other._timeout;
+        _requestTimeout   = other._requestTimeout;
+        _requestSlave     = other._requestSlave;
+        _requestSentAt    = other._requestSentAt;
+        _rxBuffer         = std::move(other._rxBuffer);
+        _adaptiveTimeouts = std::move(other._adaptiveTimeouts);
+        other._sockfd     = -1;
 
         return *this;
     }
@@ -56,13 +84,63 @@ class Connection {
     std::vector<uint8_t> sendResponse(const MB::ModbusResponse &res);
     std::vector<uint8_t> sendException(const MB::ModbusException &ex);
 
+    /**
+     * @brief Sends write request with unit id 0, without waiting for response.
+     * Serial gateways broadcast it, while TCP devices may take it as their own
+     * and answer it.
+     * @throws ModbusException - IllegalFunction if request cannot be broadcasted
+     */
+    std::vector<uint8_t> sendBroadcast(const MB::ModbusRequest &req);
+
     [[nodiscard]] MB::ModbusRequest awaitRequest();
+    /**
+     * @brief Waits for response to the last request sent, responses to earlier
+     * requests (e.g. ones that timed out) are dropped
+     */
     [[nodiscard]] MB::ModbusResponse awaitResponse();
 
+    /**
+     * @brief Sends requests with consecutive message IDs, keeping up to `window`
+     * of them in flight, and matches responses by message ID
+     * @return Responses in the order of requests
+     * @throws ModbusException - first exception response, after all responses
+     * were collected
+     */
+    std::vector<MB::ModbusResponse>
+    pipelineRequests(const std::vector<MB::ModbusRequest> &requests,
+                     std::size_t window = DefaultPipelineWindow);
+
     [[nodiscard]] std::vector<uint8_t> awaitRawMessage();
 
+    //! Sends complete MBAP frame as it is, e.g. one forwarded by gateway
+    void sendRawMessage(const std::vector<uint8_t> &frame);
+
+    //! Message ID of the next request, or of the last request received
     [[nodiscard]] uint16_t getMessageId() const { return _messageID; }
 
     void setMessageId(uint16_t messageId) { _messageID = messageId; }
+
+    [[nodiscard]] int getTimeout() const { return _timeout; }
+
+    void setTimeout(int timeout) { _timeout = timeout; }
+
+    [[nodiscard]] int getRequestTimeout() const { return _requestTimeout; }
+
+    void setRequestTimeout(int timeout) { _requestTimeout = timeout; }
+
+    /**
+     * @brief Uses timeouts estimated per unit id for awaitResponse, instead of
+     * the fixed timeout, nullptr turns it off
+     * @note Pipelined requests still use the fixed timeout, as their response
+     * times include waiting behind each other
+     */
+    void setAdaptiveTimeouts(std::shared_ptr<MB::ModbusAdaptiveTimeouts> timeouts) {
+        _adaptiveTimeouts = std::move(timeouts);
+    }
+
+    [[nodiscard]] const std::shared_ptr<MB::ModbusAdaptiveTimeouts> &
+    getAdaptiveTimeouts() const {
+        return _adaptiveTimeouts;
+    }
 };
 } // namespace MB::TCP
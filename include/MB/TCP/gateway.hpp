@@ -0,0 +1,88 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "connection.hpp"
+#include "MB/modbusGateway.hpp"
+#include "MB/modbusRateLimiter.hpp"
+
+namespace MB::TCP {
+/**
+ * Serves Modbus TCP masters with ModbusGateway, e.g. connections accepted by
+ * Server:
+ *
+ *     while (auto connection = server.awaitConnection())
+ *         gateway.serve(std::move(*connection));
+ *
+ * Each connection is read by its own thread, and responses are sent from the
+ * threads of the lines as soon as they come, so masters may pipeline their
+ * requests. Connection is closed when it sends invalid frame, or nothing
+ * for its request timeout.
+ *
+ * Each connection is a separate client of the engine, with its own queues
+ * and share of the bus time.
+ *
+ * Request rates may be capped with ModbusRateLimiter, per connection and per
+ * source IPv4 address. Over-limit request delays reading of its connection,
+ * or is answered with SlaveDeviceBusy, if it would wait too long.
+ */
+class Gateway {
+  private:
+    struct Session {
+        Connection connection;
+        MB::ModbusGateway::ClientId client;
+        std::unique_ptr<MB::ModbusRateLimiter::Client> limits;
+        std::mutex mutex; // Guards sending of responses
+        std::atomic<bool> finished = false;
+        std::thread thread;
+
+        Session(Connection &&connection, MB::ModbusGateway::ClientId client)
+            : connection(std::move(connection)), client(client) {}
+    };
+
+    MB::ModbusGateway &_engine;
+    mutable std::mutex _mutex;
+    std::vector<std::shared_ptr<Session>> _sessions;
+    MB::ModbusGateway::ClientId _nextClient = 1;
+    std::shared_ptr<MB::ModbusRateLimiter> _rateLimiter;
+
+    void run(const std::shared_ptr<Session> &session);
+    // Applies rate limits, false if request was rejected
+    bool admit(Session &session, const std::vector<uint8_t> &frame) const;
+    // Joins threads of closed sessions, must be called with the lock held
+    void reap();
+
+  public:
+    //! Engine has to outlive the gateway
+    explicit Gateway(MB::ModbusGateway &engine) : _engine(engine) {}
+    Gateway(const Gateway &) = delete;
+    Gateway &operator=(const Gateway &) = delete;
+
+    //! Shuts all connections down and waits for their threads
+    ~Gateway();
+
+    /**
+     * @brief Starts serving the connection in its own thread
+     * @param share - Share of the bus time of the connection, relative to others
+     * @throws std::invalid_argument - if share is zero
+     */
+    void serve(Connection &&connection, std::size_t share = 1);
+
+    /**
+     * @brief Limits rates of connections served from now on, nullptr turns it
+     * off
+     */
+    void setRateLimiter(std::shared_ptr<MB::ModbusRateLimiter> limiter);
+
+    //! Number of open connections
+    [[nodiscard]] std::size_t sessions() const;
+};
+} // namespace MB::TCP
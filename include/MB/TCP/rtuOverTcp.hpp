@@ -0,0 +1,80 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "connection.hpp"
+
+namespace MB::TCP {
+/**
+ * Transport, that tunnels raw RTU frames (slave id, PDU and CRC, without MBAP
+ * header) over TCP, as done by many serial device servers.
+ *
+ * Socket works in non-blocking mode. Frames are reassembled from the stream
+ * using RTU length prediction and checked with CRC. As RTU has no transaction
+ * IDs, pipelined responses are matched with requests in order, and response
+ * is recognized by its slave id and function code - responses of others (e.g.
+ * late ones to requests that have timed out) are dropped.
+ */
+class RtuOverTcp {
+  private:
+    int _sockfd  = -1;
+    int _timeout = Connection::DefaultTCPTimeout;
+    // Bytes received after the last complete frame
+    std::vector<uint8_t> _rxBuffer;
+    // Slave id and function code of the last request sent
+    uint8_t _requestSlave    = 0;
+    uint8_t _requestFunction = 0;
+
+    std::vector<uint8_t> send(std::vector<uint8_t> data);
+    std::vector<uint8_t> receiveResponse(std::chrono::steady_clock::time_point deadline);
+
+  public:
+    explicit RtuOverTcp(int sockfd) noexcept;
+    RtuOverTcp(const RtuOverTcp &copy) = delete;
+    RtuOverTcp(RtuOverTcp &&moved) noexcept;
+    RtuOverTcp &operator=(RtuOverTcp &&other) noexcept;
+    ~RtuOverTcp();
+
+    [[nodiscard]] int getSockfd() const { return _sockfd; }
+
+    static RtuOverTcp with(std::string addr, int port);
+
+    std::vector<uint8_t> sendRequest(const MB::ModbusRequest &req);
+    std::vector<uint8_t> sendResponse(const MB::ModbusResponse &res);
+    std::vector<uint8_t> sendException(const MB::ModbusException &ex);
+
+    /**
+     * @brief Sends write request to all slaves behind the converter
+     * @throws ModbusException - IllegalFunction if request cannot be broadcasted
+     */
+    std::vector<uint8_t> sendBroadcast(const MB::ModbusRequest &req);
+
+    [[nodiscard]] MB::ModbusRequest awaitRequest();
+    /**
+     * @brief Waits for response to the last request sent, responses of other
+     * slaves or functions are dropped
+     */
+    [[nodiscard]] MB::ModbusResponse awaitResponse();
+
+    /**
+     * @brief Sends requests back to back, keeping up to `window` of them in
+     * flight, and matches responses in order
+     * @return Responses in the order of requests
+     * @throws ModbusException - first exception response, after all responses
+     * were collected
+     */
+    std::vector<MB::ModbusResponse>
+    pipelineRequests(const std::vector<MB::ModbusRequest> &requests,
+                     std::size_t window = Connection::DefaultPipelineWindow);
+
+    [[nodiscard]] int getTimeout() const { return _timeout; }
+
+    void setTimeout(int timeout) { _timeout = timeout; }
+};
+} // namespace MB::TCP
@@ -43,6 +43,9 @@ class Server {
 
     [[nodiscard]] int nativeHandle() { return _serverfd; }
 
+    //! Port the server listens on, also when it was created with port 0
+    [[nodiscard]] int port() const { return _port; }
+
     std::optional<Connection> awaitConnection();
 };
 } // namespace MB::TCP
@@ -0,0 +1,145 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "server.hpp"
+#include "MB/modbusRateLimiter.hpp"
+#include "MB/modbusUnitServer.hpp"
+
+namespace MB::TCP {
+/**
+ * Serves Modbus TCP masters with ModbusUnitServer, all connections and all
+ * units from a single event loop:
+ *
+ *     MB::ModbusUnitServer units;
+ *     units.addUnit(1, std::make_shared<MB::ModbusDataStore>(16, 16, 16, 16));
+ *     MB::TCP::UnitServer server(units, 502);
+ *     server.run();
+ *
+ * Sockets are non-blocking, requests are answered as they are cut from the
+ * stream, so masters may pipeline them. Connection is closed when it sends
+ * invalid frame, or nothing for its idle timeout. Connection that does not
+ * read its responses is not read either, until they are sent.
+ *
+ * Units offloaded to the worker pool (see ModbusUnitServer::setOffloaded)
+ * are answered by the workers, their responses are handed back to the loop,
+ * that sends them. Responses of one connection may then come in a different
+ * order than its requests, matched by their transaction ids.
+ *
+ * Request rates may be capped with ModbusRateLimiter, per connection and per
+ * source IPv4 address. Over-limit request is kept in the connection, which is
+ * not read until its delay passes, or is answered with SlaveDeviceBusy, if it
+ * would wait too long. The loop goes on serving other connections meanwhile.
+ */
+class UnitServer {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    //! Responses waiting for the master, above which its requests are not read
+    static constexpr std::size_t MaxPendingResponses = 64 * 1024;
+
+  private:
+    struct Client {
+        uint64_t id;
+        int sockfd;
+        std::vector<uint8_t> rx;
+        std::vector<uint8_t> tx;
+        Clock::time_point lastRequest;
+        bool closed = false;
+        std::unique_ptr<MB::ModbusRateLimiter::Client> limits = nullptr;
+        // Tokens are taken for the first frame of `rx`, it waits till `resumeAt`
+        bool deferred = false;
+        Clock::time_point resumeAt = {};
+    };
+
+    // Responses of the workers, by client id, shared with their tasks, as
+    // they may finish after the server is gone
+    struct Completed {
+        std::mutex mutex;
+        std::vector<std::pair<uint64_t, std::vector<uint8_t>>> responses;
+        // Wakes the loop from `stop` and from the workers
+        int wakeFds[2] = {-1, -1};
+
+        ~Completed();
+        void wake() const;
+    };
+
+    MB::ModbusUnitServer &_engine;
+    Server _server;
+    std::shared_ptr<Completed> _completed = std::make_shared<Completed>();
+    std::vector<Client> _clients;
+    uint64_t _nextClient = 0;
+    std::thread::id _loopThread;
+    std::atomic<bool> _stop         = false;
+    std::atomic<std::size_t> _count = 0;
+    std::atomic<uint64_t> _requests = 0;
+    Clock::duration _idleTimeout = std::chrono::milliseconds(
+        static_cast<int>(Connection::DefaultRequestTimeout));
+    std::shared_ptr<MB::ModbusRateLimiter> _rateLimiter;
+
+    void accept();
+    void receive(Client &client);
+    // Handles complete frames of `rx`, until one of them is deferred
+    void process(Client &client);
+    // Applies rate limits, false if request was deferred or rejected
+    bool admit(Client &client, const std::vector<uint8_t> &frame);
+    void send(Client &client);
+    // Appends responses of the workers to their clients
+    void deliver();
+
+  public:
+    /**
+     * @brief Listens on the port (0 for any free port), engine has to outlive
+     * the server
+     * @throws std::runtime_error - if socket cannot be set up
+     */
+    UnitServer(MB::ModbusUnitServer &engine, int port);
+    UnitServer(const UnitServer &) = delete;
+    UnitServer &operator=(const UnitServer &) = delete;
+
+    //! Closes all connections
+    ~UnitServer();
+
+    /**
+     * @brief Waits for events up to `timeout` milliseconds (-1 for no limit)
+     * and handles them, for applications that drive the loop themselves
+     * @return Number of requests handled
+     */
+    std::size_t poll(int timeout);
+
+    //! Handles events until `stop` is called
+    void run();
+
+    //! Makes `run` return, may be called from any thread
+    void stop();
+
+    void setIdleTimeout(Clock::duration timeout) { _idleTimeout = timeout; }
+
+    /**
+     * @brief Limits rates of connections accepted from now on, nullptr turns
+     * it off
+     */
+    void setRateLimiter(std::shared_ptr<MB::ModbusRateLimiter> limiter) {
+        _rateLimiter = std::move(limiter);
+    }
+
+    [[nodiscard]] int port() const { return _server.port(); }
+
+    //! Number of open connections
+    [[nodiscard]] std::size_t connections() const noexcept { return _count; }
+
+    //! Number of requests handled, broadcasts included
+    [[nodiscard]] uint64_t requests() const noexcept { return _requests; }
+};
+} // namespace MB::TCP
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! This namespace contains functions used for LRC calculation (Modbus ASCII)
+namespace MB::LRC {
+//! Calculates LRC based on the input buffer - C style
+uint8_t calculateLRC(const uint8_t *buff, std::size_t len);
+
+//! Calculate LRC based on the input vector of bytes
+inline uint8_t calculateLRC(const std::vector<uint8_t> &buffer) {
+    return calculateLRC(buffer.data(), buffer.size());
+}
+}; // namespace MB::LRC
@@ -0,0 +1,91 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "modbusRequest.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Map of the areas of the slave, that masters may read and write, e.g. to
+ * keep them away from gaps in the address space, and from writing setpoints
+ * that are read-only.
+ *
+ * Each table has three bitmaps over the whole address space - readable,
+ * writable and mapped (readable or writable) - so that checking a range is
+ * a comparison of whole 64-bit words, whatever the number of mapped areas.
+ * The biggest request (125 registers) spans at most 3 words.
+ *
+ * ModbusUnitServer checks requests of the unit with it, when set with
+ * `setAccessMap`.
+ */
+class ModbusAccessMap {
+  public:
+    enum Access : uint8_t { None = 0, Read = 1, Write = 2, ReadWrite = Read | Write };
+
+  private:
+    static constexpr std::size_t Words = 0x10000 / 64;
+    using Bitmap                       = std::array<uint64_t, Words>;
+
+    enum Kind { Readable, Writable, Mapped };
+
+    // Indexed by table * 3 + kind, kept on the heap as they take 96 KiB
+    std::vector<Bitmap> _bitmaps;
+
+    [[nodiscard]] const Bitmap &bitmap(utils::MBFunctionRegisters table,
+                                       Kind kind) const noexcept {
+        return _bitmaps[table * 3 + kind];
+    }
+    [[nodiscard]] bool allSet(utils::MBFunctionRegisters table, Kind kind,
+                              uint16_t address, std::size_t count) const noexcept;
+
+  public:
+    //! Creates map with nothing mapped
+    ModbusAccessMap();
+
+    /**
+     * @brief Sets access of the range, replacing the previous one, None unmaps it
+     * @throws std::invalid_argument - if range exceeds the address space
+     */
+    void map(utils::MBFunctionRegisters table, uint16_t address, std::size_t count,
+             Access access);
+
+    //! True if every address of the range may be read or written
+    [[nodiscard]] bool mapped(utils::MBFunctionRegisters table, uint16_t address,
+                              std::size_t count) const noexcept {
+        return allSet(table, Mapped, address, count);
+    }
+
+    [[nodiscard]] bool readable(utils::MBFunctionRegisters table, uint16_t address,
+                                std::size_t count) const noexcept {
+        return allSet(table, Readable, address, count);
+    }
+
+    [[nodiscard]] bool writable(utils::MBFunctionRegisters table, uint16_t address,
+                                std::size_t count) const noexcept {
+        return allSet(table, Writable, address, count);
+    }
+
+    /**
+     * @brief Checks that request reads and writes only what it may, requests
+     * that do not access tables (FIFO, files, identification) are allowed
+     */
+    [[nodiscard]] bool allows(const ModbusRequest &request) const;
+
+    /**
+     * @throws ModbusException - IllegalDataAddress, with slave id and function
+     * code of the request, if request is not allowed
+     */
+    void check(const ModbusRequest &request) const;
+};
+} // namespace MB
@@ -0,0 +1,86 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Response timeouts of devices, estimated from their response times, the
+ * way TCP estimates its retransmission timeout (RFC 6298):
+ *
+ *     variance = 3/4 * variance + 1/4 * |smoothed - rtt|
+ *     smoothed = 7/8 * smoothed + 1/8 * rtt
+ *     timeout  = smoothed + 4 * variance
+ *
+ * The first response sets smoothed to rtt and variance to rtt / 2. Every
+ * timeout doubles the timeout of the device, until the next response.
+ * Timeouts are clamped to the minimum and maximum, and devices that did
+ * not respond yet get the initial timeout.
+ *
+ * Connections use it when set with `setAdaptiveTimeouts`, so that a dead
+ * device stalls the line only for its maximum, while fast devices time out
+ * in tens of milliseconds. It may be shared by connections to the same
+ * devices, all methods are thread safe.
+ */
+class ModbusAdaptiveTimeouts {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings {
+        Clock::duration minimum = std::chrono::milliseconds(20);
+        Clock::duration maximum = std::chrono::milliseconds(1000);
+        Clock::duration initial = std::chrono::milliseconds(1000);
+    };
+
+    //! State of single device
+    struct Estimate {
+        Clock::duration smoothed = Clock::duration::zero();
+        Clock::duration variance = Clock::duration::zero();
+        Clock::duration timeout  = Clock::duration::zero();
+        uint64_t samples         = 0;
+        uint64_t timeouts        = 0;
+    };
+
+  private:
+    Settings _settings;
+    mutable std::mutex _mutex;
+    std::map<uint8_t, Estimate> _devices;
+
+    [[nodiscard]] Clock::duration clamp(Clock::duration timeout) const;
+
+  public:
+    ModbusAdaptiveTimeouts();
+
+    /**
+     * @throws std::invalid_argument - if minimum is not positive or is bigger
+     * than maximum
+     */
+    explicit ModbusAdaptiveTimeouts(Settings settings);
+
+    //! Timeout for the next response of the device
+    [[nodiscard]] Clock::duration timeout(uint8_t slaveId) const;
+
+    //! Records time from the end of request to the end of response
+    void sample(uint8_t slaveId, Clock::duration rtt);
+
+    //! Records response timeout, backing off the timeout of the device
+    void timedOut(uint8_t slaveId);
+
+    //! Forgets the device, e.g. after it was replaced
+    void reset(uint8_t slaveId);
+
+    [[nodiscard]] std::optional<Estimate> estimate(uint8_t slaveId) const;
+
+    [[nodiscard]] const Settings &settings() const noexcept { return _settings; }
+};
+} // namespace MB
@@ -0,0 +1,86 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Admission control of the queue of requests, that sheds load instead of
+ * letting the queue (and latency of everyone) grow without bound.
+ *
+ * Request is admitted, when the queue ahead of it is shorter than
+ * `maxQueueDepth`, and its estimated wait is shorter than `maxWait`. Wait is
+ * estimated as the number of queued requests times the smoothed service
+ * time of one request:
+ *
+ *     serviceTime = 7/8 * serviceTime + 1/8 * sample
+ *
+ * Zero disables the limit. Shed request should be answered with
+ * SlaveDeviceBusy right away, so that master may retry later or elsewhere.
+ *
+ * @note This class is not thread safe, it is meant to be guarded by the
+ * owner of the queue.
+ */
+class ModbusAdmission {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings {
+        //! Requests waiting or being served, zero for no limit
+        std::size_t maxQueueDepth = 0;
+        //! Estimated wait of the new request, zero for no limit
+        Clock::duration maxWait = Clock::duration::zero();
+    };
+
+    struct Metrics {
+        uint64_t admitted   = 0;
+        uint64_t shed       = 0;
+        uint64_t shedByWait = 0; // Shed requests, that were within the depth limit
+        //! Smoothed service time of one request
+        Clock::duration serviceTime = Clock::duration::zero();
+    };
+
+  private:
+    Settings _settings;
+    Metrics _metrics;
+    bool _sampled = false;
+
+  public:
+    ModbusAdmission();
+
+    /**
+     * @throws std::invalid_argument - if maxWait is negative
+     */
+    explicit ModbusAdmission(Settings settings);
+
+    /**
+     * @brief Decides about the new request
+     * @param queued - Requests already waiting or being served
+     * @return false if request should be shed
+     */
+    bool admit(std::size_t queued);
+
+    //! Records time, that serving of single request took
+    void served(Clock::duration serviceTime);
+
+    //! Estimated wait of the new request
+    [[nodiscard]] Clock::duration estimatedWait(std::size_t queued) const noexcept;
+
+    /**
+     * @brief Changes limits, keeping service time and metrics
+     * @throws std::invalid_argument - if maxWait is negative
+     */
+    void setSettings(Settings settings);
+
+    [[nodiscard]] const Settings &settings() const noexcept { return _settings; }
+    [[nodiscard]] const Metrics &metrics() const noexcept { return _metrics; }
+};
+} // namespace MB
@@ -0,0 +1,52 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// This header contains Modbus ASCII encoding, that works on the same raw
+// frames (slave id and PDU) as ModbusRequest and ModbusResponse use
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * Namespace that contains Modbus ASCII framing: ':' start, hex encoded slave
+ * id, PDU and LRC, CR LF end.
+ *
+ * Hex conversion is table driven and works on whole buffers, as ASCII frames
+ * are twice the size of RTU ones.
+ */
+namespace MB::ascii {
+/**
+ * @brief Encodes `size` bytes as upper case hex
+ * @param out - Buffer for 2 * `size` characters
+ */
+void encodeHex(const uint8_t *data, std::size_t size, char *out) noexcept;
+
+/**
+ * @brief Decodes `size` hex characters, both upper and lower case
+ * @param out - Buffer for `size` / 2 bytes
+ * @return False if `size` is odd or any character is not a hex digit
+ */
+bool decodeHex(const char *hex, std::size_t size, uint8_t *out) noexcept;
+
+/**
+ * @brief Creates ASCII frame from raw frame, e.g. result of
+ * ModbusRequest::toRaw()
+ */
+std::vector<uint8_t> encodeFrame(const std::vector<uint8_t> &raw);
+
+/**
+ * @brief Checks ASCII frame and returns raw frame (without LRC), that can be
+ * passed to ModbusRequest::fromRaw() or ModbusResponse::fromRaw()
+ * @throws ModbusException - InvalidByteOrder if frame is malformed,
+ * InvalidCRC if LRC does not match
+ */
+std::vector<uint8_t> decodeFrame(const uint8_t *frame, std::size_t size);
+
+inline std::vector<uint8_t> decodeFrame(const std::vector<uint8_t> &frame) {
+    return decodeFrame(frame.data(), frame.size());
+}
+} // namespace MB::ascii
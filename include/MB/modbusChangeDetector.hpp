@@ -0,0 +1,103 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "modbusCell.hpp"
+#include "modbusPollPlan.hpp"
+#include "modbusResponse.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+//! Change of the analog tag that is too small to be reported
+struct ModbusDeadband {
+    enum Type { Absolute, Percent };
+
+    Type type;
+    //! Absolute change, or percent of the last reported value
+    double value;
+    //! Single register is int16_t and two registers are int32_t (high word
+    //! first), unsigned otherwise
+    bool isSigned = false;
+};
+
+/**
+ * Report by exception stage, that is placed after ModbusPollPlan scans.
+ *
+ * Last values of each block (request of the plan) are kept, and new
+ * responses are compared with them in chunks of `ChunkRegisters`, with
+ * memcmp (vectorized by the standard library), so unchanged parts of
+ * blocks are skipped quickly. Only tags in the changed chunks are checked.
+ *
+ * Tags with a deadband (one or two registers) are reported when they moved
+ * beyond it since the last report, other tags on any change. The first
+ * scan reports all tags.
+ *
+ * @note This class is not thread safe.
+ */
+class ModbusChangeDetector {
+  public:
+    using Subscriber =
+        std::function<void(std::size_t tag, const std::vector<ModbusCell> &values)>;
+    using SubscriberId = std::size_t;
+
+    static constexpr std::size_t ChunkRegisters = 32;
+
+  private:
+    struct Block {
+        std::vector<uint16_t> image;
+        std::vector<uint16_t> scratch;
+        std::vector<uint8_t> changed; // By chunk
+        std::vector<std::size_t> tags;
+        bool coils;
+    };
+
+    std::vector<ModbusTag> _tags;
+    std::vector<ModbusPollPlan::Placement> _placements;
+    std::vector<Block> _blocks;
+    std::map<std::size_t, ModbusDeadband> _deadbands;
+    std::map<std::size_t, double> _reported; // Last reported deadbanded values
+    std::map<SubscriberId, Subscriber> _subscribers;
+    SubscriberId _nextSubscriber = 0;
+    bool _initialized            = false;
+
+    [[nodiscard]] bool exceedsDeadband(std::size_t tag, double value) const;
+
+  public:
+    explicit ModbusChangeDetector(const ModbusPollPlan &plan);
+
+    /**
+     * @brief Sets deadband of the tag
+     * @throws std::invalid_argument - if tag does not exist, is not one or two
+     * registers, or the deadband is negative
+     */
+    void setDeadband(std::size_t tag, ModbusDeadband deadband);
+
+    SubscriberId subscribe(Subscriber subscriber);
+    bool unsubscribe(SubscriberId id);
+
+    /**
+     * @brief Compares responses to the plan requests with the previous scan
+     * and notifies subscribers about changed tags
+     * @return Changed tags, in ascending order
+     * @throws ModbusException - NumberOfValuesInvalid if responses do not
+     * match the requests (nothing is updated then)
+     */
+    std::vector<std::size_t> update(const std::vector<ModbusResponse> &responses);
+
+    /**
+     * @brief Forgets previous values, so that the next scan reports all tags,
+     * e.g. after the device was unreachable
+     */
+    void reset() noexcept;
+};
+} // namespace MB
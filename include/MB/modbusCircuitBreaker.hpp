@@ -0,0 +1,140 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Health of devices on the shared line, that keeps dead devices from
+ * burning a full timeout on every scan.
+ *
+ * Device that did not answer (Timeout, ConnectionClosed, or the gateway
+ * error for it) becomes suspect, and after `offlineAfter` such transactions
+ * in a row it goes offline.
+ * Transactions to offline device are not allowed, except for single probes,
+ * with the delay doubled after every failed probe, up to `maximumBackoff`,
+ * and randomized by +/- `jitter`, so that devices that died together are not
+ * probed together. Any answer, also exception response, means that device
+ * is alive and makes it healthy again - its scan group gets its transactions
+ * back.
+ *
+ * Each rejected transaction saves the time that the last failed transaction
+ * of the device took, it is reported as reclaimed bus time.
+ *
+ * ModbusClient uses it when set with `setCircuitBreaker`. It may be shared by
+ * clients of the same line, all methods are thread safe.
+ */
+class ModbusCircuitBreaker {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State { Healthy, Suspect, Offline };
+
+    struct Settings {
+        //! Failed transactions in a row, after which device is offline
+        std::size_t offlineAfter       = 3;
+        Clock::duration initialBackoff = std::chrono::seconds(1);
+        Clock::duration maximumBackoff = std::chrono::seconds(60);
+        //! Relative randomization of the probe delay, 0 - 1
+        double jitter = 0.2;
+    };
+
+    //! State of single device
+    struct Device {
+        State state          = State::Healthy;
+        std::size_t failures = 0; // Failed transactions in a row
+        std::size_t probes   = 0; // Failed probes since the device went offline
+        bool probing         = false;
+        Clock::time_point nextProbe;
+        //! Duration of the last failed transaction
+        Clock::duration cost      = Clock::duration::zero();
+        uint64_t rejected         = 0;
+        Clock::duration reclaimed = Clock::duration::zero();
+    };
+
+    struct Metrics {
+        uint64_t rejected         = 0; // Transactions not sent to offline devices
+        uint64_t probes           = 0;
+        uint64_t trips            = 0; // Transitions to offline
+        uint64_t recoveries       = 0; // Transitions from offline to healthy
+        Clock::duration reclaimed = Clock::duration::zero();
+    };
+
+    using Listener = std::function<void(uint8_t slaveId, State state)>;
+
+  private:
+    Settings _settings;
+    mutable std::mutex _mutex;
+    std::map<uint8_t, Device> _devices;
+    Metrics _metrics;
+    std::minstd_rand _random;
+    Listener _listener;
+
+    // Must be called with the lock held
+    void scheduleProbe(Device &device, Clock::time_point now);
+    void notify(uint8_t slaveId, State state) const;
+
+  public:
+    ModbusCircuitBreaker();
+
+    /**
+     * @param seed - Seed of the probe jitter
+     * @throws std::invalid_argument - if offlineAfter is zero, backoff is
+     * not positive or jitter is not in 0 - 1
+     */
+    explicit ModbusCircuitBreaker(Settings settings,
+                                  uint32_t seed = std::random_device()());
+
+    //! Errors which mean that device did not answer, the gateway one included
+    [[nodiscard]] static bool isFailure(utils::MBErrorCode code) noexcept {
+        return code == utils::Timeout || code == utils::ConnectionClosed ||
+               code == utils::GatewayTargetDeviceFailedToRespond;
+    }
+
+    /**
+     * @brief Checks if transaction to the device may be sent, rejected ones are
+     * counted as reclaimed. Allowed transaction to offline device is the probe,
+     * its outcome has to be recorded (or released if it was not sent).
+     */
+    [[nodiscard]] bool allow(uint8_t slaveId, Clock::time_point now = Clock::now());
+
+    //! Records that the device answered
+    void success(uint8_t slaveId);
+
+    /**
+     * @brief Records failed transaction, that took `elapsed`. Errors other
+     * than the ones of `isFailure` are answers, and count as success.
+     */
+    void failure(uint8_t slaveId, utils::MBErrorCode code, Clock::duration elapsed,
+                 Clock::time_point now = Clock::now());
+
+    //! Gives back the probe allowed by `allow`, that was not sent
+    void release(uint8_t slaveId);
+
+    //! Forgets the device, making it healthy
+    void reset(uint8_t slaveId);
+
+    //! Called on every state change, outside of the lock
+    void setListener(Listener listener);
+
+    [[nodiscard]] State state(uint8_t slaveId) const;
+    [[nodiscard]] std::optional<Device> device(uint8_t slaveId) const;
+    [[nodiscard]] Metrics metrics() const;
+
+    [[nodiscard]] const Settings &settings() const noexcept { return _settings; }
+};
+} // namespace MB
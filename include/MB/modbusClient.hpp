@@ -0,0 +1,208 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "modbusCircuitBreaker.hpp"
+#include "modbusDeviceIdentification.hpp"
+#include "modbusFileRecord.hpp"
+#include "modbusPollPlan.hpp"
+#include "modbusReadCache.hpp"
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * High level master API, that works on top of any transport.
+ *
+ * Transport is given as a function that sends the request and returns the
+ * response, e.g. TCP connection `sendRequest` followed by `awaitResponse`, or
+ * `Serial::BusMaster::submit(...).get()`. Exception responses are expected to
+ * be thrown as ModbusException.
+ *
+ * Transports that can keep many requests in flight may also give a pipeline
+ * function, e.g. TCP connection `pipelineRequests`, that is used by the
+ * operations split into many transactions. Without it, such transactions
+ * are sent one after another.
+ *
+ * Reads and writes of any length are split into chunks, that the
+ * specification allows (see utils::maxRegistersNumber), and results are
+ * joined back. Chunked write is not atomic - when it fails, part of the
+ * chunks may be already written.
+ *
+ * With circuit breaker set, transactions to offline devices are not sent,
+ * they throw GatewayTargetDeviceFailedToRespond right away. Transactions to
+ * many devices at once (e.g. poll plan of many devices) are rejected as a
+ * whole, so scan groups should poll one device each.
+ *
+ * With read cache set, `read` and the reads built on it are served from the
+ * cache when they can be, and every write sent invalidates cached values it
+ * touches.
+ */
+class ModbusClient {
+  public:
+    using Transaction = std::function<ModbusResponse(const ModbusRequest &)>;
+    using Pipeline =
+        std::function<std::vector<ModbusResponse>(const std::vector<ModbusRequest> &)>;
+
+  private:
+    Transaction _transaction;
+    Pipeline _pipeline;
+    std::shared_ptr<ModbusCircuitBreaker> _circuitBreaker;
+    std::shared_ptr<ModbusReadCache> _readCache;
+
+    // Sends requests through the circuit breaker, recording their outcome
+    template <typename Send>
+    auto guarded(const ModbusRequest *requests, std::size_t count, Send send);
+
+    // Sends request and checks that response belongs to it
+    ModbusResponse execute(const ModbusRequest &request);
+
+    std::vector<bool> readBits(uint8_t slaveId, utils::MBFunctionCode functionCode,
+                               uint16_t address, uint16_t count);
+    std::vector<uint16_t> readRegisters(uint8_t slaveId,
+                                        utils::MBFunctionCode functionCode,
+                                        uint16_t address, uint16_t count);
+
+  public:
+    explicit ModbusClient(Transaction transaction, Pipeline pipeline = nullptr);
+
+    //! Sets circuit breaker of the devices, nullptr disables it
+    void setCircuitBreaker(std::shared_ptr<ModbusCircuitBreaker> circuitBreaker) {
+        _circuitBreaker = std::move(circuitBreaker);
+    }
+    [[nodiscard]] const std::shared_ptr<ModbusCircuitBreaker> &
+    getCircuitBreaker() const noexcept {
+        return _circuitBreaker;
+    }
+
+    //! Sets cache of read values, nullptr disables it
+    void setReadCache(std::shared_ptr<ModbusReadCache> readCache) {
+        _readCache = std::move(readCache);
+    }
+    [[nodiscard]] const std::shared_ptr<ModbusReadCache> &getReadCache() const noexcept {
+        return _readCache;
+    }
+
+    /**
+     * @brief Sends requests, pipelined if transport allows it, e.g. requests
+     * of ModbusPollPlan, which responses go to ModbusChangeDetector
+     * @return Responses in the order of requests
+     * @throws ModbusException - if any transaction failed, or its response
+     * does not belong to the request
+     */
+    std::vector<ModbusResponse> executeAll(const std::vector<ModbusRequest> &requests);
+
+    /**
+     * @brief Reads `count` values with any read function, in as many
+     * transactions as needed
+     * @return Values in the order of addresses
+     * @throws ModbusException - IllegalFunction if function is not a read,
+     * IllegalDataAddress if range exceeds the address space
+     */
+    std::vector<ModbusCell> read(uint8_t slaveId, utils::MBFunctionCode functionCode,
+                                 uint16_t address, std::size_t count);
+
+    /**
+     * @brief Writes `values` with any write function, in as many transactions
+     * as needed (single write functions send one value per transaction)
+     * @throws ModbusException - IllegalFunction if function is not a write,
+     * IllegalDataAddress if range exceeds the address space
+     */
+    void write(uint8_t slaveId, utils::MBFunctionCode functionCode, uint16_t address,
+               const std::vector<ModbusCell> &values);
+
+    std::vector<bool> readCoils(uint8_t slaveId, uint16_t address, uint16_t count);
+    std::vector<bool> readInputContacts(uint8_t slaveId, uint16_t address,
+                                        uint16_t count);
+    std::vector<uint16_t> readHoldingRegisters(uint8_t slaveId, uint16_t address,
+                                               uint16_t count);
+    std::vector<uint16_t> readInputRegisters(uint8_t slaveId, uint16_t address,
+                                             uint16_t count);
+
+    void writeCoil(uint8_t slaveId, uint16_t address, bool value);
+    void writeRegister(uint8_t slaveId, uint16_t address, uint16_t value);
+    void writeCoils(uint8_t slaveId, uint16_t address, const std::vector<bool> &values);
+    void writeRegisters(uint8_t slaveId, uint16_t address,
+                        const std::vector<uint16_t> &values);
+
+    /**
+     * @brief Modifies single holding register on the device (MaskWriteRegister),
+     * result is `(current & andMask) | (orMask & ~andMask)`
+     */
+    void maskWriteRegister(uint8_t slaveId, uint16_t address, uint16_t andMask,
+                           uint16_t orMask);
+    //! Sets `bits` of the holding register, leaving other bits untouched
+    void setRegisterBits(uint8_t slaveId, uint16_t address, uint16_t bits);
+    //! Clears `bits` of the holding register, leaving other bits untouched
+    void clearRegisterBits(uint8_t slaveId, uint16_t address, uint16_t bits);
+
+    /**
+     * @brief Writes `values` and then reads `readCount` holding registers, in
+     * single transaction (ReadWriteMultipleRegisters)
+     * @return Registers read after the write
+     */
+    std::vector<uint16_t> readWriteRegisters(uint8_t slaveId, uint16_t readAddress,
+                                             uint16_t readCount, uint16_t writeAddress,
+                                             const std::vector<uint16_t> &values);
+
+    /**
+     * @brief Reads FIFO queue at the pointer address (ReadFIFOQueue), at most
+     * `utils::MaxFIFOCount` values in single transaction
+     * @return Queued values, the oldest one first
+     */
+    std::vector<uint16_t> readFIFOQueue(uint8_t slaveId, uint16_t pointerAddress);
+
+    /**
+     * @brief Reads file records in single transaction (ReadFileRecord)
+     * @param records - Sub-requests, with `recordLength` set
+     * @return Sub-requests with `data` filled
+     */
+    std::vector<ModbusFileRecord>
+    readFileRecords(uint8_t slaveId, const std::vector<ModbusFileRecord> &records);
+    //! Writes file records in single transaction (WriteFileRecord)
+    void writeFileRecords(uint8_t slaveId, const std::vector<ModbusFileRecord> &records);
+
+    /**
+     * @brief Reads `count` records of the file, starting from `recordNumber`,
+     * with as few transactions as possible (see fileRecord::packRead)
+     *
+     * Records past the last one of the file (fileRecord::MaxRecordNumber) are
+     * read from the beginning of the next file. Throws ModbusException
+     * (IllegalDataAddress) if they would go past the file 0xFFFF.
+     */
+    std::vector<uint16_t> readFile(uint8_t slaveId, uint16_t fileNumber,
+                                   uint16_t recordNumber, std::size_t count);
+    //! Writes `data` to the file, the same way as readFile
+    void writeFile(uint8_t slaveId, uint16_t fileNumber, uint16_t recordNumber,
+                   const std::vector<uint16_t> &data);
+
+    /**
+     * @brief Reads identification objects of the category given by `readCode`
+     * (ReadDeviceIdentification), following "more follows" continuations
+     * @param objectId - Object to read with deviceId::Specific, or the first
+     * one of the stream
+     * @return All objects, with conformity level of the device
+     * @note See ModbusDeviceIdCache, to not repeat this on every connection
+     */
+    ModbusDeviceIdentification
+    readDeviceIdentification(uint8_t slaveId, uint8_t readCode = deviceId::Basic,
+                             uint8_t objectId = deviceId::VendorName);
+
+    /**
+     * @brief Sends all requests of the plan, pipelined if transport allows it
+     * @return Values of the plan tags, in their order
+     */
+    std::vector<std::vector<ModbusCell>> poll(const ModbusPollPlan &plan);
+};
+} // namespace MB
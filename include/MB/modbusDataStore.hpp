@@ -0,0 +1,133 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "modbusCell.hpp"
+#include "modbusFifo.hpp"
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Tables of the slave (coils, input contacts, holding and input registers),
+ * that answer incoming requests.
+ *
+ * Every request is executed under a single lock, so multi register writes,
+ * MaskWriteRegister and the write and read of ReadWriteMultipleRegisters are
+ * atomic, both for other masters and for the application that updates tables
+ * concurrently.
+ *
+ * FIFO queues read by ReadFIFOQueue are registered separately, under their
+ * pointer address, and so are files of ReadFileRecord and WriteFileRecord.
+ * Objects returned by ReadDeviceIdentification are set as a whole.
+ */
+class ModbusDataStore {
+  private:
+    mutable std::mutex _mutex;
+    // Indexed by utils::MBFunctionRegisters, coils are stored as 0 and 1
+    std::array<std::vector<uint16_t>, 4> _tables;
+    std::map<uint16_t, ModbusFifo> _fifos;
+    std::map<uint16_t, std::vector<uint16_t>> _files;
+    std::map<uint8_t, std::string> _deviceObjects;
+
+    void checkRange(utils::MBFunctionRegisters table, uint16_t address,
+                    std::size_t count) const;
+    [[nodiscard]] std::vector<ModbusCell> readLocked(utils::MBFunctionRegisters table,
+                                                     uint16_t address,
+                                                     uint16_t count) const;
+    void writeLocked(utils::MBFunctionRegisters table, uint16_t address,
+                     const std::vector<ModbusCell> &values);
+    // Finds file and checks that sub-request fits in it
+    std::vector<uint16_t> &fileLocked(const ModbusFileRecord &record);
+
+  public:
+    /**
+     * @brief Creates tables of the given sizes, filled with zeros
+     */
+    ModbusDataStore(std::size_t coils, std::size_t inputContacts,
+                    std::size_t holdingRegisters, std::size_t inputRegisters);
+
+    ModbusDataStore(const ModbusDataStore &) = delete;
+
+    /**
+     * @brief Executes request on the tables
+     * @return Response that should be sent to the master
+     * @throws ModbusException - IllegalFunction, IllegalDataAddress or
+     * IllegalDataValue, with slave id and function code of the request, that
+     * should be sent to the master
+     */
+    [[nodiscard]] ModbusResponse handle(const ModbusRequest &request);
+
+    /**
+     * @brief Reads values, used by the application
+     * @throws ModbusException - IllegalDataAddress if range is outside the table
+     */
+    [[nodiscard]] std::vector<ModbusCell> read(utils::MBFunctionRegisters table,
+                                               uint16_t address, uint16_t count) const;
+
+    /**
+     * @brief Writes values, used by the application (input contacts and input
+     * registers can be written only this way)
+     * @throws ModbusException - IllegalDataAddress if range is outside the table
+     */
+    void write(utils::MBFunctionRegisters table, uint16_t address,
+               const std::vector<ModbusCell> &values);
+
+    /**
+     * @brief Registers FIFO queue under the pointer address, replacing the
+     * previous one
+     * @throws std::invalid_argument - if capacity is 0
+     */
+    void addFifo(uint16_t pointerAddress, std::size_t capacity = ModbusFifo::MaxReadCount,
+                 bool consumeOnRead = true);
+
+    /**
+     * @brief Appends value to the FIFO queue, used by the application
+     * @return false if the queue was full and the oldest value was overwritten
+     * @throws ModbusException - IllegalDataAddress if there is no such queue
+     */
+    bool pushFifo(uint16_t pointerAddress, uint16_t value);
+
+    /**
+     * @brief Number of values waiting in the FIFO queue
+     * @throws ModbusException - IllegalDataAddress if there is no such queue
+     */
+    [[nodiscard]] std::size_t fifoSize(uint16_t pointerAddress) const;
+
+    /**
+     * @brief Creates file of `records` registers, filled with zeros, replacing
+     * the previous one
+     */
+    void addFile(uint16_t fileNumber, std::size_t records);
+
+    /**
+     * @brief Returns copy of the whole file
+     * @throws ModbusException - IllegalDataAddress if there is no such file
+     */
+    [[nodiscard]] std::vector<uint16_t> file(uint16_t fileNumber) const;
+
+    /**
+     * @brief Sets identification objects, by object id (see deviceId::ObjectId),
+     * VendorName, ProductCode and MajorMinorRevision are mandatory
+     */
+    void setDeviceObjects(std::map<uint8_t, std::string> objects);
+
+    [[nodiscard]] std::size_t size(utils::MBFunctionRegisters table) const {
+        return _tables[table].size();
+    }
+};
+} // namespace MB
@@ -0,0 +1,160 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// This header contains Read Device Identification (function 0x2B, MEI type
+// 0x0E) objects, their encoding and the cache of identified devices
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Identification objects of the device, together with the fields of the
+ * Read Device Identification PDU.
+ *
+ * In request only `readCode` and `objectId` (the first object to read) are
+ * used. In response `objectId` is the next object id, valid when
+ * `moreFollows` is set.
+ */
+struct ModbusDeviceIdentification {
+    uint8_t readCode        = 0x01;
+    uint8_t objectId        = 0x00;
+    uint8_t conformityLevel = 0x00;
+    bool moreFollows        = false;
+    std::map<uint8_t, std::string> objects;
+
+    //! Returns object value, if it was read
+    [[nodiscard]] std::optional<std::string> object(uint8_t id) const {
+        const auto it = objects.find(id);
+        if (it == objects.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+    bool operator==(const ModbusDeviceIdentification &other) const {
+        return readCode == other.readCode && objectId == other.objectId &&
+               conformityLevel == other.conformityLevel &&
+               moreFollows == other.moreFollows && objects == other.objects;
+    }
+};
+} // namespace MB
+
+/*!
+ * Namespace that contains Read Device Identification encoding and the
+ * server side selection of objects.
+ *
+ * Encode and decode functions work on the PDU after the function code, MEI
+ * type included. Decoding throws ModbusException (InvalidByteOrder) on
+ * malformed data.
+ */
+namespace MB::deviceId {
+//! MEI type of Read Device Identification
+constexpr uint8_t MEIType = 0x0E;
+
+//! Read device id codes
+enum ReadCode : uint8_t {
+    Basic    = 0x01,
+    Regular  = 0x02,
+    Extended = 0x03,
+    Specific = 0x04,
+};
+
+//! Basic and regular object ids
+enum ObjectId : uint8_t {
+    VendorName          = 0x00,
+    ProductCode         = 0x01,
+    MajorMinorRevision  = 0x02,
+    VendorUrl           = 0x03,
+    ProductName         = 0x04,
+    ModelName           = 0x05,
+    UserApplicationName = 0x06,
+};
+
+//! Space for objects (id, length and value) in single response
+constexpr std::size_t MaxObjectsSize = 253 - 7;
+
+void encodeRequest(std::vector<uint8_t> &out, const ModbusDeviceIdentification &request);
+ModbusDeviceIdentification decodeRequest(const uint8_t *data, std::size_t size);
+
+void encodeResponse(std::vector<uint8_t> &out,
+                    const ModbusDeviceIdentification &response);
+//! @param consumed - Set to the number of decoded bytes
+ModbusDeviceIdentification decodeResponse(const uint8_t *data, std::size_t size,
+                                          std::size_t &consumed);
+
+/**
+ * @brief Selects objects, that answer the request, as the device does
+ *
+ * Stream access codes return objects of their category starting from the
+ * requested one (or from 0 if it does not exist), continued with
+ * `moreFollows` when they do not fit in single response.
+ * @throws ModbusException - IllegalDataValue for unknown read code,
+ * IllegalDataAddress if specific object does not exist
+ */
+ModbusDeviceIdentification respond(const std::map<uint8_t, std::string> &objects,
+                                   uint8_t readCode, uint8_t objectId);
+} // namespace MB::deviceId
+
+namespace MB {
+/**
+ * Cache of device identifications, keyed by endpoint (e.g. "10.0.0.5:502" or
+ * "/dev/ttyUSB0") and unit id.
+ *
+ * It outlives connections, so reconnecting does not identify devices again.
+ * Devices are identified concurrently - the lock is not held while fetching,
+ * and concurrent requests for the same device wait for a single fetch. Failed
+ * fetches are not cached.
+ */
+class ModbusDeviceIdCache {
+  public:
+    using Fetch = std::function<ModbusDeviceIdentification()>;
+
+  private:
+    using Key = std::pair<std::string, uint8_t>;
+
+    struct Entry {
+        std::shared_future<ModbusDeviceIdentification> future;
+        // Tells fetches of the same device apart, after it was invalidated
+        uint64_t fetch;
+    };
+
+    mutable std::mutex _mutex;
+    std::map<Key, Entry> _entries;
+    uint64_t _fetches = 0;
+
+  public:
+    /**
+     * @brief Returns cached identification or calls `fetch`, e.g. a lambda
+     * around ModbusClient::readDeviceIdentification
+     * @throws Whatever `fetch` throws
+     */
+    ModbusDeviceIdentification get(const std::string &endpoint, uint8_t unitId,
+                                   const Fetch &fetch);
+
+    //! Returns identification only if it is already cached
+    [[nodiscard]] std::optional<ModbusDeviceIdentification>
+    find(const std::string &endpoint, uint8_t unitId) const;
+
+    //! Forgets single device, e.g. after its firmware update
+    void invalidate(const std::string &endpoint, uint8_t unitId);
+    //! Forgets all devices of the endpoint
+    void invalidate(const std::string &endpoint);
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+};
+} // namespace MB
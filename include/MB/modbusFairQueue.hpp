@@ -0,0 +1,171 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Queue shared by many clients, that serves them with deficit round-robin,
+ * so that client flooding it with requests does not delay the others.
+ *
+ * Each client has its own queue, bounded by `limit`. Clients with queued
+ * items are visited in turns, and each turn adds `quantum * share` to the
+ * deficit of the client, from which costs of its items are paid (e.g. bytes
+ * on the wire). Client gets bus time in proportion to its share, unless it
+ * needs less, and client with a single request waits at most one turn of
+ * every other client.
+ *
+ * @note This class is not thread safe, it is meant to be guarded by the owner.
+ */
+template <typename T>
+class ModbusFairQueue {
+  public:
+    using ClientId = uint64_t;
+
+    static constexpr std::size_t DefaultQuantum = 256;
+    static constexpr std::size_t DefaultLimit   = 64;
+
+  private:
+    struct Entry {
+        T item;
+        std::size_t cost;
+    };
+
+    struct Flow {
+        std::deque<Entry> queue;
+        std::size_t deficit = 0;
+        // Quantum of the current turn was already added
+        bool credited = false;
+    };
+
+    std::size_t _quantum;
+    std::size_t _limit;
+    std::size_t _size = 0;
+    std::unordered_map<ClientId, Flow> _flows;
+    std::unordered_map<ClientId, std::size_t> _shares;
+    // Clients with queued items, in the order of their turns
+    std::deque<ClientId> _active;
+
+  public:
+    /**
+     * @throws std::invalid_argument - if quantum or limit is zero
+     */
+    explicit ModbusFairQueue(std::size_t quantum = DefaultQuantum,
+                             std::size_t limit   = DefaultLimit)
+        : _quantum(quantum), _limit(limit) {
+        if (quantum == 0 || limit == 0)
+            throw std::invalid_argument("Invalid fair queue settings");
+    }
+
+    /**
+     * @brief Sets share of the client, 1 if not set
+     * @throws std::invalid_argument - if share is zero
+     */
+    void setShare(ClientId client, std::size_t share) {
+        if (share == 0)
+            throw std::invalid_argument("Share has to be positive");
+        _shares[client] = share;
+    }
+
+    //! Forgets share of the client, queued items are still served
+    void removeClient(ClientId client) { _shares.erase(client); }
+
+    [[nodiscard]] std::size_t share(ClientId client) const {
+        const auto found = _shares.find(client);
+        return found == _shares.end() ? 1 : found->second;
+    }
+
+    [[nodiscard]] std::size_t limit() const noexcept { return _limit; }
+
+    /**
+     * @throws std::invalid_argument - if limit is zero
+     */
+    void setLimit(std::size_t limit) {
+        if (limit == 0)
+            throw std::invalid_argument("Invalid fair queue settings");
+        _limit = limit;
+    }
+
+    /**
+     * @brief Queues item of the client
+     * @return false if queue of the client is full, item is not queued then
+     */
+    bool push(ClientId client, T item, std::size_t cost) {
+        auto &flow = _flows[client];
+        if (flow.queue.size() >= _limit)
+            return false;
+
+        if (flow.queue.empty())
+            _active.push_back(client);
+        flow.queue.push_back({std::move(item), cost});
+        _size++;
+        return true;
+    }
+
+    //! Removes item to be served next, nullopt if queue is empty
+    std::optional<T> pop() {
+        while (!_active.empty()) {
+            const auto client = _active.front();
+            auto &flow        = _flows[client];
+            if (!flow.credited) {
+                flow.deficit += _quantum * share(client);
+                flow.credited = true;
+            }
+
+            if (flow.queue.front().cost > flow.deficit) {
+                // The rest of the deficit is kept for the next turn
+                flow.credited = false;
+                _active.pop_front();
+                _active.push_back(client);
+                continue;
+            }
+
+            flow.deficit -= flow.queue.front().cost;
+            std::optional<T> item(std::move(flow.queue.front().item));
+            flow.queue.pop_front();
+            _size--;
+
+            // Client that has nothing to send does not save its deficit
+            if (flow.queue.empty()) {
+                _active.pop_front();
+                _flows.erase(client);
+            }
+            return item;
+        }
+        return std::nullopt;
+    }
+
+    //! Returns the first queued item that satisfies the predicate, or nullptr
+    template <typename Predicate>
+    T *find(Predicate predicate) {
+        for (auto &[client, flow] : _flows) {
+            for (auto &entry : flow.queue) {
+                if (predicate(entry.item))
+                    return &entry.item;
+            }
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    //! Number of items queued by the client
+    [[nodiscard]] std::size_t size(ClientId client) const {
+        const auto found = _flows.find(client);
+        return found == _flows.end() ? 0 : found->second.queue.size();
+    }
+};
+} // namespace MB
@@ -0,0 +1,73 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Fixed size FIFO queue of registers, that is read by ReadFIFOQueue.
+ *
+ * Values are kept in the ring buffer, so pushing new events and draining
+ * old ones never moves the data. When the queue is full, the oldest value
+ * is overwritten.
+ *
+ * By default read consumes returned values (at most `MaxReadCount` of them),
+ * so the master drains the queue with consecutive reads. When
+ * `consumeOnRead` is false, read follows the specification - values stay in
+ * the queue and reading more than `MaxReadCount` of them is an error.
+ *
+ * @note This class is not thread safe, ModbusDataStore guards it with its
+ * lock.
+ */
+class ModbusFifo {
+  public:
+    //! The biggest number of values in single ReadFIFOQueue response
+    static constexpr uint16_t MaxReadCount = utils::MaxFIFOCount;
+
+  private:
+    std::vector<uint16_t> _buffer;
+    std::size_t _head = 0; // Index of the oldest value
+    std::size_t _size = 0;
+    bool _consumeOnRead;
+    uint64_t _overwritten = 0;
+
+  public:
+    /**
+     * @brief Creates empty queue
+     * @throws std::invalid_argument - if capacity is 0
+     */
+    explicit ModbusFifo(std::size_t capacity = MaxReadCount, bool consumeOnRead = true);
+
+    /**
+     * @brief Appends value to the queue
+     * @return false if the queue was full and the oldest value was overwritten
+     */
+    bool push(uint16_t value) noexcept;
+
+    /**
+     * @brief Returns the oldest values, as they should be sent to the master
+     * @throws ModbusException - IllegalDataValue if values are not consumed
+     * on read and there are more than `MaxReadCount` of them
+     */
+    [[nodiscard]] std::vector<uint16_t> read();
+
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return _buffer.size(); }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    [[nodiscard]] bool consumeOnRead() const noexcept { return _consumeOnRead; }
+    //! Number of values lost, because the queue was full
+    [[nodiscard]] uint64_t overwritten() const noexcept { return _overwritten; }
+};
+} // namespace MB
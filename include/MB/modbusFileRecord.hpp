@@ -0,0 +1,91 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// This header contains file record sub-requests of ReadFileRecord and
+// WriteFileRecord, together with their encoding
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Single sub-request (or sub-response) of ReadFileRecord and WriteFileRecord.
+ *
+ * Read requests use `recordLength` and leave `data` empty, in responses and
+ * writes `data` holds the records. Read responses do not carry file and
+ * record numbers, so they are 0 there.
+ */
+struct ModbusFileRecord {
+    uint16_t fileNumber   = 0;
+    uint16_t recordNumber = 0;
+    uint16_t recordLength = 0;
+    std::vector<uint16_t> data;
+
+    bool operator==(const ModbusFileRecord &other) const {
+        return fileNumber == other.fileNumber && recordNumber == other.recordNumber &&
+               recordLength == other.recordLength && data == other.data;
+    }
+};
+} // namespace MB
+
+/*!
+ * Namespace that contains encoding and packing of file record sub-requests.
+ *
+ * Encode and decode functions work on the PDU after the function code, byte
+ * count included. Decoding throws ModbusException (InvalidByteOrder) on
+ * malformed data, encoding throws ModbusException (NumberOfValuesInvalid)
+ * if records do not fit in single PDU.
+ */
+namespace MB::fileRecord {
+//! The only reference type defined by the specification
+constexpr uint8_t ReferenceType = 0x06;
+//! Records of a file are numbered from 0 up to this value
+constexpr uint16_t MaxRecordNumber = 0x270F;
+//! The biggest byte count of read request and read response
+constexpr std::size_t MaxReadBytes = 0xF5;
+//! The biggest byte count of write request (and its echo)
+constexpr std::size_t MaxWriteBytes = 0xFB;
+
+//! Byte count of ReadFileRecord request
+std::size_t readRequestSize(const std::vector<ModbusFileRecord> &records);
+//! Byte count of ReadFileRecord response, based on `recordLength`
+std::size_t readResponseSize(const std::vector<ModbusFileRecord> &records);
+//! Byte count of WriteFileRecord request and response
+std::size_t writeSize(const std::vector<ModbusFileRecord> &records);
+
+void encodeReadRequest(std::vector<uint8_t> &out,
+                       const std::vector<ModbusFileRecord> &records);
+std::vector<ModbusFileRecord> decodeReadRequest(const uint8_t *data, std::size_t size);
+
+void encodeReadResponse(std::vector<uint8_t> &out,
+                        const std::vector<ModbusFileRecord> &records);
+std::vector<ModbusFileRecord> decodeReadResponse(const uint8_t *data, std::size_t size);
+
+void encodeWrite(std::vector<uint8_t> &out, const std::vector<ModbusFileRecord> &records);
+std::vector<ModbusFileRecord> decodeWrite(const uint8_t *data, std::size_t size);
+
+/**
+ * @brief Splits read of `segments` into the smallest number of transactions,
+ * each packed with as many sub-requests as both request and response allow
+ *
+ * Segments longer than single response are split into consecutive records.
+ * @return Sub-requests of each transaction
+ */
+std::vector<std::vector<ModbusFileRecord>>
+packRead(const std::vector<ModbusFileRecord> &segments);
+
+/**
+ * @brief Splits write of `segments` (with data) into the smallest number of
+ * transactions, the same way as packRead
+ * @return Sub-requests of each transaction
+ */
+std::vector<std::vector<ModbusFileRecord>>
+packWrite(const std::vector<ModbusFileRecord> &segments);
+} // namespace MB::fileRecord
@@ -0,0 +1,42 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// This header contains frame length prediction, used to cut frames out of
+// the byte streams
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+/*!
+ * Namespace that contains functions that find frame boundaries in the
+ * stream of bytes.
+ *
+ * All functions return number of bytes that the frame needs, as far as it can
+ * be told from `size` bytes. If returned value is bigger than `size`, more
+ * bytes are needed and function should be called again once they are
+ * available. `std::nullopt` means that bytes do not start a valid frame.
+ */
+namespace MB::framing {
+//! Size of the MBAP header, including unit id
+constexpr std::size_t MBAPHeaderSize = 7;
+//! Size of the RTU CRC
+constexpr std::size_t CRCSize = 2;
+//! ':', hex encoded slave id, PDU and LRC, CR LF
+constexpr std::size_t MaxASCIIFrameSize = 1 + 2 * 255 + 2;
+
+//! Length of RTU request frame (slave id, PDU and CRC)
+std::optional<std::size_t> rtuRequestLength(const uint8_t *data, std::size_t size);
+
+//! Length of RTU response frame (slave id, PDU and CRC), exceptions included
+std::optional<std::size_t> rtuResponseLength(const uint8_t *data, std::size_t size);
+
+//! Length of Modbus TCP frame (MBAP header and PDU)
+std::optional<std::size_t> mbapFrameLength(const uint8_t *data, std::size_t size);
+
+//! Length of Modbus ASCII frame, from ':' up to LF
+std::optional<std::size_t> asciiFrameLength(const uint8_t *data, std::size_t size);
+} // namespace MB::framing
@@ -0,0 +1,198 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "modbusAdmission.hpp"
+#include "modbusFairQueue.hpp"
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Gateway engine, that forwards Modbus TCP requests of many masters to the
+ * serial lines behind it.
+ *
+ * Request (MBAP frame) is routed by its unit id to the line of that device,
+ * and queued there. Each line has its own thread, that sends queued requests
+ * one at a time, so lines work in parallel. Response goes back in MBAP frame
+ * with the original transaction id, so masters may keep many requests in
+ * flight.
+ *
+ * Masters (clients) have their own queues on each line, served with deficit
+ * round-robin weighted by their shares (see ModbusFairQueue), with the cost
+ * of request estimated as its bytes on the wire. So master that floods the
+ * gateway does not delay the others. Request that does not fit into the
+ * queue of its master is answered with SlaveDeviceBusy.
+ *
+ * Lines may also shed load (see ModbusAdmission), answering requests with
+ * SlaveDeviceBusy when too many bus transactions are queued, or when
+ * queued ones would take too long, so that latency of admitted requests
+ * stays bounded. Coalesced reads add no bus time and are always admitted.
+ *
+ * Line is given as transaction function, e.g. serial connection
+ * `sendRequest` followed by `awaitResponse`. Exception response of the device
+ * is forwarded, device that did not answer is reported with
+ * GatewayTargetDeviceFailedToRespond and unit without line with
+ * GatewayPathUnavailable. Unit id 0 addresses the gateway itself, that has
+ * no registers, unless broadcast is enabled - then it goes as broadcast to
+ * all lines with broadcast function (e.g. serial connection `sendBroadcast`),
+ * that sends it without waiting for response, and it is not answered.
+ *
+ * Units may have coalescing enabled, then read that is identical (unit,
+ * function, address and count) to the one already queued or being sent on
+ * the bus is attached to it, and gets the same response, with its own
+ * transaction id.
+ *
+ * See TCP::Gateway, that serves TCP connections with it.
+ */
+class ModbusGateway {
+  public:
+    using Clock       = std::chrono::steady_clock;
+    using ClientId    = uint64_t;
+    using Transaction = std::function<ModbusResponse(const ModbusRequest &)>;
+    //! Sends broadcast request, devices do not answer it
+    using Broadcast = std::function<void(const ModbusRequest &)>;
+    //! Receives MBAP response frame, it is called from the line thread
+    using Reply = std::function<void(std::vector<uint8_t> frame)>;
+
+    struct Metrics {
+        std::size_t queueDepth    = 0; // Requests waiting or being sent
+        std::size_t maxQueueDepth = 0;
+        uint64_t requests         = 0; // Completed requests
+        uint64_t failures         = 0; // Requests answered by the gateway
+        uint64_t coalesced        = 0; // Bus transactions saved by coalescing
+        uint64_t rejected         = 0; // Requests over the queue limit of the client
+        uint64_t shed             = 0; // Requests not admitted by the line
+        //! Smoothed time of single bus transaction
+        Clock::duration serviceTime = Clock::duration::zero();
+        //! Time from receiving request to sending its response
+        Clock::duration lastLatency  = Clock::duration::zero();
+        Clock::duration maxLatency   = Clock::duration::zero();
+        Clock::duration totalLatency = Clock::duration::zero();
+    };
+
+  private:
+    struct Waiter {
+        uint16_t transactionId;
+        Reply reply;
+        Clock::time_point received;
+    };
+
+    // Single bus transaction, with all requests attached to it
+    struct Pending {
+        ModbusRequest request;
+        std::vector<Waiter> waiters;
+    };
+
+    struct Line {
+        Transaction transaction;
+        Broadcast broadcast;
+        std::mutex mutex;
+        std::condition_variable cond;
+        ModbusFairQueue<Pending> queue;
+        // Transaction on the bus, requests may still attach to it
+        std::optional<Pending> current;
+        ModbusAdmission admission;
+        Metrics metrics;
+        bool stop = false;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Line>> _lines;
+    // Line index by unit id
+    std::array<std::optional<std::size_t>, 256> _routes;
+    std::array<bool, 256> _coalescing = {};
+    bool _broadcast                   = false;
+
+    void run(Line &line);
+    void enqueue(Line &line, const ModbusRequest &request, Waiter waiter,
+                 ClientId client);
+    static void answer(const Waiter &waiter, const std::vector<uint8_t> &pdu);
+
+  public:
+    ModbusGateway() = default;
+    ModbusGateway(const ModbusGateway &) = delete;
+    ModbusGateway &operator=(const ModbusGateway &) = delete;
+
+    //! Stops lines, requests left in queues are answered with GatewayPathUnavailable
+    ~ModbusGateway();
+
+    /**
+     * @brief Adds serial line with devices of `unitIds`, and starts its thread.
+     * Line without `broadcast` function does not get broadcasts.
+     * @return Index of the line
+     * @throws std::invalid_argument - if unit id is broadcast or already routed
+     * @note Lines have to be added before requests are handled
+     */
+    std::size_t addLine(Transaction transaction, const std::vector<uint8_t> &unitIds,
+                        Broadcast broadcast = {});
+
+    /**
+     * @brief Enables coalescing of identical reads of the unit. It is off by
+     * default, as attached read may get values read before it was received.
+     * @note Has to be set before requests are handled
+     */
+    void setCoalescing(uint8_t unitId, bool enabled) { _coalescing[unitId] = enabled; }
+
+    /**
+     * @brief Forwards requests to unit id 0 to all lines as broadcast, they are
+     * answered with GatewayPathUnavailable otherwise
+     * @note Has to be set before requests are handled
+     */
+    void setBroadcast(bool enabled) noexcept { _broadcast = enabled; }
+
+    [[nodiscard]] bool broadcast() const noexcept { return _broadcast; }
+
+    /**
+     * @brief Sets admission limits of the line, there are none by default
+     * @throws std::out_of_range - if there is no such line
+     * @throws std::invalid_argument - if settings are not valid
+     */
+    void setAdmission(std::size_t line, ModbusAdmission::Settings settings);
+
+    /**
+     * @brief Sets share of the client on all lines, it is 1 by default
+     * @throws std::invalid_argument - if share is zero
+     */
+    void setShare(ClientId client, std::size_t share);
+
+    //! Forgets share of the client, e.g. after its connection was closed
+    void removeClient(ClientId client);
+
+    /**
+     * @brief Sets number of requests, that each client may have queued on the
+     * line (ModbusFairQueue::DefaultLimit by default)
+     * @throws std::invalid_argument - if limit is zero
+     */
+    void setClientQueueLimit(std::size_t limit);
+
+    /**
+     * @brief Routes MBAP request frame of the client, its response is given to
+     * `reply` (exception responses of the gateway may be given before return)
+     * @throws ModbusException - ProtocolError if frame is not valid MBAP frame,
+     * connection with the master should be closed then
+     */
+    void handle(const std::vector<uint8_t> &frame, Reply reply, ClientId client = 0);
+
+    [[nodiscard]] std::size_t lines() const noexcept { return _lines.size(); }
+
+    //! Queue depth and latency statistics of the line
+    [[nodiscard]] Metrics metrics(std::size_t line) const;
+};
+} // namespace MB
@@ -0,0 +1,114 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "modbusCell.hpp"
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+//! Range of values polled by the application
+struct ModbusTag {
+    uint8_t slaveId;
+    utils::MBFunctionRegisters table;
+    uint16_t address;
+    uint16_t count = 1;
+};
+
+//! Properties of the device, used when its tags are merged
+struct ModbusDeviceLimits {
+    //! Range that must not be read, e.g. hole in the device map
+    struct Range {
+        utils::MBFunctionRegisters table;
+        uint16_t address;
+        uint16_t count;
+    };
+
+    //! The biggest blocks read with single request
+    uint16_t maxRegisters = utils::MaxReadRegisters;
+    uint16_t maxCoils     = utils::MaxReadCoils;
+    /**
+     * Bytes that every transaction costs besides the data, the default is for
+     * RTU: 8 bytes of request, 5 bytes of response header and CRC and 3.5
+     * characters of silence after each frame
+     */
+    std::size_t transactionOverhead = 20;
+    //! Gaps between tags are never read, when they overlap these ranges
+    std::vector<Range> forbidden;
+};
+
+/**
+ * Set of read requests, that polls all given tags.
+ *
+ * Tags of the same device and table are sorted by address and merged into
+ * blocks greedily. Overlapping and adjacent tags are always merged, tags
+ * separated by a gap are merged when reading the gap costs fewer bytes than
+ * another transaction. Blocks never exceed the device limits and never cover
+ * its forbidden ranges.
+ *
+ * Plan is built once and reused on every scan - requests are sent, e.g. with
+ * ModbusClient::poll, and responses are split back into the values of tags.
+ */
+class ModbusPollPlan {
+  public:
+    //! Where values of the tag are found
+    struct Placement {
+        std::size_t request;
+        uint16_t offset;
+    };
+
+  private:
+    std::vector<ModbusTag> _tags;
+    std::vector<Placement> _placements; // By tag index
+    std::vector<ModbusRequest> _requests;
+    std::size_t _wireBytes = 0;
+
+  public:
+    /**
+     * @brief Builds the plan
+     * @param limits - Limits by slave id, other devices use the defaults
+     * @throws std::invalid_argument - if tag is empty, exceeds the address
+     * space or does not fit in a single block
+     */
+    explicit ModbusPollPlan(std::vector<ModbusTag> tags,
+                            const std::map<uint8_t, ModbusDeviceLimits> &limits = {});
+
+    //! Requests of a single scan, sorted by slave id, table and address
+    [[nodiscard]] const std::vector<ModbusRequest> &requests() const noexcept {
+        return _requests;
+    }
+
+    [[nodiscard]] const std::vector<ModbusTag> &tags() const noexcept { return _tags; }
+
+    [[nodiscard]] const Placement &placement(std::size_t tag) const {
+        return _placements.at(tag);
+    }
+
+    /**
+     * @brief Splits responses to requests() into the values of tags
+     * @return Values in the order of tags
+     * @throws ModbusException - NumberOfValuesInvalid if responses do not
+     * match the requests
+     */
+    [[nodiscard]] std::vector<std::vector<ModbusCell>>
+    values(const std::vector<ModbusResponse> &responses) const;
+
+    //! Transactions of a single scan
+    [[nodiscard]] std::size_t transactions() const noexcept { return _requests.size(); }
+
+    //! Bytes of a single scan, data and transaction overheads, as estimated
+    //! by the planner
+    [[nodiscard]] std::size_t wireBytes() const noexcept { return _wireBytes; }
+};
+} // namespace MB
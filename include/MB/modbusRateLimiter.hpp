@@ -0,0 +1,168 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "modbusRequest.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Hard caps of request and register rates of masters, per connection and per
+ * source address, for servers behind which are devices that cannot keep up
+ * with masters polling at kHz rates.
+ *
+ * Each limit is a token bucket, that refills at its rate up to its burst.
+ * Request takes one token from the request buckets, and the number of
+ * registers it reads or writes (16 coils count as one register) from the
+ * register buckets, of its connection and of its source address. Request,
+ * that would have to wait for tokens, is delayed, unless the wait is longer
+ * than `maxDelay` - then it should be rejected with SlaveDeviceBusy. Request,
+ * that takes more tokens than the burst (e.g. ReadWriteMultipleRegisters of
+ * 246 registers), waits for the full bucket and empties it.
+ *
+ * Buckets are kept as their theoretical arrival time (GCRA), in a single
+ * atomic, so that checking request takes no locks. The only lock is taken
+ * when connection is added, to find buckets of its source address.
+ */
+class ModbusRateLimiter {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    //! Token bucket, that may be used from many threads
+    class Bucket {
+      private:
+        // Time to refill single token, zero if there is no limit
+        Clock::duration _interval = Clock::duration::zero();
+        Clock::duration _burst    = Clock::duration::zero();
+        std::atomic<Clock::rep> _arrival{Clock::duration::min().count()};
+
+        // Time to refill the tokens, at most the burst
+        [[nodiscard]] Clock::rep cost(double tokens) const;
+
+      public:
+        /**
+         * @param rate - Tokens per second, zero for no limit
+         * @param burst - Tokens that may be taken at once after idle time
+         * @throws std::invalid_argument - if rate is negative, or burst is
+         * smaller than one token
+         */
+        explicit Bucket(double rate = 0, double burst = 1);
+
+        /**
+         * @brief Takes tokens, waiting for them at most `maxDelay`
+         * @return Time, that has to pass before tokens are used, nullopt if
+         * it is longer than `maxDelay` (no tokens are taken then)
+         */
+        std::optional<Clock::duration> take(double tokens, Clock::time_point now,
+                                            Clock::duration maxDelay);
+
+        //! Gives back tokens, that were taken for rejected request
+        void refund(double tokens);
+
+        //! True if the bucket is full, i.e. it was not used for its burst time
+        [[nodiscard]] bool full(Clock::time_point now) const noexcept;
+    };
+
+    struct Limits {
+        double requestsPerSecond  = 0; // Zero for no limit
+        double requestBurst       = 1;
+        double registersPerSecond = 0; // Zero for no limit
+        double registerBurst      = 125;
+    };
+
+    struct Settings {
+        Limits connection;
+        Limits source;
+        //! Requests that would wait longer are rejected
+        Clock::duration maxDelay = Clock::duration::zero();
+    };
+
+    struct Metrics {
+        uint64_t admitted          = 0; // Including delayed ones
+        uint64_t delayed           = 0;
+        uint64_t rejected          = 0;
+        Clock::duration totalDelay = Clock::duration::zero();
+    };
+
+  private:
+    struct Buckets {
+        Bucket requests;
+        Bucket registers;
+
+        explicit Buckets(const Limits &limits);
+    };
+
+    struct Counters {
+        std::atomic<uint64_t> admitted = 0;
+        std::atomic<uint64_t> delayed  = 0;
+        std::atomic<uint64_t> rejected = 0;
+        std::atomic<Clock::rep> delay  = 0;
+    };
+
+    Settings _settings;
+    std::shared_ptr<Counters> _counters = std::make_shared<Counters>();
+    std::mutex _mutex;
+    // Buckets of source addresses, that have open connections or are not full
+    std::map<uint32_t, std::shared_ptr<Buckets>> _sources;
+
+  public:
+    //! Limits of single connection, see `connect`
+    class Client {
+      private:
+        Clock::duration _maxDelay;
+        Buckets _connection;
+        std::shared_ptr<Buckets> _source;
+        std::shared_ptr<Counters> _counters;
+
+        friend class ModbusRateLimiter;
+        Client(const Settings &settings, std::shared_ptr<Buckets> source,
+               std::shared_ptr<Counters> counters);
+
+      public:
+        /**
+         * @brief Takes tokens for the request
+         * @return Time to wait before the request is handled, nullopt if it
+         * should be rejected
+         * @note Thread safe and lock free, also with other connections of the
+         * same source address
+         */
+        std::optional<Clock::duration> acquire(const ModbusRequest &request,
+                                               Clock::time_point now = Clock::now());
+    };
+
+    ModbusRateLimiter();
+
+    /**
+     * @throws std::invalid_argument - if limits are not valid, or maxDelay is
+     * negative
+     */
+    explicit ModbusRateLimiter(Settings settings);
+
+    /**
+     * @brief Creates limits of the new connection from the source address
+     * (e.g. IPv4 address), they may outlive the limiter
+     * @note Source keeps its tokens used by closed connections, so that
+     * reconnecting does not reset its limits
+     */
+    [[nodiscard]] std::unique_ptr<Client> connect(uint32_t address,
+                                                  Clock::time_point now = Clock::now());
+
+    //! Number of registers that the request reads and writes, for the limits
+    [[nodiscard]] static std::size_t registers(const ModbusRequest &request) noexcept;
+
+    [[nodiscard]] const Settings &settings() const noexcept { return _settings; }
+    [[nodiscard]] Metrics metrics() const noexcept;
+};
+} // namespace MB
@@ -0,0 +1,123 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "modbusCell.hpp"
+#include "modbusRequest.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Cache of values read from devices, for the client that reads the same
+ * registers more often than they change.
+ *
+ * Only ranges with TTL set are cached. Read is served from the cache, when
+ * every value it asks for was read within TTL of its range, otherwise it goes
+ * to the device and refreshes the cache. Writes sent through the client
+ * invalidate values they touch (broadcast writes - of all devices), as the
+ * device may not store them as written. Read sent before the write may still
+ * bring the old values, so `store` takes generation of the cache from before
+ * the read was sent, and skips pages invalidated since then.
+ *
+ * Values are kept in pages of `PageSize` registers, so lookup takes time
+ * proportional to the length of read, regardless of the size of the cache.
+ *
+ * ModbusClient uses it when set with `setReadCache`. It may be shared by
+ * clients of the same devices, all methods are thread safe.
+ */
+class ModbusReadCache {
+  public:
+    using Clock      = std::chrono::steady_clock;
+    using Generation = uint64_t;
+
+    static constexpr std::size_t PageSize = 64;
+
+    struct Metrics {
+        uint64_t hits          = 0;
+        uint64_t misses        = 0;
+        uint64_t invalidations = 0; // Writes that touched cached values
+    };
+
+    struct Range {
+        uint16_t address;
+        std::size_t count;
+        Clock::duration ttl;
+    };
+
+  private:
+    struct Page {
+        std::array<uint16_t, PageSize> values;
+        std::array<Clock::time_point, PageSize> expires;
+        Generation invalidated = 0;
+    };
+
+    using TableKey = std::pair<uint8_t, utils::MBFunctionRegisters>;
+
+    mutable std::mutex _mutex;
+    // Pages by slave id, table and page number
+    std::unordered_map<uint32_t, Page> _pages;
+    // Disjoint ranges by their address, tables without them are not cached
+    std::map<TableKey, std::map<uint16_t, Range>> _ttls;
+    Metrics _metrics;
+    Generation _generation = 0;
+    Generation _cleared    = 0;
+
+    static uint32_t pageKey(uint8_t slaveId, utils::MBFunctionRegisters table,
+                            uint16_t address) noexcept;
+    // Must be called with the lock held, false if nothing was cached. Pages of
+    // `written` values are marked even if empty, for reads already sent.
+    bool expire(uint8_t slaveId, utils::MBFunctionRegisters table, uint16_t address,
+                std::size_t count, bool written);
+
+  public:
+    /**
+     * @brief Caches values of the range for `ttl`, later ranges override
+     * earlier ones where they overlap, zero `ttl` stops caching
+     * @throws std::invalid_argument - if range exceeds the address space
+     */
+    void setTtl(uint8_t slaveId, utils::MBFunctionRegisters table, uint16_t address,
+                std::size_t count, Clock::duration ttl);
+
+    //! Cached ranges of the table, in the order of addresses
+    [[nodiscard]] std::vector<Range> ranges(uint8_t slaveId,
+                                            utils::MBFunctionRegisters table) const;
+
+    //! Returns values, if all of them are cached and fresh
+    [[nodiscard]] std::optional<std::vector<ModbusCell>>
+    lookup(uint8_t slaveId, utils::MBFunctionRegisters table, uint16_t address,
+           std::size_t count, Clock::time_point now = Clock::now());
+
+    //! Current generation, to be taken before the read is sent to the device
+    [[nodiscard]] Generation generation() const;
+
+    /**
+     * @brief Stores values read from the device, that are within cached ranges,
+     * except pages invalidated after `since` generation
+     */
+    void store(uint8_t slaveId, utils::MBFunctionRegisters table, uint16_t address,
+               const std::vector<ModbusCell> &values, Generation since,
+               Clock::time_point now = Clock::now());
+
+    //! Invalidates values written by the request, does nothing for other requests
+    void invalidate(const ModbusRequest &request);
+
+    //! Invalidates all values
+    void clear();
+
+    [[nodiscard]] Metrics metrics() const;
+};
+} // namespace MB
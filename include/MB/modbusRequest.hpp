@@ -9,6 +9,8 @@
 #include <vector>
 
 #include "modbusCell.hpp"
+#include "modbusDeviceIdentification.hpp"
+#include "modbusFileRecord.hpp"
 #include "modbusUtils.hpp"
 
 /**
@@ -24,10 +26,20 @@ class ModbusRequest {
     uint8_t _slaveID;
     utils::MBFunctionCode _functionCode;
 
+    // For ReadFIFOQueue this is the FIFO pointer address
     uint16_t _address;
     uint16_t _registersNumber;
+    // Used only by ReadWriteMultipleRegisters, where address and number of
+    // registers describe the read
+    uint16_t _writeAddress = 0;
 
+    // For MaskWriteRegister values are { AND mask, OR mask }
     std::vector<ModbusCell> _values;
+    // Sub-requests of ReadFileRecord and WriteFileRecord, number of registers
+    // is the number of sub-requests then
+    std::vector<ModbusFileRecord> _fileRecords;
+    // Read device id code and object id of ReadDeviceIdentification
+    ModbusDeviceIdentification _deviceIdentification;
 
   public:
     // We do not allow default CTORs: https://github.com/Mazurel/Modbus/issues/6
@@ -93,6 +105,9 @@ class ModbusRequest {
     [[nodiscard]] std::string toString() const noexcept;
     //! Returns raw bytes representation of object, ready for modbus
     //! communication
+    //! @throws ModbusException - NumberOfRegistersInvalid if the request asks
+    //! for more registers than the specification allows (see
+    //! ModbusClient::read and ModbusClient::write for bigger ranges)
     [[nodiscard]] std::vector<uint8_t> toRaw() const;
 
     //! Returns function type based on Modbus function code
@@ -111,6 +126,20 @@ class ModbusRequest {
     [[nodiscard]] const std::vector<ModbusCell> &registerValues() const {
         return _values;
     }
+    //! Address of the written registers, for ReadWriteMultipleRegisters
+    [[nodiscard]] uint16_t writeRegisterAddress() const { return _writeAddress; }
+    //! Sub-requests of ReadFileRecord and WriteFileRecord
+    [[nodiscard]] const std::vector<ModbusFileRecord> &fileRecords() const {
+        return _fileRecords;
+    }
+    //! Read device id code and object id of ReadDeviceIdentification
+    [[nodiscard]] const ModbusDeviceIdentification &deviceIdentification() const {
+        return _deviceIdentification;
+    }
+    //! Checks if request is addressed to all slaves (it will not be answered)
+    [[nodiscard]] bool isBroadcast() const {
+        return _slaveID == utils::BroadcastSlaveID;
+    }
 
     void setSlaveId(uint8_t slaveId) { _slaveID = slaveId; }
     void setFunctionCode(utils::MBFunctionCode functionCode) {
@@ -119,8 +148,22 @@ class ModbusRequest {
     void setAddress(uint16_t address) { _address = address; }
     void setRegistersNumber(uint16_t registersNumber) {
         _registersNumber = registersNumber;
-        _values.resize(registersNumber);
+        // Values of read-write request are the written ones, and mask write
+        // always carries AND and OR masks
+        if (_functionCode != utils::ReadWriteMultipleRegisters &&
+            _functionCode != utils::MaskWriteRegister &&
+            functionType() != utils::FileRecord)
+            _values.resize(registersNumber);
     }
     void setValues(const std::vector<ModbusCell> &values) { _values = values; }
+    void setWriteAddress(uint16_t writeAddress) { _writeAddress = writeAddress; }
+    void setFileRecords(const std::vector<ModbusFileRecord> &fileRecords) {
+        _fileRecords     = fileRecords;
+        _registersNumber = static_cast<uint16_t>(fileRecords.size());
+    }
+    void setDeviceIdentification(uint8_t readCode, uint8_t objectId) {
+        _deviceIdentification.readCode = readCode;
+        _deviceIdentification.objectId = objectId;
+    }
 };
 } // namespace MB
@@ -32,6 +32,10 @@ class ModbusResponse {
     uint16_t _registersNumber;
 
     std::vector<ModbusCell> _values;
+    // Sub-responses of ReadFileRecord and WriteFileRecord
+    std::vector<ModbusFileRecord> _fileRecords;
+    // Objects of ReadDeviceIdentification
+    ModbusDeviceIdentification _deviceIdentification;
 
   public:
     // We do not allow default CTORs: https://github.com/Mazurel/Modbus/issues/6
@@ -107,9 +111,11 @@ class ModbusResponse {
      * @note Resulting Modbus response is not guaranteed to be correct
      **/
     static ModbusResponse from(const ModbusRequest &request) {
-        return ModbusResponse(request.slaveID(), request.functionCode(),
-                              request.registerAddress(), request.numberOfRegisters(),
-                              request.registerValues());
+        ModbusResponse response(request.slaveID(), request.functionCode(),
+                                request.registerAddress(), request.numberOfRegisters(),
+                                request.registerValues());
+        response._fileRecords = request.fileRecords();
+        return response;
     }
 
     [[nodiscard]] utils::MBFunctionType functionType() const {
@@ -130,9 +136,31 @@ class ModbusResponse {
         }
         return _values;
     }
+    //! Sub-responses of ReadFileRecord and WriteFileRecord
+    [[nodiscard]] const std::vector<ModbusFileRecord> &fileRecords() const {
+        return _fileRecords;
+    }
+    //! Objects of ReadDeviceIdentification
+    [[nodiscard]] const ModbusDeviceIdentification &deviceIdentification() const {
+        return _deviceIdentification;
+    }
 
     [[nodiscard]] uint16_t numberOfBytesToFollow() const {
-        if (this->functionType() == utils::Read) {
+        if (this->functionCode() == utils::ReadFileRecord) {
+            uint16_t size = 0;
+            for (const auto &record : _fileRecords)
+                size += static_cast<uint16_t>(2 + record.data.size() * 2);
+            return size;
+        }
+        if (this->functionCode() == utils::WriteFileRecord) {
+            return static_cast<uint16_t>(fileRecord::writeSize(_fileRecords));
+        }
+        if (this->functionType() == utils::ReadFIFO) {
+            // FIFO count and values
+            return 2 + this->numberOfRegisters() * 2;
+        }
+        if (this->functionType() == utils::Read ||
+            this->functionType() == utils::ReadWrite) {
             if ((*this->registerValues().begin()).isCoil()) {
                 // Coils
                 return (this->numberOfRegisters() / 8) +
@@ -144,8 +172,11 @@ class ModbusResponse {
         } else {
             if (this->functionType() == utils::WriteSingle) {
                 return static_cast<uint16_t>(2);
+            } else if (this->functionType() == utils::MaskWrite) {
+                return static_cast<uint16_t>(4);
             } else {
-                return this->numberOfRegisters();
+                // Address and quantity
+                return static_cast<uint16_t>(4);
             }
         }
     }
@@ -160,6 +191,14 @@ class ModbusResponse {
         _values.resize(registersNumber);
     }
     void setValues(const std::vector<ModbusCell> &values) { _values = values; }
+    void setFileRecords(const std::vector<ModbusFileRecord> &fileRecords) {
+        _fileRecords     = fileRecords;
+        _registersNumber = static_cast<uint16_t>(fileRecords.size());
+    }
+    void setDeviceIdentification(const ModbusDeviceIdentification &deviceIdentification) {
+        _deviceIdentification = deviceIdentification;
+        _registersNumber = static_cast<uint16_t>(deviceIdentification.objects.size());
+    }
 };
 
 } // namespace MB
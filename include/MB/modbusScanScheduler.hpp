@@ -0,0 +1,134 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "modbusTimerWheel.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Runs poll groups periodically, on a single thread.
+ *
+ * Each group has its own period and deadline and a scan function, that
+ * does the transactions, e.g. `ModbusClient::poll` of its plan. Scans are
+ * kept on a ModbusTimerWheel, so adding, removing and rescheduling groups is
+ * O(1), also with tens of thousands of them.
+ *
+ * Scans start on the fixed grid `start + n * period`, so the delay of one
+ * scan does not shift the next ones. Scan that ends after its next start
+ * is an overrun - the missed starts are skipped instead of being run in a
+ * burst. Scan that ends after its deadline is counted as late.
+ *
+ * @note This class is not thread safe, scans run on the thread that calls
+ * runDue or run.
+ */
+class ModbusScanScheduler {
+  public:
+    using Clock   = std::chrono::steady_clock;
+    using GroupId = uint64_t;
+    using Scan    = std::function<void()>;
+
+    //! Poll group settings
+    struct Group {
+        Clock::duration period;
+        //! Time from the scheduled start to the end of the scan, period if zero
+        Clock::duration deadline = Clock::duration::zero();
+        //! Delay of the first scan, used to spread groups of the same period
+        Clock::duration phase = Clock::duration::zero();
+        Scan scan;
+    };
+
+    //! Statistics of single group
+    struct Statistics {
+        uint64_t scans    = 0;
+        uint64_t failures = 0; // Scans that threw
+        uint64_t late     = 0; // Scans that ended after the deadline
+        uint64_t overruns = 0; // Scans that ended after the next start
+        uint64_t skipped  = 0; // Starts skipped because of overruns
+        Clock::duration lastScanTime  = Clock::duration::zero();
+        Clock::duration maxScanTime   = Clock::duration::zero();
+        Clock::duration totalScanTime = Clock::duration::zero();
+        //! Delay of the scan start after its scheduled time
+        Clock::duration maxJitter   = Clock::duration::zero();
+        Clock::duration totalJitter = Clock::duration::zero();
+    };
+
+  private:
+    struct Entry {
+        Group group;
+        Clock::time_point scheduled;
+        ModbusTimerWheel::TimerId timer;
+        Statistics statistics;
+    };
+
+    std::function<Clock::time_point()> _clock;
+    ModbusTimerWheel _wheel;
+    std::unordered_map<GroupId, Entry> _groups;
+    std::vector<GroupId> _due;
+    GroupId _nextId = 0;
+    // Group which scan is running, it is removed only after the scan
+    GroupId _runningId  = 0;
+    bool _running       = false;
+    bool _removeRunning = false;
+
+    // Runs scan of the group and schedules the next one, false if the group
+    // was removed before
+    bool runScan(GroupId id);
+
+  public:
+    /**
+     * @brief Creates scheduler without groups
+     * @param tick - Resolution of the timer wheel
+     * @param clock - Source of time, steady clock by default
+     */
+    explicit ModbusScanScheduler(Clock::duration tick = std::chrono::milliseconds(1),
+                                 std::function<Clock::time_point()> clock = Clock::now);
+
+    /**
+     * @brief Registers group, its first scan starts after `phase`
+     * @throws std::invalid_argument - if period is not positive or there is
+     * no scan function
+     */
+    GroupId add(Group group);
+
+    /**
+     * @brief Removes group, it may be its own scan that calls this
+     * @return false if there is no such group
+     */
+    bool remove(GroupId id);
+
+    /**
+     * @brief Runs scans of all groups, which start time has come
+     * @return Number of scans that were run
+     */
+    std::size_t runDue();
+
+    /**
+     * @brief Runs scans until `stop` is set, sleeping one tick when nothing
+     * is due
+     */
+    void run(const std::atomic<bool> &stop);
+
+    /**
+     * @brief Statistics of the group
+     * @throws std::out_of_range - if there is no such group
+     */
+    [[nodiscard]] const Statistics &statistics(GroupId id) const {
+        return _groups.at(id).statistics;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return _groups.size(); }
+};
+} // namespace MB
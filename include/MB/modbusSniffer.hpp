@@ -0,0 +1,125 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Passive decoder of the RTU bus traffic, that works on raw bytes taken from
+ * the tap (serial port or capture file), with both directions mixed.
+ *
+ * Frames are found with candidate-start search: byte that may be slave id and
+ * is followed by known function code starts a candidate, its length is
+ * predicted for both directions and confirmed with CRC. When the candidate
+ * fails, only one byte is dropped, so decoder locks onto the next frame right
+ * after the noise. Requests are paired with the responses that follow them.
+ *
+ * @note Frames are kept in fixed size buffers and decoded only on demand, so
+ * that capture files can be processed at memory speed.
+ */
+class ModbusSniffer {
+  public:
+    using Timestamp = std::chrono::system_clock::time_point;
+
+    //! Slave id, the biggest PDU and CRC
+    static constexpr std::size_t MaxFrameSize = 256;
+    //! Slave id, exception function code, exception code and CRC
+    static constexpr std::size_t MinFrameSize = 5;
+    //! Slave ids above this one are reserved
+    static constexpr uint8_t MaxSlaveID = 247;
+
+    //! Single frame seen on the bus, with its CRC
+    struct Frame {
+        //! Time when the first chunk of the frame was fed
+        Timestamp timestamp;
+        std::size_t size = 0;
+        std::array<uint8_t, MaxFrameSize> data;
+
+        [[nodiscard]] uint8_t slaveID() const { return data[0]; }
+        [[nodiscard]] uint8_t functionCode() const { return data[1]; }
+        [[nodiscard]] std::vector<uint8_t> raw() const {
+            return std::vector<uint8_t>(data.begin(), data.begin() + size);
+        }
+    };
+
+    /**
+     * Request paired with its response. Request is missing when decoder
+     * locked in the middle of transaction, response is missing when slave did
+     * not answer (or request was a broadcast).
+     */
+    struct Transaction {
+        std::optional<Frame> request;
+        std::optional<Frame> response;
+
+        //! Decodes the request, throws ModbusException if it is missing
+        [[nodiscard]] ModbusRequest decodeRequest() const;
+        //! Decodes the response, throws ModbusException if it is missing or if
+        //! slave answered with an exception
+        [[nodiscard]] ModbusResponse decodeResponse() const;
+    };
+
+    using Callback = std::function<void(const Transaction &)>;
+
+    struct Statistics {
+        uint64_t frames         = 0;
+        uint64_t transactions   = 0;
+        uint64_t discardedBytes = 0;
+    };
+
+  private:
+    Callback _callback;
+    Statistics _statistics;
+
+    std::vector<uint8_t> _buffer;
+    // Position of the first byte that was not consumed yet
+    std::size_t _offset = 0;
+    // Number of bytes consumed before the beginning of the buffer
+    std::size_t _consumed = 0;
+    // Timestamps of the fed chunks, by their position in the stream
+    std::deque<std::pair<std::size_t, Timestamp>> _chunks;
+    std::optional<Frame> _pending;
+
+    void scan(bool flush);
+    void onFrame(const uint8_t *data, std::size_t size, bool isRequest);
+    void emit(const Transaction &transaction);
+    [[nodiscard]] Timestamp timestampAt(std::size_t position);
+
+  public:
+    explicit ModbusSniffer(Callback callback);
+
+    /**
+     * @brief Feeds bytes taken from the bus, complete transactions are passed
+     * to the callback
+     * @param timestamp - Time when the bytes were captured
+     */
+    void feed(const uint8_t *data, std::size_t size,
+              Timestamp timestamp = std::chrono::system_clock::now());
+
+    void feed(const std::vector<uint8_t> &data,
+              Timestamp timestamp = std::chrono::system_clock::now()) {
+        feed(data.data(), data.size(), timestamp);
+    }
+
+    //! Decodes what is left in the stream, used at the end of the capture
+    void finish();
+
+    [[nodiscard]] const Statistics &statistics() const { return _statistics; }
+};
+} // namespace MB
@@ -0,0 +1,104 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Hierarchical timer wheel, with `Levels` wheels of `Slots` slots each.
+ *
+ * The first wheel has slots of one tick, every next one slots as long as
+ * the whole previous wheel. Timers are kept in intrusive lists of slots, so
+ * schedule and cancel are O(1) and advance is O(1) per tick and per expired
+ * timer (timers move to the lower wheel at most `Levels` - 1 times). Timers
+ * further than the last wheel wait in its last slot and are placed again.
+ *
+ * Deadlines are rounded up to the whole tick, so timers never expire early.
+ *
+ * @note This class is not thread safe.
+ */
+class ModbusTimerWheel {
+  public:
+    using Clock   = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+
+    static constexpr std::size_t Levels    = 4;
+    static constexpr std::size_t SlotsBits = 8;
+    static constexpr std::size_t Slots     = 1 << SlotsBits;
+
+  private:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Node {
+        uint64_t expiry     = 0;
+        std::size_t payload = 0;
+        uint32_t previous   = None;
+        uint32_t next       = None;
+        uint32_t generation = 0;
+        uint16_t slot       = 0; // Level * Slots + index
+        bool active         = false;
+    };
+
+    Clock::duration _tick;
+    Clock::time_point _start;
+    uint64_t _current = 0; // Ticks since start, already processed
+    std::size_t _size = 0;
+    std::vector<Node> _nodes;
+    std::vector<uint32_t> _free;
+    std::array<uint32_t, Levels * Slots> _heads;
+
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    // Unlinks node and returns it to the free list
+    void release(uint32_t index);
+    // Moves timers of the slot to the lower wheels
+    void cascade(std::size_t level);
+
+  public:
+    /**
+     * @brief Creates empty wheel
+     * @throws std::invalid_argument - if tick is not positive
+     */
+    explicit ModbusTimerWheel(Clock::duration tick = std::chrono::milliseconds(1),
+                              Clock::time_point start = Clock::now());
+
+    /**
+     * @brief Schedules timer, that expires at the first tick not earlier than
+     * `deadline` (deadlines from the past expire with the next tick)
+     * @param payload - Value given back on expiry
+     */
+    TimerId schedule(Clock::time_point deadline, std::size_t payload);
+
+    /**
+     * @brief Cancels timer
+     * @return false if the timer already expired or was cancelled
+     */
+    bool cancel(TimerId id) noexcept;
+
+    /**
+     * @brief Processes ticks up to `now`, calling `expired` with the payload of
+     * each expired timer, in the order of expiry ticks. Callback may schedule
+     * and cancel timers.
+     */
+    void advance(Clock::time_point now, const std::function<void(std::size_t)> &expired);
+
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    [[nodiscard]] Clock::duration tick() const noexcept { return _tick; }
+    //! Time of the last processed tick
+    [[nodiscard]] Clock::time_point now() const noexcept {
+        return _start + _tick * static_cast<Clock::rep>(_current);
+    }
+};
+} // namespace MB
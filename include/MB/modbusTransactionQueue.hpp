@@ -0,0 +1,88 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <optional>
+
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+//! Priority classes of bus transactions, from the most urgent one
+enum class ModbusPriority : uint8_t { Control = 0, Alarm = 1, Poll = 2 };
+
+/**
+ * Queue of transactions waiting for the bus, that is shared by priority
+ * classes. Transactions are dispatched one by one (on the frame boundary),
+ * the most urgent class first. Waiting transactions are aged - every
+ * `agingStep` of waiting promotes them by one class, so that polls are not
+ * starved by the constant stream of control writes.
+ *
+ * @note This class is not thread safe, it is meant to be guarded by the bus
+ * owner.
+ */
+class ModbusTransactionQueue {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t PriorityCount = 3;
+    static constexpr Clock::duration DefaultAgingStep = std::chrono::seconds(1);
+
+    //! Single transaction waiting for the bus
+    struct Transaction {
+        ModbusRequest request;
+        ModbusPriority priority;
+        Clock::time_point enqueuedAt;
+        std::promise<ModbusResponse> promise;
+    };
+
+    //! Statistics of single priority class
+    struct Metrics {
+        std::size_t queueDepth    = 0;
+        uint64_t dispatched       = 0;
+        Clock::duration totalWait = Clock::duration::zero();
+        Clock::duration maxWait   = Clock::duration::zero();
+    };
+
+  private:
+    std::array<std::deque<Transaction>, PriorityCount> _queues;
+    std::array<Metrics, PriorityCount> _metrics;
+    Clock::duration _agingStep = DefaultAgingStep;
+
+  public:
+    /**
+     * @brief Enqueues request in the given priority class
+     * @return Future that will be fulfilled with the response (or exception)
+     */
+    std::future<ModbusResponse> push(const ModbusRequest &request,
+                                     ModbusPriority priority,
+                                     Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Removes transaction that should be dispatched next
+     * @return Transaction or nullopt if queue is empty
+     */
+    std::optional<Transaction> pop(Clock::time_point now = Clock::now());
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    [[nodiscard]] const Metrics &metrics(ModbusPriority priority) const {
+        return _metrics[static_cast<std::size_t>(priority)];
+    }
+
+    [[nodiscard]] Clock::duration agingStep() const { return _agingStep; }
+    void setAgingStep(Clock::duration agingStep) { _agingStep = agingStep; }
+};
+} // namespace MB
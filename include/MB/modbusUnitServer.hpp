@@ -0,0 +1,200 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "modbusAccessMap.hpp"
+#include "modbusAdmission.hpp"
+#include "modbusDataStore.hpp"
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+#include "modbusWorkerPool.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Server engine, that hosts many units (slaves) behind one address, e.g.
+ * simulated devices, or devices aggregated by one process.
+ *
+ * Units are kept in a table indexed by unit id, so finding the unit of the
+ * request takes constant time, whatever the number of units. Each unit is
+ * answered by its ModbusDataStore, or by its handler, that overrides the store
+ * (e.g. to compute values on read). Request to unit that is not hosted is
+ * answered with GatewayTargetDeviceFailedToRespond, as from a gateway with
+ * the device missing.
+ *
+ * On Modbus TCP unit id 0 addresses the server itself, so by default it is
+ * hosted and answered as any other unit. With broadcast enabled it is taken
+ * as on serial line instead, executed by all units and not answered.
+ *
+ * Unit may have ModbusAccessMap, then requests outside of its readable and
+ * writable areas are answered with IllegalDataAddress, before they reach the
+ * store or the handler.
+ *
+ * Units are answered inline by default, in the thread that dispatches the
+ * request (e.g. event loop), which suits in-memory stores. Units with slow
+ * handlers may be offloaded to ModbusWorkerPool instead, each unit to its
+ * own strand, so requests of the unit stay serialized, while different units
+ * run in parallel and the event loop goes on. Offloaded units may shed load
+ * (see ModbusAdmission), answering requests with SlaveDeviceBusy when too
+ * many of them are queued on the strand, or would wait there too long.
+ *
+ * See TCP::UnitServer, that serves all units from one event loop.
+ *
+ * @note Units have to be set up before requests are handled, handling itself
+ * is thread safe as far as handlers are.
+ */
+class ModbusUnitServer {
+  public:
+    //! Answers request, exception response is given by throwing ModbusException
+    using Handler = std::function<ModbusResponse(const ModbusRequest &)>;
+    //! Receives MBAP response frame, nullopt if there is none (broadcast)
+    using Completion = std::function<void(std::optional<std::vector<uint8_t>> frame)>;
+
+    //! The biggest unit id, that may be hosted
+    static constexpr uint8_t MaxUnitId = 247;
+
+  private:
+    struct Unit {
+        std::shared_ptr<ModbusDataStore> store;
+        Handler handler;
+        std::shared_ptr<const ModbusAccessMap> access;
+        bool offloaded = false;
+    };
+
+    // Requests of offloaded unit, queued or running on its strand
+    struct Queue {
+        ModbusAdmission admission;
+        std::size_t queued = 0;
+    };
+
+    using Work = std::function<std::optional<std::vector<uint8_t>>()>;
+
+    // Indexed by unit id
+    std::array<Unit, 256> _units;
+    std::size_t _count = 0;
+    bool _broadcast    = false;
+    // Guards queues, that change in dispatch and on the workers
+    mutable std::mutex _mutex;
+    mutable std::array<Queue, 256> _queues;
+    // Destroyed first, so that its tasks finish while units still exist
+    std::shared_ptr<ModbusWorkerPool> _pool;
+
+    static void checkUnitId(uint8_t unitId);
+    static void checkFrame(const std::vector<uint8_t> &frame);
+    [[nodiscard]] ModbusResponse execute(const Unit &unit,
+                                         const ModbusRequest &request) const;
+    // Posts work to the strand of the unit, false if it was shed
+    bool offload(uint8_t unitId, Work work, Completion completion) const;
+
+  public:
+    ModbusUnitServer() = default;
+    ModbusUnitServer(const ModbusUnitServer &) = delete;
+    ModbusUnitServer &operator=(const ModbusUnitServer &) = delete;
+
+    /**
+     * @brief Hosts unit with its store, replacing the previous one
+     * @throws std::invalid_argument - if unit id is not 0 - 247, or store is
+     * nullptr
+     */
+    void addUnit(uint8_t unitId, std::shared_ptr<ModbusDataStore> store);
+
+    /**
+     * @brief Answers requests of the unit with the handler, instead of the
+     * store, the unit is hosted if it was not. Empty handler restores the store.
+     * @throws std::invalid_argument - if unit id is not 0 - 247
+     */
+    void setHandler(uint8_t unitId, Handler handler);
+
+    /**
+     * @brief Restricts requests of the unit to the map, nullptr allows all
+     * @throws std::invalid_argument - if unit id is not 0 - 247
+     */
+    void setAccessMap(uint8_t unitId, std::shared_ptr<const ModbusAccessMap> access);
+
+    /**
+     * @brief Answers requests of the unit on the worker pool, instead of inline
+     * @throws std::invalid_argument - if unit id is not 0 - 247
+     */
+    void setOffloaded(uint8_t unitId, bool offloaded);
+
+    /**
+     * @brief Sets admission limits of the offloaded unit, there are none by
+     * default
+     * @throws std::invalid_argument - if unit id is not 0 - 247, or settings
+     * are not valid
+     */
+    void setAdmission(uint8_t unitId, ModbusAdmission::Settings settings);
+
+    //! Admission metrics of the offloaded unit, e.g. number of shed requests
+    [[nodiscard]] ModbusAdmission::Metrics admissionMetrics(uint8_t unitId) const;
+
+    /**
+     * @brief Sets pool of offloaded units, without it all units are inline
+     * @note Pool shared with others has to finish tasks of this server, before
+     * the server is destroyed
+     */
+    void setWorkerPool(std::shared_ptr<ModbusWorkerPool> pool) {
+        _pool = std::move(pool);
+    }
+
+    /**
+     * @brief Executes requests to unit id 0 on all units, without answering
+     * them, as serial slaves do with broadcast. It is off by default.
+     */
+    void setBroadcast(bool enabled) noexcept { _broadcast = enabled; }
+
+    [[nodiscard]] bool broadcast() const noexcept { return _broadcast; }
+
+    //! Stops hosting the unit, and forgets its access map
+    void removeUnit(uint8_t unitId);
+
+    [[nodiscard]] bool hasUnit(uint8_t unitId) const noexcept;
+
+    //! Store of the unit, nullptr if it has none
+    [[nodiscard]] std::shared_ptr<ModbusDataStore> store(uint8_t unitId) const;
+
+    //! Number of hosted units
+    [[nodiscard]] std::size_t units() const noexcept { return _count; }
+
+    /**
+     * @brief Executes request on its unit, or on all units if it is broadcast
+     * and broadcast is enabled (its response is empty then, and should not be
+     * sent)
+     * @throws ModbusException - exception response, that should be sent
+     */
+    [[nodiscard]] ModbusResponse handle(const ModbusRequest &request) const;
+
+    /**
+     * @brief Answers MBAP request frame
+     * @return MBAP response frame, nullopt for broadcast, if it is enabled
+     * @throws ModbusException - ProtocolError if frame is not valid MBAP frame,
+     * connection with the master should be closed then
+     */
+    [[nodiscard]] std::optional<std::vector<uint8_t>>
+    handleFrame(const std::vector<uint8_t> &frame) const;
+
+    /**
+     * @brief Answers MBAP request frame inline, or on the strand of its unit
+     * if the unit is offloaded, and gives the response to `completion` (from
+     * the worker thread then). Request shed by the admission of the unit is
+     * answered with SlaveDeviceBusy right away. Broadcast, if it is enabled,
+     * is executed by each unit in its own way, and completed right away.
+     * @throws ModbusException - ProtocolError if frame is not valid MBAP frame,
+     * connection with the master should be closed then
+     */
+    void dispatch(const std::vector<uint8_t> &frame, Completion completion) const;
+};
+} // namespace MB
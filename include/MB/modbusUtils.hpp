@@ -138,12 +138,65 @@ enum MBFunctionCode : uint8_t {
     WriteMultipleDiscreteOutputCoils          = 0x0F,
     WriteMultipleAnalogOutputHoldingRegisters = 0x10,
 
+    // File record functions
+    ReadFileRecord  = 0x14,
+    WriteFileRecord = 0x15,
+
+    // Combined functions
+    MaskWriteRegister          = 0x16,
+    ReadWriteMultipleRegisters = 0x17,
+
+    // Queue functions
+    ReadFIFOQueue = 0x18,
+
+    // Encapsulated interface transport, only Read Device Identification (MEI
+    // type 0x0E) is supported
+    ReadDeviceIdentification = 0x2B,
+
     // User defined
     Undefined = 0x00
 };
 
+//! Slave ID reserved for broadcast requests, that are never answered by slaves
+constexpr uint8_t BroadcastSlaveID = 0x00;
+
+//! The biggest number of values returned by ReadFIFOQueue
+constexpr uint16_t MaxFIFOCount = 31;
+
+//! The biggest quantities of single request, as the specification allows.
+//! MaxReadWriteRegisters is the write part of ReadWriteMultipleRegisters.
+constexpr uint16_t MaxReadCoils          = 2000;
+constexpr uint16_t MaxReadRegisters      = 125;
+constexpr uint16_t MaxWriteCoils         = 1968;
+constexpr uint16_t MaxWriteRegisters     = 123;
+constexpr uint16_t MaxReadWriteRegisters = 121;
+
+//! Checks if function code may be broadcasted - only writes are allowed
+inline bool isBroadcastable(const MBFunctionCode code) {
+    switch (code) {
+    case WriteSingleDiscreteOutputCoil:
+    case WriteSingleAnalogOutputRegister:
+    case WriteMultipleDiscreteOutputCoils:
+    case WriteMultipleAnalogOutputHoldingRegisters:
+    case MaskWriteRegister:
+    case WriteFileRecord:
+        return true;
+    default:
+        return false;
+    }
+}
+
 //! Simplified function types
-enum MBFunctionType { Read, WriteSingle, WriteMultiple };
+enum MBFunctionType {
+    Read,
+    WriteSingle,
+    WriteMultiple,
+    ReadWrite,
+    MaskWrite,
+    ReadFIFO,
+    FileRecord,
+    DeviceIdentification
+};
 
 //! Checks "Function type", according to MBFunctionType
 inline MBFunctionType functionType(const MBFunctionCode code) {
@@ -159,6 +212,17 @@ inline MBFunctionType functionType(const MBFunctionCode code) {
     case WriteMultipleAnalogOutputHoldingRegisters:
     case WriteMultipleDiscreteOutputCoils:
         return WriteMultiple;
+    case MaskWriteRegister:
+        return MaskWrite;
+    case ReadWriteMultipleRegisters:
+        return ReadWrite;
+    case ReadFIFOQueue:
+        return ReadFIFO;
+    case ReadFileRecord:
+    case WriteFileRecord:
+        return FileRecord;
+    case ReadDeviceIdentification:
+        return DeviceIdentification;
     case Undefined:
         throw std::runtime_error("The function code is undefined");
     }
@@ -180,8 +244,16 @@ inline MBFunctionRegisters functionRegister(const MBFunctionCode code) {
     case ReadAnalogOutputHoldingRegisters:
     case WriteSingleAnalogOutputRegister:
     case WriteMultipleAnalogOutputHoldingRegisters:
+    case MaskWriteRegister:
+    case ReadWriteMultipleRegisters:
+    case ReadFIFOQueue:
+    // File records are registers as well, although outside of the tables
+    case ReadFileRecord:
+    case WriteFileRecord:
         return HoldingRegisters;
     case ReadAnalogInputRegisters:
+    // Identification objects are read only and are not kept in the tables
+    case ReadDeviceIdentification:
         return InputRegisters;
     case Undefined:
         throw std::runtime_error("The function code is undefined");
@@ -189,6 +261,31 @@ inline MBFunctionRegisters functionRegister(const MBFunctionCode code) {
     throw std::runtime_error("The function code is undefined");
 }
 
+//! The biggest number of registers (or coils) of single request, as the
+//! specification allows. For ReadWriteMultipleRegisters it is the read quantity.
+inline uint16_t maxRegistersNumber(const MBFunctionCode code) {
+    switch (code) {
+    case ReadDiscreteOutputCoils:
+    case ReadDiscreteInputContacts:
+        return MaxReadCoils;
+    case ReadAnalogOutputHoldingRegisters:
+    case ReadAnalogInputRegisters:
+    case ReadWriteMultipleRegisters:
+        return MaxReadRegisters;
+    case WriteSingleDiscreteOutputCoil:
+    case WriteSingleAnalogOutputRegister:
+    case MaskWriteRegister:
+        return 1;
+    case WriteMultipleDiscreteOutputCoils:
+        return MaxWriteCoils;
+    case WriteMultipleAnalogOutputHoldingRegisters:
+        return MaxWriteRegisters;
+    default:
+        // Quantity is not a number of registers
+        return 0xFFFF;
+    }
+}
+
 //! Converts modbus function code to its string represenatiton
 inline std::string mbFunctionToStr(MBFunctionCode code) noexcept {
     switch (code) {
@@ -208,6 +305,18 @@ inline std::string mbFunctionToStr(MBFunctionCode code) noexcept {
         return "Write to multiple holding registers";
     case WriteMultipleDiscreteOutputCoils:
         return "Write to multiple output coils";
+    case MaskWriteRegister:
+        return "Mask write to holding register";
+    case ReadWriteMultipleRegisters:
+        return "Read and write multiple holding registers";
+    case ReadFIFOQueue:
+        return "Read FIFO queue";
+    case ReadFileRecord:
+        return "Read file record";
+    case WriteFileRecord:
+        return "Write file record";
+    case ReadDeviceIdentification:
+        return "Read device identification";
     case Undefined:
         return "Undefined";
     }
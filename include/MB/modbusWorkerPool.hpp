@@ -0,0 +1,76 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * Threads, that run tasks posted to strands - tasks of the same strand run
+ * one at a time, in the order they were posted, and tasks of different
+ * strands run in parallel.
+ *
+ * ModbusUnitServer uses it for units with slow handlers (e.g. PLC driver or
+ * database calls), with unit id as the strand, so that such unit does not
+ * block the event loop, and requests of the unit are still serialized.
+ */
+class ModbusWorkerPool {
+  public:
+    using Task     = std::function<void()>;
+    using StrandId = uint32_t;
+
+  private:
+    struct Strand {
+        std::deque<Task> tasks;
+        bool running = false;
+    };
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cond;
+    // Strands with tasks, only those that are not running are in `_ready`
+    std::unordered_map<StrandId, Strand> _strands;
+    std::deque<StrandId> _ready;
+    std::size_t _pending = 0;
+    bool _stop           = false;
+    std::vector<std::thread> _threads;
+
+    void run();
+
+  public:
+    /**
+     * @brief Starts `threads` threads
+     * @throws std::invalid_argument - if threads is 0
+     */
+    explicit ModbusWorkerPool(
+        std::size_t threads = std::max(1u, std::thread::hardware_concurrency()));
+    ModbusWorkerPool(const ModbusWorkerPool &) = delete;
+    ModbusWorkerPool &operator=(const ModbusWorkerPool &) = delete;
+
+    //! Runs tasks that were posted, and joins the threads
+    ~ModbusWorkerPool();
+
+    /**
+     * @brief Queues task on the strand, exceptions thrown by it are ignored
+     */
+    void post(StrandId strand, Task task);
+
+    [[nodiscard]] std::size_t threads() const noexcept { return _threads.size(); }
+
+    //! Tasks that are queued or running
+    [[nodiscard]] std::size_t pending() const;
+};
+} // namespace MB
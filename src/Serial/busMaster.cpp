@@ -0,0 +1,80 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "Serial/busMaster.hpp"
+
+using namespace MB::Serial;
+
+BusMaster::BusMaster(Connection &&connection) : _connection(std::move(connection)) {
+    _thread = std::thread(&BusMaster::run, this);
+}
+
+BusMaster::~BusMaster() {
+    {
+        std::lock_guard lock{_mutex};
+        _stop = true;
+    }
+    _cond.notify_all();
+    _thread.join();
+
+    while (auto transaction = _queue.pop()) {
+        transaction->promise.set_exception(std::make_exception_ptr(
+            MB::ModbusException(MB::utils::ConnectionClosed,
+                                transaction->request.slaveID(),
+                                transaction->request.functionCode())));
+    }
+}
+
+std::future<MB::ModbusResponse> BusMaster::submit(const MB::ModbusRequest &request,
+                                                  MB::ModbusPriority priority) {
+    std::future<MB::ModbusResponse> result;
+    {
+        std::lock_guard lock{_mutex};
+        result = _queue.push(request, priority);
+    }
+    _cond.notify_one();
+    return result;
+}
+
+MB::ModbusTransactionQueue::Metrics BusMaster::metrics(MB::ModbusPriority priority) const {
+    std::lock_guard lock{_mutex};
+    return _queue.metrics(priority);
+}
+
+void BusMaster::setAgingStep(MB::ModbusTransactionQueue::Clock::duration agingStep) {
+    std::lock_guard lock{_mutex};
+    _queue.setAgingStep(agingStep);
+}
+
+void BusMaster::run() {
+    while (true) {
+        std::unique_lock lock{_mutex};
+        _cond.wait(lock, [this]() { return _stop || !_queue.empty(); });
+        if (_stop)
+            return;
+
+        // Scheduling decision is made on the frame boundary, so that urgent
+        // transaction submitted in the meantime goes first
+        auto transaction = _queue.pop();
+        lock.unlock();
+
+        dispatch(*transaction);
+    }
+}
+
+void BusMaster::dispatch(MB::ModbusTransactionQueue::Transaction &transaction) {
+    try {
+        if (transaction.request.isBroadcast()) {
+            _connection.sendBroadcast(transaction.request);
+            transaction.promise.set_value(MB::ModbusResponse::from(transaction.request));
+            return;
+        }
+
+        _connection.sendRequest(transaction.request);
+        auto [response, raw] = _connection.awaitResponse();
+        transaction.promise.set_value(response);
+    } catch (...) {
+        transaction.promise.set_exception(std::current_exception());
+    }
+}
@@ -3,10 +3,15 @@
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
 #include "Serial/connection.hpp"
+#include "modbusAscii.hpp"
+#include "modbusFraming.hpp"
 #include "modbusUtils.hpp"
 #include "modbusLog.hpp"
 #include "serialportimpl.hpp"
 
+#include <algorithm>
+#include <thread>
+
 using namespace MB::Serial;
 
 Connection::Connection()
@@ -20,36 +25,75 @@ void Connection::connect(const std::string &path) {
     }
     _impl->setBaudRate(115200);
     _impl->setDataBits(8);
-    _impl->setParity(static_cast<SerialPortImpl::Parity>(NOPARITY));
-    _impl->setStopBits(static_cast<SerialPortImpl::StopBits>(ONESTOPBIT));
+    _impl->setParity(SerialPortImpl::Parity::NONE);
+    _impl->setStopBits(SerialPortImpl::StopBits::ONE);
     _impl->setFlowControl(SerialPortImpl::FlowControl::NONE);
 }
 
 Connection::~Connection() {
+    // Moved-from connection does not own the port anymore
+    if (_impl == nullptr)
+        return;
+
     if (_impl->isOpen()) {
         _impl->close();
     }
+    delete _impl;
 }
 
 std::vector<uint8_t> Connection::sendRequest(const MB::ModbusRequest &request) {
-    return send(request.toRaw());
+    if (request.isBroadcast())
+        return sendBroadcast(request);
+
+    auto raw = send(request.toRaw());
+    _requestSlave = request.slaveID();
+    _requestSentAt = std::chrono::steady_clock::now();
+    return raw;
 }
 
 std::vector<uint8_t> Connection::sendResponse(const MB::ModbusResponse &response) {
+    // Broadcast is applied by the slave, but never answered
+    if (response.slaveID() == utils::BroadcastSlaveID)
+        return {};
+
     return send(response.toRaw());
 }
 
 std::vector<uint8_t> Connection::sendException(const MB::ModbusException &exception) {
+    if (exception.slaveID() == utils::BroadcastSlaveID)
+        return {};
+
     return send(exception.toRaw());
 }
 
+std::vector<uint8_t> Connection::sendBroadcast(const MB::ModbusRequest &request) {
+    if (!utils::isBroadcastable(request.functionCode()))
+        throw MB::ModbusException(utils::IllegalFunction, utils::BroadcastSlaveID,
+                                  request.functionCode());
+
+    auto broadcast = request;
+    broadcast.setSlaveId(utils::BroadcastSlaveID);
+
+    auto raw = send(broadcast.toRaw());
+
+    // There is no response to wait for, slaves only need time to apply it
+    _busFreeAt = std::chrono::steady_clock::now() +
+                 std::chrono::milliseconds(_turnaroundDelay);
+
+    return raw;
+}
+
 std::vector<uint8_t> Connection::awaitRawMessage() {
+    return readRaw(_timeout);
+}
+
+std::vector<uint8_t> Connection::readRaw(int timeout) {
     std::vector<uint8_t> data(1024);
     if (!_impl->isOpen()) {
         throw MB::ModbusException(MB::utils::ConnectionClosed);
     }
 
-    int number_of_bytes_read = _impl->read((void *)data.data(), static_cast<int>(data.size()), SerialPortImpl::milliseconds(_timeout));
+    int number_of_bytes_read = _impl->read((void *)data.data(), static_cast<int>(data.size()), SerialPortImpl::milliseconds(timeout));
     if (number_of_bytes_read < 0) {
         throw std::runtime_error("Error while reading from serial port");
     }
@@ -62,8 +106,112 @@ std::vector<uint8_t> Connection::awaitRawMessage() {
     return data;
 }
 
-// TODO: Figure out how to return raw data when exception is being thrown
+std::size_t Connection::sniff(MB::ModbusSniffer &sniffer) {
+    std::vector<uint8_t> data(1024);
+    if (!_impl->isOpen()) {
+        throw MB::ModbusException(MB::utils::ConnectionClosed);
+    }
+
+    int number_of_bytes_read = _impl->read((void *)data.data(), static_cast<int>(data.size()), SerialPortImpl::milliseconds(_timeout));
+    if (number_of_bytes_read < 0) {
+        throw std::runtime_error("Error while reading from serial port");
+    }
+
+    sniffer.feed(data.data(), static_cast<std::size_t>(number_of_bytes_read));
+
+    return static_cast<std::size_t>(number_of_bytes_read);
+}
+
+std::vector<uint8_t> Connection::awaitAsciiFrame(int timeout) {
+    if (!_impl->isOpen()) {
+        throw MB::ModbusException(MB::utils::ConnectionClosed);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    std::vector<char> line(MB::framing::MaxASCIIFrameSize);
+    std::vector<uint8_t> frame;
+    frame.reserve(line.size());
+
+    while (true) {
+        const auto remaining = std::chrono::duration_cast<SerialPortImpl::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            throw MB::ModbusException(MB::utils::Timeout);
+        }
+
+        int number_of_bytes_read = _impl->readLine(line.data(), static_cast<int>(line.size()), remaining);
+        if (number_of_bytes_read < 0) {
+            throw std::runtime_error("Error while reading from serial port");
+        }
+        frame.insert(frame.end(), line.begin(), line.begin() + number_of_bytes_read);
+
+        // ':' always starts a new frame, so anything before it is noise
+        auto start = std::find(frame.rbegin(), frame.rend(), ':');
+        if (start == frame.rend()) {
+            frame.clear();
+            continue;
+        }
+        frame.erase(frame.begin(), start.base() - 1);
+
+        const auto length = MB::framing::asciiFrameLength(frame.data(), frame.size());
+        if (!length.has_value()) {
+            frame.clear();
+            continue;
+        }
+        if (*length <= frame.size()) {
+            frame.resize(*length);
+            return frame;
+        }
+    }
+}
+
 std::tuple<MB::ModbusResponse, std::vector<uint8_t>> Connection::awaitResponse() {
+    auto timeout = std::chrono::milliseconds(_timeout);
+    if (_adaptiveTimeouts)
+        timeout = std::chrono::ceil<std::chrono::milliseconds>(_adaptiveTimeouts->timeout(_requestSlave));
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true) {
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        try {
+            if (remaining.count() <= 0)
+                throw MB::ModbusException(MB::utils::Timeout);
+
+            auto response = readResponse(static_cast<int>(remaining.count()));
+            // Answer of another slave, e.g. late one to the previous request
+            if (std::get<0>(response).slaveID() != _requestSlave)
+                continue;
+
+            if (_adaptiveTimeouts)
+                _adaptiveTimeouts->sample(_requestSlave, std::chrono::steady_clock::now() - _requestSentAt);
+            return response;
+        } catch (const MB::ModbusException &ex) {
+            const bool answered = MB::utils::isStandardErrorCode(ex.getErrorCode());
+            if (answered && ex.slaveID() != _requestSlave)
+                continue;
+
+            // Exception response is a response as well
+            if (_adaptiveTimeouts && ex.getErrorCode() == MB::utils::Timeout)
+                _adaptiveTimeouts->timedOut(_requestSlave);
+            else if (_adaptiveTimeouts && answered)
+                _adaptiveTimeouts->sample(_requestSlave, std::chrono::steady_clock::now() - _requestSentAt);
+            throw;
+        }
+    }
+}
+
+// TODO: Figure out how to return raw data when exception is being thrown
+std::tuple<MB::ModbusResponse, std::vector<uint8_t>> Connection::readResponse(int timeout) {
+    if (_framing == Framing::ASCII) {
+        auto frame = awaitAsciiFrame(timeout);
+        const auto raw = MB::ascii::decodeFrame(frame);
+
+        if (MB::ModbusException::exist(raw))
+            throw MB::ModbusException(raw);
+
+        return std::make_tuple(MB::ModbusResponse::fromRaw(raw), frame);
+    }
+
     std::vector<uint8_t> data;
     data.reserve(8);
 
@@ -71,7 +219,7 @@ std::tuple<MB::ModbusResponse, std::vector<uint8_t>> Connection::awaitResponse()
 
     while (true) {
         try {
-            auto tmpResponse = awaitRawMessage();
+            auto tmpResponse = readRaw(timeout);
             data.insert(data.end(), tmpResponse.begin(), tmpResponse.end());
 
             if (MB::ModbusException::exist(data))
@@ -92,6 +240,18 @@ std::tuple<MB::ModbusResponse, std::vector<uint8_t>> Connection::awaitResponse()
 }
 
 std::tuple<MB::ModbusRequest, std::vector<uint8_t>> Connection::awaitRequest() {
+    if (_framing == Framing::ASCII) {
+        // Frames with invalid LRC are dropped, as in RTU
+        while (true) {
+            auto frame = awaitAsciiFrame(_timeout);
+            try {
+                return std::make_tuple(MB::ModbusRequest::fromRaw(MB::ascii::decodeFrame(frame)), frame);
+            } catch (const MB::ModbusException &) {
+                continue;
+            }
+        }
+    }
+
     std::vector<uint8_t> data;
     data.reserve(8);
 
@@ -116,14 +276,20 @@ std::tuple<MB::ModbusRequest, std::vector<uint8_t>> Connection::awaitRequest() {
 }
 
 std::vector<uint8_t> Connection::send(std::vector<uint8_t> data) {
-    data.reserve(data.size() + 2);
-    const auto crc = utils::calculateCRC(data.data(), data.size());
+    std::this_thread::sleep_until(_busFreeAt);
 
-    data.push_back(reinterpret_cast<const uint8_t *>(&crc)[0]);
-    data.push_back(reinterpret_cast<const uint8_t *>(&crc)[1]);
+    if (_framing == Framing::ASCII) {
+        data = MB::ascii::encodeFrame(data);
+    } else {
+        data.reserve(data.size() + 2);
+        const auto crc = utils::calculateCRC(data.data(), data.size());
+
+        data.push_back(reinterpret_cast<const uint8_t *>(&crc)[0]);
+        data.push_back(reinterpret_cast<const uint8_t *>(&crc)[1]);
+    }
 
-    int nwriten = _impl->write(data.data(), (int)data.size());
-    if (nwriten != data.size()) {
+    const auto written = _impl->write(data.data(), static_cast<int>(data.size()));
+    if (written < 0 || static_cast<std::size_t>(written) != data.size()) {
         throw std::runtime_error("Failed to send data");
     }
 
@@ -134,15 +300,35 @@ Connection::Connection(Connection &&moved) noexcept {
     _impl = moved._impl;
     moved._impl = nullptr;
     _timeout = moved._timeout;
+    _turnaroundDelay = moved._turnaroundDelay;
+    _busFreeAt = moved._busFreeAt;
+    _framing = moved._framing;
+    _adaptiveTimeouts = std::move(moved._adaptiveTimeouts);
+    _requestSlave = moved._requestSlave;
+    _requestSentAt = moved._requestSentAt;
 }
 
 Connection &Connection::operator=(Connection &&moved) {
     if (this == &moved)
         return *this;
 
+    // Port of this connection would be leaked open otherwise
+    if (_impl != nullptr && _impl != moved._impl) {
+        if (_impl->isOpen()) {
+            _impl->close();
+        }
+        delete _impl;
+    }
+
     _impl = moved._impl;
-    moved._impl = NULL;
+    moved._impl = nullptr;
     _timeout = moved._timeout;
+    _turnaroundDelay = moved._turnaroundDelay;
+    _busFreeAt = moved._busFreeAt;
+    _framing = moved._framing;
+    _adaptiveTimeouts = std::move(moved._adaptiveTimeouts);
+    _requestSlave = moved._requestSlave;
+    _requestSentAt = moved._requestSentAt;
     return *this;
 }
 
@@ -4,10 +4,13 @@
 #include <functional>
 #include <chrono>
 #include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
 #include "serialportimpl.hpp"
 #include "modbusLog.hpp"
 #ifdef WIN32
 #include <windows.h>
+#else
+#include <termios.h>
 #endif
 #define TAG "SerialPortImpl"
 
@@ -75,9 +78,10 @@ bool SerialPortImpl::open(const char *portName) {
 		m_serial_port.async_read_some(boost::asio::buffer(m_one_byte_buffer, 1), 
 			std::bind(&SerialPortImpl::onReceived, this, std::placeholders::_1, std::placeholders::_2));
 		// 创建线程，用于异步读取数据
+		m_io_context.restart();
 		m_thread = std::thread([this]() {
 			m_io_context.run();
-			LogError(TAG, "io_context stopped");
+			LOG_ERROR(TAG, "io_context stopped");
 		});
 		return true;
 	}
@@ -86,15 +90,24 @@ bool SerialPortImpl::open(const char *portName) {
 
 void SerialPortImpl::close() {
 	if (m_serial_port.is_open()) {
-		boost::system::error_code ec;
-		m_serial_port.close(ec);
-		if (ec != boost::system::errc::success) {
-			LogError(TAG, "close error: %s", ec.what().c_str());
-		}
-		LogDebug(TAG, "waiting thread to join ...");
+		const auto closePort = [this]() {
+			boost::system::error_code ec;
+			m_serial_port.close(ec);
+			if (ec != boost::system::errc::success) {
+				LOG_ERROR(TAG, "close error: %s", ec.message().c_str());
+			}
+		};
+		// Closed on the reading thread, as the port is not thread safe; pending
+		// read is aborted then, and the thread runs out of work
+		boost::asio::post(m_io_context, closePort);
+		LOG_DEBUG(TAG, "waiting thread to join ...");
 		m_thread.join();
-		LogDebug(TAG, "thread joined");
-		LogDebug(TAG, "serial port closed");
+		LOG_DEBUG(TAG, "thread joined");
+		// Thread may have stopped before, when the port was hung up
+		if (m_serial_port.is_open()) {
+			closePort();
+		}
+		LOG_DEBUG(TAG, "serial port closed");
 	}
 }
 
@@ -106,7 +119,7 @@ int SerialPortImpl::write(const void *data, int length) {
 	boost::system::error_code ec;
     size_t n = m_serial_port.write_some(boost::asio::buffer(data, length), ec);
 	if (ec != boost::system::errc::success) {
-		LogError(TAG, "write error: %s", ec.what());
+		LOG_ERROR(TAG, "write error: %s", ec.message().c_str());
 		return -1;
 	}
 	flush();
@@ -127,7 +140,7 @@ int SerialPortImpl::read(void *buffer, int length, milliseconds timeout) {
 			if (n > m_num_bytes_required) {
 				n = m_num_bytes_required;
 			}
-			LogInfo(TAG, "read %d bytes", n);
+			LOG_INFO(TAG, "read %zu bytes", n);
 
 			std::copy(m_buffer.begin(), m_buffer.begin() + n, (char *)buffer + num_bytes_read);
 			m_buffer.erase_begin(n);
@@ -142,7 +155,7 @@ int SerialPortImpl::read(void *buffer, int length, milliseconds timeout) {
             break;
         }
 		if (m_cond.wait_until(lock, tp) == std::cv_status::timeout) {
-			LogInfo(TAG, "read timeout");
+			LOG_INFO(TAG, "read timeout");
 		}
     }
 
@@ -190,7 +203,7 @@ int SerialPortImpl::readLine(char *buffer, int size, milliseconds timeout) {
 
         m_num_bytes_required = SIZE_MAX; // 读取到换行符为止
 		if (m_cond.wait_until(lock, tp) == std::cv_status::timeout) {
-			LogInfo(TAG, "read timeout");
+			LOG_INFO(TAG, "read timeout");
 		}
 	}
 	m_num_bytes_required = 0;
@@ -204,15 +217,27 @@ void SerialPortImpl::clearInputs() {
 }
 
 void SerialPortImpl::flush() {
+#ifdef WIN32
 	::FlushFileBuffers(m_serial_port.native_handle());
+#else
+	::tcdrain(m_serial_port.native_handle());
+#endif
 }
 
 void SerialPortImpl::clearRxBuffer() {
+#ifdef WIN32
 	::PurgeComm(m_serial_port.native_handle(), PURGE_RXCLEAR | PURGE_RXABORT);
+#else
+	::tcflush(m_serial_port.native_handle(), TCIFLUSH);
+#endif
 }
 
 void SerialPortImpl::clearTxBuffer() {
+#ifdef WIN32
 	::PurgeComm(m_serial_port.native_handle(), PURGE_TXCLEAR | PURGE_TXABORT);
+#else
+	::tcflush(m_serial_port.native_handle(), TCOFLUSH);
+#endif
 }
 
 void SerialPortImpl::onReceived(const boost::system::error_code &ec,
@@ -232,9 +257,13 @@ void SerialPortImpl::onReceived(const boost::system::error_code &ec,
 			std::bind(&SerialPortImpl::onReceived, this, std::placeholders::_1, std::placeholders::_2));
 	} 
 	else if (ec.value() != boost::asio::error::operation_aborted) {
-		LogError(TAG, "serial port read error: %s (catage: %s, value: %d)", ec.message().c_str(),
+		LOG_ERROR(TAG, "serial port read error: %s (catage: %s, value: %d)", ec.message().c_str(),
 			ec.category().name(), ec.value());
-		// 重启读取
+		// 重启读取, unless the port is gone (e.g. device was unplugged), as
+		// reading would fail again right away
+		if (ec == boost::asio::error::eof || !m_serial_port.is_open()) {
+			return;
+		}
 		m_serial_port.async_read_some(boost::asio::buffer(m_one_byte_buffer, 1),
 			std::bind(&SerialPortImpl::onReceived, this, std::placeholders::_1, std::placeholders::_2));
 	} 
@@ -3,7 +3,12 @@
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
 #include "TCP/connection.hpp"
+#include "modbusFraming.hpp"
+#include "socketio.hpp"
+
+#include <algorithm>
 #include <cstdint>
+#include <optional>
 #include <sys/poll.h>
 #include <sys/socket.h>
 
@@ -22,128 +27,77 @@ Connection::~Connection() {
     _sockfd = -1;
 }
 
-std::vector<uint8_t> Connection::sendRequest(const MB::ModbusRequest &req) {
+std::vector<uint8_t> Connection::sendFrame(uint16_t messageID,
+                                           const std::vector<uint8_t> &dat) {
     std::vector<uint8_t> rawReq;
-    rawReq.reserve(6);
+    rawReq.reserve(6 + dat.size());
 
-    rawReq.push_back(
-        static_cast<const uint8_t &&>(reinterpret_cast<const uint8_t *>(&_messageID)[1]));
-    rawReq.push_back(static_cast<uint8_t>(_messageID));
+    MB::utils::pushUint16(rawReq, messageID);
     rawReq.push_back(0x00);
     rawReq.push_back(0x00);
-
-    std::vector<uint8_t> dat = req.toRaw();
-
-    uint32_t size = dat.size();
-    rawReq.push_back(
-        static_cast<const uint16_t &&>(reinterpret_cast<const uint16_t *>(&size)[1]));
-    rawReq.push_back(static_cast<uint16_t>(size));
+    MB::utils::pushUint16(rawReq, static_cast<uint16_t>(dat.size()));
 
     rawReq.insert(rawReq.end(), dat.begin(), dat.end());
 
-    ::send(_sockfd, rawReq.begin().base(), rawReq.size(), 0);
+    io::sendAll(_sockfd, rawReq, _timeout);
 
     return rawReq;
 }
 
-std::vector<uint8_t> Connection::sendResponse(const MB::ModbusResponse &res) {
-    std::vector<uint8_t> rawReq;
-    rawReq.reserve(6);
-
-    rawReq.push_back(
-        static_cast<const uint8_t &&>(reinterpret_cast<const uint8_t *>(&_messageID)[1]));
-    rawReq.push_back(static_cast<uint8_t>(_messageID));
-    rawReq.push_back(0x00);
-    rawReq.push_back(0x00);
-
-    std::vector<uint8_t> dat = res.toRaw();
-
-    uint32_t size = dat.size();
-    rawReq.push_back(
-        static_cast<const uint16_t &&>(reinterpret_cast<const uint16_t *>(&size)[1]));
-    rawReq.push_back(static_cast<uint16_t>(size));
-
-    rawReq.insert(rawReq.end(), dat.begin(), dat.end());
+std::vector<uint8_t> Connection::receiveFrame(int timeout,
+                                              MB::utils::MBErrorCode onTimeout) {
+    return io::receiveFrame(_sockfd, _rxBuffer, MB::framing::mbapFrameLength, timeout,
+                            onTimeout);
+}
 
-    ::send(_sockfd, rawReq.begin().base(), rawReq.size(), 0);
+std::vector<uint8_t> Connection::sendRequest(const MB::ModbusRequest &req) {
+    // Each request has its own message ID, so that late response to the
+    // previous one is not taken for its response
+    _requestID     = _messageID++;
+    auto raw       = sendFrame(_requestID, req.toRaw());
+    _requestSlave  = req.slaveID();
+    _requestSentAt = std::chrono::steady_clock::now();
+    return raw;
+}
 
-    return rawReq;
+// Unit id 0 addresses the TCP device itself, so unlike on serial line its
+// requests are answered
+std::vector<uint8_t> Connection::sendResponse(const MB::ModbusResponse &res) {
+    return sendFrame(_messageID, res.toRaw());
 }
 
 std::vector<uint8_t> Connection::sendException(const MB::ModbusException &ex) {
-    std::vector<uint8_t> rawReq;
-    rawReq.reserve(6);
-
-    rawReq.push_back(
-        static_cast<const uint8_t &&>(reinterpret_cast<const uint8_t *>(&_messageID)[1]));
-    rawReq.push_back(static_cast<uint8_t>(_messageID));
-    rawReq.push_back(0x00);
-    rawReq.push_back(0x00);
-
-    std::vector<uint8_t> dat = ex.toRaw();
+    return sendFrame(_messageID, ex.toRaw());
+}
 
-    uint32_t size = dat.size();
-    rawReq.push_back(
-        static_cast<const uint16_t &&>(reinterpret_cast<const uint16_t *>(&size)[1]));
-    rawReq.push_back(static_cast<uint16_t>(size));
+namespace {
+MB::ModbusRequest broadcastOf(const MB::ModbusRequest &req) {
+    if (!MB::utils::isBroadcastable(req.functionCode()))
+        throw MB::ModbusException(MB::utils::IllegalFunction, MB::utils::BroadcastSlaveID,
+                                  req.functionCode());
 
-    rawReq.insert(rawReq.end(), dat.begin(), dat.end());
-
-    ::send(_sockfd, rawReq.begin().base(), rawReq.size(), 0);
+    auto broadcast = req;
+    broadcast.setSlaveId(MB::utils::BroadcastSlaveID);
+    return broadcast;
+}
+} // namespace
 
-    return rawReq;
+std::vector<uint8_t> Connection::sendBroadcast(const MB::ModbusRequest &req) {
+    return sendRequest(broadcastOf(req));
 }
 
 std::vector<uint8_t> Connection::awaitRawMessage() {
-    pollfd pfd;
-    pfd.fd      = this->_sockfd;
-    pfd.events  = POLLIN;
-    pfd.revents = POLLIN;
-    if (::poll(&pfd, 1, 60 * 1000 /* 1 minute means the connection has died */) <= 0) {
-        throw MB::ModbusException(MB::utils::ConnectionClosed);
-    }
-
-    std::vector<uint8_t> r(1024);
-
-    auto size = ::recv(_sockfd, r.begin().base(), r.size(), 0);
-
-    if (size == -1)
-        throw MB::ModbusException(MB::utils::ProtocolError);
-    else if (size == 0) {
-        throw MB::ModbusException(MB::utils::ConnectionClosed);
-    }
-
-    r.resize(size); // Set vector to proper shape
-    r.shrink_to_fit();
+    return receiveFrame(_requestTimeout, MB::utils::ConnectionClosed);
+}
 
-    return r;
+void Connection::sendRawMessage(const std::vector<uint8_t> &frame) {
+    io::sendAll(_sockfd, frame, _timeout);
 }
 
 MB::ModbusRequest Connection::awaitRequest() {
-    pollfd pfd;
-    pfd.fd      = this->_sockfd;
-    pfd.events  = POLLIN;
-    pfd.revents = POLLIN;
-    if (::poll(&pfd, 1, 60 * 1000 /* 1 minute means the connection has died */) <= 0) {
-        throw MB::ModbusException(MB::utils::Timeout);
-    }
-
-    std::vector<uint8_t> r(1024);
-
-    auto size = ::recv(_sockfd, r.begin().base(), r.size(), 0);
-
-    if (size == -1)
-        throw MB::ModbusException(MB::utils::ProtocolError);
-    else if (size == 0) {
-        throw MB::ModbusException(MB::utils::ConnectionClosed);
-    }
-
-    r.resize(size); // Set vector to proper shape
-    r.shrink_to_fit();
-
-    const auto resultMessageID = *reinterpret_cast<uint16_t *>(&r[0]);
+    auto r = receiveFrame(_requestTimeout, MB::utils::Timeout);
 
-    _messageID = resultMessageID;
+    _messageID = MB::utils::bigEndianConv(&r[0]);
 
     r.erase(r.begin(), r.begin() + 6);
 
@@ -151,32 +105,38 @@ MB::ModbusRequest Connection::awaitRequest() {
 }
 
 MB::ModbusResponse Connection::awaitResponse() {
-    pollfd pfd;
-    pfd.fd      = this->_sockfd;
-    pfd.events  = POLLIN;
-    pfd.revents = POLLIN;
-
-    if (::poll(&pfd, 1, this->_timeout) <= 0) {
-        throw MB::ModbusException(MB::utils::Timeout);
-    }
-
-    std::vector<uint8_t> r(1024);
-    auto size = ::recv(this->_sockfd, r.begin().base(), r.size(), 0);
-
-    if (size == -1)
-        throw MB::ModbusException(MB::utils::ProtocolError);
-    else if (size == 0) {
-        throw MB::ModbusException(MB::utils::ConnectionClosed);
+    auto timeout = std::chrono::milliseconds(_timeout);
+    if (_adaptiveTimeouts)
+        timeout = std::chrono::ceil<std::chrono::milliseconds>(
+            _adaptiveTimeouts->timeout(_requestSlave));
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true) {
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        std::vector<uint8_t> r;
+        try {
+            r = receiveFrame(static_cast<int>(std::max<int64_t>(remaining.count(), 0)),
+                             MB::utils::Timeout);
+        } catch (const MB::ModbusException &ex) {
+            if (_adaptiveTimeouts && ex.getErrorCode() == MB::utils::Timeout)
+                _adaptiveTimeouts->timedOut(_requestSlave);
+            throw;
+        }
+
+        // Late response to the previous request, that has timed out
+        if (MB::utils::bigEndianConv(&r[0]) != _requestID)
+            continue;
+
+        // Exception response is a response as well
+        if (_adaptiveTimeouts)
+            _adaptiveTimeouts->sample(_requestSlave,
+                                      std::chrono::steady_clock::now() - _requestSentAt);
+        return parseResponse(std::move(r));
     }
+}
 
-    r.resize(size); // Set vector to proper shape
-    r.shrink_to_fit();
-
-    const auto resultMessageID = *reinterpret_cast<uint16_t *>(&r[0]);
-
-    if (resultMessageID != this->_messageID)
-        throw MB::ModbusException(MB::utils::InvalidMessageID);
-
+MB::ModbusResponse Connection::parseResponse(std::vector<uint8_t> r) {
     r.erase(r.begin(), r.begin() + 6);
 
     if (MB::ModbusException::exist(r))
@@ -185,13 +145,89 @@ MB::ModbusResponse Connection::awaitResponse() {
     return MB::ModbusResponse::fromRaw(r);
 }
 
+std::vector<MB::ModbusResponse>
+Connection::pipelineRequests(const std::vector<MB::ModbusRequest> &requests,
+                             std::size_t window) {
+    if (window == 0)
+        window = 1;
+
+    const uint16_t firstID = _messageID;
+    // Up front, so that requests after failed pipeline do not reuse its IDs
+    _messageID = static_cast<uint16_t>(firstID + requests.size());
+    std::vector<std::optional<MB::ModbusResponse>> responses(requests.size());
+    std::vector<bool> completed(requests.size(), false);
+    std::optional<MB::ModbusException> error;
+    std::size_t sent     = 0;
+    std::size_t received = 0;
+
+    while (received < requests.size()) {
+        while (sent < requests.size() && sent - received < window) {
+            const auto &request = requests[sent];
+            if (request.isBroadcast()) {
+                // It is complete as soon as it is sent, with its own message ID,
+                // so that the answer of device that takes unit 0 as its own
+                // is not taken for the response to another request
+                sendFrame(static_cast<uint16_t>(firstID + sent),
+                          broadcastOf(request).toRaw());
+                responses[sent] = MB::ModbusResponse::from(request);
+                completed[sent] = true;
+                received++;
+            } else {
+                sendFrame(static_cast<uint16_t>(firstID + sent), request.toRaw());
+            }
+            sent++;
+        }
+
+        if (received == requests.size())
+            break;
+
+        auto r = receiveFrame(this->_timeout, MB::utils::Timeout);
+
+        // Message IDs wrap around, so offset is calculated modulo 2^16
+        const auto index =
+            static_cast<uint16_t>(MB::utils::bigEndianConv(&r[0]) - firstID);
+        // Late response to the request sent before, that has timed out
+        if (index >= sent || requests[index].isBroadcast())
+            continue;
+        if (completed[index])
+            throw MB::ModbusException(MB::utils::InvalidMessageID);
+
+        r.erase(r.begin(), r.begin() + 6);
+
+        if (MB::ModbusException::exist(r)) {
+            if (!error.has_value())
+                error = MB::ModbusException(r);
+        } else {
+            responses[index] = MB::ModbusResponse::fromRaw(r);
+        }
+        completed[index] = true;
+        received++;
+    }
+
+    if (error.has_value())
+        throw *error;
+
+    std::vector<MB::ModbusResponse> result;
+    result.reserve(responses.size());
+    for (auto &response : responses)
+        result.push_back(*response);
+    return result;
+}
+
 Connection::Connection(Connection &&moved) noexcept {
     if (_sockfd != -1 && moved._sockfd != _sockfd)
         ::close(_sockfd);
 
-    _sockfd       = moved._sockfd;
-    _messageID    = moved._messageID;
-    moved._sockfd = -1;
+    _sockfd           = moved._sockfd;
+    _messageID        = moved._messageID;
+    _requestID        = moved._requestID;
+    _timeout          = moved._timeout;
+    _requestTimeout   = moved._requestTimeout;
+    _requestSlave     = moved._requestSlave;
+    _requestSentAt    = moved._requestSentAt;
+    _rxBuffer         = std::move(moved._rxBuffer);
+    _adaptiveTimeouts = std::move(moved._adaptiveTimeouts);
+    moved._sockfd     = -1;
 }
 
 Connection Connection::with(std::string addr, int port) {
@@ -0,0 +1,134 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "TCP/gateway.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include <arpa/inet.h>
+
+using namespace MB::TCP;
+
+Gateway::~Gateway() {
+    std::vector<std::shared_ptr<Session>> sessions;
+    {
+        std::lock_guard lock{_mutex};
+        sessions = std::move(_sessions);
+    }
+
+    // Wakes sessions blocked on reading
+    for (const auto &session : sessions)
+        ::shutdown(session->connection.getSockfd(), SHUT_RDWR);
+    for (const auto &session : sessions)
+        session->thread.join();
+}
+
+void Gateway::serve(Connection &&connection, std::size_t share) {
+    std::lock_guard lock{_mutex};
+    reap();
+
+    auto session = std::make_shared<Session>(std::move(connection), _nextClient++);
+    if (share != 1)
+        _engine.setShare(session->client, share);
+    if (_rateLimiter) {
+        sockaddr_in peer{};
+        socklen_t length  = sizeof(peer);
+        const auto sockfd = session->connection.getSockfd();
+        if (::getpeername(sockfd, reinterpret_cast<sockaddr *>(&peer), &length) != 0)
+            peer.sin_addr.s_addr = INADDR_ANY;
+        session->limits = _rateLimiter->connect(ntohl(peer.sin_addr.s_addr));
+    }
+    session->thread = std::thread(&Gateway::run, this, session);
+    _sessions.push_back(std::move(session));
+}
+
+void Gateway::setRateLimiter(std::shared_ptr<MB::ModbusRateLimiter> limiter) {
+    std::lock_guard lock{_mutex};
+    _rateLimiter = std::move(limiter);
+}
+
+std::size_t Gateway::sessions() const {
+    std::lock_guard lock{_mutex};
+    return std::count_if(_sessions.begin(), _sessions.end(),
+                         [](const auto &session) { return !session->finished; });
+}
+
+void Gateway::reap() {
+    for (auto it = _sessions.begin(); it != _sessions.end();) {
+        if ((*it)->finished) {
+            (*it)->thread.join();
+            it = _sessions.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+bool Gateway::admit(Session &session, const std::vector<uint8_t> &frame) const {
+    std::optional<MB::ModbusRequest> request;
+    try {
+        request = MB::ModbusRequest::fromRaw(
+            std::vector<uint8_t>(frame.begin() + std::min<std::size_t>(6, frame.size()),
+                                 frame.end()));
+    } catch (const MB::ModbusException &) {
+        // Engine answers or rejects invalid requests
+        return true;
+    }
+
+    const auto delay = session.limits->acquire(*request);
+    if (delay) {
+        std::this_thread::sleep_for(*delay);
+        return true;
+    }
+
+    // Broadcast is never answered
+    if (_engine.broadcast() && request->isBroadcast())
+        return false;
+
+    const auto pdu = MB::ModbusException(MB::utils::SlaveDeviceBusy, request->slaveID(),
+                                         request->functionCode())
+                         .toRaw();
+    std::vector<uint8_t> response(frame.begin(), frame.begin() + 4);
+    MB::utils::pushUint16(response, static_cast<uint16_t>(pdu.size()));
+    response.insert(response.end(), pdu.begin(), pdu.end());
+
+    std::lock_guard lock{session.mutex};
+    session.connection.sendRawMessage(response);
+    return false;
+}
+
+void Gateway::run(const std::shared_ptr<Session> &session) {
+    // Responses that come after the session has finished are dropped
+    std::weak_ptr<Session> weak = session;
+    const auto reply            = [weak](std::vector<uint8_t> frame) {
+        const auto session = weak.lock();
+        if (!session)
+            return;
+
+        std::lock_guard lock{session->mutex};
+        if (session->finished)
+            return;
+        try {
+            session->connection.sendRawMessage(frame);
+        } catch (const std::exception &) {
+            // Reading side notices the closed connection
+        }
+    };
+
+    try {
+        while (true) {
+            auto frame = session->connection.awaitRawMessage();
+            if (session->limits && !admit(*session, frame))
+                continue;
+            _engine.handle(frame, reply, session->client);
+        }
+    } catch (const std::exception &) {
+        // Connection was closed, timed out, or sent invalid frame
+    }
+
+    _engine.removeClient(session->client);
+    std::lock_guard lock{session->mutex};
+    session->finished = true;
+}
@@ -0,0 +1,224 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "TCP/rtuOverTcp.hpp"
+#include "modbusFraming.hpp"
+#include "socketio.hpp"
+
+#include <chrono>
+#include <deque>
+#include <fcntl.h>
+#include <optional>
+
+using namespace MB::TCP;
+
+RtuOverTcp::RtuOverTcp(int sockfd) noexcept : _sockfd(sockfd) {
+    if (_sockfd != -1)
+        ::fcntl(_sockfd, F_SETFL, ::fcntl(_sockfd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+RtuOverTcp::RtuOverTcp(RtuOverTcp &&moved) noexcept
+    : _sockfd(moved._sockfd), _timeout(moved._timeout),
+      _rxBuffer(std::move(moved._rxBuffer)), _requestSlave(moved._requestSlave),
+      _requestFunction(moved._requestFunction) {
+    moved._sockfd = -1;
+}
+
+RtuOverTcp &RtuOverTcp::operator=(RtuOverTcp &&other) noexcept {
+    if (this == &other)
+        return *this;
+
+    if (_sockfd != -1 && _sockfd != other._sockfd)
+        ::close(_sockfd);
+
+    _sockfd          = other._sockfd;
+    _timeout         = other._timeout;
+    _rxBuffer        = std::move(other._rxBuffer);
+    _requestSlave    = other._requestSlave;
+    _requestFunction = other._requestFunction;
+    other._sockfd    = -1;
+
+    return *this;
+}
+
+RtuOverTcp::~RtuOverTcp() {
+    if (_sockfd == -1)
+        return;
+
+    ::close(_sockfd);
+    _sockfd = -1;
+}
+
+RtuOverTcp RtuOverTcp::with(std::string addr, int port) {
+    auto sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == -1)
+        throw std::runtime_error("Cannot open socket, errno = " + std::to_string(errno));
+
+    sockaddr_in server;
+    server.sin_family = AF_INET;
+    server.sin_port   = ::htons(port);
+    server.sin_addr   = {inet_addr(addr.c_str())};
+
+    if (::connect(sock, reinterpret_cast<struct sockaddr *>(&server), sizeof(server)) <
+        0) {
+        ::close(sock);
+        throw std::runtime_error("Cannot connect, errno = " + std::to_string(errno));
+    }
+
+    return RtuOverTcp(sock);
+}
+
+std::vector<uint8_t> RtuOverTcp::send(std::vector<uint8_t> data) {
+    const auto crc = MB::CRC::calculateCRC(data);
+
+    // CRC is sent low byte first
+    data.push_back(static_cast<uint8_t>(crc & 0xFF));
+    data.push_back(static_cast<uint8_t>(crc >> 8));
+
+    io::sendAll(_sockfd, data, _timeout);
+
+    return data;
+}
+
+std::vector<uint8_t> RtuOverTcp::sendRequest(const MB::ModbusRequest &req) {
+    auto raw         = send(req.toRaw());
+    _requestSlave    = req.slaveID();
+    _requestFunction = req.functionCode();
+    return raw;
+}
+
+std::vector<uint8_t> RtuOverTcp::sendResponse(const MB::ModbusResponse &res) {
+    // Broadcast is applied by the slave, but never answered
+    if (res.slaveID() == MB::utils::BroadcastSlaveID)
+        return {};
+
+    return send(res.toRaw());
+}
+
+std::vector<uint8_t> RtuOverTcp::sendException(const MB::ModbusException &ex) {
+    if (ex.slaveID() == MB::utils::BroadcastSlaveID)
+        return {};
+
+    return send(ex.toRaw());
+}
+
+std::vector<uint8_t> RtuOverTcp::sendBroadcast(const MB::ModbusRequest &req) {
+    if (!MB::utils::isBroadcastable(req.functionCode()))
+        throw MB::ModbusException(MB::utils::IllegalFunction, MB::utils::BroadcastSlaveID,
+                                  req.functionCode());
+
+    auto broadcast = req;
+    broadcast.setSlaveId(MB::utils::BroadcastSlaveID);
+
+    return send(broadcast.toRaw());
+}
+
+MB::ModbusRequest RtuOverTcp::awaitRequest() {
+    // 1 minute means the connection has died
+    const auto r = io::receiveFrame(_sockfd, _rxBuffer, MB::framing::rtuRequestLength,
+                                    60 * 1000, MB::utils::Timeout);
+
+    return MB::ModbusRequest::fromRawCRC(r);
+}
+
+namespace {
+// RTU has no transaction IDs, so response is recognized by its slave id and
+// function code
+bool answers(const std::vector<uint8_t> &frame, uint8_t slaveId, uint8_t functionCode) {
+    return frame[0] == slaveId && (frame[1] & 0b01111111) == functionCode;
+}
+} // namespace
+
+std::vector<uint8_t> RtuOverTcp::receiveResponse(io::Clock::time_point deadline) {
+    try {
+        return io::receiveFrame(_sockfd, _rxBuffer, MB::framing::rtuResponseLength,
+                                io::remaining(deadline), MB::utils::Timeout);
+    } catch (const MB::ModbusException &) {
+        // Part of the late response would be taken for the next one
+        _rxBuffer.clear();
+        throw;
+    }
+}
+
+MB::ModbusResponse RtuOverTcp::awaitResponse() {
+    const auto deadline = io::Clock::now() + std::chrono::milliseconds(_timeout);
+
+    while (true) {
+        const auto r = receiveResponse(deadline);
+        // Answer to another request, e.g. late one to the request that timed out
+        if (!answers(r, _requestSlave, _requestFunction))
+            continue;
+
+        if (MB::ModbusException::exist(r))
+            throw MB::ModbusException(r, true);
+
+        return MB::ModbusResponse::fromRawCRC(r);
+    }
+}
+
+std::vector<MB::ModbusResponse>
+RtuOverTcp::pipelineRequests(const std::vector<MB::ModbusRequest> &requests,
+                             std::size_t window) {
+    if (window == 0)
+        window = 1;
+
+    std::vector<std::optional<MB::ModbusResponse>> responses(requests.size());
+    std::optional<MB::ModbusException> error;
+    std::deque<std::size_t> inFlight;
+    std::size_t sent = 0;
+    auto deadline    = io::Clock::now();
+
+    // Responses left in flight would be taken for the responses to the next
+    // requests, so they are dropped on error
+    try {
+        while (sent < requests.size() || !inFlight.empty()) {
+            while (sent < requests.size() && inFlight.size() < window) {
+                const auto &request = requests[sent];
+                if (request.isBroadcast()) {
+                    // Nobody will answer, it is complete as soon as it is sent
+                    sendBroadcast(request);
+                    responses[sent] = MB::ModbusResponse::from(request);
+                } else {
+                    sendRequest(request);
+                    if (inFlight.empty())
+                        deadline = io::Clock::now() + std::chrono::milliseconds(_timeout);
+                    inFlight.push_back(sent);
+                }
+                sent++;
+            }
+
+            if (inFlight.empty())
+                break;
+
+            const auto r        = receiveResponse(deadline);
+            const auto &request = requests[inFlight.front()];
+
+            // Responses come in order, others are late ones to the requests sent
+            // before, that have timed out
+            if (!answers(r, request.slaveID(), request.functionCode()))
+                continue;
+
+            if (MB::ModbusException::exist(r)) {
+                if (!error.has_value())
+                    error = MB::ModbusException(r, true);
+            } else {
+                responses[inFlight.front()] = MB::ModbusResponse::fromRawCRC(r);
+            }
+            inFlight.pop_front();
+            deadline = io::Clock::now() + std::chrono::milliseconds(_timeout);
+        }
+    } catch (...) {
+        _rxBuffer.clear();
+        throw;
+    }
+
+    if (error.has_value())
+        throw *error;
+
+    std::vector<MB::ModbusResponse> result;
+    result.reserve(responses.size());
+    for (auto &response : responses)
+        result.push_back(*response);
+    return result;
+}
@@ -26,6 +26,13 @@ Server::Server(int port) {
                sizeof(_server)) < 0)
         throw std::runtime_error("Cannot bind socket");
 
+    // Port chosen by the system
+    socklen_t length = sizeof(_server);
+    if (_port == 0 &&
+        ::getsockname(_serverfd, reinterpret_cast<struct sockaddr *>(&_server),
+                      &length) == 0)
+        _port = ::ntohs(_server.sin_port);
+
     ::listen(_serverfd, 255);
 }
 
@@ -0,0 +1,120 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Socket helpers shared by the TCP transports, they work with both blocking
+// and non-blocking sockets
+
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "MB/modbusException.hpp"
+
+namespace MB::TCP::io {
+using Clock = std::chrono::steady_clock;
+
+//! Milliseconds left until deadline, suitable for `poll`
+inline int remaining(Clock::time_point deadline) {
+    const auto left =
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+    return left.count() > 0 ? static_cast<int>(left.count()) : 0;
+}
+
+/**
+ * @brief Waits for bytes until deadline and appends them to the buffer
+ * @throws ModbusException - `onTimeout` error code, ConnectionClosed or
+ * ProtocolError
+ */
+inline void receiveSome(int sockfd, std::vector<uint8_t> &buffer,
+                        Clock::time_point deadline, MB::utils::MBErrorCode onTimeout) {
+    pollfd pfd;
+    pfd.fd      = sockfd;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+
+    if (::poll(&pfd, 1, remaining(deadline)) <= 0)
+        throw MB::ModbusException(onTimeout);
+
+    std::array<uint8_t, 1024> chunk;
+    const auto size = ::recv(sockfd, chunk.data(), chunk.size(), 0);
+
+    if (size == -1) {
+        // Spurious wakeup of non-blocking socket
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return;
+        throw MB::ModbusException(MB::utils::ProtocolError);
+    } else if (size == 0) {
+        throw MB::ModbusException(MB::utils::ConnectionClosed);
+    }
+
+    buffer.insert(buffer.end(), chunk.begin(), chunk.begin() + size);
+}
+
+/**
+ * @brief Cuts single frame from the front of the buffer, receiving more bytes
+ * when needed. Bytes that follow the frame are kept for the next call, so
+ * frames split over many segments and many frames in one segment both work.
+ * @param length - One of `MB::framing` length functions
+ * @throws ModbusException - InvalidByteOrder if stream is not a valid frame
+ */
+template <typename LengthFunction>
+std::vector<uint8_t> receiveFrame(int sockfd, std::vector<uint8_t> &buffer,
+                                  LengthFunction length, int timeout,
+                                  MB::utils::MBErrorCode onTimeout) {
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeout);
+
+    while (true) {
+        const std::optional<std::size_t> needed = length(buffer.data(), buffer.size());
+        if (!needed.has_value()) {
+            // Stream cannot be resynchronized, drop everything that was received
+            buffer.clear();
+            throw MB::ModbusException(MB::utils::InvalidByteOrder);
+        }
+
+        if (*needed <= buffer.size()) {
+            std::vector<uint8_t> frame(buffer.begin(), buffer.begin() + *needed);
+            buffer.erase(buffer.begin(), buffer.begin() + *needed);
+            return frame;
+        }
+
+        receiveSome(sockfd, buffer, deadline, onTimeout);
+    }
+}
+
+/**
+ * @brief Sends all bytes, waiting for the socket to become writable if needed
+ * @throws ModbusException - ConnectionClosed if bytes cannot be sent
+ */
+inline void sendAll(int sockfd, const std::vector<uint8_t> &data, int timeout) {
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeout);
+    std::size_t sent    = 0;
+
+    while (sent < data.size()) {
+        const auto size =
+            ::send(sockfd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (size >= 0) {
+            sent += static_cast<std::size_t>(size);
+            continue;
+        }
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            throw MB::ModbusException(MB::utils::ConnectionClosed);
+
+        pollfd pfd;
+        pfd.fd      = sockfd;
+        pfd.events  = POLLOUT;
+        pfd.revents = 0;
+        if (::poll(&pfd, 1, remaining(deadline)) <= 0)
+            throw MB::ModbusException(MB::utils::Timeout);
+    }
+}
+} // namespace MB::TCP::io
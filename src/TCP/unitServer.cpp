@@ -0,0 +1,289 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "TCP/unitServer.hpp"
+#include "MB/modbusFraming.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace MB::TCP;
+
+namespace {
+bool setNonBlocking(int fd) {
+    const auto flags = ::fcntl(fd, F_GETFL, 0);
+    return flags != -1 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+} // namespace
+
+UnitServer::Completed::~Completed() {
+    for (const auto fd : wakeFds) {
+        if (fd != -1)
+            ::close(fd);
+    }
+}
+
+void UnitServer::Completed::wake() const {
+    const uint8_t byte = 0;
+    utils::ignore_result(::write(wakeFds[1], &byte, 1));
+}
+
+UnitServer::UnitServer(MB::ModbusUnitServer &engine, int port)
+    : _engine(engine), _server(port) {
+    if (::pipe(_completed->wakeFds) != 0)
+        throw std::runtime_error("Cannot create pipe");
+    if (!setNonBlocking(_completed->wakeFds[0]) ||
+        !setNonBlocking(_completed->wakeFds[1]) ||
+        !setNonBlocking(_server.nativeHandle()))
+        throw std::runtime_error("Cannot set up sockets");
+}
+
+UnitServer::~UnitServer() {
+    for (const auto &client : _clients)
+        ::close(client.sockfd);
+}
+
+void UnitServer::stop() {
+    _stop = true;
+    _completed->wake();
+}
+
+void UnitServer::run() {
+    _stop = false;
+    while (!_stop) {
+        // Wakes up now and then to close idle connections
+        const auto timeout =
+            std::chrono::duration_cast<std::chrono::milliseconds>(_idleTimeout);
+        poll(static_cast<int>(std::clamp<int64_t>(timeout.count(), 1, 1000)));
+    }
+}
+
+std::size_t UnitServer::poll(int timeout) {
+    _loopThread = std::this_thread::get_id();
+
+    std::vector<pollfd> fds;
+    fds.reserve(2 + _clients.size());
+    fds.push_back({_completed->wakeFds[0], POLLIN, 0});
+    fds.push_back({_server.nativeHandle(), POLLIN, 0});
+    const auto start = Clock::now();
+    for (const auto &client : _clients) {
+        short events = client.tx.empty() ? 0 : POLLOUT;
+        if (client.tx.size() < MaxPendingResponses && !client.deferred)
+            events |= POLLIN;
+        fds.push_back({client.sockfd, events, 0});
+
+        // Wakes up for deferred requests
+        if (client.deferred) {
+            const auto wait =
+                std::chrono::ceil<std::chrono::milliseconds>(client.resumeAt - start);
+            const auto resume = static_cast<int>(std::max<int64_t>(wait.count(), 0));
+            if (timeout < 0 || resume < timeout)
+                timeout = resume;
+        }
+    }
+
+    if (::poll(fds.data(), fds.size(), timeout) < 0)
+        return 0;
+
+    if (fds[0].revents & POLLIN) {
+        std::array<uint8_t, 64> drain;
+        while (::read(_completed->wakeFds[0], drain.data(), drain.size()) > 0)
+            ;
+        deliver();
+    }
+
+    const auto before = _requests.load();
+    const auto now    = Clock::now();
+    // Clients accepted below are not in `fds` yet
+    const auto polled = _clients.size();
+    for (std::size_t i = 0; i < polled; i++) {
+        auto &client       = _clients[i];
+        const auto revents = fds[i + 2].revents;
+        if (client.deferred && (revents & (POLLHUP | POLLERR)))
+            client.closed = true;
+        if (!client.closed && client.deferred && client.resumeAt <= now)
+            process(client);
+        if (!client.closed && (revents & (POLLIN | POLLHUP | POLLERR)))
+            receive(client);
+        if (!client.closed && !client.tx.empty())
+            send(client);
+        if (now - client.lastRequest > _idleTimeout)
+            client.closed = true;
+    }
+
+    if (fds[1].revents & POLLIN)
+        accept();
+
+    const auto closed =
+        std::remove_if(_clients.begin(), _clients.end(),
+                       [](const Client &client) { return client.closed; });
+    for (auto it = closed; it != _clients.end(); it++)
+        ::close(it->sockfd);
+    _clients.erase(closed, _clients.end());
+    _count = _clients.size();
+
+    return _requests - before;
+}
+
+void UnitServer::accept() {
+    while (true) {
+        sockaddr_in peer{};
+        socklen_t length  = sizeof(peer);
+        const auto sockfd = ::accept(_server.nativeHandle(),
+                                     reinterpret_cast<sockaddr *>(&peer), &length);
+        if (sockfd < 0)
+            return;
+        if (!setNonBlocking(sockfd)) {
+            ::close(sockfd);
+            continue;
+        }
+
+        Client client{_nextClient++, sockfd, {}, {}, Clock::now()};
+        if (_rateLimiter)
+            client.limits = _rateLimiter->connect(ntohl(peer.sin_addr.s_addr));
+        _clients.push_back(std::move(client));
+    }
+}
+
+void UnitServer::receive(Client &client) {
+    std::array<uint8_t, 4096> chunk;
+    while (client.tx.size() < MaxPendingResponses && !client.deferred) {
+        const auto size = ::recv(client.sockfd, chunk.data(), chunk.size(), 0);
+        if (size == 0 || (size < 0 && !wouldBlock())) {
+            client.closed = true;
+            return;
+        }
+        if (size < 0)
+            break;
+        client.rx.insert(client.rx.end(), chunk.begin(), chunk.begin() + size);
+
+        process(client);
+        if (client.closed)
+            return;
+    }
+}
+
+void UnitServer::process(Client &client) {
+    // Answers complete frames, the rest waits for more bytes
+    std::size_t offset = 0;
+    while (true) {
+        const auto length = MB::framing::mbapFrameLength(client.rx.data() + offset,
+                                                         client.rx.size() - offset);
+        if (!length) {
+            client.closed = true;
+            return;
+        }
+        if (*length > client.rx.size() - offset)
+            break;
+
+        const std::vector<uint8_t> frame(client.rx.begin() + offset,
+                                         client.rx.begin() + offset + *length);
+        if (!admit(client, frame)) {
+            if (client.deferred)
+                break;
+            offset += *length;
+            continue;
+        }
+        offset += *length;
+
+        try {
+            _engine.dispatch(frame, [&client, completed = _completed, id = client.id,
+                                     loop = _loopThread](auto response) {
+                if (!response)
+                    return;
+                // Inline units complete within this call, workers later
+                if (std::this_thread::get_id() == loop) {
+                    client.tx.insert(client.tx.end(), response->begin(),
+                                     response->end());
+                    return;
+                }
+                {
+                    std::lock_guard lock{completed->mutex};
+                    completed->responses.emplace_back(id, std::move(*response));
+                }
+                completed->wake();
+            });
+        } catch (const MB::ModbusException &) {
+            client.closed = true;
+            return;
+        }
+        client.lastRequest = Clock::now();
+        _requests++;
+    }
+    client.rx.erase(client.rx.begin(), client.rx.begin() + offset);
+}
+
+bool UnitServer::admit(Client &client, const std::vector<uint8_t> &frame) {
+    // Tokens of deferred request were taken already
+    if (!client.limits || client.deferred) {
+        client.deferred = false;
+        return true;
+    }
+
+    std::optional<MB::ModbusRequest> request;
+    try {
+        request = MB::ModbusRequest::fromRaw(
+            std::vector<uint8_t>(frame.begin() + 6, frame.end()));
+    } catch (const MB::ModbusException &) {
+        // Engine answers or rejects invalid requests
+        return true;
+    }
+
+    const auto delay = client.limits->acquire(*request);
+    if (delay == Clock::duration::zero())
+        return true;
+    if (delay) {
+        client.deferred = true;
+        client.resumeAt = Clock::now() + *delay;
+        return false;
+    }
+
+    // Broadcast is never answered
+    if (_engine.broadcast() && request->isBroadcast())
+        return false;
+
+    const auto pdu = MB::ModbusException(MB::utils::SlaveDeviceBusy, request->slaveID(),
+                                         request->functionCode())
+                         .toRaw();
+    client.tx.insert(client.tx.end(), frame.begin(), frame.begin() + 4);
+    MB::utils::pushUint16(client.tx, static_cast<uint16_t>(pdu.size()));
+    client.tx.insert(client.tx.end(), pdu.begin(), pdu.end());
+    return false;
+}
+
+void UnitServer::deliver() {
+    std::vector<std::pair<uint64_t, std::vector<uint8_t>>> responses;
+    {
+        std::lock_guard lock{_completed->mutex};
+        responses.swap(_completed->responses);
+    }
+
+    for (auto &[id, response] : responses) {
+        // Client may have disconnected in the meantime
+        const auto client =
+            std::find_if(_clients.begin(), _clients.end(),
+                         [id = id](const Client &client) { return client.id == id; });
+        if (client != _clients.end())
+            client->tx.insert(client->tx.end(), response.begin(), response.end());
+    }
+}
+
+void UnitServer::send(Client &client) {
+    const auto size =
+        ::send(client.sockfd, client.tx.data(), client.tx.size(), MSG_NOSIGNAL);
+    if (size < 0) {
+        client.closed = !wouldBlock();
+        return;
+    }
+    client.tx.erase(client.tx.begin(), client.tx.begin() + size);
+}
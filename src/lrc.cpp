@@ -0,0 +1,11 @@
+#include "MB/lrc.hpp"
+
+uint8_t MB::LRC::calculateLRC(const uint8_t *buff, std::size_t len) {
+    uint8_t sum = 0;
+
+    while (len--)
+        sum += *buff++;
+
+    // Two's complement, so that sum of the data and LRC is zero
+    return static_cast<uint8_t>(-sum);
+}
@@ -0,0 +1,83 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusAccessMap.hpp"
+#include "modbusException.hpp"
+
+#include <stdexcept>
+
+using namespace MB;
+
+ModbusAccessMap::ModbusAccessMap() : _bitmaps(4 * 3, Bitmap{}) {}
+
+void ModbusAccessMap::map(utils::MBFunctionRegisters table, uint16_t address,
+                          std::size_t count, Access access) {
+    if (address + count > 0x10000)
+        throw std::invalid_argument("Invalid mapped range");
+
+    auto &readable = _bitmaps[table * 3 + Readable];
+    auto &writable = _bitmaps[table * 3 + Writable];
+    auto &mapped   = _bitmaps[table * 3 + Mapped];
+    for (std::size_t i = address; i < address + count; i++) {
+        const auto bit  = uint64_t(1) << (i % 64);
+        const auto word = i / 64;
+        readable[word]  = access & Read ? readable[word] | bit : readable[word] & ~bit;
+        writable[word]  = access & Write ? writable[word] | bit : writable[word] & ~bit;
+        mapped[word]    = access != None ? mapped[word] | bit : mapped[word] & ~bit;
+    }
+}
+
+bool ModbusAccessMap::allSet(utils::MBFunctionRegisters table, Kind kind,
+                             uint16_t address, std::size_t count) const noexcept {
+    if (count == 0)
+        return true;
+    if (address + count > 0x10000)
+        return false;
+
+    const auto &bits       = bitmap(table, kind);
+    const std::size_t last = address + count - 1;
+    std::size_t word       = address / 64;
+    const auto lastWord    = last / 64;
+    const auto head        = ~uint64_t(0) << (address % 64);
+    const auto tail        = ~uint64_t(0) >> (63 - last % 64);
+
+    if (word == lastWord)
+        return (bits[word] & (head & tail)) == (head & tail);
+    if ((bits[word] & head) != head)
+        return false;
+    for (word++; word < lastWord; word++) {
+        if (bits[word] != ~uint64_t(0))
+            return false;
+    }
+    return (bits[lastWord] & tail) == tail;
+}
+
+bool ModbusAccessMap::allows(const ModbusRequest &request) const {
+    const auto code    = request.functionCode();
+    const auto address = request.registerAddress();
+    switch (utils::functionType(code)) {
+    case utils::Read:
+        return readable(utils::functionRegister(code), address,
+                        request.numberOfRegisters());
+    case utils::WriteSingle:
+    // Device reads the register to mask it, but master does not see it
+    case utils::MaskWrite:
+        return writable(utils::functionRegister(code), address, 1);
+    case utils::WriteMultiple:
+        return writable(utils::functionRegister(code), address,
+                        request.numberOfRegisters());
+    case utils::ReadWrite:
+        return readable(utils::HoldingRegisters, address, request.numberOfRegisters()) &&
+               writable(utils::HoldingRegisters, request.writeRegisterAddress(),
+                        request.registerValues().size());
+    default:
+        return true;
+    }
+}
+
+void ModbusAccessMap::check(const ModbusRequest &request) const {
+    if (!allows(request))
+        throw ModbusException(utils::IllegalDataAddress, request.slaveID(),
+                              request.functionCode());
+}
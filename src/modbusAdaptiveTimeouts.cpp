@@ -0,0 +1,81 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusAdaptiveTimeouts.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace MB;
+
+ModbusAdaptiveTimeouts::ModbusAdaptiveTimeouts() : ModbusAdaptiveTimeouts(Settings()) {}
+
+ModbusAdaptiveTimeouts::ModbusAdaptiveTimeouts(Settings settings) : _settings(settings) {
+    if (settings.minimum <= Clock::duration::zero() ||
+        settings.minimum > settings.maximum)
+        throw std::invalid_argument("Invalid timeout limits");
+}
+
+ModbusAdaptiveTimeouts::Clock::duration
+ModbusAdaptiveTimeouts::clamp(Clock::duration timeout) const {
+    return std::clamp(timeout, _settings.minimum, _settings.maximum);
+}
+
+ModbusAdaptiveTimeouts::Clock::duration
+ModbusAdaptiveTimeouts::timeout(uint8_t slaveId) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto device = _devices.find(slaveId);
+    if (device == _devices.end())
+        return clamp(_settings.initial);
+    return device->second.timeout;
+}
+
+void ModbusAdaptiveTimeouts::sample(uint8_t slaveId, Clock::duration rtt) {
+    if (rtt < Clock::duration::zero())
+        rtt = Clock::duration::zero();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto &device = _devices[slaveId];
+    if (device.samples == 0) {
+        device.smoothed = rtt;
+        device.variance = rtt / 2;
+    } else {
+        const auto error = device.smoothed > rtt ? device.smoothed - rtt
+                                                 : rtt - device.smoothed;
+        device.variance  = (device.variance * 3 + error) / 4;
+        device.smoothed  = (device.smoothed * 7 + rtt) / 8;
+    }
+    device.samples++;
+    device.timeout = clamp(device.smoothed + device.variance * 4);
+}
+
+void ModbusAdaptiveTimeouts::timedOut(uint8_t slaveId) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto device = _devices.find(slaveId);
+    if (device == _devices.end()) {
+        // Nothing is known, the initial timeout is already the safe one
+        Estimate estimate;
+        estimate.timeout  = clamp(_settings.initial);
+        estimate.timeouts = 1;
+        _devices.emplace(slaveId, estimate);
+        return;
+    }
+
+    device->second.timeouts++;
+    device->second.timeout = clamp(device->second.timeout * 2);
+}
+
+void ModbusAdaptiveTimeouts::reset(uint8_t slaveId) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _devices.erase(slaveId);
+}
+
+std::optional<ModbusAdaptiveTimeouts::Estimate>
+ModbusAdaptiveTimeouts::estimate(uint8_t slaveId) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto device = _devices.find(slaveId);
+    if (device == _devices.end())
+        return std::nullopt;
+    return device->second;
+}
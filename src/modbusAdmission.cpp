@@ -0,0 +1,46 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusAdmission.hpp"
+
+#include <stdexcept>
+
+using namespace MB;
+
+ModbusAdmission::ModbusAdmission() : ModbusAdmission(Settings()) {}
+
+ModbusAdmission::ModbusAdmission(Settings settings) { setSettings(settings); }
+
+void ModbusAdmission::setSettings(Settings settings) {
+    if (settings.maxWait < Clock::duration::zero())
+        throw std::invalid_argument("Invalid admission settings");
+    _settings = settings;
+}
+
+bool ModbusAdmission::admit(std::size_t queued) {
+    if (_settings.maxQueueDepth != 0 && queued >= _settings.maxQueueDepth) {
+        _metrics.shed++;
+        return false;
+    }
+    if (_settings.maxWait != Clock::duration::zero() &&
+        estimatedWait(queued) > _settings.maxWait) {
+        _metrics.shed++;
+        _metrics.shedByWait++;
+        return false;
+    }
+
+    _metrics.admitted++;
+    return true;
+}
+
+void ModbusAdmission::served(Clock::duration serviceTime) {
+    auto &smoothed = _metrics.serviceTime;
+    smoothed       = _sampled ? smoothed - smoothed / 8 + serviceTime / 8 : serviceTime;
+    _sampled       = true;
+}
+
+ModbusAdmission::Clock::duration
+ModbusAdmission::estimatedWait(std::size_t queued) const noexcept {
+    return _metrics.serviceTime * static_cast<Clock::rep>(queued);
+}
@@ -0,0 +1,101 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusAscii.hpp"
+#include "lrc.hpp"
+#include "modbusException.hpp"
+
+#include <array>
+
+using namespace MB;
+
+namespace {
+// Both characters of every byte, so that each byte is a single lookup
+constexpr std::array<std::array<char, 2>, 256> makeEncodeTable() {
+    constexpr char digits[] = "0123456789ABCDEF";
+    std::array<std::array<char, 2>, 256> table{};
+    for (int n = 0; n < 256; n++)
+        table[n] = {digits[n >> 4], digits[n & 0x0F]};
+    return table;
+}
+
+// Value of the hex digit, or Invalid
+constexpr uint8_t Invalid = 0xF0;
+
+constexpr std::array<uint8_t, 256> makeDecodeTable() {
+    std::array<uint8_t, 256> table{};
+    for (int n = 0; n < 256; n++)
+        table[n] = Invalid;
+    for (int n = 0; n < 10; n++)
+        table['0' + n] = static_cast<uint8_t>(n);
+    for (int n = 0; n < 6; n++) {
+        table['A' + n] = static_cast<uint8_t>(10 + n);
+        table['a' + n] = static_cast<uint8_t>(10 + n);
+    }
+    return table;
+}
+
+constexpr auto encodeTable = makeEncodeTable();
+constexpr auto decodeTable = makeDecodeTable();
+
+// ':', slave id, function code, LRC, CR LF
+constexpr std::size_t MinFrameSize = 1 + 2 * 3 + 2;
+} // namespace
+
+void ascii::encodeHex(const uint8_t *data, std::size_t size, char *out) noexcept {
+    for (std::size_t i = 0; i < size; i++) {
+        const auto &pair = encodeTable[data[i]];
+        out[2 * i]       = pair[0];
+        out[2 * i + 1]   = pair[1];
+    }
+}
+
+bool ascii::decodeHex(const char *hex, std::size_t size, uint8_t *out) noexcept {
+    if (size % 2 != 0)
+        return false;
+
+    // Invalid digits are collected and checked once, so the loop has no branches
+    uint8_t invalid = 0;
+    for (std::size_t i = 0; i < size / 2; i++) {
+        const auto high = decodeTable[static_cast<uint8_t>(hex[2 * i])];
+        const auto low  = decodeTable[static_cast<uint8_t>(hex[2 * i + 1])];
+        invalid |= high | low;
+        out[i] = static_cast<uint8_t>((high << 4) | (low & 0x0F));
+    }
+
+    return (invalid & Invalid) == 0;
+}
+
+std::vector<uint8_t> ascii::encodeFrame(const std::vector<uint8_t> &raw) {
+    std::vector<uint8_t> frame(1 + 2 * (raw.size() + 1) + 2);
+    auto *text = reinterpret_cast<char *>(frame.data());
+
+    const uint8_t lrc = LRC::calculateLRC(raw);
+
+    text[0] = ':';
+    encodeHex(raw.data(), raw.size(), text + 1);
+    encodeHex(&lrc, 1, text + 1 + 2 * raw.size());
+    frame[frame.size() - 2] = '\r';
+    frame[frame.size() - 1] = '\n';
+
+    return frame;
+}
+
+std::vector<uint8_t> ascii::decodeFrame(const uint8_t *frame, std::size_t size) {
+    if (size < MinFrameSize || frame[0] != ':' || frame[size - 2] != '\r' ||
+        frame[size - 1] != '\n')
+        throw ModbusException(utils::InvalidByteOrder);
+
+    const auto hexSize = size - 3;
+    std::vector<uint8_t> raw(hexSize / 2);
+    if (!decodeHex(reinterpret_cast<const char *>(frame + 1), hexSize, raw.data()))
+        throw ModbusException(utils::InvalidByteOrder);
+
+    // Sum of data and LRC is zero
+    if (LRC::calculateLRC(raw) != 0)
+        throw ModbusException(utils::InvalidCRC, raw[0]);
+
+    raw.pop_back();
+    return raw;
+}
@@ -0,0 +1,161 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusChangeDetector.hpp"
+#include "modbusException.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+using namespace MB;
+
+namespace {
+// Value of one or two registers, the high word first
+double decode(const uint16_t *values, uint16_t count, bool isSigned) {
+    if (count == 1) {
+        return isSigned ? static_cast<double>(static_cast<int16_t>(values[0]))
+                        : static_cast<double>(values[0]);
+    }
+
+    const uint32_t value = (static_cast<uint32_t>(values[0]) << 16) | values[1];
+    return isSigned ? static_cast<double>(static_cast<int32_t>(value))
+                    : static_cast<double>(value);
+}
+} // namespace
+
+ModbusChangeDetector::ModbusChangeDetector(const ModbusPollPlan &plan)
+    : _tags(plan.tags()) {
+    for (const auto &request : plan.requests()) {
+        const auto size   = request.numberOfRegisters();
+        const auto chunks = (size + ChunkRegisters - 1) / ChunkRegisters;
+        const auto table  = utils::functionRegister(request.functionCode());
+
+        Block block;
+        block.image.resize(size);
+        block.scratch.resize(size);
+        block.changed.resize(chunks);
+        block.coils = table == utils::OutputCoils || table == utils::InputContacts;
+        _blocks.push_back(std::move(block));
+    }
+
+    for (std::size_t tag = 0; tag < _tags.size(); tag++) {
+        _placements.push_back(plan.placement(tag));
+        _blocks[_placements.back().request].tags.push_back(tag);
+    }
+}
+
+void ModbusChangeDetector::setDeadband(std::size_t tag, ModbusDeadband deadband) {
+    if (tag >= _tags.size() || _tags[tag].count > 2 || deadband.value < 0 ||
+        _blocks[_placements[tag].request].coils)
+        throw std::invalid_argument("Deadband is valid only for analog tags");
+    _deadbands[tag] = deadband;
+    _reported.erase(tag);
+}
+
+ModbusChangeDetector::SubscriberId
+ModbusChangeDetector::subscribe(Subscriber subscriber) {
+    const auto id = _nextSubscriber++;
+    _subscribers.emplace(id, std::move(subscriber));
+    return id;
+}
+
+bool ModbusChangeDetector::unsubscribe(SubscriberId id) {
+    return _subscribers.erase(id) != 0;
+}
+
+bool ModbusChangeDetector::exceedsDeadband(std::size_t tag, double value) const {
+    const auto reported = _reported.find(tag);
+    if (reported == _reported.end())
+        return true;
+
+    const auto &deadband = _deadbands.at(tag);
+    const auto change    = std::fabs(value - reported->second);
+    if (deadband.type == ModbusDeadband::Absolute)
+        return change > deadband.value;
+    return change > std::fabs(reported->second) * deadband.value / 100;
+}
+
+std::vector<std::size_t>
+ModbusChangeDetector::update(const std::vector<ModbusResponse> &responses) {
+    if (responses.size() != _blocks.size())
+        throw ModbusException(utils::NumberOfValuesInvalid);
+    // Coils may be padded to the whole byte, so there may be more values
+    for (std::size_t i = 0; i < _blocks.size(); i++) {
+        if (responses[i].registerValues().size() < _blocks[i].image.size())
+            throw ModbusException(utils::NumberOfValuesInvalid);
+    }
+
+    std::vector<std::size_t> changed;
+    for (std::size_t i = 0; i < _blocks.size(); i++) {
+        auto &block        = _blocks[i];
+        const auto &values = responses[i].registerValues();
+        const auto size    = block.image.size();
+
+        for (std::size_t j = 0; j < size; j++)
+            block.scratch[j] = block.coils ? values[j].coil() : values[j].reg();
+
+        for (std::size_t chunk = 0; chunk < block.changed.size(); chunk++) {
+            const auto first = chunk * ChunkRegisters;
+            const auto count = std::min(ChunkRegisters, size - first);
+            block.changed[chunk] =
+                !_initialized || std::memcmp(&block.image[first], &block.scratch[first],
+                                             count * sizeof(uint16_t)) != 0;
+        }
+
+        for (const auto tag : block.tags) {
+            const auto offset = _placements[tag].offset;
+            const auto count  = _tags[tag].count;
+            // Only chunks covering the tag are checked
+            const auto first = block.changed.begin() + offset / ChunkRegisters;
+            const auto last =
+                block.changed.begin() + (offset + count - 1) / ChunkRegisters + 1;
+            if (std::find(first, last, 1) == last)
+                continue;
+            if (_initialized && std::memcmp(&block.image[offset], &block.scratch[offset],
+                                            count * sizeof(uint16_t)) == 0)
+                continue;
+
+            const auto deadband = _deadbands.find(tag);
+            if (deadband != _deadbands.end()) {
+                const auto value =
+                    decode(&block.scratch[offset], count, deadband->second.isSigned);
+                if (!exceedsDeadband(tag, value))
+                    continue;
+                _reported[tag] = value;
+            }
+            changed.push_back(tag);
+        }
+
+        std::swap(block.image, block.scratch);
+    }
+    _initialized = true;
+
+    std::sort(changed.begin(), changed.end());
+    if (!_subscribers.empty()) {
+        for (const auto tag : changed) {
+            const auto &block = _blocks[_placements[tag].request];
+            const auto first  = block.image.begin() + _placements[tag].offset;
+
+            std::vector<ModbusCell> values;
+            values.reserve(_tags[tag].count);
+            std::for_each(first, first + _tags[tag].count, [&](uint16_t value) {
+                values.push_back(block.coils ? ModbusCell::initCoil(value != 0)
+                                             : ModbusCell::initReg(value));
+            });
+
+            for (const auto &[id, subscriber] : _subscribers)
+                subscriber(tag, values);
+        }
+    }
+
+    return changed;
+}
+
+void ModbusChangeDetector::reset() noexcept {
+    _initialized = false;
+    _reported.clear();
+}
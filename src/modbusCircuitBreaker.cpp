@@ -0,0 +1,171 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusCircuitBreaker.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace MB;
+
+ModbusCircuitBreaker::ModbusCircuitBreaker() : ModbusCircuitBreaker(Settings()) {}
+
+ModbusCircuitBreaker::ModbusCircuitBreaker(Settings settings, uint32_t seed)
+    : _settings(settings), _random(seed) {
+    if (settings.offlineAfter == 0 ||
+        settings.initialBackoff <= Clock::duration::zero() ||
+        settings.initialBackoff > settings.maximumBackoff || settings.jitter < 0 ||
+        settings.jitter > 1)
+        throw std::invalid_argument("Invalid circuit breaker settings");
+}
+
+void ModbusCircuitBreaker::scheduleProbe(Device &device, Clock::time_point now) {
+    auto backoff = _settings.initialBackoff;
+    for (std::size_t i = 0; i < device.probes && backoff < _settings.maximumBackoff; i++)
+        backoff *= 2;
+    backoff = std::min(backoff, _settings.maximumBackoff);
+
+    if (_settings.jitter > 0) {
+        std::uniform_real_distribution<double> spread(-_settings.jitter,
+                                                      _settings.jitter);
+        backoff += std::chrono::duration_cast<Clock::duration>(backoff * spread(_random));
+    }
+
+    device.probing   = false;
+    device.nextProbe = now + backoff;
+}
+
+void ModbusCircuitBreaker::notify(uint8_t slaveId, State state) const {
+    Listener listener;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        listener = _listener;
+    }
+    if (listener)
+        listener(slaveId, state);
+}
+
+bool ModbusCircuitBreaker::allow(uint8_t slaveId, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto found = _devices.find(slaveId);
+    if (found == _devices.end() || found->second.state != State::Offline)
+        return true;
+
+    auto &device = found->second;
+    // Probe which outcome was never recorded does not block the device forever
+    const auto due = device.probing ? device.nextProbe + _settings.maximumBackoff
+                                    : device.nextProbe;
+    if (now >= due) {
+        device.probing = true;
+        _metrics.probes++;
+        return true;
+    }
+
+    device.rejected++;
+    device.reclaimed += device.cost;
+    _metrics.rejected++;
+    _metrics.reclaimed += device.cost;
+    return false;
+}
+
+void ModbusCircuitBreaker::success(uint8_t slaveId) {
+    std::optional<State> changed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto found = _devices.find(slaveId);
+        if (found == _devices.end())
+            return;
+
+        auto &device    = found->second;
+        device.failures = 0;
+        if (device.state == State::Healthy)
+            return;
+        if (device.state == State::Offline)
+            _metrics.recoveries++;
+        device.state   = State::Healthy;
+        device.probes  = 0;
+        device.probing = false;
+        changed        = State::Healthy;
+    }
+    notify(slaveId, *changed);
+}
+
+void ModbusCircuitBreaker::failure(uint8_t slaveId, utils::MBErrorCode code,
+                                   Clock::duration elapsed, Clock::time_point now) {
+    if (!isFailure(code)) {
+        success(slaveId);
+        return;
+    }
+
+    std::optional<State> changed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto &device        = _devices[slaveId];
+        const auto previous = device.state;
+        device.cost         = std::max(elapsed, Clock::duration::zero());
+        device.failures++;
+
+        switch (device.state) {
+        case State::Healthy:
+        case State::Suspect:
+            if (device.failures >= _settings.offlineAfter) {
+                device.state  = State::Offline;
+                device.probes = 0;
+                scheduleProbe(device, now);
+                _metrics.trips++;
+            } else {
+                device.state = State::Suspect;
+            }
+            if (device.state != previous)
+                changed = device.state;
+            break;
+        case State::Offline:
+            // Only the probe is sent to offline device
+            device.probes++;
+            scheduleProbe(device, now);
+            break;
+        }
+    }
+
+    if (changed)
+        notify(slaveId, *changed);
+}
+
+void ModbusCircuitBreaker::release(uint8_t slaveId) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto found = _devices.find(slaveId);
+    if (found != _devices.end())
+        found->second.probing = false;
+}
+
+void ModbusCircuitBreaker::reset(uint8_t slaveId) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _devices.erase(slaveId);
+}
+
+void ModbusCircuitBreaker::setListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _listener = std::move(listener);
+}
+
+ModbusCircuitBreaker::State ModbusCircuitBreaker::state(uint8_t slaveId) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto found = _devices.find(slaveId);
+    return found == _devices.end() ? State::Healthy : found->second.state;
+}
+
+std::optional<ModbusCircuitBreaker::Device>
+ModbusCircuitBreaker::device(uint8_t slaveId) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto found = _devices.find(slaveId);
+    if (found == _devices.end())
+        return std::nullopt;
+    return found->second;
+}
+
+ModbusCircuitBreaker::Metrics ModbusCircuitBreaker::metrics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _metrics;
+}
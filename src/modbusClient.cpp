@@ -0,0 +1,451 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusClient.hpp"
+#include "modbusException.hpp"
+
+#include <algorithm>
+
+using namespace MB;
+
+namespace {
+std::vector<ModbusCell> toCells(const std::vector<uint16_t> &values) {
+    return std::vector<ModbusCell>(values.begin(), values.end());
+}
+
+std::vector<ModbusCell> toCells(const std::vector<bool> &values) {
+    std::vector<ModbusCell> cells;
+    cells.reserve(values.size());
+    for (const bool value : values)
+        cells.push_back(ModbusCell::initCoil(value));
+    return cells;
+}
+} // namespace
+
+ModbusClient::ModbusClient(Transaction transaction, Pipeline pipeline)
+    : _transaction(std::move(transaction)), _pipeline(std::move(pipeline)) {}
+
+namespace {
+void checkResponse(const ModbusRequest &request, const ModbusResponse &response) {
+    if (response.slaveID() != request.slaveID() ||
+        response.functionCode() != request.functionCode())
+        throw ModbusException(utils::ProtocolError, request.slaveID(),
+                              request.functionCode());
+}
+} // namespace
+
+template <typename Send>
+auto ModbusClient::guarded(const ModbusRequest *requests, std::size_t count, Send send) {
+    if (!_circuitBreaker)
+        return send();
+
+    // Broadcast is not answered, so it says nothing about the devices
+    std::vector<const ModbusRequest *> devices;
+    for (const auto *request = requests; request != requests + count; request++) {
+        if (request->slaveID() != 0 &&
+            std::none_of(devices.begin(), devices.end(), [&](const ModbusRequest *other) {
+                return other->slaveID() == request->slaveID();
+            }))
+            devices.push_back(request);
+    }
+
+    for (std::size_t i = 0; i < devices.size(); i++) {
+        if (_circuitBreaker->allow(devices[i]->slaveID()))
+            continue;
+        for (std::size_t j = 0; j < i; j++)
+            _circuitBreaker->release(devices[j]->slaveID());
+        throw ModbusException(utils::GatewayTargetDeviceFailedToRespond,
+                              devices[i]->slaveID(), devices[i]->functionCode());
+    }
+
+    const auto start = ModbusCircuitBreaker::Clock::now();
+    try {
+        auto result = send();
+        for (const auto *device : devices)
+            _circuitBreaker->success(device->slaveID());
+        return result;
+    } catch (const ModbusException &exception) {
+        const auto now = ModbusCircuitBreaker::Clock::now();
+        for (const auto *device : devices)
+            _circuitBreaker->failure(device->slaveID(), exception.getErrorCode(),
+                                     now - start, now);
+        throw;
+    } catch (...) {
+        for (const auto *device : devices)
+            _circuitBreaker->release(device->slaveID());
+        throw;
+    }
+}
+
+ModbusResponse ModbusClient::execute(const ModbusRequest &request) {
+    // Invalidated up front, as failed write may still have been applied
+    if (_readCache)
+        _readCache->invalidate(request);
+    return guarded(&request, 1, [&] {
+        auto response = _transaction(request);
+        checkResponse(request, response);
+        return response;
+    });
+}
+
+std::vector<ModbusResponse>
+ModbusClient::executeAll(const std::vector<ModbusRequest> &requests) {
+    if (_pipeline && requests.size() > 1) {
+        if (_readCache) {
+            for (const auto &request : requests)
+                _readCache->invalidate(request);
+        }
+        return guarded(requests.data(), requests.size(), [&] {
+            auto responses = _pipeline(requests);
+            if (responses.size() != requests.size())
+                throw ModbusException(utils::ProtocolError);
+            for (std::size_t i = 0; i < requests.size(); i++)
+                checkResponse(requests[i], responses[i]);
+            return responses;
+        });
+    }
+
+    std::vector<ModbusResponse> responses;
+    responses.reserve(requests.size());
+    for (const auto &request : requests)
+        responses.push_back(execute(request));
+    return responses;
+}
+
+std::vector<ModbusCell> ModbusClient::read(uint8_t slaveId,
+                                           utils::MBFunctionCode functionCode,
+                                           uint16_t address, std::size_t count) {
+    if (utils::functionType(functionCode) != utils::Read)
+        throw ModbusException(utils::IllegalFunction, slaveId, functionCode);
+    if (count == 0 || address + count > 0x10000)
+        throw ModbusException(utils::IllegalDataAddress, slaveId, functionCode);
+
+    const auto table = utils::functionRegister(functionCode);
+    // Taken before the read is sent, so that writes sent meanwhile are not undone
+    const auto generation = _readCache ? _readCache->generation() : 0;
+    if (_readCache) {
+        if (auto cached = _readCache->lookup(slaveId, table, address, count))
+            return std::move(*cached);
+    }
+
+    const std::size_t chunk = utils::maxRegistersNumber(functionCode);
+    std::vector<ModbusRequest> requests;
+    requests.reserve((count + chunk - 1) / chunk);
+    for (std::size_t offset = 0; offset < count; offset += chunk) {
+        requests.emplace_back(slaveId, functionCode,
+                              static_cast<uint16_t>(address + offset),
+                              static_cast<uint16_t>(std::min(chunk, count - offset)));
+    }
+
+    const auto responses = executeAll(requests);
+    const bool coils     = table == utils::OutputCoils || table == utils::InputContacts;
+
+    std::vector<ModbusCell> result;
+    result.reserve(count);
+    for (std::size_t i = 0; i < responses.size(); i++) {
+        const auto expected = requests[i].numberOfRegisters();
+        const auto &values  = responses[i].registerValues();
+
+        // Coils are padded to whole bytes
+        if (values.size() < expected || (!coils && values.size() != expected))
+            throw ModbusException(utils::NumberOfValuesInvalid, slaveId, functionCode);
+        result.insert(result.end(), values.begin(), values.begin() + expected);
+    }
+
+    if (_readCache)
+        _readCache->store(slaveId, table, address, result, generation);
+    return result;
+}
+
+void ModbusClient::write(uint8_t slaveId, utils::MBFunctionCode functionCode,
+                         uint16_t address, const std::vector<ModbusCell> &values) {
+    const auto type = utils::functionType(functionCode);
+    if (type != utils::WriteSingle && type != utils::WriteMultiple)
+        throw ModbusException(utils::IllegalFunction, slaveId, functionCode);
+    if (values.empty() || address + values.size() > 0x10000)
+        throw ModbusException(utils::IllegalDataAddress, slaveId, functionCode);
+
+    // Single writes are split value by value
+    const std::size_t chunk = utils::maxRegistersNumber(functionCode);
+    std::vector<ModbusRequest> requests;
+    requests.reserve((values.size() + chunk - 1) / chunk);
+    for (std::size_t offset = 0; offset < values.size(); offset += chunk) {
+        const auto size  = std::min(chunk, values.size() - offset);
+        const auto first = values.begin() + offset;
+        requests.emplace_back(slaveId, functionCode,
+                              static_cast<uint16_t>(address + offset),
+                              static_cast<uint16_t>(size),
+                              std::vector<ModbusCell>(first, first + size));
+    }
+
+    utils::ignore_result(executeAll(requests));
+}
+
+std::vector<bool> ModbusClient::readBits(uint8_t slaveId,
+                                         utils::MBFunctionCode functionCode,
+                                         uint16_t address, uint16_t count) {
+    const auto values = read(slaveId, functionCode, address, count);
+
+    std::vector<bool> result(count);
+    for (uint16_t i = 0; i < count; i++)
+        result[i] = values[i].coil();
+    return result;
+}
+
+std::vector<uint16_t> ModbusClient::readRegisters(uint8_t slaveId,
+                                                  utils::MBFunctionCode functionCode,
+                                                  uint16_t address, uint16_t count) {
+    const auto values = read(slaveId, functionCode, address, count);
+
+    std::vector<uint16_t> result(count);
+    for (uint16_t i = 0; i < count; i++)
+        result[i] = values[i].reg();
+    return result;
+}
+
+std::vector<bool> ModbusClient::readCoils(uint8_t slaveId, uint16_t address,
+                                          uint16_t count) {
+    return readBits(slaveId, utils::ReadDiscreteOutputCoils, address, count);
+}
+
+std::vector<bool> ModbusClient::readInputContacts(uint8_t slaveId, uint16_t address,
+                                                  uint16_t count) {
+    return readBits(slaveId, utils::ReadDiscreteInputContacts, address, count);
+}
+
+std::vector<uint16_t> ModbusClient::readHoldingRegisters(uint8_t slaveId,
+                                                         uint16_t address,
+                                                         uint16_t count) {
+    return readRegisters(slaveId, utils::ReadAnalogOutputHoldingRegisters, address,
+                         count);
+}
+
+std::vector<uint16_t> ModbusClient::readInputRegisters(uint8_t slaveId,
+                                                       uint16_t address,
+                                                       uint16_t count) {
+    return readRegisters(slaveId, utils::ReadAnalogInputRegisters, address, count);
+}
+
+void ModbusClient::writeCoil(uint8_t slaveId, uint16_t address, bool value) {
+    const ModbusRequest request(slaveId, utils::WriteSingleDiscreteOutputCoil, address, 1,
+                                {ModbusCell::initCoil(value)});
+    utils::ignore_result(execute(request));
+}
+
+void ModbusClient::writeRegister(uint8_t slaveId, uint16_t address, uint16_t value) {
+    const ModbusRequest request(slaveId, utils::WriteSingleAnalogOutputRegister, address,
+                                1, {ModbusCell::initReg(value)});
+    utils::ignore_result(execute(request));
+}
+
+void ModbusClient::writeCoils(uint8_t slaveId, uint16_t address,
+                              const std::vector<bool> &values) {
+    write(slaveId, utils::WriteMultipleDiscreteOutputCoils, address, toCells(values));
+}
+
+void ModbusClient::writeRegisters(uint8_t slaveId, uint16_t address,
+                                  const std::vector<uint16_t> &values) {
+    write(slaveId, utils::WriteMultipleAnalogOutputHoldingRegisters, address,
+          toCells(values));
+}
+
+void ModbusClient::maskWriteRegister(uint8_t slaveId, uint16_t address, uint16_t andMask,
+                                     uint16_t orMask) {
+    const ModbusRequest request(
+        slaveId, utils::MaskWriteRegister, address, 1,
+        {ModbusCell::initReg(andMask), ModbusCell::initReg(orMask)});
+    utils::ignore_result(execute(request));
+}
+
+void ModbusClient::setRegisterBits(uint8_t slaveId, uint16_t address, uint16_t bits) {
+    maskWriteRegister(slaveId, address, static_cast<uint16_t>(~bits), bits);
+}
+
+void ModbusClient::clearRegisterBits(uint8_t slaveId, uint16_t address, uint16_t bits) {
+    maskWriteRegister(slaveId, address, static_cast<uint16_t>(~bits), 0x0000);
+}
+
+std::vector<uint16_t>
+ModbusClient::readWriteRegisters(uint8_t slaveId, uint16_t readAddress,
+                                 uint16_t readCount, uint16_t writeAddress,
+                                 const std::vector<uint16_t> &values) {
+    ModbusRequest request(slaveId, utils::ReadWriteMultipleRegisters, readAddress,
+                          readCount, toCells(values));
+    request.setWriteAddress(writeAddress);
+
+    const auto response = execute(request);
+    const auto &read    = response.registerValues();
+
+    if (read.size() != readCount)
+        throw ModbusException(utils::NumberOfValuesInvalid, slaveId,
+                              utils::ReadWriteMultipleRegisters);
+
+    std::vector<uint16_t> result(readCount);
+    for (uint16_t i = 0; i < readCount; i++)
+        result[i] = read[i].reg();
+    return result;
+}
+
+std::vector<uint16_t> ModbusClient::readFIFOQueue(uint8_t slaveId,
+                                                  uint16_t pointerAddress) {
+    const auto response =
+        execute(ModbusRequest(slaveId, utils::ReadFIFOQueue, pointerAddress));
+
+    // Empty queue is answered without values
+    if (response.numberOfRegisters() == 0)
+        return {};
+
+    const auto &values = response.registerValues();
+    std::vector<uint16_t> result(values.size());
+    for (std::size_t i = 0; i < values.size(); i++)
+        result[i] = values[i].reg();
+    return result;
+}
+
+std::vector<ModbusFileRecord>
+ModbusClient::readFileRecords(uint8_t slaveId,
+                              const std::vector<ModbusFileRecord> &records) {
+    ModbusRequest request(slaveId, utils::ReadFileRecord);
+    request.setFileRecords(records);
+
+    const auto response = execute(request);
+    const auto &read    = response.fileRecords();
+    if (read.size() != records.size())
+        throw ModbusException(utils::NumberOfValuesInvalid, slaveId,
+                              utils::ReadFileRecord);
+
+    std::vector<ModbusFileRecord> result = records;
+    for (std::size_t i = 0; i < result.size(); i++) {
+        if (read[i].data.size() != records[i].recordLength)
+            throw ModbusException(utils::NumberOfValuesInvalid, slaveId,
+                                  utils::ReadFileRecord);
+        result[i].data = read[i].data;
+    }
+    return result;
+}
+
+void ModbusClient::writeFileRecords(uint8_t slaveId,
+                                    const std::vector<ModbusFileRecord> &records) {
+    ModbusRequest request(slaveId, utils::WriteFileRecord);
+    request.setFileRecords(records);
+    utils::ignore_result(execute(request));
+}
+
+namespace {
+// Splits `count` records starting from `recordNumber` into segments of
+// consecutive files, an empty vector if they go past the last file
+std::vector<ModbusFileRecord> fileSegments(uint16_t fileNumber, uint16_t recordNumber,
+                                           std::size_t count) {
+    std::vector<ModbusFileRecord> segments;
+    std::size_t file   = fileNumber;
+    std::size_t record = recordNumber;
+    if (record > fileRecord::MaxRecordNumber)
+        return segments;
+
+    while (count > 0) {
+        if (file > UINT16_MAX)
+            return {};
+        const auto length =
+            std::min(count, fileRecord::MaxRecordNumber + std::size_t(1) - record);
+        segments.push_back({static_cast<uint16_t>(file), static_cast<uint16_t>(record),
+                            static_cast<uint16_t>(length), {}});
+        count -= length;
+        file++;
+        record = 0;
+    }
+    return segments;
+}
+} // namespace
+
+std::vector<uint16_t> ModbusClient::readFile(uint8_t slaveId, uint16_t fileNumber,
+                                             uint16_t recordNumber, std::size_t count) {
+    const auto segments = fileSegments(fileNumber, recordNumber, count);
+    if (segments.empty() && count > 0)
+        throw ModbusException(utils::IllegalDataAddress, slaveId, utils::ReadFileRecord);
+
+    const auto transactions = fileRecord::packRead(segments);
+
+    std::vector<ModbusRequest> requests;
+    requests.reserve(transactions.size());
+    for (const auto &records : transactions) {
+        requests.emplace_back(slaveId, utils::ReadFileRecord);
+        requests.back().setFileRecords(records);
+    }
+
+    std::vector<uint16_t> result;
+    result.reserve(count);
+    const auto responses = executeAll(requests);
+    for (std::size_t i = 0; i < responses.size(); i++) {
+        const auto &expected = transactions[i];
+        const auto &read     = responses[i].fileRecords();
+        if (read.size() != expected.size())
+            throw ModbusException(utils::NumberOfValuesInvalid, slaveId,
+                                  utils::ReadFileRecord);
+        for (std::size_t j = 0; j < read.size(); j++) {
+            if (read[j].data.size() != expected[j].recordLength)
+                throw ModbusException(utils::NumberOfValuesInvalid, slaveId,
+                                      utils::ReadFileRecord);
+            result.insert(result.end(), read[j].data.begin(), read[j].data.end());
+        }
+    }
+    return result;
+}
+
+void ModbusClient::writeFile(uint8_t slaveId, uint16_t fileNumber, uint16_t recordNumber,
+                             const std::vector<uint16_t> &data) {
+    auto segments = fileSegments(fileNumber, recordNumber, data.size());
+    if (segments.empty() && !data.empty())
+        throw ModbusException(utils::IllegalDataAddress, slaveId, utils::WriteFileRecord);
+
+    auto next = data.begin();
+    for (auto &segment : segments) {
+        segment.data.assign(next, next + segment.recordLength);
+        next += segment.recordLength;
+    }
+
+    const auto transactions = fileRecord::packWrite(segments);
+
+    std::vector<ModbusRequest> requests;
+    requests.reserve(transactions.size());
+    for (const auto &records : transactions) {
+        requests.emplace_back(slaveId, utils::WriteFileRecord);
+        requests.back().setFileRecords(records);
+    }
+
+    utils::ignore_result(executeAll(requests));
+}
+
+ModbusDeviceIdentification ModbusClient::readDeviceIdentification(uint8_t slaveId,
+                                                                  uint8_t readCode,
+                                                                  uint8_t objectId) {
+    ModbusDeviceIdentification result;
+    result.readCode = readCode;
+
+    // There are at most 256 objects, so continuation cannot go on forever
+    for (int i = 0; i < 256; i++) {
+        ModbusRequest request(slaveId, utils::ReadDeviceIdentification);
+        request.setDeviceIdentification(readCode, objectId);
+
+        const auto response = execute(request);
+        const auto &read    = response.deviceIdentification();
+
+        result.conformityLevel = read.conformityLevel;
+        result.objects.insert(read.objects.begin(), read.objects.end());
+
+        if (!read.moreFollows || readCode == deviceId::Specific)
+            return result;
+        // Next object has to follow the ones already received
+        if (read.objects.empty() || read.objectId <= read.objects.rbegin()->first)
+            break;
+        objectId = read.objectId;
+    }
+
+    throw ModbusException(utils::ProtocolError, slaveId, utils::ReadDeviceIdentification);
+}
+
+std::vector<std::vector<ModbusCell>> ModbusClient::poll(const ModbusPollPlan &plan) {
+    if (plan.requests().empty())
+        return std::vector<std::vector<ModbusCell>>(plan.tags().size());
+    return plan.values(executeAll(plan.requests()));
+}
@@ -0,0 +1,236 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusDataStore.hpp"
+#include "modbusException.hpp"
+
+#include <algorithm>
+
+using namespace MB;
+
+namespace {
+bool isCoilTable(utils::MBFunctionRegisters table) {
+    return table == utils::OutputCoils || table == utils::InputContacts;
+}
+
+void checkQuantity(std::size_t count, std::size_t max) {
+    if (count == 0 || count > max)
+        throw ModbusException(utils::IllegalDataValue);
+}
+} // namespace
+
+ModbusDataStore::ModbusDataStore(std::size_t coils, std::size_t inputContacts,
+                                 std::size_t holdingRegisters,
+                                 std::size_t inputRegisters) {
+    _tables[utils::OutputCoils].resize(coils);
+    _tables[utils::InputContacts].resize(inputContacts);
+    _tables[utils::HoldingRegisters].resize(holdingRegisters);
+    _tables[utils::InputRegisters].resize(inputRegisters);
+}
+
+void ModbusDataStore::checkRange(utils::MBFunctionRegisters table, uint16_t address,
+                                 std::size_t count) const {
+    if (static_cast<std::size_t>(address) + count > _tables[table].size())
+        throw ModbusException(utils::IllegalDataAddress);
+}
+
+std::vector<ModbusCell> ModbusDataStore::readLocked(utils::MBFunctionRegisters table,
+                                                    uint16_t address,
+                                                    uint16_t count) const {
+    checkRange(table, address, count);
+
+    const auto &values = _tables[table];
+    std::vector<ModbusCell> result;
+    result.reserve(count);
+    for (std::size_t i = address; i < static_cast<std::size_t>(address) + count; i++) {
+        if (isCoilTable(table))
+            result.push_back(ModbusCell::initCoil(values[i] != 0));
+        else
+            result.push_back(ModbusCell::initReg(values[i]));
+    }
+
+    return result;
+}
+
+void ModbusDataStore::writeLocked(utils::MBFunctionRegisters table, uint16_t address,
+                                  const std::vector<ModbusCell> &values) {
+    checkRange(table, address, values.size());
+
+    auto &target = _tables[table];
+    for (std::size_t i = 0; i < values.size(); i++) {
+        const auto &cell = values[i];
+        target[address + i] =
+            cell.isCoil() ? static_cast<uint16_t>(cell.coil()) : cell.reg();
+    }
+}
+
+std::vector<uint16_t> &ModbusDataStore::fileLocked(const ModbusFileRecord &record) {
+    const auto file = _files.find(record.fileNumber);
+    if (file == _files.end() || record.recordNumber > fileRecord::MaxRecordNumber ||
+        static_cast<std::size_t>(record.recordNumber) + record.recordLength >
+            file->second.size())
+        throw ModbusException(utils::IllegalDataAddress);
+    return file->second;
+}
+
+ModbusResponse ModbusDataStore::handle(const ModbusRequest &request) {
+    const auto slaveID      = request.slaveID();
+    const auto functionCode = request.functionCode();
+    const auto address      = request.registerAddress();
+    const auto count        = request.numberOfRegisters();
+    const auto &values      = request.registerValues();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    try {
+        switch (functionCode) {
+        case utils::ReadDiscreteOutputCoils:
+        case utils::ReadDiscreteInputContacts:
+            checkQuantity(count, utils::MaxReadCoils);
+            return ModbusResponse(slaveID, functionCode, address, count,
+                                  readLocked(utils::functionRegister(functionCode),
+                                             address, count));
+        case utils::ReadAnalogOutputHoldingRegisters:
+        case utils::ReadAnalogInputRegisters:
+            checkQuantity(count, utils::MaxReadRegisters);
+            return ModbusResponse(slaveID, functionCode, address, count,
+                                  readLocked(utils::functionRegister(functionCode),
+                                             address, count));
+        case utils::WriteSingleDiscreteOutputCoil:
+        case utils::WriteSingleAnalogOutputRegister:
+            checkQuantity(values.size(), 1);
+            writeLocked(utils::functionRegister(functionCode), address, values);
+            return ModbusResponse(slaveID, functionCode, address, 1, values);
+        case utils::WriteMultipleDiscreteOutputCoils:
+        case utils::WriteMultipleAnalogOutputHoldingRegisters:
+            checkQuantity(count, functionCode == utils::WriteMultipleDiscreteOutputCoils
+                                     ? utils::MaxWriteCoils
+                                     : utils::MaxWriteRegisters);
+            if (values.size() != count)
+                throw ModbusException(utils::IllegalDataValue);
+            writeLocked(utils::functionRegister(functionCode), address, values);
+            return ModbusResponse(slaveID, functionCode, address, count, values);
+        case utils::MaskWriteRegister: {
+            if (values.size() != 2)
+                throw ModbusException(utils::IllegalDataValue);
+            checkRange(utils::HoldingRegisters, address, 1);
+            const uint16_t andMask = values[0].reg();
+            const uint16_t orMask  = values[1].reg();
+            auto &target = _tables[utils::HoldingRegisters][address];
+            target = static_cast<uint16_t>((target & andMask) | (orMask & ~andMask));
+            return ModbusResponse(slaveID, functionCode, address, 1, values);
+        }
+        case utils::ReadFileRecord: {
+            if (fileRecord::readResponseSize(request.fileRecords()) >
+                fileRecord::MaxReadBytes)
+                throw ModbusException(utils::IllegalDataValue);
+
+            std::vector<ModbusFileRecord> records;
+            for (const auto &record : request.fileRecords()) {
+                const auto &file = fileLocked(record);
+                ModbusFileRecord read;
+                read.recordLength = record.recordLength;
+                const auto first = file.begin() + record.recordNumber;
+                read.data.assign(first, first + record.recordLength);
+                records.push_back(std::move(read));
+            }
+
+            ModbusResponse response(slaveID, functionCode);
+            response.setFileRecords(records);
+            return response;
+        }
+        case utils::WriteFileRecord: {
+            // Nothing is written unless all sub-requests are valid
+            for (const auto &record : request.fileRecords())
+                utils::ignore_result(fileLocked(record));
+            for (const auto &record : request.fileRecords()) {
+                auto &file = fileLocked(record);
+                std::copy(record.data.begin(), record.data.end(),
+                          file.begin() + record.recordNumber);
+            }
+            return ModbusResponse::from(request);
+        }
+        case utils::ReadDeviceIdentification: {
+            const auto &requested = request.deviceIdentification();
+            ModbusResponse response(slaveID, functionCode);
+            response.setDeviceIdentification(deviceId::respond(
+                _deviceObjects, requested.readCode, requested.objectId));
+            return response;
+        }
+        case utils::ReadFIFOQueue: {
+            const auto fifo = _fifos.find(address);
+            if (fifo == _fifos.end())
+                throw ModbusException(utils::IllegalDataAddress);
+            const auto queued = fifo->second.read();
+            return ModbusResponse(slaveID, functionCode, address,
+                                  static_cast<uint16_t>(queued.size()),
+                                  std::vector<ModbusCell>(queued.begin(), queued.end()));
+        }
+        case utils::ReadWriteMultipleRegisters:
+            checkQuantity(count, utils::MaxReadRegisters);
+            checkQuantity(values.size(), utils::MaxReadWriteRegisters);
+            // Nothing is written unless the read can be done as well
+            checkRange(utils::HoldingRegisters, address, count);
+            writeLocked(utils::HoldingRegisters, request.writeRegisterAddress(), values);
+            return ModbusResponse(slaveID, functionCode, address, count,
+                                  readLocked(utils::HoldingRegisters, address, count));
+        default:
+            throw ModbusException(utils::IllegalFunction);
+        }
+    } catch (const ModbusException &ex) {
+        throw ModbusException(ex.getErrorCode(), slaveID, functionCode);
+    }
+}
+
+std::vector<ModbusCell> ModbusDataStore::read(utils::MBFunctionRegisters table,
+                                              uint16_t address, uint16_t count) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return readLocked(table, address, count);
+}
+
+void ModbusDataStore::write(utils::MBFunctionRegisters table, uint16_t address,
+                            const std::vector<ModbusCell> &values) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    writeLocked(table, address, values);
+}
+
+void ModbusDataStore::addFifo(uint16_t pointerAddress, std::size_t capacity,
+                              bool consumeOnRead) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _fifos.insert_or_assign(pointerAddress, ModbusFifo(capacity, consumeOnRead));
+}
+
+bool ModbusDataStore::pushFifo(uint16_t pointerAddress, uint16_t value) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto fifo = _fifos.find(pointerAddress);
+    if (fifo == _fifos.end())
+        throw ModbusException(utils::IllegalDataAddress);
+    return fifo->second.push(value);
+}
+
+std::size_t ModbusDataStore::fifoSize(uint16_t pointerAddress) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto fifo = _fifos.find(pointerAddress);
+    if (fifo == _fifos.end())
+        throw ModbusException(utils::IllegalDataAddress);
+    return fifo->second.size();
+}
+
+void ModbusDataStore::addFile(uint16_t fileNumber, std::size_t records) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _files[fileNumber].assign(records, 0);
+}
+
+std::vector<uint16_t> ModbusDataStore::file(uint16_t fileNumber) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto file = _files.find(fileNumber);
+    if (file == _files.end())
+        throw ModbusException(utils::IllegalDataAddress);
+    return file->second;
+}
+
+void ModbusDataStore::setDeviceObjects(std::map<uint8_t, std::string> objects) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _deviceObjects = std::move(objects);
+}
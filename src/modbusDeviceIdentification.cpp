@@ -0,0 +1,219 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusDeviceIdentification.hpp"
+#include "modbusException.hpp"
+
+#include <chrono>
+
+using namespace MB;
+
+namespace {
+// The last object id of each stream access category
+uint8_t lastObjectId(uint8_t readCode) {
+    switch (readCode) {
+    case deviceId::Basic:
+        return deviceId::MajorMinorRevision;
+    case deviceId::Regular:
+        return 0x7F;
+    case deviceId::Extended:
+        return 0xFF;
+    default:
+        throw ModbusException(utils::IllegalDataValue);
+    }
+}
+
+uint8_t conformityLevel(const std::map<uint8_t, std::string> &objects) {
+    // Individual access is always supported
+    uint8_t level = deviceId::Basic;
+    if (!objects.empty() && objects.rbegin()->first >= 0x80)
+        level = deviceId::Extended;
+    else if (objects.upper_bound(deviceId::MajorMinorRevision) != objects.end())
+        level = deviceId::Regular;
+    return level | 0x80;
+}
+} // namespace
+
+void deviceId::encodeRequest(std::vector<uint8_t> &out,
+                             const ModbusDeviceIdentification &request) {
+    out.push_back(MEIType);
+    out.push_back(request.readCode);
+    out.push_back(request.objectId);
+}
+
+ModbusDeviceIdentification deviceId::decodeRequest(const uint8_t *data,
+                                                   std::size_t size) {
+    if (size < 3 || data[0] != MEIType)
+        throw ModbusException(utils::InvalidByteOrder);
+
+    ModbusDeviceIdentification request;
+    request.readCode = data[1];
+    request.objectId = data[2];
+    return request;
+}
+
+void deviceId::encodeResponse(std::vector<uint8_t> &out,
+                              const ModbusDeviceIdentification &response) {
+    std::size_t size = 0;
+    for (const auto &[id, value] : response.objects)
+        size += 2 + value.size();
+    if (size > MaxObjectsSize)
+        throw ModbusException(utils::NumberOfValuesInvalid);
+
+    out.push_back(MEIType);
+    out.push_back(response.readCode);
+    out.push_back(response.conformityLevel);
+    out.push_back(response.moreFollows ? 0xFF : 0x00);
+    out.push_back(response.moreFollows ? response.objectId : 0x00);
+    out.push_back(static_cast<uint8_t>(response.objects.size()));
+    for (const auto &[id, value] : response.objects) {
+        out.push_back(id);
+        out.push_back(static_cast<uint8_t>(value.size()));
+        out.insert(out.end(), value.begin(), value.end());
+    }
+}
+
+ModbusDeviceIdentification deviceId::decodeResponse(const uint8_t *data,
+                                                    std::size_t size,
+                                                    std::size_t &consumed) {
+    if (size < 6 || data[0] != MEIType || (data[3] != 0x00 && data[3] != 0xFF))
+        throw ModbusException(utils::InvalidByteOrder);
+
+    ModbusDeviceIdentification response;
+    response.readCode        = data[1];
+    response.conformityLevel = data[2];
+    response.moreFollows     = data[3] == 0xFF;
+    response.objectId        = data[4];
+
+    std::size_t i = 6;
+    for (uint8_t n = 0; n < data[5]; n++) {
+        if (i + 2 > size || i + 2 + data[i + 1] > size)
+            throw ModbusException(utils::InvalidByteOrder);
+        const auto *value = reinterpret_cast<const char *>(&data[i + 2]);
+        response.objects[data[i]].assign(value, data[i + 1]);
+        i += 2 + data[i + 1];
+    }
+
+    consumed = i;
+    return response;
+}
+
+ModbusDeviceIdentification
+deviceId::respond(const std::map<uint8_t, std::string> &objects, uint8_t readCode,
+                  uint8_t objectId) {
+    ModbusDeviceIdentification response;
+    response.readCode        = readCode;
+    response.conformityLevel = conformityLevel(objects);
+
+    if (readCode == Specific) {
+        const auto object = objects.find(objectId);
+        if (object == objects.end())
+            throw ModbusException(utils::IllegalDataAddress);
+        response.objects.insert(*object);
+        return response;
+    }
+
+    const auto last = lastObjectId(readCode);
+    // Unknown object restarts the stream
+    if (objects.count(objectId) == 0 || objectId > last)
+        objectId = 0;
+
+    std::size_t size = 0;
+    const auto end = objects.upper_bound(last);
+    for (auto it = objects.lower_bound(objectId); it != end; it++) {
+        const auto objectSize = 2 + it->second.size();
+        if (size + objectSize > MaxObjectsSize) {
+            if (response.objects.empty())
+                throw ModbusException(utils::SlaveDeviceFailure);
+            response.moreFollows = true;
+            response.objectId    = it->first;
+            break;
+        }
+        response.objects.insert(*it);
+        size += objectSize;
+    }
+
+    return response;
+}
+
+ModbusDeviceIdentification ModbusDeviceIdCache::get(const std::string &endpoint,
+                                                    uint8_t unitId, const Fetch &fetch) {
+    const Key key(endpoint, unitId);
+    std::promise<ModbusDeviceIdentification> promise;
+    std::shared_future<ModbusDeviceIdentification> future;
+    uint64_t fetchId = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto entry = _entries.find(key);
+        // Somebody else fetches (or fetched) this device
+        if (entry != _entries.end()) {
+            future = entry->second.future;
+        } else {
+            fetchId = ++_fetches;
+            _entries.emplace(key, Entry{promise.get_future().share(), fetchId});
+        }
+    }
+
+    if (future.valid())
+        return future.get();
+
+    try {
+        auto identification = fetch();
+        promise.set_value(identification);
+        return identification;
+    } catch (...) {
+        // Waiting callers get the error, next call fetches again
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lock(_mutex);
+        // Device may have been invalidated and fetched again in the meantime
+        const auto entry = _entries.find(key);
+        if (entry != _entries.end() && entry->second.fetch == fetchId)
+            _entries.erase(entry);
+        throw;
+    }
+}
+
+std::optional<ModbusDeviceIdentification>
+ModbusDeviceIdCache::find(const std::string &endpoint, uint8_t unitId) const {
+    std::shared_future<ModbusDeviceIdentification> future;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto entry = _entries.find(Key(endpoint, unitId));
+        if (entry == _entries.end())
+            return std::nullopt;
+        future = entry->second.future;
+    }
+
+    // Fetch in progress
+    if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return std::nullopt;
+
+    try {
+        return future.get();
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+void ModbusDeviceIdCache::invalidate(const std::string &endpoint, uint8_t unitId) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(Key(endpoint, unitId));
+}
+
+void ModbusDeviceIdCache::invalidate(const std::string &endpoint) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(_entries.lower_bound(Key(endpoint, 0)),
+                   _entries.upper_bound(Key(endpoint, 0xFF)));
+}
+
+void ModbusDeviceIdCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
+std::size_t ModbusDeviceIdCache::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
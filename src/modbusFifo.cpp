@@ -0,0 +1,53 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusFifo.hpp"
+#include "modbusException.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace MB;
+
+ModbusFifo::ModbusFifo(std::size_t capacity, bool consumeOnRead)
+    : _buffer(capacity), _consumeOnRead(consumeOnRead) {
+    if (capacity == 0)
+        throw std::invalid_argument("FIFO capacity must not be 0");
+}
+
+bool ModbusFifo::push(uint16_t value) noexcept {
+    const auto tail = (_head + _size) % _buffer.size();
+    _buffer[tail]   = value;
+
+    if (_size == _buffer.size()) {
+        _head = (_head + 1) % _buffer.size();
+        _overwritten++;
+        return false;
+    }
+
+    _size++;
+    return true;
+}
+
+std::vector<uint16_t> ModbusFifo::read() {
+    if (!_consumeOnRead && _size > MaxReadCount)
+        throw ModbusException(utils::IllegalDataValue);
+
+    const auto count = std::min<std::size_t>(_size, MaxReadCount);
+    std::vector<uint16_t> result(count);
+    for (std::size_t i = 0; i < count; i++)
+        result[i] = _buffer[(_head + i) % _buffer.size()];
+
+    if (_consumeOnRead) {
+        _head = (_head + count) % _buffer.size();
+        _size -= count;
+    }
+
+    return result;
+}
+
+void ModbusFifo::clear() noexcept {
+    _head = 0;
+    _size = 0;
+}
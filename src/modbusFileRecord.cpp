@@ -0,0 +1,236 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusFileRecord.hpp"
+#include "modbusException.hpp"
+#include "modbusUtils.hpp"
+
+#include <algorithm>
+
+using namespace MB;
+
+namespace {
+// Reference type, file number, record number and record length
+constexpr std::size_t SubRequestHeader = 7;
+// Record length and reference type
+constexpr std::size_t SubResponseHeader = 2;
+
+// Checks byte count and returns index just past the sub-requests
+std::size_t checkByteCount(const uint8_t *data, std::size_t size, std::size_t max) {
+    if (size < 1 || data[0] == 0 || data[0] > max || size < 1u + data[0])
+        throw ModbusException(utils::InvalidByteOrder);
+    return 1u + data[0];
+}
+
+// Greedily fills transactions, `take` returns how many records of the segment
+// still fit in the current one
+template <typename Take>
+std::vector<std::vector<ModbusFileRecord>>
+pack(const std::vector<ModbusFileRecord> &segments, Take take) {
+    std::vector<std::vector<ModbusFileRecord>> transactions;
+    std::vector<ModbusFileRecord> current;
+    std::size_t requestBytes  = 0;
+    std::size_t responseBytes = 0;
+
+    for (const auto &segment : segments) {
+        std::size_t done = 0;
+        while (done < segment.recordLength) {
+            const std::size_t remaining = segment.recordLength - done;
+            const auto count = take(requestBytes, responseBytes, remaining);
+            if (count == 0) {
+                // Nothing more fits, start next transaction
+                transactions.push_back(std::move(current));
+                current.clear();
+                requestBytes  = 0;
+                responseBytes = 0;
+                continue;
+            }
+
+            ModbusFileRecord record;
+            record.fileNumber   = segment.fileNumber;
+            record.recordNumber = static_cast<uint16_t>(segment.recordNumber + done);
+            record.recordLength = static_cast<uint16_t>(count);
+            if (!segment.data.empty())
+                record.data.insert(record.data.end(), segment.data.begin() + done,
+                                   segment.data.begin() + done + count);
+
+            requestBytes += SubRequestHeader + record.data.size() * 2;
+            responseBytes += SubResponseHeader + count * 2;
+            current.push_back(std::move(record));
+            done += count;
+        }
+    }
+
+    if (!current.empty())
+        transactions.push_back(std::move(current));
+    return transactions;
+}
+} // namespace
+
+std::size_t fileRecord::readRequestSize(const std::vector<ModbusFileRecord> &records) {
+    return records.size() * SubRequestHeader;
+}
+
+std::size_t fileRecord::readResponseSize(const std::vector<ModbusFileRecord> &records) {
+    std::size_t size = 0;
+    for (const auto &record : records)
+        size += SubResponseHeader + record.recordLength * 2u;
+    return size;
+}
+
+std::size_t fileRecord::writeSize(const std::vector<ModbusFileRecord> &records) {
+    std::size_t size = 0;
+    for (const auto &record : records)
+        size += SubRequestHeader + record.data.size() * 2;
+    return size;
+}
+
+void fileRecord::encodeReadRequest(std::vector<uint8_t> &out,
+                                   const std::vector<ModbusFileRecord> &records) {
+    const auto size = readRequestSize(records);
+    if (size == 0 || size > MaxReadBytes)
+        throw ModbusException(utils::NumberOfValuesInvalid);
+
+    out.push_back(static_cast<uint8_t>(size));
+    for (const auto &record : records) {
+        out.push_back(ReferenceType);
+        utils::pushUint16(out, record.fileNumber);
+        utils::pushUint16(out, record.recordNumber);
+        utils::pushUint16(out, record.recordLength);
+    }
+}
+
+std::vector<ModbusFileRecord> fileRecord::decodeReadRequest(const uint8_t *data,
+                                                            std::size_t size) {
+    const auto end = checkByteCount(data, size, MaxReadBytes);
+    if ((end - 1) % SubRequestHeader != 0)
+        throw ModbusException(utils::InvalidByteOrder);
+
+    std::vector<ModbusFileRecord> records;
+    for (std::size_t i = 1; i < end; i += SubRequestHeader) {
+        if (data[i] != ReferenceType)
+            throw ModbusException(utils::InvalidByteOrder);
+
+        ModbusFileRecord record;
+        record.fileNumber   = utils::bigEndianConv(&data[i + 1]);
+        record.recordNumber = utils::bigEndianConv(&data[i + 3]);
+        record.recordLength = utils::bigEndianConv(&data[i + 5]);
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+void fileRecord::encodeReadResponse(std::vector<uint8_t> &out,
+                                    const std::vector<ModbusFileRecord> &records) {
+    std::size_t size = 0;
+    for (const auto &record : records)
+        size += SubResponseHeader + record.data.size() * 2;
+    if (size == 0 || size > MaxReadBytes)
+        throw ModbusException(utils::NumberOfValuesInvalid);
+
+    out.push_back(static_cast<uint8_t>(size));
+    for (const auto &record : records) {
+        out.push_back(static_cast<uint8_t>(1 + record.data.size() * 2));
+        out.push_back(ReferenceType);
+        for (const auto value : record.data)
+            utils::pushUint16(out, value);
+    }
+}
+
+std::vector<ModbusFileRecord> fileRecord::decodeReadResponse(const uint8_t *data,
+                                                             std::size_t size) {
+    const auto end = checkByteCount(data, size, MaxReadBytes);
+
+    std::vector<ModbusFileRecord> records;
+    std::size_t i = 1;
+    while (i < end) {
+        // Length covers reference type and even number of data bytes
+        const std::size_t length = data[i];
+        if (length % 2 == 0 || i + 1 + length > end || data[i + 1] != ReferenceType)
+            throw ModbusException(utils::InvalidByteOrder);
+
+        ModbusFileRecord record;
+        record.recordLength = static_cast<uint16_t>(length / 2);
+        record.data.resize(record.recordLength);
+        for (std::size_t j = 0; j < record.data.size(); j++)
+            record.data[j] = utils::bigEndianConv(&data[i + 2 + j * 2]);
+
+        records.push_back(std::move(record));
+        i += 1 + length;
+    }
+    return records;
+}
+
+void fileRecord::encodeWrite(std::vector<uint8_t> &out,
+                             const std::vector<ModbusFileRecord> &records) {
+    const auto size = writeSize(records);
+    if (size == 0 || size > MaxWriteBytes)
+        throw ModbusException(utils::NumberOfValuesInvalid);
+
+    out.push_back(static_cast<uint8_t>(size));
+    for (const auto &record : records) {
+        out.push_back(ReferenceType);
+        utils::pushUint16(out, record.fileNumber);
+        utils::pushUint16(out, record.recordNumber);
+        utils::pushUint16(out, static_cast<uint16_t>(record.data.size()));
+        for (const auto value : record.data)
+            utils::pushUint16(out, value);
+    }
+}
+
+std::vector<ModbusFileRecord> fileRecord::decodeWrite(const uint8_t *data,
+                                                      std::size_t size) {
+    const auto end = checkByteCount(data, size, MaxWriteBytes);
+
+    std::vector<ModbusFileRecord> records;
+    std::size_t i = 1;
+    while (i < end) {
+        if (i + SubRequestHeader > end || data[i] != ReferenceType)
+            throw ModbusException(utils::InvalidByteOrder);
+
+        ModbusFileRecord record;
+        record.fileNumber   = utils::bigEndianConv(&data[i + 1]);
+        record.recordNumber = utils::bigEndianConv(&data[i + 3]);
+        record.recordLength = utils::bigEndianConv(&data[i + 5]);
+        i += SubRequestHeader;
+
+        if (i + record.recordLength * 2u > end)
+            throw ModbusException(utils::InvalidByteOrder);
+        record.data.resize(record.recordLength);
+        for (std::size_t j = 0; j < record.data.size(); j++)
+            record.data[j] = utils::bigEndianConv(&data[i + j * 2]);
+
+        i += record.recordLength * 2u;
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+std::vector<std::vector<ModbusFileRecord>>
+fileRecord::packRead(const std::vector<ModbusFileRecord> &segments) {
+    return pack(segments, [](std::size_t requestBytes, std::size_t responseBytes,
+                             std::size_t remaining) -> std::size_t {
+        // Sub-request has to fit in the request and its records in the response
+        if (requestBytes + SubRequestHeader > MaxReadBytes ||
+            responseBytes + SubResponseHeader + 2 > MaxReadBytes)
+            return 0;
+        return std::min(remaining,
+                        (MaxReadBytes - responseBytes - SubResponseHeader) / 2);
+    });
+}
+
+std::vector<std::vector<ModbusFileRecord>>
+fileRecord::packWrite(const std::vector<ModbusFileRecord> &segments) {
+    for (const auto &segment : segments) {
+        if (segment.data.size() != segment.recordLength)
+            throw ModbusException(utils::NumberOfValuesInvalid);
+    }
+
+    return pack(segments, [](std::size_t requestBytes, std::size_t,
+                             std::size_t remaining) -> std::size_t {
+        if (requestBytes + SubRequestHeader + 2 > MaxWriteBytes)
+            return 0;
+        return std::min(remaining, (MaxWriteBytes - requestBytes - SubRequestHeader) / 2);
+    });
+}
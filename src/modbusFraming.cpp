@@ -0,0 +1,146 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusFraming.hpp"
+#include "modbusUtils.hpp"
+
+#include <algorithm>
+
+using namespace MB;
+
+std::optional<std::size_t> framing::rtuRequestLength(const uint8_t *data,
+                                                     std::size_t size) {
+    // Slave id and function code
+    if (size < 2)
+        return 2;
+
+    switch (static_cast<utils::MBFunctionCode>(data[1])) {
+    case utils::ReadDiscreteOutputCoils:
+    case utils::ReadDiscreteInputContacts:
+    case utils::ReadAnalogOutputHoldingRegisters:
+    case utils::ReadAnalogInputRegisters:
+    case utils::WriteSingleDiscreteOutputCoil:
+    case utils::WriteSingleAnalogOutputRegister:
+        return 6 + CRCSize;
+    case utils::WriteMultipleDiscreteOutputCoils:
+    case utils::WriteMultipleAnalogOutputHoldingRegisters:
+        // Address, quantity and byte count are followed by values
+        if (size < 7)
+            return 7;
+        return 7 + data[6] + CRCSize;
+    case utils::MaskWriteRegister:
+        // Address, AND mask and OR mask
+        return 8 + CRCSize;
+    case utils::ReadFileRecord:
+    case utils::WriteFileRecord:
+        // Byte count of all sub-requests
+        if (size < 3)
+            return 3;
+        return 3 + data[2] + CRCSize;
+    case utils::ReadFIFOQueue:
+        // FIFO pointer address
+        return 4 + CRCSize;
+    case utils::ReadDeviceIdentification:
+        // MEI type, read device id code and object id
+        return 5 + CRCSize;
+    case utils::ReadWriteMultipleRegisters:
+        // Read address and quantity, write address, quantity and byte count
+        if (size < 11)
+            return 11;
+        return 11 + data[10] + CRCSize;
+    default:
+        return std::nullopt;
+    }
+}
+
+std::optional<std::size_t> framing::rtuResponseLength(const uint8_t *data,
+                                                      std::size_t size) {
+    if (size < 2)
+        return 2;
+
+    // Slave id, function code, exception code
+    if (data[1] & 0b10000000)
+        return 3 + CRCSize;
+
+    switch (static_cast<utils::MBFunctionCode>(data[1])) {
+    case utils::ReadDiscreteOutputCoils:
+    case utils::ReadDiscreteInputContacts:
+    case utils::ReadAnalogOutputHoldingRegisters:
+    case utils::ReadAnalogInputRegisters:
+    case utils::ReadWriteMultipleRegisters:
+    case utils::ReadFileRecord:
+    case utils::WriteFileRecord:
+        if (size < 3)
+            return 3;
+        return 3 + data[2] + CRCSize;
+    case utils::WriteSingleDiscreteOutputCoil:
+    case utils::WriteSingleAnalogOutputRegister:
+    case utils::WriteMultipleDiscreteOutputCoils:
+    case utils::WriteMultipleAnalogOutputHoldingRegisters:
+        return 6 + CRCSize;
+    case utils::MaskWriteRegister:
+        return 8 + CRCSize;
+    case utils::ReadFIFOQueue: {
+        // 16 bit byte count, that covers FIFO count and values
+        if (size < 4)
+            return 4;
+        const auto bytes = utils::bigEndianConv(&data[2]);
+        if (bytes < 2 || bytes > 2 + 2 * utils::MaxFIFOCount)
+            return std::nullopt;
+        return 4 + bytes + CRCSize;
+    }
+    case utils::ReadDeviceIdentification: {
+        // Header up to the number of objects, then objects with their lengths
+        if (size < 8)
+            return 8;
+        std::size_t length = 8;
+        for (uint8_t i = 0; i < data[7]; i++) {
+            if (size < length + 2)
+                return length + 2;
+            length += 2 + data[length + 1];
+        }
+        if (length > 1 + 253)
+            return std::nullopt;
+        return length + CRCSize;
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+std::optional<std::size_t> framing::mbapFrameLength(const uint8_t *data,
+                                                    std::size_t size) {
+    // Transaction id, protocol id and length
+    if (size < 6)
+        return MBAPHeaderSize;
+
+    const auto protocolId = utils::bigEndianConv(&data[2]);
+    const auto length     = utils::bigEndianConv(&data[4]);
+
+    // Length covers unit id and PDU, which is at most 253 bytes
+    if (protocolId != 0 || length < 2 || length > 254)
+        return std::nullopt;
+
+    return 6 + length;
+}
+
+std::optional<std::size_t> framing::asciiFrameLength(const uint8_t *data,
+                                                     std::size_t size) {
+    if (size < 1)
+        return 1;
+
+    if (data[0] != ':')
+        return std::nullopt;
+
+    const auto end = std::min(size, MaxASCIIFrameSize);
+    const auto lf  = std::find(data, data + end, '\n');
+    if (lf != data + end)
+        return static_cast<std::size_t>(lf - data) + 1;
+
+    // Frame does not end where it should
+    if (end == MaxASCIIFrameSize)
+        return std::nullopt;
+
+    return size + 1;
+}
@@ -0,0 +1,277 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusGateway.hpp"
+#include "modbusException.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace MB;
+
+ModbusGateway::~ModbusGateway() {
+    for (auto &line : _lines) {
+        {
+            std::lock_guard lock{line->mutex};
+            line->stop = true;
+        }
+        line->cond.notify_all();
+    }
+
+    for (auto &line : _lines) {
+        line->thread.join();
+        while (const auto pending = line->queue.pop()) {
+            const auto &request = pending->request;
+            const auto pdu = ModbusException(utils::GatewayPathUnavailable,
+                                             request.slaveID(), request.functionCode())
+                                 .toRaw();
+            for (const auto &waiter : pending->waiters)
+                answer(waiter, pdu);
+        }
+    }
+}
+
+std::size_t ModbusGateway::addLine(Transaction transaction,
+                                   const std::vector<uint8_t> &unitIds,
+                                   Broadcast broadcast) {
+    for (const auto unitId : unitIds) {
+        if (unitId == utils::BroadcastSlaveID || _routes[unitId].has_value() ||
+            std::count(unitIds.begin(), unitIds.end(), unitId) > 1)
+            throw std::invalid_argument("Unit id cannot be routed to the line");
+    }
+
+    const auto index  = _lines.size();
+    auto line         = std::make_unique<Line>();
+    line->transaction = std::move(transaction);
+    line->broadcast   = std::move(broadcast);
+    line->thread      = std::thread(&ModbusGateway::run, this, std::ref(*line));
+    _lines.push_back(std::move(line));
+
+    for (const auto unitId : unitIds)
+        _routes[unitId] = index;
+    return index;
+}
+
+void ModbusGateway::setAdmission(std::size_t line,
+                                 ModbusAdmission::Settings settings) {
+    auto &selected = *_lines.at(line);
+    std::lock_guard lock{selected.mutex};
+    selected.admission.setSettings(settings);
+}
+
+void ModbusGateway::setShare(ClientId client, std::size_t share) {
+    for (auto &line : _lines) {
+        std::lock_guard lock{line->mutex};
+        line->queue.setShare(client, share);
+    }
+}
+
+void ModbusGateway::removeClient(ClientId client) {
+    for (auto &line : _lines) {
+        std::lock_guard lock{line->mutex};
+        line->queue.removeClient(client);
+    }
+}
+
+void ModbusGateway::setClientQueueLimit(std::size_t limit) {
+    for (auto &line : _lines) {
+        std::lock_guard lock{line->mutex};
+        line->queue.setLimit(limit);
+    }
+}
+
+void ModbusGateway::answer(const Waiter &waiter, const std::vector<uint8_t> &pdu) {
+    if (!waiter.reply)
+        return;
+
+    std::vector<uint8_t> frame;
+    frame.reserve(6 + pdu.size());
+    utils::pushUint16(frame, waiter.transactionId);
+    utils::pushUint16(frame, 0x0000);
+    utils::pushUint16(frame, static_cast<uint16_t>(pdu.size()));
+    frame.insert(frame.end(), pdu.begin(), pdu.end());
+    waiter.reply(std::move(frame));
+}
+
+void ModbusGateway::handle(const std::vector<uint8_t> &frame, Reply reply,
+                           ClientId client) {
+    // Header, unit id and function code
+    if (frame.size() < 8 || utils::bigEndianConv(&frame[2]) != 0x0000 ||
+        utils::bigEndianConv(&frame[4]) != frame.size() - 6)
+        throw ModbusException(utils::ProtocolError);
+
+    const auto unitId       = frame[6];
+    const auto functionCode = static_cast<utils::MBFunctionCode>(frame[7]);
+    // Broadcast is never answered
+    const bool broadcast = _broadcast && unitId == utils::BroadcastSlaveID;
+    const Waiter waiter{utils::bigEndianConv(&frame[0]),
+                        broadcast ? Reply() : std::move(reply), Clock::now()};
+
+    std::optional<ModbusRequest> request;
+    try {
+        request = ModbusRequest::fromRaw({frame.begin() + 6, frame.end()});
+    } catch (const ModbusException &exception) {
+        const auto code = utils::isStandardErrorCode(exception.getErrorCode())
+                              ? exception.getErrorCode()
+                              : utils::IllegalDataValue;
+        answer(waiter, ModbusException(code, unitId, functionCode).toRaw());
+        return;
+    }
+
+    if (broadcast) {
+        if (!utils::isBroadcastable(functionCode))
+            return;
+        for (auto &line : _lines) {
+            if (line->broadcast)
+                enqueue(*line, *request, waiter, client);
+        }
+        return;
+    }
+
+    const auto route = _routes[unitId];
+    if (!route.has_value()) {
+        answer(waiter, ModbusException(utils::GatewayPathUnavailable, unitId,
+                                       functionCode)
+                           .toRaw());
+        return;
+    }
+    enqueue(*_lines[*route], *request, waiter, client);
+}
+
+namespace {
+bool identicalReads(const ModbusRequest &a, const ModbusRequest &b) {
+    return utils::functionType(a.functionCode()) == utils::Read &&
+           a.slaveID() == b.slaveID() && a.functionCode() == b.functionCode() &&
+           a.registerAddress() == b.registerAddress() &&
+           a.numberOfRegisters() == b.numberOfRegisters();
+}
+
+// Bytes of the request and its response on the serial line, as RTU frames
+std::size_t wireCost(const ModbusRequest &request) {
+    // Slave id, function code and CRC of the response
+    constexpr std::size_t Overhead = 4;
+    const std::size_t count        = request.numberOfRegisters();
+
+    std::size_t payload = 4; // Address and quantity, or value, of writes
+    if (utils::functionType(request.functionCode()) == utils::Read) {
+        const auto table = utils::functionRegister(request.functionCode());
+        const bool coils = table == utils::OutputCoils || table == utils::InputContacts;
+        payload          = 1 + (coils ? (count + 7) / 8 : count * 2);
+    }
+    return request.toRaw().size() + 2 + Overhead + payload;
+}
+} // namespace
+
+void ModbusGateway::enqueue(Line &line, const ModbusRequest &request, Waiter waiter,
+                            ClientId client) {
+    bool queued = false;
+    {
+        std::lock_guard lock{line.mutex};
+        if (_coalescing[request.slaveID()]) {
+            auto *target = line.current && identicalReads(line.current->request, request)
+                               ? &*line.current
+                               : line.queue.find([&request](const Pending &pending) {
+                                     return identicalReads(pending.request, request);
+                                 });
+            if (target) {
+                target->waiters.push_back(std::move(waiter));
+                line.metrics.coalesced++;
+                line.metrics.queueDepth++;
+                line.metrics.maxQueueDepth =
+                    std::max(line.metrics.maxQueueDepth, line.metrics.queueDepth);
+                return;
+            }
+        }
+
+        // Bus transactions ahead of the request
+        const auto ahead = line.queue.size() + (line.current ? 1 : 0);
+        if (line.queue.size(client) >= line.queue.limit()) {
+            line.metrics.rejected++;
+        } else if (!line.admission.admit(ahead)) {
+            line.metrics.shed++;
+        } else {
+            queued = line.queue.push(client, {request, {waiter}}, wireCost(request));
+            line.metrics.queueDepth++;
+            line.metrics.maxQueueDepth =
+                std::max(line.metrics.maxQueueDepth, line.metrics.queueDepth);
+        }
+    }
+
+    if (queued) {
+        line.cond.notify_one();
+        return;
+    }
+    answer(waiter, ModbusException(utils::SlaveDeviceBusy, request.slaveID(),
+                                   request.functionCode())
+                       .toRaw());
+}
+
+void ModbusGateway::run(Line &line) {
+    while (true) {
+        std::unique_lock lock{line.mutex};
+        line.cond.wait(lock, [&line]() { return line.stop || !line.queue.empty(); });
+        if (line.stop)
+            return;
+
+        line.current = line.queue.pop();
+        // Only waiters of the current transaction may change from now on
+        const auto request = line.current->request;
+        lock.unlock();
+
+        const auto started = Clock::now();
+        std::vector<uint8_t> pdu;
+        bool failed = false;
+        try {
+            // Nobody waits for the response of broadcast
+            if (request.isBroadcast())
+                line.broadcast(request);
+            else
+                pdu = line.transaction(request).toRaw();
+        } catch (const ModbusException &exception) {
+            // Errors other than exception responses mean, that device did not
+            // answer properly
+            failed          = !utils::isStandardErrorCode(exception.getErrorCode());
+            const auto code = failed ? utils::GatewayTargetDeviceFailedToRespond
+                                     : exception.getErrorCode();
+            pdu =
+                ModbusException(code, request.slaveID(), request.functionCode()).toRaw();
+        } catch (const std::exception &) {
+            failed = true;
+            pdu    = ModbusException(utils::GatewayPathUnavailable, request.slaveID(),
+                                     request.functionCode())
+                      .toRaw();
+        }
+        // Nobody gets the error of broadcast, it is not failure of the device
+        failed = failed && !request.isBroadcast();
+
+        const auto now = Clock::now();
+        lock.lock();
+        line.admission.served(Clock::now() - started);
+        line.metrics.serviceTime = line.admission.metrics().serviceTime;
+        const auto waiters       = std::move(line.current->waiters);
+        line.current.reset();
+        // Before answering, so that metrics already count the answered requests
+        auto &metrics = line.metrics;
+        for (const auto &waiter : waiters) {
+            const auto latency = now - waiter.received;
+            metrics.queueDepth--;
+            metrics.requests++;
+            metrics.failures += failed;
+            metrics.lastLatency = latency;
+            metrics.maxLatency  = std::max(metrics.maxLatency, latency);
+            metrics.totalLatency += latency;
+        }
+        lock.unlock();
+
+        for (const auto &waiter : waiters)
+            answer(waiter, pdu);
+    }
+}
+
+ModbusGateway::Metrics ModbusGateway::metrics(std::size_t line) const {
+    auto &selected = *_lines.at(line);
+    std::lock_guard lock{selected.mutex};
+    return selected.metrics;
+}
@@ -1,9 +1,11 @@
 #include "modbusLog.hpp"
 #include <ctime>
 #include <cstdarg>
+#include <cstdio>
 #include <chrono>
 #include <iostream>
 #include <fstream>
+#include <memory>
 
 
 static const char *kLevelStrings[] = {"Trace",   "Debug", "Info",
@@ -44,7 +46,7 @@ void mblog_printf(mblog_level_t level, const char *tag, const char* format, ...)
     static char message[4096];
     va_list args;
     va_start(args, format);
-    vsprintf_s(message, format, args);
+    vsnprintf(message, sizeof(message), format, args);
     va_end(args);
 
     char datetime_str[64];
@@ -0,0 +1,135 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusPollPlan.hpp"
+#include "modbusException.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace MB;
+
+namespace {
+bool isCoilTable(utils::MBFunctionRegisters table) {
+    return table == utils::OutputCoils || table == utils::InputContacts;
+}
+
+utils::MBFunctionCode readFunction(utils::MBFunctionRegisters table) {
+    switch (table) {
+    case utils::OutputCoils:
+        return utils::ReadDiscreteOutputCoils;
+    case utils::InputContacts:
+        return utils::ReadDiscreteInputContacts;
+    case utils::HoldingRegisters:
+        return utils::ReadAnalogOutputHoldingRegisters;
+    default:
+        return utils::ReadAnalogInputRegisters;
+    }
+}
+
+// Bytes of the transaction, that reads `count` values
+std::size_t cost(const ModbusDeviceLimits &limits, utils::MBFunctionRegisters table,
+                 std::size_t count) {
+    return limits.transactionOverhead +
+           (isCoilTable(table) ? (count + 7) / 8 : count * 2);
+}
+
+// Checks if gap [begin, end) overlaps any forbidden range of the table
+bool isForbidden(const ModbusDeviceLimits &limits, utils::MBFunctionRegisters table,
+                 std::size_t begin, std::size_t end) {
+    return std::any_of(limits.forbidden.begin(), limits.forbidden.end(),
+                       [&](const ModbusDeviceLimits::Range &range) {
+                           return range.table == table && range.address < end &&
+                                  static_cast<std::size_t>(range.address) + range.count >
+                                      begin;
+                       });
+}
+} // namespace
+
+ModbusPollPlan::ModbusPollPlan(std::vector<ModbusTag> tags,
+                               const std::map<uint8_t, ModbusDeviceLimits> &limits)
+    : _tags(std::move(tags)), _placements(_tags.size()) {
+    const ModbusDeviceLimits defaults;
+
+    // Tag indexes by device and table, map keeps requests sorted
+    std::map<std::pair<uint8_t, utils::MBFunctionRegisters>, std::vector<std::size_t>>
+        groups;
+    for (std::size_t i = 0; i < _tags.size(); i++)
+        groups[{_tags[i].slaveId, _tags[i].table}].push_back(i);
+
+    for (auto &[key, indexes] : groups) {
+        const auto [slaveId, table] = key;
+        const auto found            = limits.find(slaveId);
+        const auto &device          = found != limits.end() ? found->second : defaults;
+        const std::size_t maxBlock =
+            isCoilTable(table) ? device.maxCoils : device.maxRegisters;
+
+        std::sort(indexes.begin(), indexes.end(), [this](std::size_t a, std::size_t b) {
+            return _tags[a].address < _tags[b].address;
+        });
+
+        // Current block is [begin, end) and holds tags from `first`
+        std::size_t begin = 0, end = 0, first = 0;
+        const auto flush  = [&](std::size_t last) {
+            for (std::size_t i = first; i < last; i++) {
+                _placements[indexes[i]] = {
+                    _requests.size(),
+                    static_cast<uint16_t>(_tags[indexes[i]].address - begin)};
+            }
+            _requests.emplace_back(slaveId, readFunction(table),
+                                   static_cast<uint16_t>(begin),
+                                   static_cast<uint16_t>(end - begin));
+            _wireBytes += cost(device, table, end - begin);
+        };
+
+        for (std::size_t i = 0; i < indexes.size(); i++) {
+            const auto &tag         = _tags[indexes[i]];
+            const std::size_t start = tag.address;
+            const std::size_t stop  = start + tag.count;
+            if (tag.count == 0 || stop > 0x10000 || tag.count > maxBlock)
+                throw std::invalid_argument("Tag does not fit in a single request");
+
+            if (i != 0) {
+                const auto merged = std::max(end, stop) - begin;
+                const bool fits   = merged <= maxBlock;
+                const bool gap    = start > end;
+                if (fits && (!gap || (!isForbidden(device, table, end, start) &&
+                                      cost(device, table, merged) <=
+                                          cost(device, table, end - begin) +
+                                              cost(device, table, tag.count)))) {
+                    end = std::max(end, stop);
+                    continue;
+                }
+                flush(i);
+            }
+
+            begin = start;
+            end   = stop;
+            first = i;
+        }
+        flush(indexes.size());
+    }
+}
+
+std::vector<std::vector<ModbusCell>>
+ModbusPollPlan::values(const std::vector<ModbusResponse> &responses) const {
+    if (responses.size() != _requests.size())
+        throw ModbusException(utils::NumberOfValuesInvalid);
+
+    std::vector<std::vector<ModbusCell>> result;
+    result.reserve(_tags.size());
+    for (std::size_t i = 0; i < _tags.size(); i++) {
+        const auto &placement = _placements[i];
+        const auto &values    = responses[placement.request].registerValues();
+
+        // Coils may be padded to the whole byte, so there may be more values
+        if (values.size() < _requests[placement.request].numberOfRegisters())
+            throw ModbusException(utils::NumberOfValuesInvalid);
+
+        const auto first = values.begin() + placement.offset;
+        result.emplace_back(first, first + _tags[i].count);
+    }
+    return result;
+}
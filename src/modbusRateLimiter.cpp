@@ -0,0 +1,160 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusRateLimiter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+using namespace MB;
+
+namespace {
+using Clock = ModbusRateLimiter::Clock;
+
+Clock::duration tokensTime(double tokens, Clock::duration interval) {
+    return std::chrono::duration_cast<Clock::duration>(interval * tokens);
+}
+} // namespace
+
+ModbusRateLimiter::Bucket::Bucket(double rate, double burst) {
+    if (rate < 0 || burst < 1)
+        throw std::invalid_argument("Invalid rate limit");
+    if (rate == 0)
+        return;
+
+    _interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / rate));
+    _burst = tokensTime(burst, _interval);
+}
+
+Clock::rep ModbusRateLimiter::Bucket::cost(double tokens) const {
+    // Otherwise it would never fit in the bucket
+    return std::min(tokensTime(tokens, _interval), _burst).count();
+}
+
+std::optional<Clock::duration>
+ModbusRateLimiter::Bucket::take(double tokens, Clock::time_point now,
+                                Clock::duration maxDelay) {
+    if (_interval == Clock::duration::zero())
+        return Clock::duration::zero();
+
+    const auto needed  = cost(tokens);
+    const auto current = now.time_since_epoch().count();
+    auto arrival       = _arrival.load(std::memory_order_relaxed);
+    while (true) {
+        // Bucket is full, when the arrival time is in the past
+        const auto next  = std::max(arrival, current) + needed;
+        const auto delay = std::max<Clock::rep>(next - _burst.count() - current, 0);
+        if (delay > maxDelay.count())
+            return std::nullopt;
+        if (_arrival.compare_exchange_weak(arrival, next, std::memory_order_relaxed))
+            return Clock::duration(delay);
+    }
+}
+
+void ModbusRateLimiter::Bucket::refund(double tokens) {
+    if (_interval != Clock::duration::zero())
+        _arrival.fetch_sub(cost(tokens), std::memory_order_relaxed);
+}
+
+bool ModbusRateLimiter::Bucket::full(Clock::time_point now) const noexcept {
+    return _arrival.load(std::memory_order_relaxed) <= now.time_since_epoch().count();
+}
+
+ModbusRateLimiter::Buckets::Buckets(const Limits &limits)
+    : requests(limits.requestsPerSecond, limits.requestBurst),
+      registers(limits.registersPerSecond, limits.registerBurst) {}
+
+ModbusRateLimiter::ModbusRateLimiter() : ModbusRateLimiter(Settings()) {}
+
+ModbusRateLimiter::ModbusRateLimiter(Settings settings) : _settings(settings) {
+    if (settings.maxDelay < Clock::duration::zero())
+        throw std::invalid_argument("Invalid rate limit");
+    // Validates limits
+    Buckets(settings.connection);
+    Buckets(settings.source);
+}
+
+std::unique_ptr<ModbusRateLimiter::Client>
+ModbusRateLimiter::connect(uint32_t address, Clock::time_point now) {
+    std::lock_guard lock{_mutex};
+    // Sources without connections are forgotten, once they have all tokens
+    for (auto it = _sources.begin(); it != _sources.end();) {
+        const auto &buckets = *it->second;
+        if (it->second.use_count() == 1 && buckets.requests.full(now) &&
+            buckets.registers.full(now))
+            it = _sources.erase(it);
+        else
+            it++;
+    }
+
+    auto &source = _sources[address];
+    if (!source)
+        source = std::make_shared<Buckets>(_settings.source);
+    return std::unique_ptr<Client>(new Client(_settings, source, _counters));
+}
+
+std::size_t ModbusRateLimiter::registers(const ModbusRequest &request) noexcept {
+    const std::size_t count = request.numberOfRegisters();
+
+    const auto table = utils::functionRegister(request.functionCode());
+    const bool coils = table == utils::OutputCoils || table == utils::InputContacts;
+
+    switch (utils::functionType(request.functionCode())) {
+    case utils::Read:
+    case utils::WriteMultiple:
+        return coils ? (count + 15) / 16 : count;
+    case utils::ReadWrite:
+        return count + request.registerValues().size();
+    default:
+        return 1;
+    }
+}
+
+ModbusRateLimiter::Metrics ModbusRateLimiter::metrics() const noexcept {
+    Metrics metrics;
+    metrics.admitted   = _counters->admitted;
+    metrics.delayed    = _counters->delayed;
+    metrics.rejected   = _counters->rejected;
+    metrics.totalDelay = Clock::duration(_counters->delay);
+    return metrics;
+}
+
+ModbusRateLimiter::Client::Client(const Settings &settings,
+                                  std::shared_ptr<Buckets> source,
+                                  std::shared_ptr<Counters> counters)
+    : _maxDelay(settings.maxDelay), _connection(settings.connection),
+      _source(std::move(source)), _counters(std::move(counters)) {}
+
+std::optional<Clock::duration>
+ModbusRateLimiter::Client::acquire(const ModbusRequest &request, Clock::time_point now) {
+    const auto words = static_cast<double>(registers(request));
+    const std::array<std::pair<Bucket *, double>, 4> buckets = {{
+        {&_connection.requests, 1},
+        {&_connection.registers, words},
+        {&_source->requests, 1},
+        {&_source->registers, words},
+    }};
+
+    auto delay = Clock::duration::zero();
+    for (std::size_t i = 0; i < buckets.size(); i++) {
+        const auto wait = buckets[i].first->take(buckets[i].second, now, _maxDelay);
+        if (!wait) {
+            // Request is not handled, so it does not use tokens
+            for (std::size_t j = 0; j < i; j++)
+                buckets[j].first->refund(buckets[j].second);
+            _counters->rejected++;
+            return std::nullopt;
+        }
+        delay = std::max(delay, *wait);
+    }
+
+    _counters->admitted++;
+    if (delay != Clock::duration::zero()) {
+        _counters->delayed++;
+        _counters->delay += delay.count();
+    }
+    return delay;
+}
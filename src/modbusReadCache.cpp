@@ -0,0 +1,238 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusReadCache.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace MB;
+
+namespace {
+bool isCoilTable(utils::MBFunctionRegisters table) {
+    return table == utils::OutputCoils || table == utils::InputContacts;
+}
+} // namespace
+
+uint32_t ModbusReadCache::pageKey(uint8_t slaveId, utils::MBFunctionRegisters table,
+                                  uint16_t address) noexcept {
+    return (static_cast<uint32_t>(slaveId) << 24) | (static_cast<uint32_t>(table) << 16) |
+           (address / PageSize);
+}
+
+void ModbusReadCache::setTtl(uint8_t slaveId, utils::MBFunctionRegisters table,
+                             uint16_t address, std::size_t count, Clock::duration ttl) {
+    if (count == 0 || address + count > 0x10000)
+        throw std::invalid_argument("Invalid cached range");
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto &ranges          = _ttls[{slaveId, table}];
+    const std::size_t end = address + count;
+
+    // Cut the new range out of those it overlaps, keeping their other parts
+    auto overlapped = ranges.lower_bound(address);
+    if (overlapped != ranges.begin()) {
+        const auto previous = std::prev(overlapped);
+        if (previous->first + previous->second.count > address)
+            overlapped = previous;
+    }
+    while (overlapped != ranges.end() && overlapped->first < end) {
+        const auto range = overlapped->second;
+        overlapped       = ranges.erase(overlapped);
+
+        const std::size_t rangeEnd = range.address + range.count;
+        if (range.address < address) {
+            auto head  = range;
+            head.count = address - range.address;
+            ranges.emplace(head.address, head);
+        }
+        if (rangeEnd > end) {
+            auto tail    = range;
+            tail.address = static_cast<uint16_t>(end);
+            tail.count   = rangeEnd - end;
+            ranges.emplace(tail.address, tail);
+        }
+    }
+
+    if (ttl > Clock::duration::zero())
+        ranges.emplace(address, Range{address, count, ttl});
+    if (ranges.empty())
+        _ttls.erase({slaveId, table});
+
+    // Values stored with the previous TTL are read again
+    expire(slaveId, table, address, count, false);
+}
+
+std::vector<ModbusReadCache::Range>
+ModbusReadCache::ranges(uint8_t slaveId, utils::MBFunctionRegisters table) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<Range> result;
+    const auto found = _ttls.find({slaveId, table});
+    if (found != _ttls.end()) {
+        for (const auto &[address, range] : found->second)
+            result.push_back(range);
+    }
+    return result;
+}
+
+std::optional<std::vector<ModbusCell>>
+ModbusReadCache::lookup(uint8_t slaveId, utils::MBFunctionRegisters table,
+                        uint16_t address, std::size_t count, Clock::time_point now) {
+    const bool coils = isCoilTable(table);
+    std::vector<ModbusCell> result;
+    result.reserve(count);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (count == 0 || address + count > 0x10000) {
+        _metrics.misses++;
+        return std::nullopt;
+    }
+
+    // Page by page, so that each page is looked up once
+    for (std::size_t i = 0; i < count;) {
+        const auto current = static_cast<uint16_t>(address + i);
+        const auto page    = _pages.find(pageKey(slaveId, table, current));
+        const auto first   = current % PageSize;
+        const auto last    = std::min(PageSize, first + (count - i));
+
+        if (page == _pages.end()) {
+            _metrics.misses++;
+            return std::nullopt;
+        }
+        for (auto j = first; j < last; j++) {
+            if (page->second.expires[j] <= now) {
+                _metrics.misses++;
+                return std::nullopt;
+            }
+            const auto value = page->second.values[j];
+            result.push_back(coils ? ModbusCell::initCoil(value != 0)
+                                   : ModbusCell::initReg(value));
+        }
+        i += last - first;
+    }
+
+    _metrics.hits++;
+    return result;
+}
+
+ModbusReadCache::Generation ModbusReadCache::generation() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _generation;
+}
+
+void ModbusReadCache::store(uint8_t slaveId, utils::MBFunctionRegisters table,
+                            uint16_t address, const std::vector<ModbusCell> &values,
+                            Generation since, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto ranges = _ttls.find({slaveId, table});
+    if (ranges == _ttls.end() || _cleared > since)
+        return;
+
+    const std::size_t end = address + values.size();
+    for (const auto &[start, range] : ranges->second) {
+        if (start >= end)
+            break;
+        const auto expires     = now + range.ttl;
+        std::size_t current    = std::max<std::size_t>(range.address, address);
+        const std::size_t last = std::min(range.address + range.count, end);
+
+        while (current < last) {
+            const auto key = pageKey(slaveId, table, static_cast<uint16_t>(current));
+            auto page      = _pages.find(key);
+            if (page == _pages.end()) {
+                page = _pages.emplace(key, Page()).first;
+                page->second.expires.fill(Clock::time_point::min());
+            }
+
+            const auto pageEnd = std::min(last, (current / PageSize + 1) * PageSize);
+            // Values may have been written after they were read
+            if (page->second.invalidated > since) {
+                current = pageEnd;
+                continue;
+            }
+            for (; current < pageEnd; current++) {
+                const auto &cell = values[current - address];
+                page->second.values[current % PageSize] =
+                    cell.isCoil() ? cell.coil() : cell.reg();
+                page->second.expires[current % PageSize] = expires;
+            }
+        }
+    }
+}
+
+bool ModbusReadCache::expire(uint8_t slaveId, utils::MBFunctionRegisters table,
+                             uint16_t address, std::size_t count, bool written) {
+    // Values of tables without TTL are never stored
+    written               = written && _ttls.count({slaveId, table}) != 0;
+    const auto generation = ++_generation;
+
+    bool touched           = false;
+    const std::size_t last = std::min<std::size_t>(address + count, 0x10000);
+    for (std::size_t current = address; current < last;) {
+        const auto key     = pageKey(slaveId, table, static_cast<uint16_t>(current));
+        const auto pageEnd = std::min(last, (current / PageSize + 1) * PageSize);
+        auto page          = _pages.find(key);
+        if (page == _pages.end() && written) {
+            page = _pages.emplace(key, Page()).first;
+            page->second.expires.fill(Clock::time_point::min());
+        }
+        if (page == _pages.end()) {
+            current = pageEnd;
+            continue;
+        }
+
+        page->second.invalidated = generation;
+        for (; current < pageEnd; current++) {
+            auto &expires = page->second.expires[current % PageSize];
+            if (expires != Clock::time_point::min())
+                touched = true;
+            expires = Clock::time_point::min();
+        }
+    }
+    return touched;
+}
+
+void ModbusReadCache::invalidate(const ModbusRequest &request) {
+    uint16_t address  = request.registerAddress();
+    std::size_t count = request.numberOfRegisters();
+    switch (utils::functionType(request.functionCode())) {
+    case utils::WriteSingle:
+    case utils::MaskWrite:
+        count = 1;
+        break;
+    case utils::WriteMultiple:
+        break;
+    case utils::ReadWrite:
+        address = request.writeRegisterAddress();
+        count   = request.registerValues().size();
+        break;
+    default:
+        return;
+    }
+    const auto table = utils::functionRegister(request.functionCode());
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool touched = false;
+    if (!request.isBroadcast()) {
+        touched = expire(request.slaveID(), table, address, count, true);
+    } else {
+        // Broadcast writes to all devices, that have the table cached
+        for (const auto &[key, ranges] : _ttls) {
+            if (key.second == table)
+                touched |= expire(key.first, table, address, count, true);
+        }
+    }
+    _metrics.invalidations += touched;
+}
+
+void ModbusReadCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pages.clear();
+    _cleared = ++_generation;
+}
+
+ModbusReadCache::Metrics ModbusReadCache::metrics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _metrics;
+}
@@ -36,14 +36,19 @@ ModbusRequest::ModbusRequest(const ModbusRequest &reference)
     : _slaveID(reference.slaveID()), _functionCode(reference.functionCode()),
       _address(reference.registerAddress()),
       _registersNumber(reference.numberOfRegisters()),
-      _values(reference.registerValues()) {}
+      _writeAddress(reference.writeRegisterAddress()),
+      _values(reference.registerValues()), _fileRecords(reference.fileRecords()),
+      _deviceIdentification(reference.deviceIdentification()) {}
 
 ModbusRequest &ModbusRequest::operator=(const ModbusRequest &reference) {
     this->_slaveID         = reference.slaveID();
     this->_functionCode    = reference.functionCode();
     this->_address         = reference.registerAddress();
     this->_registersNumber = reference.numberOfRegisters();
+    this->_writeAddress    = reference.writeRegisterAddress();
     this->_values          = reference.registerValues();
+    this->_fileRecords     = reference.fileRecords();
+    this->_deviceIdentification = reference.deviceIdentification();
     return *this;
 }
 
@@ -57,7 +62,8 @@ ModbusRequest::ModbusRequest(const std::vector<uint8_t> &inputData, bool CRC) {
         _address      = utils::bigEndianConv(&inputData[2]);
 
         int crcIndex = -1;
-        int8_t follow;
+        uint8_t follow;
+        uint16_t writeNumber;
 
         switch (_functionCode) {
         case utils::ReadDiscreteOutputCoils:
@@ -82,7 +88,7 @@ ModbusRequest::ModbusRequest(const std::vector<uint8_t> &inputData, bool CRC) {
             _registersNumber = utils::bigEndianConv(&inputData[4]);
             follow           = inputData[6];
             _values          = std::vector<ModbusCell>(_registersNumber);
-            for (int8_t i = 0; i < _registersNumber; i++) {
+            for (uint16_t i = 0; i < _registersNumber; i++) {
                 _values[i].coil() = inputData[7 + (i / 8)] & (1 << (i % 8));
             }
             crcIndex = 6 + follow + 1;
@@ -91,16 +97,71 @@ ModbusRequest::ModbusRequest(const std::vector<uint8_t> &inputData, bool CRC) {
             _registersNumber = utils::bigEndianConv(&inputData[4]);
             follow           = inputData[6];
             _values          = std::vector<ModbusCell>(_registersNumber);
-            for (int8_t i = 0; i < _registersNumber; i++) {
+            for (uint16_t i = 0; i < _registersNumber; i++) {
                 _values[i].reg() = utils::bigEndianConv(&inputData[i * 2 + 7]);
             }
             crcIndex = 6 + follow + 1;
             break;
+        case utils::ReadFileRecord:
+        case utils::WriteFileRecord:
+            // Byte count and sub-requests, there is no address
+            _address     = 0;
+            _fileRecords = _functionCode == utils::ReadFileRecord
+                               ? fileRecord::decodeReadRequest(&inputData[2],
+                                                               inputData.size() - 2)
+                               : fileRecord::decodeWrite(&inputData[2],
+                                                         inputData.size() - 2);
+            _registersNumber = static_cast<uint16_t>(_fileRecords.size());
+            _values          = {};
+            crcIndex         = 3 + inputData[2];
+            break;
+        case utils::ReadDeviceIdentification:
+            _address              = 0;
+            _registersNumber      = 0;
+            _values               = {};
+            _deviceIdentification = deviceId::decodeRequest(&inputData[2],
+                                                            inputData.size() - 2);
+            crcIndex              = 5;
+            break;
+        case utils::ReadFIFOQueue:
+            // Only the FIFO pointer address
+            _registersNumber = 0;
+            _values          = {};
+            crcIndex         = 4;
+            break;
+        case utils::MaskWriteRegister:
+            // Address, AND mask and OR mask
+            if (inputData.size() < 8)
+                throw ModbusException(utils::InvalidByteOrder);
+            _registersNumber = 1;
+            _values          = {ModbusCell::initReg(utils::bigEndianConv(&inputData[4])),
+                                ModbusCell::initReg(utils::bigEndianConv(&inputData[6]))};
+            crcIndex         = 8;
+            break;
+        case utils::ReadWriteMultipleRegisters:
+            // Read address and quantity, then write address, quantity and values
+            if (inputData.size() < 11)
+                throw ModbusException(utils::InvalidByteOrder);
+            _registersNumber = utils::bigEndianConv(&inputData[4]);
+            _writeAddress    = utils::bigEndianConv(&inputData[6]);
+            writeNumber      = utils::bigEndianConv(&inputData[8]);
+            follow           = inputData[10];
+            if (follow != writeNumber * 2 || inputData.size() < 11u + follow)
+                throw ModbusException(utils::InvalidByteOrder);
+            _values = {};
+            for (uint16_t i = 0; i < writeNumber; i++) {
+                _values.emplace_back(utils::bigEndianConv(&inputData[i * 2 + 11]));
+            }
+            crcIndex = 11 + follow;
+            break;
         default:
             throw ModbusException(utils::InvalidByteOrder);
         }
 
-        _values.resize(_registersNumber);
+        if (_functionCode != utils::ReadWriteMultipleRegisters &&
+            _functionCode != utils::MaskWriteRegister &&
+            functionType() != utils::FileRecord)
+            _values.resize(_registersNumber);
 
         if (CRC) {
             if (crcIndex == -1 || static_cast<size_t>(crcIndex) + 2 > inputData.size())
@@ -128,10 +189,33 @@ std::string ModbusRequest::toString() const noexcept {
     result << utils::mbFunctionToStr(_functionCode)
            << ", from slave " + std::to_string(_slaveID);
 
-    if (functionType() != utils::WriteSingle) {
+    if (functionType() == utils::DeviceIdentification) {
+        result << ", read device id code " +
+                      std::to_string(_deviceIdentification.readCode) +
+                      ", from object " + std::to_string(_deviceIdentification.objectId);
+    } else if (functionType() == utils::FileRecord) {
+        for (const auto &record : _fileRecords) {
+            result << "\n file " + std::to_string(record.fileNumber) + ", records " +
+                          std::to_string(record.recordNumber) + " - " +
+                          std::to_string(record.recordNumber + record.recordLength);
+        }
+    } else if (functionType() == utils::ReadFIFO) {
+        result << ", FIFO pointer address " + std::to_string(_address);
+    } else if (functionType() == utils::MaskWrite) {
+        result << ", on address " + std::to_string(_address);
+        if (_values.size() == 2) {
+            result << "\nAND mask = " + _values[0].toString()
+                   << ", OR mask = " + _values[1].toString();
+        }
+    } else if (functionType() != utils::WriteSingle) {
         result << ", starting from address " + std::to_string(_address)
                << ", on " + std::to_string(_registersNumber) + " registers";
-        if (functionType() == utils::WriteMultiple) {
+        if (functionType() == utils::ReadWrite) {
+            result << ", writing " + std::to_string(_values.size()) +
+                          " registers from address " + std::to_string(_writeAddress);
+        }
+        if (functionType() == utils::WriteMultiple ||
+            functionType() == utils::ReadWrite) {
             result << "\n values = { ";
             for (std::size_t i = 0; i < _values.size(); i++) {
                 result << _values[i].toString() + " , ";
@@ -156,8 +240,52 @@ std::vector<uint8_t> ModbusRequest::toRaw() const {
 
     result.push_back(_slaveID);
     result.push_back(_functionCode);
+
+    if (_functionCode == utils::ReadDeviceIdentification) {
+        deviceId::encodeRequest(result, _deviceIdentification);
+        return result;
+    } else if (_functionCode == utils::ReadFileRecord) {
+        fileRecord::encodeReadRequest(result, _fileRecords);
+        return result;
+    } else if (_functionCode == utils::WriteFileRecord) {
+        fileRecord::encodeWrite(result, _fileRecords);
+        return result;
+    }
+
     utils::pushUint16(result, _address);
 
+    if (_functionCode == utils::ReadFIFOQueue)
+        return result;
+
+    if (_functionCode == utils::ReadWriteMultipleRegisters) {
+        // Byte count of written values has to fit in one byte
+        if (_registersNumber == 0 || _registersNumber > utils::MaxReadRegisters)
+            throw ModbusException(utils::NumberOfRegistersInvalid);
+        if (_values.empty() || _values.size() > utils::MaxReadWriteRegisters)
+            throw ModbusException(utils::NumberOfValuesInvalid);
+
+        utils::pushUint16(result, _registersNumber);
+        utils::pushUint16(result, _writeAddress);
+        utils::pushUint16(result, static_cast<uint16_t>(_values.size()));
+        result.push_back(static_cast<uint8_t>(_values.size() * 2));
+        for (auto value : _values) {
+            utils::pushUint16(result, value.reg());
+        }
+        return result;
+    }
+
+    if (_functionCode == utils::MaskWriteRegister) {
+        if (_values.size() != 2)
+            throw ModbusException(utils::NumberOfValuesInvalid);
+        utils::pushUint16(result, _values[0].reg());
+        utils::pushUint16(result, _values[1].reg());
+        return result;
+    }
+
+    if (_registersNumber > utils::maxRegistersNumber(_functionCode)) {
+        throw ModbusException(utils::NumberOfRegistersInvalid);
+    }
+
     if (this->functionType() == utils::WriteMultiple) {
         // note: it is assumbed here, that number of registers is the "correct" one
         if (this->numberOfRegisters() != this->registerValues().size()) {
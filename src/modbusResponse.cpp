@@ -35,15 +35,18 @@ ModbusResponse::ModbusResponse(uint8_t slaveId, utils::MBFunctionCode functionCo
 ModbusResponse::ModbusResponse(const ModbusResponse &reference)
     : _slaveID(reference.slaveID()), _functionCode(reference.functionCode()),
       _address(reference.registerAddress()),
-      _registersNumber(reference.numberOfRegisters()),
-      _values(reference.registerValues()) {}
+      _registersNumber(reference.numberOfRegisters()), _values(reference._values),
+      _fileRecords(reference._fileRecords),
+      _deviceIdentification(reference._deviceIdentification) {}
 
 ModbusResponse &ModbusResponse::operator=(const ModbusResponse &reference) {
     this->_slaveID         = reference.slaveID();
     this->_functionCode    = reference.functionCode();
     this->_address         = reference.registerAddress();
     this->_registersNumber = reference.numberOfRegisters();
-    this->_values          = reference.registerValues();
+    this->_values          = reference._values;
+    this->_fileRecords     = reference._fileRecords;
+    this->_deviceIdentification = reference._deviceIdentification;
     return *this;
 }
 
@@ -55,11 +58,15 @@ ModbusResponse::ModbusResponse(std::vector<uint8_t> inputData, bool CRC) {
         _slaveID      = inputData[0];
         _functionCode = static_cast<utils::MBFunctionCode>(inputData[1]);
 
-        if (functionType() != utils::Read)
+        if (functionType() != utils::Read && functionType() != utils::ReadWrite &&
+            functionType() != utils::ReadFIFO && functionType() != utils::FileRecord &&
+            functionType() != utils::DeviceIdentification)
             _address = utils::bigEndianConv(&inputData[2]);
 
         int crcIndex = -1;
         uint8_t bytes;
+        uint16_t fifoBytes;
+        std::size_t consumed;
 
         switch (_functionCode) {
         case utils::ReadDiscreteOutputCoils:
@@ -74,6 +81,7 @@ ModbusResponse::ModbusResponse(std::vector<uint8_t> inputData, bool CRC) {
             break;
         case utils::ReadAnalogOutputHoldingRegisters:
         case utils::ReadAnalogInputRegisters:
+        case utils::ReadWriteMultipleRegisters:
             bytes            = inputData[2];
             _registersNumber = bytes / 2;
             for (auto i = 0; i < bytes / 2; i++) {
@@ -99,11 +107,59 @@ ModbusResponse::ModbusResponse(std::vector<uint8_t> inputData, bool CRC) {
             _registersNumber = utils::bigEndianConv(&inputData[4]);
             crcIndex         = 6;
             break;
+        case utils::ReadDeviceIdentification:
+            _address              = 0;
+            _deviceIdentification = deviceId::decodeResponse(
+                &inputData[2], inputData.size() - 2, consumed);
+            _registersNumber =
+                static_cast<uint16_t>(_deviceIdentification.objects.size());
+            crcIndex = static_cast<int>(2 + consumed);
+            break;
+        case utils::ReadFileRecord:
+        case utils::WriteFileRecord:
+            // Write response is the echo of the request
+            _address     = 0;
+            _fileRecords = _functionCode == utils::ReadFileRecord
+                               ? fileRecord::decodeReadResponse(&inputData[2],
+                                                                inputData.size() - 2)
+                               : fileRecord::decodeWrite(&inputData[2],
+                                                         inputData.size() - 2);
+            _registersNumber = static_cast<uint16_t>(_fileRecords.size());
+            crcIndex         = 3 + inputData[2];
+            break;
+        case utils::ReadFIFOQueue:
+            // Byte count and FIFO count are both 16 bit
+            if (inputData.size() < 6)
+                throw ModbusException(utils::InvalidByteOrder);
+            fifoBytes        = utils::bigEndianConv(&inputData[2]);
+            _registersNumber = utils::bigEndianConv(&inputData[4]);
+            if (_registersNumber > utils::MaxFIFOCount ||
+                fifoBytes != 2 + _registersNumber * 2 ||
+                inputData.size() < 4u + fifoBytes)
+                throw ModbusException(utils::InvalidByteOrder);
+            _values = {};
+            for (uint16_t i = 0; i < _registersNumber; i++) {
+                _values.emplace_back(utils::bigEndianConv(&inputData[6 + (i * 2)]));
+            }
+            crcIndex = 4 + fifoBytes;
+            break;
+        case utils::MaskWriteRegister:
+            // Echo of the request
+            if (inputData.size() < 8)
+                throw ModbusException(utils::InvalidByteOrder);
+            _registersNumber = 1;
+            _values          = {ModbusCell::initReg(utils::bigEndianConv(&inputData[4])),
+                                ModbusCell::initReg(utils::bigEndianConv(&inputData[6]))};
+            crcIndex         = 8;
+            break;
         default:
             throw ModbusException(utils::InvalidByteOrder);
         }
 
-        _values.resize(_registersNumber);
+        if (_functionCode != utils::MaskWriteRegister &&
+            functionType() != utils::FileRecord &&
+            functionType() != utils::DeviceIdentification)
+            _values.resize(_registersNumber);
 
         if (CRC) {
             if (crcIndex == -1 || static_cast<size_t>(crcIndex) + 2 > inputData.size())
@@ -132,7 +188,39 @@ std::string ModbusResponse::toString() const {
     result << utils::mbFunctionToStr(_functionCode)
            << ", from slave " + std::to_string(_slaveID);
 
-    if (functionType() != utils::WriteSingle) {
+    if (functionType() == utils::DeviceIdentification) {
+        for (const auto &[id, value] : _deviceIdentification.objects)
+            result << "\n object " + std::to_string(id) + " = " + value;
+        if (_deviceIdentification.moreFollows)
+            result << "\n more follows from object " +
+                          std::to_string(_deviceIdentification.objectId);
+    } else if (functionType() == utils::FileRecord) {
+        for (const auto &record : _fileRecords) {
+            result << "\n " + std::to_string(record.recordLength) + " records";
+            if (_functionCode == utils::WriteFileRecord)
+                result << " of file " + std::to_string(record.fileNumber) +
+                              " from record " + std::to_string(record.recordNumber);
+        }
+    } else if (functionType() == utils::ReadFIFO) {
+        result << ", " + std::to_string(_registersNumber) + " values in FIFO";
+        if (!_values.empty()) {
+            result << "\n values = { ";
+            for (std::size_t i = 0; i < _values.size(); i++) {
+                result << _values[i].toString() + " , ";
+                if (i >= 3) {
+                    result << " , ... ";
+                    break;
+                }
+            }
+            result << "}";
+        }
+    } else if (functionType() == utils::MaskWrite) {
+        result << ", on address " + std::to_string(_address);
+        if (_values.size() == 2) {
+            result << "\nAND mask = " + _values[0].toString()
+                   << ", OR mask = " + _values[1].toString();
+        }
+    } else if (functionType() != utils::WriteSingle) {
         result << ", starting from address " + std::to_string(_address)
                << ", on " + std::to_string(_registersNumber) + " registers";
         if (functionType() == utils::WriteMultiple) {
@@ -155,6 +243,40 @@ std::string ModbusResponse::toString() const {
 }
 
 std::vector<uint8_t> ModbusResponse::toRaw() const {
+    if (functionType() == utils::DeviceIdentification) {
+        std::vector<uint8_t> result = {_slaveID, _functionCode};
+        deviceId::encodeResponse(result, _deviceIdentification);
+        return result;
+    }
+
+    if (functionType() == utils::FileRecord) {
+        std::vector<uint8_t> result = {_slaveID, _functionCode};
+        if (_functionCode == utils::ReadFileRecord)
+            fileRecord::encodeReadResponse(result, _fileRecords);
+        else
+            fileRecord::encodeWrite(result, _fileRecords);
+        return result;
+    }
+
+    if (functionType() == utils::ReadFIFO) {
+        // FIFO may be empty, so values are not accessed through registerValues
+        if (_registersNumber > utils::MaxFIFOCount)
+            throw ModbusException(utils::NumberOfRegistersInvalid);
+        if (_values.size() != _registersNumber)
+            throw ModbusException(utils::NumberOfValuesInvalid);
+
+        std::vector<uint8_t> result;
+        result.reserve(6 + _values.size() * 2);
+        result.push_back(_slaveID);
+        result.push_back(_functionCode);
+        utils::pushUint16(result, numberOfBytesToFollow());
+        utils::pushUint16(result, _registersNumber);
+        for (auto value : _values) {
+            utils::pushUint16(result, value.reg());
+        }
+        return result;
+    }
+
     // Fix for: https://github.com/Mazurel/Modbus/issues/3
     const auto longBytesToFollow = this->numberOfBytesToFollow();
     if (longBytesToFollow > 0xFF) {
@@ -168,7 +290,7 @@ std::vector<uint8_t> ModbusResponse::toRaw() const {
     result.push_back(_slaveID);
     result.push_back(_functionCode);
 
-    if (functionType() == utils::Read) {
+    if (functionType() == utils::Read || functionType() == utils::ReadWrite) {
         if (_values[0].isCoil()) {
             result.push_back(bytesToFollow); // number of bytes to follow
             auto end = result.size() - 1;
@@ -188,7 +310,12 @@ std::vector<uint8_t> ModbusResponse::toRaw() const {
     } else {
         utils::pushUint16(result, _address);
 
-        if (functionType() == utils::WriteSingle) {
+        if (functionType() == utils::MaskWrite) {
+            if (_values.size() != 2)
+                throw ModbusException(utils::NumberOfValuesInvalid);
+            utils::pushUint16(result, _values[0].reg());
+            utils::pushUint16(result, _values[1].reg());
+        } else if (functionType() == utils::WriteSingle) {
             if (_values[0].isCoil()) {
                 result.push_back(_values[0].coil() ? 0xFF : 0x00);
                 result.push_back(0x00);
@@ -196,7 +323,7 @@ std::vector<uint8_t> ModbusResponse::toRaw() const {
                 utils::pushUint16(result, _values[0].reg());
             }
         } else {
-            utils::pushUint16(result, bytesToFollow);
+            utils::pushUint16(result, _registersNumber);
         }
     }
 
@@ -0,0 +1,118 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusScanScheduler.hpp"
+
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+using namespace MB;
+
+ModbusScanScheduler::ModbusScanScheduler(Clock::duration tick,
+                                         std::function<Clock::time_point()> clock)
+    : _clock(std::move(clock)), _wheel(tick, _clock()) {}
+
+ModbusScanScheduler::GroupId ModbusScanScheduler::add(Group group) {
+    if (group.period <= Clock::duration::zero() || !group.scan)
+        throw std::invalid_argument("Poll group needs positive period and scan");
+    if (group.deadline <= Clock::duration::zero())
+        group.deadline = group.period;
+
+    const auto id        = _nextId++;
+    const auto scheduled = _clock() + group.phase;
+    const auto timer     = _wheel.schedule(scheduled, static_cast<std::size_t>(id));
+    _groups.emplace(id, Entry{std::move(group), scheduled, timer, Statistics()});
+    return id;
+}
+
+bool ModbusScanScheduler::remove(GroupId id) {
+    const auto entry = _groups.find(id);
+    if (entry == _groups.end())
+        return false;
+
+    // Scan that is running is removed when it returns
+    if (_running && id == _runningId) {
+        _removeRunning = true;
+        return true;
+    }
+
+    _wheel.cancel(entry->second.timer);
+    _groups.erase(entry);
+    return true;
+}
+
+bool ModbusScanScheduler::runScan(GroupId id) {
+    const auto found = _groups.find(id);
+    if (found == _groups.end())
+        return false;
+    auto &entry = found->second;
+    auto &stats = entry.statistics;
+
+    const auto start = _clock();
+    _running         = true;
+    _runningId       = id;
+    try {
+        entry.group.scan();
+    } catch (...) {
+        // Whatever it throws, the scan must not stay marked as running
+        stats.failures++;
+    }
+    _running       = false;
+    const auto end = _clock();
+
+    if (_removeRunning) {
+        _removeRunning = false;
+        _groups.erase(id);
+        return true;
+    }
+
+    const auto scanTime = end - start;
+    const auto jitter   = start - entry.scheduled;
+    stats.scans++;
+    stats.lastScanTime = scanTime;
+    stats.totalScanTime += scanTime;
+    if (scanTime > stats.maxScanTime)
+        stats.maxScanTime = scanTime;
+    stats.totalJitter += jitter;
+    if (jitter > stats.maxJitter)
+        stats.maxJitter = jitter;
+    if (end > entry.scheduled + entry.group.deadline)
+        stats.late++;
+
+    // Next start stays on the grid, starts that already passed are skipped
+    const auto period = entry.group.period;
+    auto next         = entry.scheduled + period;
+    if (end > next) {
+        const auto passed =
+            (end - entry.scheduled + period - Clock::duration(1)) / period;
+        stats.overruns++;
+        stats.skipped += static_cast<uint64_t>(passed - 1);
+        next = entry.scheduled + period * passed;
+    }
+
+    entry.scheduled = next;
+    entry.timer     = _wheel.schedule(next, static_cast<std::size_t>(id));
+    return true;
+}
+
+std::size_t ModbusScanScheduler::runDue() {
+    _due.clear();
+    _wheel.advance(_clock(), [this](std::size_t id) { _due.push_back(id); });
+
+    std::size_t scans = 0;
+    for (const auto id : _due) {
+        if (runScan(id))
+            scans++;
+    }
+    return scans;
+}
+
+void ModbusScanScheduler::run(const std::atomic<bool> &stop) {
+    while (!stop) {
+        if (runDue() == 0)
+            std::this_thread::sleep_for(_wheel.tick());
+    }
+}
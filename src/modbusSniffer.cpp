@@ -0,0 +1,186 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusSniffer.hpp"
+#include "crc.hpp"
+#include "modbusException.hpp"
+#include "modbusFraming.hpp"
+
+#include <algorithm>
+
+using namespace MB;
+
+namespace {
+// Checks candidate of the given predicted length, sets `waiting` if candidate
+// may still be valid, but its bytes were not fed yet
+bool candidateValid(const std::optional<std::size_t> &length, const uint8_t *data,
+                    std::size_t available, bool &waiting) {
+    if (!length.has_value() || *length > ModbusSniffer::MaxFrameSize ||
+        *length < ModbusSniffer::MinFrameSize)
+        return false;
+
+    if (*length > available) {
+        waiting = true;
+        return false;
+    }
+
+    // CRC is sent low byte first
+    const auto crc = static_cast<uint16_t>(data[*length - 2] | (data[*length - 1] << 8));
+    return CRC::calculateCRC(data, *length - framing::CRCSize) == crc;
+}
+
+bool knownException(const uint8_t *data) {
+    if (!(data[1] & 0b10000000))
+        return true;
+
+    // Exception can only be answered to the function that exists
+    const uint8_t request[] = {data[0], static_cast<uint8_t>(data[1] & 0b01111111)};
+    return framing::rtuRequestLength(request, sizeof(request)).has_value();
+}
+} // namespace
+
+ModbusRequest ModbusSniffer::Transaction::decodeRequest() const {
+    if (!request.has_value())
+        throw ModbusException(utils::ProtocolError);
+
+    return ModbusRequest::fromRawCRC(request->raw());
+}
+
+ModbusResponse ModbusSniffer::Transaction::decodeResponse() const {
+    if (!response.has_value())
+        throw ModbusException(utils::ProtocolError);
+
+    const auto raw = response->raw();
+    if (ModbusException::exist(raw))
+        throw ModbusException(raw, true);
+
+    return ModbusResponse::fromRawCRC(raw);
+}
+
+ModbusSniffer::ModbusSniffer(Callback callback) : _callback(std::move(callback)) {
+    _buffer.reserve(4 * MaxFrameSize);
+}
+
+void ModbusSniffer::feed(const uint8_t *data, std::size_t size, Timestamp timestamp) {
+    if (size == 0)
+        return;
+
+    // Consumed bytes are dropped in batches, so that long captures do not
+    // move the buffer on every frame
+    if (_offset > MaxFrameSize && _offset * 2 > _buffer.size()) {
+        _buffer.erase(_buffer.begin(), _buffer.begin() + _offset);
+        _consumed += _offset;
+        _offset = 0;
+    }
+
+    _chunks.emplace_back(_consumed + _buffer.size(), timestamp);
+    _buffer.insert(_buffer.end(), data, data + size);
+
+    scan(false);
+}
+
+void ModbusSniffer::finish() {
+    scan(true);
+
+    _statistics.discardedBytes += _buffer.size() - _offset;
+    _consumed += _buffer.size();
+    _buffer.clear();
+    _offset = 0;
+    _chunks.clear();
+
+    if (_pending.has_value()) {
+        emit({_pending, std::nullopt});
+        _pending.reset();
+    }
+}
+
+void ModbusSniffer::scan(bool flush) {
+    while (_buffer.size() - _offset >= MinFrameSize) {
+        const uint8_t *data   = _buffer.data() + _offset;
+        const auto available  = _buffer.size() - _offset;
+        const auto slaveValid = data[0] <= MaxSlaveID;
+
+        bool waiting    = false;
+        bool isRequest  = false;
+        bool isResponse = false;
+        std::optional<std::size_t> requestLength;
+        std::optional<std::size_t> responseLength;
+
+        if (slaveValid) {
+            requestLength = framing::rtuRequestLength(data, available);
+            isRequest     = candidateValid(requestLength, data, available, waiting);
+
+            // Broadcasts are never answered
+            if (data[0] != utils::BroadcastSlaveID && knownException(data)) {
+                responseLength = framing::rtuResponseLength(data, available);
+                isResponse = candidateValid(responseLength, data, available, waiting);
+            }
+        }
+
+        if (!isRequest && !isResponse) {
+            if (waiting && !flush)
+                return;
+
+            // Not a frame start, next byte is the next candidate
+            _offset++;
+            _statistics.discardedBytes++;
+            continue;
+        }
+
+        // Single writes are echoed, so the same bytes are valid in both
+        // directions, they answer the pending request if it matches
+        if (isRequest && isResponse)
+            isRequest = !(_pending.has_value() && _pending->slaveID() == data[0] &&
+                          _pending->functionCode() == data[1]);
+
+        const auto length = isRequest ? *requestLength : *responseLength;
+        onFrame(data, length, isRequest);
+        _offset += length;
+    }
+}
+
+void ModbusSniffer::onFrame(const uint8_t *data, std::size_t size, bool isRequest) {
+    Frame frame;
+    frame.timestamp = timestampAt(_consumed + _offset);
+    frame.size      = size;
+    std::copy(data, data + size, frame.data.begin());
+    _statistics.frames++;
+
+    if (isRequest) {
+        // Previous request was left without an answer
+        if (_pending.has_value())
+            emit({_pending, std::nullopt});
+
+        _pending.reset();
+        if (frame.slaveID() == utils::BroadcastSlaveID)
+            emit({frame, std::nullopt});
+        else
+            _pending = frame;
+        return;
+    }
+
+    if (_pending.has_value() && _pending->slaveID() == frame.slaveID() &&
+        _pending->functionCode() == (frame.functionCode() & 0b01111111)) {
+        emit({_pending, frame});
+        _pending.reset();
+        return;
+    }
+
+    // Decoder locked in the middle of transaction
+    emit({std::nullopt, frame});
+}
+
+void ModbusSniffer::emit(const Transaction &transaction) {
+    _statistics.transactions++;
+    if (_callback)
+        _callback(transaction);
+}
+
+ModbusSniffer::Timestamp ModbusSniffer::timestampAt(std::size_t position) {
+    // Chunks before the one that contains position are not needed anymore
+    while (_chunks.size() > 1 && _chunks[1].first <= position)
+        _chunks.pop_front();
+
+    return _chunks.front().second;
+}
@@ -0,0 +1,146 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusTimerWheel.hpp"
+
+#include <stdexcept>
+
+using namespace MB;
+
+ModbusTimerWheel::ModbusTimerWheel(Clock::duration tick, Clock::time_point start)
+    : _tick(tick), _start(start) {
+    if (tick <= Clock::duration::zero())
+        throw std::invalid_argument("Timer wheel tick must be positive");
+    _heads.fill(None);
+}
+
+void ModbusTimerWheel::link(uint32_t index) {
+    auto &node        = _nodes[index];
+    const auto delta  = node.expiry - _current;
+    std::size_t level = 0;
+    while (level < Levels - 1 && delta >> (SlotsBits * (level + 1)) != 0)
+        level++;
+
+    std::size_t slot;
+    if (delta >> (SlotsBits * (level + 1)) != 0) {
+        // Beyond the last wheel, waits in its farthest slot and is placed again
+        slot = ((_current >> (SlotsBits * level)) + Slots - 1) % Slots;
+    } else {
+        slot = (node.expiry >> (SlotsBits * level)) % Slots;
+    }
+
+    node.slot     = static_cast<uint16_t>(level * Slots + slot);
+    node.previous = None;
+    node.next     = _heads[node.slot];
+    if (node.next != None)
+        _nodes[node.next].previous = index;
+    _heads[node.slot] = index;
+}
+
+void ModbusTimerWheel::unlink(uint32_t index) {
+    auto &node = _nodes[index];
+    if (node.previous != None)
+        _nodes[node.previous].next = node.next;
+    else
+        _heads[node.slot] = node.next;
+    if (node.next != None)
+        _nodes[node.next].previous = node.previous;
+}
+
+void ModbusTimerWheel::release(uint32_t index) {
+    unlink(index);
+    _nodes[index].active = false;
+    _nodes[index].generation++;
+    _free.push_back(index);
+    _size--;
+}
+
+void ModbusTimerWheel::cascade(std::size_t level) {
+    const auto slot = level * Slots + (_current >> (SlotsBits * level)) % Slots;
+    auto index      = _heads[slot];
+    _heads[slot]    = None;
+    while (index != None) {
+        const auto next = _nodes[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+ModbusTimerWheel::TimerId ModbusTimerWheel::schedule(Clock::time_point deadline,
+                                                     std::size_t payload) {
+    uint64_t expiry = 0;
+    if (deadline > _start) {
+        const auto ticks = (deadline - _start + _tick - Clock::duration(1)) / _tick;
+        expiry           = static_cast<uint64_t>(ticks);
+    }
+    if (expiry <= _current)
+        expiry = _current + 1;
+
+    uint32_t index;
+    if (!_free.empty()) {
+        index = _free.back();
+        _free.pop_back();
+    } else {
+        if (_nodes.size() >= None)
+            throw std::length_error("Too many timers");
+        index = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+    }
+
+    auto &node   = _nodes[index];
+    node.expiry  = expiry;
+    node.payload = payload;
+    node.active  = true;
+    link(index);
+    _size++;
+
+    return (static_cast<TimerId>(node.generation) << 32) | index;
+}
+
+bool ModbusTimerWheel::cancel(TimerId id) noexcept {
+    const auto index = static_cast<uint32_t>(id);
+    if (index >= _nodes.size())
+        return false;
+
+    auto &node = _nodes[index];
+    if (!node.active || node.generation != static_cast<uint32_t>(id >> 32))
+        return false;
+
+    release(index);
+    return true;
+}
+
+void ModbusTimerWheel::advance(Clock::time_point now,
+                               const std::function<void(std::size_t)> &expired) {
+    if (now <= _start)
+        return;
+    const auto target = static_cast<uint64_t>((now - _start) / _tick);
+
+    while (_current < target) {
+        // Nothing to expire, jump straight to the target
+        if (_size == 0) {
+            _current = target;
+            break;
+        }
+        _current++;
+
+        // Timers of the higher wheels move down, the highest one first
+        std::size_t level = 0;
+        while (level < Levels - 1 &&
+               (_current & ((uint64_t(1) << (SlotsBits * (level + 1))) - 1)) == 0)
+            level++;
+        for (; level > 0; level--)
+            cascade(level);
+
+        // Callback may cancel other timers of the slot, so they are taken
+        // one by one
+        const auto slot = _current % Slots;
+        while (_heads[slot] != None) {
+            const auto index   = _heads[slot];
+            const auto payload = _nodes[index].payload;
+            release(index);
+            expired(payload);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusTransactionQueue.hpp"
+
+#include <algorithm>
+
+using namespace MB;
+
+std::future<ModbusResponse> ModbusTransactionQueue::push(const ModbusRequest &request,
+                                                         ModbusPriority priority,
+                                                         Clock::time_point now) {
+    const auto index = static_cast<std::size_t>(priority);
+
+    auto &transaction = _queues[index].emplace_back(
+        Transaction{request, priority, now, std::promise<ModbusResponse>()});
+    _metrics[index].queueDepth++;
+
+    return transaction.promise.get_future();
+}
+
+std::optional<ModbusTransactionQueue::Transaction>
+ModbusTransactionQueue::pop(Clock::time_point now) {
+    std::optional<std::size_t> best;
+    std::size_t bestLevel = 0;
+
+    for (std::size_t i = 0; i < PriorityCount; i++) {
+        if (_queues[i].empty())
+            continue;
+
+        // Only the head can be promoted, as it is the oldest one in the class
+        const auto wait   = now - _queues[i].front().enqueuedAt;
+        std::size_t steps = PriorityCount;
+        if (_agingStep > Clock::duration::zero())
+            steps = static_cast<std::size_t>(std::max<Clock::rep>(wait / _agingStep, 0));
+        const auto level = i > steps ? i - steps : 0;
+
+        // On equal level, the older transaction wins - that prevents starvation
+        if (!best.has_value() || level < bestLevel ||
+            (level == bestLevel &&
+             _queues[i].front().enqueuedAt < _queues[*best].front().enqueuedAt)) {
+            best      = i;
+            bestLevel = level;
+        }
+    }
+
+    if (!best.has_value())
+        return std::nullopt;
+
+    auto transaction = std::move(_queues[*best].front());
+    _queues[*best].pop_front();
+
+    auto &metrics   = _metrics[*best];
+    const auto wait = now - transaction.enqueuedAt;
+    metrics.queueDepth--;
+    metrics.dispatched++;
+    metrics.totalWait += wait;
+    metrics.maxWait = std::max(metrics.maxWait, wait);
+
+    return transaction;
+}
+
+bool ModbusTransactionQueue::empty() const noexcept { return size() == 0; }
+
+std::size_t ModbusTransactionQueue::size() const noexcept {
+    std::size_t result = 0;
+    for (const auto &queue : _queues)
+        result += queue.size();
+    return result;
+}
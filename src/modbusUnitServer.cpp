@@ -0,0 +1,226 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusUnitServer.hpp"
+#include "modbusException.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+using namespace MB;
+
+void ModbusUnitServer::checkUnitId(uint8_t unitId) {
+    if (unitId > MaxUnitId)
+        throw std::invalid_argument("Invalid unit id");
+}
+
+void ModbusUnitServer::addUnit(uint8_t unitId, std::shared_ptr<ModbusDataStore> store) {
+    checkUnitId(unitId);
+    if (!store)
+        throw std::invalid_argument("Unit has to have a store");
+
+    _count += !hasUnit(unitId);
+    _units[unitId].store = std::move(store);
+}
+
+void ModbusUnitServer::setHandler(uint8_t unitId, Handler handler) {
+    checkUnitId(unitId);
+    const bool hosted      = hasUnit(unitId);
+    _units[unitId].handler = std::move(handler);
+    _count                 = _count - hosted + hasUnit(unitId);
+}
+
+void ModbusUnitServer::setAccessMap(uint8_t unitId,
+                                    std::shared_ptr<const ModbusAccessMap> access) {
+    checkUnitId(unitId);
+    _units[unitId].access = std::move(access);
+}
+
+void ModbusUnitServer::setOffloaded(uint8_t unitId, bool offloaded) {
+    checkUnitId(unitId);
+    _units[unitId].offloaded = offloaded;
+}
+
+void ModbusUnitServer::setAdmission(uint8_t unitId,
+                                    ModbusAdmission::Settings settings) {
+    checkUnitId(unitId);
+    std::lock_guard lock{_mutex};
+    _queues[unitId].admission.setSettings(settings);
+}
+
+ModbusAdmission::Metrics ModbusUnitServer::admissionMetrics(uint8_t unitId) const {
+    std::lock_guard lock{_mutex};
+    return _queues[unitId].admission.metrics();
+}
+
+void ModbusUnitServer::removeUnit(uint8_t unitId) {
+    _count -= hasUnit(unitId);
+    _units[unitId] = Unit();
+}
+
+bool ModbusUnitServer::hasUnit(uint8_t unitId) const noexcept {
+    const auto &unit = _units[unitId];
+    return unit.store || unit.handler;
+}
+
+std::shared_ptr<ModbusDataStore> ModbusUnitServer::store(uint8_t unitId) const {
+    return _units[unitId].store;
+}
+
+ModbusResponse ModbusUnitServer::execute(const Unit &unit,
+                                         const ModbusRequest &request) const {
+    if (unit.access)
+        unit.access->check(request);
+
+    try {
+        return unit.handler ? unit.handler(request) : unit.store->handle(request);
+    } catch (const ModbusException &) {
+        throw;
+    } catch (const std::exception &) {
+        // Handler failed, e.g. its backend is not available
+        throw ModbusException(utils::SlaveDeviceFailure, request.slaveID(),
+                              request.functionCode());
+    }
+}
+
+ModbusResponse ModbusUnitServer::handle(const ModbusRequest &request) const {
+    if (_broadcast && request.isBroadcast()) {
+        if (!utils::isBroadcastable(request.functionCode()))
+            throw ModbusException(utils::IllegalFunction, request.slaveID(),
+                                  request.functionCode());
+        // Failure of one unit does not stop the others
+        for (const auto &unit : _units) {
+            if (!unit.store && !unit.handler)
+                continue;
+            try {
+                utils::ignore_result(execute(unit, request));
+            } catch (const ModbusException &) {
+            }
+        }
+        return ModbusResponse(request.slaveID(), request.functionCode());
+    }
+
+    const auto &unit = _units[request.slaveID()];
+    if (!unit.store && !unit.handler)
+        throw ModbusException(utils::GatewayTargetDeviceFailedToRespond,
+                              request.slaveID(), request.functionCode());
+    return execute(unit, request);
+}
+
+void ModbusUnitServer::checkFrame(const std::vector<uint8_t> &frame) {
+    // Header, unit id and function code
+    if (frame.size() < 8 || utils::bigEndianConv(&frame[2]) != 0x0000 ||
+        utils::bigEndianConv(&frame[4]) != frame.size() - 6)
+        throw ModbusException(utils::ProtocolError);
+}
+
+namespace {
+std::vector<uint8_t> mbapResponse(const std::vector<uint8_t> &frame,
+                                  const std::vector<uint8_t> &pdu) {
+    std::vector<uint8_t> response(frame.begin(), frame.begin() + 4);
+    utils::pushUint16(response, static_cast<uint16_t>(pdu.size()));
+    response.insert(response.end(), pdu.begin(), pdu.end());
+    return response;
+}
+} // namespace
+
+std::optional<std::vector<uint8_t>>
+ModbusUnitServer::handleFrame(const std::vector<uint8_t> &frame) const {
+    checkFrame(frame);
+
+    const auto unitId       = frame[6];
+    const auto functionCode = static_cast<utils::MBFunctionCode>(frame[7]);
+
+    const bool broadcast    = _broadcast && unitId == utils::BroadcastSlaveID;
+
+    std::vector<uint8_t> pdu;
+    try {
+        const auto request  = ModbusRequest::fromRaw({frame.begin() + 6, frame.end()});
+        const auto response = handle(request);
+        if (broadcast)
+            return std::nullopt;
+        pdu = response.toRaw();
+    } catch (const ModbusException &exception) {
+        if (broadcast)
+            return std::nullopt;
+        const auto code = utils::isStandardErrorCode(exception.getErrorCode())
+                              ? exception.getErrorCode()
+                              : utils::IllegalDataValue;
+        pdu = ModbusException(code, unitId, functionCode).toRaw();
+    }
+    return mbapResponse(frame, pdu);
+}
+
+bool ModbusUnitServer::offload(uint8_t unitId, Work work, Completion completion) const {
+    auto &queue = _queues[unitId];
+    {
+        std::lock_guard lock{_mutex};
+        if (!queue.admission.admit(queue.queued))
+            return false;
+        queue.queued++;
+    }
+
+    _pool->post(unitId, [this, &queue, work = std::move(work),
+                         completion = std::move(completion)]() {
+        const auto started = ModbusAdmission::Clock::now();
+        auto response      = work();
+        {
+            // Before completion, that may dispatch the next request
+            std::lock_guard lock{_mutex};
+            queue.queued--;
+            queue.admission.served(ModbusAdmission::Clock::now() - started);
+        }
+        if (completion)
+            completion(std::move(response));
+    });
+    return true;
+}
+
+void ModbusUnitServer::dispatch(const std::vector<uint8_t> &frame,
+                                Completion completion) const {
+    checkFrame(frame);
+    const auto unitId = frame[6];
+
+    if (!_broadcast || unitId != utils::BroadcastSlaveID) {
+        if (!_pool || !_units[unitId].offloaded) {
+            completion(handleFrame(frame));
+        } else if (!offload(
+                       unitId, [this, frame]() { return handleFrame(frame); },
+                       completion)) {
+            const auto functionCode = static_cast<utils::MBFunctionCode>(frame[7]);
+            completion(mbapResponse(
+                frame,
+                ModbusException(utils::SlaveDeviceBusy, unitId, functionCode).toRaw()));
+        }
+        return;
+    }
+
+    std::optional<ModbusRequest> request;
+    try {
+        request = ModbusRequest::fromRaw({frame.begin() + 6, frame.end()});
+    } catch (const ModbusException &) {
+    }
+    if (request && utils::isBroadcastable(request->functionCode())) {
+        // Offloaded units keep their requests serialized
+        for (std::size_t id = 0; id <= MaxUnitId; id++) {
+            const auto &unit = _units[id];
+            if (!unit.store && !unit.handler)
+                continue;
+
+            const auto task = [this, &unit, request]() {
+                try {
+                    utils::ignore_result(execute(unit, *request));
+                } catch (const ModbusException &) {
+                }
+                return std::optional<std::vector<uint8_t>>();
+            };
+            // Shed broadcast is missed by the unit, as by busy serial slave
+            if (_pool && unit.offloaded)
+                offload(static_cast<uint8_t>(id), task, nullptr);
+            else
+                utils::ignore_result(task());
+        }
+    }
+    completion(std::nullopt);
+}
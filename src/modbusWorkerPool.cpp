@@ -0,0 +1,85 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusWorkerPool.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+using namespace MB;
+
+ModbusWorkerPool::ModbusWorkerPool(std::size_t threads) {
+    if (threads == 0)
+        throw std::invalid_argument("Worker pool needs threads");
+
+    _threads.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++)
+        _threads.emplace_back(&ModbusWorkerPool::run, this);
+}
+
+ModbusWorkerPool::~ModbusWorkerPool() {
+    {
+        std::lock_guard lock{_mutex};
+        _stop = true;
+    }
+    _cond.notify_all();
+    for (auto &thread : _threads)
+        thread.join();
+}
+
+void ModbusWorkerPool::post(StrandId strand, Task task) {
+    {
+        std::lock_guard lock{_mutex};
+        auto &queued = _strands[strand];
+        queued.tasks.push_back(std::move(task));
+        _pending++;
+        // Running strand is made ready again, when its task is done
+        if (queued.running || queued.tasks.size() > 1)
+            return;
+        _ready.push_back(strand);
+    }
+    _cond.notify_one();
+}
+
+std::size_t ModbusWorkerPool::pending() const {
+    std::lock_guard lock{_mutex};
+    return _pending;
+}
+
+void ModbusWorkerPool::run() {
+    std::unique_lock lock{_mutex};
+    while (true) {
+        // Queued tasks are run before stopping
+        _cond.wait(lock, [this] { return !_ready.empty() || (_stop && _pending == 0); });
+        if (_ready.empty())
+            return;
+
+        const auto id = _ready.front();
+        _ready.pop_front();
+        auto &strand = _strands[id];
+        auto task    = std::move(strand.tasks.front());
+        strand.tasks.pop_front();
+        strand.running = true;
+        lock.unlock();
+
+        try {
+            task();
+        } catch (...) {
+            // Task is responsible for reporting its errors
+        }
+        task = nullptr;
+
+        lock.lock();
+        _pending--;
+        strand.running = false;
+        if (strand.tasks.empty()) {
+            _strands.erase(id);
+        } else {
+            _ready.push_back(id);
+            _cond.notify_one();
+        }
+        if (_stop && _pending == 0)
+            _cond.notify_all();
+    }
+}
@@ -0,0 +1,95 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusAccessMap.hpp"
+#include "MB/modbusException.hpp"
+#include "MB/modbusUnitServer.hpp"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <stdexcept>
+
+using namespace MB;
+
+TEST(ModbusAccessMap, Ranges) {
+    ModbusAccessMap map;
+    map.map(utils::HoldingRegisters, 10, 200, ModbusAccessMap::ReadWrite);
+    map.map(utils::HoldingRegisters, 100, 20, ModbusAccessMap::Read);
+    map.map(utils::HoldingRegisters, 150, 1, ModbusAccessMap::None);
+    map.map(utils::InputRegisters, 0xFF00, 0x100, ModbusAccessMap::Read);
+
+    // Within a word, across words and across whole words
+    EXPECT_TRUE(map.readable(utils::HoldingRegisters, 10, 1));
+    EXPECT_TRUE(map.readable(utils::HoldingRegisters, 10, 140));
+    EXPECT_FALSE(map.readable(utils::HoldingRegisters, 9, 2));
+    EXPECT_FALSE(map.readable(utils::HoldingRegisters, 140, 20));
+    EXPECT_TRUE(map.readable(utils::HoldingRegisters, 151, 59));
+    EXPECT_FALSE(map.readable(utils::HoldingRegisters, 151, 60));
+
+    EXPECT_TRUE(map.writable(utils::HoldingRegisters, 20, 80));
+    EXPECT_FALSE(map.writable(utils::HoldingRegisters, 20, 81));
+    EXPECT_TRUE(map.writable(utils::HoldingRegisters, 120, 30));
+    EXPECT_TRUE(map.mapped(utils::HoldingRegisters, 10, 140));
+    EXPECT_FALSE(map.mapped(utils::HoldingRegisters, 150, 1));
+
+    // End of the address space, and other tables
+    EXPECT_TRUE(map.readable(utils::InputRegisters, 0xFF80, 0x80));
+    EXPECT_FALSE(map.readable(utils::InputRegisters, 0xFF80, 0x81));
+    EXPECT_FALSE(map.readable(utils::OutputCoils, 10, 1));
+    EXPECT_FALSE(map.writable(utils::InputRegisters, 0xFF80, 1));
+
+    EXPECT_THROW(map.map(utils::OutputCoils, 0xFFFF, 2, ModbusAccessMap::Read),
+                 std::invalid_argument);
+}
+
+TEST(ModbusAccessMap, Requests) {
+    ModbusAccessMap map;
+    map.map(utils::HoldingRegisters, 0, 10, ModbusAccessMap::Read);
+    map.map(utils::HoldingRegisters, 10, 10, ModbusAccessMap::ReadWrite);
+    map.map(utils::OutputCoils, 0, 16, ModbusAccessMap::Write);
+
+    EXPECT_TRUE(
+        map.allows(ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters, 0, 20)));
+    EXPECT_FALSE(map.allows(ModbusRequest(1, utils::WriteSingleAnalogOutputRegister, 5,
+                                          1, {ModbusCell::initReg(1)})));
+    EXPECT_TRUE(
+        map.allows(ModbusRequest(1, utils::WriteMultipleDiscreteOutputCoils, 0, 16,
+                                 std::vector<ModbusCell>(16, ModbusCell(false)))));
+    EXPECT_FALSE(map.allows(ModbusRequest(1, utils::ReadDiscreteOutputCoils, 0, 1)));
+
+    ModbusRequest readWrite(1, utils::ReadWriteMultipleRegisters, 0, 10,
+                            {ModbusCell::initReg(1), ModbusCell::initReg(2)});
+    readWrite.setWriteAddress(18);
+    EXPECT_TRUE(map.allows(readWrite));
+    readWrite.setWriteAddress(19);
+    EXPECT_FALSE(map.allows(readWrite));
+
+    // Requests outside of the tables
+    EXPECT_TRUE(map.allows(ModbusRequest(1, utils::ReadFIFOQueue, 100, 1)));
+}
+
+TEST(ModbusAccessMap, UnitServer) {
+    auto map = std::make_shared<ModbusAccessMap>();
+    map->map(utils::HoldingRegisters, 0, 4, ModbusAccessMap::Read);
+
+    ModbusUnitServer server;
+    server.addUnit(1, std::make_shared<ModbusDataStore>(0, 0, 16, 0));
+    server.setAccessMap(1, map);
+
+    EXPECT_NO_THROW(utils::ignore_result(
+        server.handle(ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters, 0, 4))));
+    try {
+        utils::ignore_result(server.handle(ModbusRequest(
+            1, utils::WriteSingleAnalogOutputRegister, 0, 1, {ModbusCell::initReg(1)})));
+        FAIL() << "Read-only register was written";
+    } catch (const ModbusException &exception) {
+        EXPECT_EQ(exception.getErrorCode(), utils::IllegalDataAddress);
+    }
+    EXPECT_EQ(server.store(1)->read(utils::HoldingRegisters, 0, 1)[0].reg(), 0);
+
+    // Store has the register, but the map does not
+    EXPECT_THROW(utils::ignore_result(server.handle(
+                     ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters, 8, 1))),
+                 ModbusException);
+}
@@ -0,0 +1,70 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusAdaptiveTimeouts.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <stdexcept>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+TEST(ModbusAdaptiveTimeouts, Estimate) {
+    ModbusAdaptiveTimeouts timeouts;
+    EXPECT_EQ(timeouts.timeout(1), 1000ms);
+    EXPECT_FALSE(timeouts.estimate(1).has_value());
+
+    // The first sample: 10 + 4 * 5
+    timeouts.sample(1, 10ms);
+    EXPECT_EQ(timeouts.timeout(1), 30ms);
+
+    // variance = 3/4 * 5, smoothed stays
+    timeouts.sample(1, 10ms);
+    EXPECT_EQ(timeouts.timeout(1), 25ms);
+
+    // smoothed = 7/8 * 10 + 1/8 * 18, variance = 3/4 * 3.75 + 1/4 * 8
+    timeouts.sample(1, 18ms);
+    const auto estimate = timeouts.estimate(1);
+    ASSERT_TRUE(estimate.has_value());
+    EXPECT_EQ(estimate->smoothed, 11ms);
+    EXPECT_EQ(estimate->variance, 4812500ns);
+    EXPECT_EQ(estimate->timeout, 30250us);
+    EXPECT_EQ(estimate->samples, 3);
+
+    // Other devices are not affected
+    EXPECT_EQ(timeouts.timeout(2), 1000ms);
+}
+
+TEST(ModbusAdaptiveTimeouts, BackoffAndLimits) {
+    ModbusAdaptiveTimeouts timeouts({20ms, 500ms, 200ms});
+    EXPECT_EQ(timeouts.timeout(1), 200ms);
+
+    // Fast device is clamped to the minimum
+    timeouts.sample(1, 1ms);
+    EXPECT_EQ(timeouts.timeout(1), 20ms);
+
+    timeouts.timedOut(1);
+    EXPECT_EQ(timeouts.timeout(1), 40ms);
+    for (int i = 0; i < 10; i++)
+        timeouts.timedOut(1);
+    EXPECT_EQ(timeouts.timeout(1), 500ms);
+    EXPECT_EQ(timeouts.estimate(1)->timeouts, 11);
+
+    // Response ends the backoff
+    timeouts.sample(1, 1ms);
+    EXPECT_EQ(timeouts.timeout(1), 20ms);
+
+    // Device that never answered keeps the initial timeout
+    timeouts.timedOut(2);
+    EXPECT_EQ(timeouts.timeout(2), 200ms);
+    timeouts.sample(2, 100ms);
+    EXPECT_EQ(timeouts.timeout(2), 300ms);
+
+    timeouts.reset(2);
+    EXPECT_EQ(timeouts.timeout(2), 200ms);
+
+    EXPECT_THROW(ModbusAdaptiveTimeouts({0ms, 500ms, 200ms}), std::invalid_argument);
+    EXPECT_THROW(ModbusAdaptiveTimeouts({600ms, 500ms, 200ms}), std::invalid_argument);
+}
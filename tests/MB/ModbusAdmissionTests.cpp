@@ -0,0 +1,54 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusAdmission.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <stdexcept>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+TEST(ModbusAdmission, QueueDepth) {
+    ModbusAdmission admission({3, ModbusAdmission::Clock::duration::zero()});
+    EXPECT_TRUE(admission.admit(0));
+    EXPECT_TRUE(admission.admit(2));
+    EXPECT_FALSE(admission.admit(3));
+    EXPECT_FALSE(admission.admit(100));
+
+    const auto &metrics = admission.metrics();
+    EXPECT_EQ(metrics.admitted, 2);
+    EXPECT_EQ(metrics.shed, 2);
+    EXPECT_EQ(metrics.shedByWait, 0);
+
+    // No limits by default
+    ModbusAdmission unlimited;
+    unlimited.served(1s);
+    EXPECT_TRUE(unlimited.admit(10000));
+}
+
+TEST(ModbusAdmission, EstimatedWait) {
+    ModbusAdmission admission({0, 100ms});
+    // Nothing is known about service time yet
+    EXPECT_TRUE(admission.admit(1000));
+
+    admission.served(16ms);
+    EXPECT_EQ(admission.metrics().serviceTime, 16ms);
+    admission.served(32ms);
+    EXPECT_EQ(admission.metrics().serviceTime, 18ms);
+    EXPECT_EQ(admission.estimatedWait(5), 90ms);
+
+    EXPECT_TRUE(admission.admit(5));
+    EXPECT_FALSE(admission.admit(6));
+    EXPECT_EQ(admission.metrics().shedByWait, 1);
+
+    // Limits change at runtime, service time is kept
+    admission.setSettings({1, 0ms});
+    EXPECT_FALSE(admission.admit(1));
+    EXPECT_EQ(admission.metrics().serviceTime, 18ms);
+    EXPECT_EQ(admission.metrics().shed, 2);
+
+    EXPECT_THROW(admission.setSettings({0, -1ms}), std::invalid_argument);
+}
@@ -0,0 +1,125 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Serial::Connection in ASCII mode, with pseudo terminal standing in for the
+// serial port. Works only on POSIX systems.
+
+#include "MB/Serial/connection.hpp"
+#include "MB/modbusAscii.hpp"
+#include "MB/modbusException.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "PtyLoopback.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+class ModBusAsciiPty : public PtyLoopback {
+  protected:
+    Serial::Connection connection;
+
+    void SetUp() override {
+        PtyLoopback::SetUp();
+        if (HasFatalFailure())
+            return;
+        connection.connect(path);
+        connection.setFraming(Serial::Connection::Framing::ASCII);
+        connection.setTimeout(1000);
+    }
+};
+
+TEST_F(ModBusAsciiPty, Transaction) {
+    const ModbusRequest request(0x11, utils::ReadAnalogOutputHoldingRegisters, 0x006B, 3);
+    const auto sent = connection.sendRequest(request);
+    EXPECT_EQ(sent.front(), ':');
+    EXPECT_EQ(readLine(), sent);
+
+    auto response = ModbusResponse::from(request);
+    response.setValues({ModbusCell::initReg(0xAE41), ModbusCell::initReg(0x5652),
+                        ModbusCell::initReg(0x4340)});
+    const auto frame = ascii::encodeFrame(response.toRaw());
+
+    // Line noise, then frame split in the middle, while connection waits
+    std::thread line([&]() {
+        write({0x00, '1', '\n', 'x'});
+        write(std::vector<uint8_t>(frame.begin(), frame.begin() + 7));
+        std::this_thread::sleep_for(50ms);
+        write(std::vector<uint8_t>(frame.begin() + 7, frame.end()));
+    });
+    const auto [answer, raw] = connection.awaitResponse();
+    line.join();
+
+    EXPECT_EQ(raw, frame);
+    ASSERT_EQ(answer.registerValues().size(), 3);
+    EXPECT_EQ(answer.registerValues()[0].reg(), 0xAE41);
+    EXPECT_EQ(answer.registerValues()[2].reg(), 0x4340);
+}
+
+TEST_F(ModBusAsciiPty, OtherSlave) {
+    connection.setAdaptiveTimeouts(std::make_shared<ModbusAdaptiveTimeouts>());
+    const ModbusRequest request(0x11, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    connection.sendRequest(request);
+
+    // Late answer of the slave asked before is neither returned, nor sampled
+    for (const uint8_t slave : {0x12, 0x11}) {
+        write(ascii::encodeFrame(ModbusResponse(slave, request.functionCode(), 0, 1,
+                                                {ModbusCell::initReg(slave)})
+                                     .toRaw()));
+    }
+    const ModbusException other(utils::IllegalDataAddress, 0x13, request.functionCode());
+    write(ascii::encodeFrame(other.toRaw()));
+
+    const auto [response, raw] = connection.awaitResponse();
+    EXPECT_EQ(response.registerValues()[0].reg(), 0x11);
+    EXPECT_EQ(connection.getAdaptiveTimeouts()->estimate(0x11)->samples, 1);
+    EXPECT_FALSE(connection.getAdaptiveTimeouts()->estimate(0x12).has_value());
+
+    // Exception response of another slave is dropped as well
+    connection.sendRequest(request);
+    EXPECT_THROW(utils::ignore_result(connection.awaitResponse()), ModbusException);
+    EXPECT_EQ(connection.getAdaptiveTimeouts()->estimate(0x11)->timeouts, 1);
+}
+
+TEST_F(ModBusAsciiPty, ExceptionResponse) {
+    connection.sendRequest(ModbusRequest(0x0A, utils::ReadDiscreteOutputCoils, 0, 8));
+    write(ascii::encodeFrame(
+        ModbusException(utils::IllegalDataAddress, 0x0A, utils::ReadDiscreteOutputCoils)
+            .toRaw()));
+
+    try {
+        utils::ignore_result(connection.awaitResponse());
+        FAIL() << "Exception response was not thrown";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::IllegalDataAddress);
+    }
+}
+
+TEST_F(ModBusAsciiPty, CorruptedFrame) {
+    const ModbusRequest request(0x01, utils::WriteSingleAnalogOutputRegister, 0x0001, 1,
+                                {ModbusCell::initReg(3)});
+    auto corrupted = ascii::encodeFrame(request.toRaw());
+    // Flipped bit in the value changes the LRC
+    corrupted[10] = corrupted[10] == '3' ? '2' : '3';
+
+    write(corrupted);
+    try {
+        utils::ignore_result(connection.awaitResponse());
+        FAIL() << "Corrupted frame was accepted";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::InvalidCRC);
+    }
+
+    // Slave drops it, and waits for the next frame
+    write(corrupted);
+    write(ascii::encodeFrame(request.toRaw()));
+    const auto [received, raw] = connection.awaitRequest();
+    EXPECT_EQ(received.slaveID(), 0x01);
+    EXPECT_EQ(received.registerValues()[0].reg(), 3);
+}
@@ -0,0 +1,97 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/lrc.hpp"
+#include "MB/modbusAscii.hpp"
+#include "MB/modbusException.hpp"
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusRequest.hpp"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace MB;
+
+class ModBusAscii : public ::testing::Test {
+  protected:
+    // Read one holding register of slave 1
+    std::vector<uint8_t> fn3Raw   = {0x01, 0x03, 0x00, 0x00, 0x00, 0x01};
+    std::string fn3Frame          = ":010300000001FB\r\n";
+    std::vector<uint8_t> fn3Ascii = std::vector<uint8_t>(fn3Frame.begin(), fn3Frame.end());
+};
+
+TEST_F(ModBusAscii, LRC) {
+    EXPECT_EQ(LRC::calculateLRC(fn3Raw), 0xFB);
+    EXPECT_EQ(LRC::calculateLRC(std::vector<uint8_t>{}), 0x00);
+
+    auto withLRC = fn3Raw;
+    withLRC.push_back(0xFB);
+    EXPECT_EQ(LRC::calculateLRC(withLRC), 0x00);
+}
+
+TEST_F(ModBusAscii, Hex) {
+    std::vector<uint8_t> bytes(256);
+    for (int i = 0; i < 256; i++)
+        bytes[i] = static_cast<uint8_t>(i);
+
+    std::string hex(2 * bytes.size(), '\0');
+    ascii::encodeHex(bytes.data(), bytes.size(), hex.data());
+    EXPECT_EQ(hex.substr(0, 6), "000102");
+    EXPECT_EQ(hex.substr(2 * 0xAB, 2), "AB");
+
+    std::vector<uint8_t> decoded(bytes.size());
+    EXPECT_TRUE(ascii::decodeHex(hex.data(), hex.size(), decoded.data()));
+    EXPECT_EQ(decoded, bytes);
+
+    uint8_t byte;
+    EXPECT_TRUE(ascii::decodeHex("fe", 2, &byte));
+    EXPECT_EQ(byte, 0xFE);
+    EXPECT_FALSE(ascii::decodeHex("0G", 2, &byte));
+    EXPECT_FALSE(ascii::decodeHex("0:", 2, &byte));
+    EXPECT_FALSE(ascii::decodeHex("012", 3, &byte));
+}
+
+TEST_F(ModBusAscii, Frame) {
+    EXPECT_EQ(ascii::encodeFrame(fn3Raw), fn3Ascii);
+    EXPECT_EQ(ascii::decodeFrame(fn3Ascii), fn3Raw);
+
+    const auto request = ModbusRequest::fromRaw(ascii::decodeFrame(fn3Ascii));
+    EXPECT_EQ(request.slaveID(), 0x01);
+    EXPECT_EQ(request.functionCode(), utils::ReadAnalogOutputHoldingRegisters);
+    EXPECT_EQ(ascii::encodeFrame(request.toRaw()), fn3Ascii);
+}
+
+TEST_F(ModBusAscii, InvalidFrame) {
+    auto invalidLRC = fn3Ascii;
+    invalidLRC[14]  = 'C';
+    try {
+        utils::ignore_result(ascii::decodeFrame(invalidLRC));
+        FAIL() << "Invalid LRC was accepted";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::InvalidCRC);
+    }
+
+    auto noStart = fn3Ascii;
+    noStart[0]   = '0';
+    EXPECT_THROW(utils::ignore_result(ascii::decodeFrame(noStart)), ModbusException);
+
+    auto noEnd = fn3Ascii;
+    noEnd.pop_back();
+    EXPECT_THROW(utils::ignore_result(ascii::decodeFrame(noEnd)), ModbusException);
+
+    auto invalidDigit = fn3Ascii;
+    invalidDigit[3]   = 'x';
+    EXPECT_THROW(utils::ignore_result(ascii::decodeFrame(invalidDigit)), ModbusException);
+}
+
+TEST_F(ModBusAscii, FrameLength) {
+    EXPECT_EQ(framing::asciiFrameLength(fn3Ascii.data(), 0), 1);
+    EXPECT_EQ(framing::asciiFrameLength(fn3Ascii.data(), 5), 6);
+    EXPECT_EQ(framing::asciiFrameLength(fn3Ascii.data(), fn3Ascii.size()), fn3Ascii.size());
+    EXPECT_FALSE(framing::asciiFrameLength(fn3Ascii.data() + 1, 5).has_value());
+
+    const std::vector<uint8_t> endless(framing::MaxASCIIFrameSize + 1, ':');
+    EXPECT_FALSE(framing::asciiFrameLength(endless.data(), endless.size()).has_value());
+}
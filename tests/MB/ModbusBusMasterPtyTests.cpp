@@ -0,0 +1,122 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Serial::BusMaster on ASCII line, with pseudo terminal standing in for the
+// serial port. Works only on POSIX systems.
+
+#include "MB/Serial/busMaster.hpp"
+#include "MB/modbusAscii.hpp"
+#include "MB/modbusException.hpp"
+#include "PtyLoopback.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+class ModBusBusMasterPty : public PtyLoopback {
+  protected:
+    std::unique_ptr<Serial::BusMaster> master;
+
+    void SetUp() override {
+        PtyLoopback::SetUp();
+        if (HasFatalFailure())
+            return;
+
+        Serial::Connection connection;
+        connection.connect(path);
+        connection.setFraming(Serial::Connection::Framing::ASCII);
+        connection.setTimeout(500);
+        master = std::make_unique<Serial::BusMaster>(std::move(connection));
+    }
+
+    void TearDown() override {
+        master.reset();
+        PtyLoopback::TearDown();
+    }
+
+    // Request, that master has put on the bus
+    ModbusRequest request() const {
+        return ModbusRequest::fromRaw(ascii::decodeFrame(readLine()));
+    }
+
+    // Answers read with `value` in each register, and write with its echo
+    void respond(const ModbusRequest &request, uint16_t value) const {
+        auto response = ModbusResponse::from(request);
+        if (utils::functionType(request.functionCode()) == utils::Read) {
+            response.setValues(std::vector<ModbusCell>(request.numberOfRegisters(),
+                                                       ModbusCell::initReg(value)));
+        }
+        write(ascii::encodeFrame(response.toRaw()));
+    }
+};
+
+TEST_F(ModBusBusMasterPty, PriorityOnFrameBoundary) {
+    const auto read = [](uint8_t slave) {
+        return ModbusRequest(slave, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    };
+
+    auto first = master->submit(read(1));
+    const auto onBus = request();
+    ASSERT_EQ(onBus.slaveID(), 1);
+
+    // Frame on the bus is not interrupted, urgent transactions go right after it
+    auto poll    = master->submit(read(2));
+    auto alarm   = master->submit(read(3), ModbusPriority::Alarm);
+    auto control = master->submit(ModbusRequest(4, utils::WriteSingleAnalogOutputRegister,
+                                                0, 1, {ModbusCell::initReg(7)}),
+                                  ModbusPriority::Control);
+    std::this_thread::sleep_for(50ms);
+    respond(onBus, 1);
+
+    for (const uint8_t slave : {4, 3, 2}) {
+        const auto next = request();
+        EXPECT_EQ(next.slaveID(), slave);
+        respond(next, slave);
+    }
+
+    EXPECT_EQ(first.get().registerValues()[0].reg(), 1);
+    EXPECT_EQ(poll.get().registerValues()[0].reg(), 2);
+    EXPECT_EQ(alarm.get().registerValues()[0].reg(), 3);
+    EXPECT_EQ(control.get().registerValues()[0].reg(), 7);
+
+    // Each class waited at least for the frame, that was on the bus
+    const auto controls = master->metrics(ModbusPriority::Control);
+    const auto polls    = master->metrics(ModbusPriority::Poll);
+    EXPECT_EQ(controls.dispatched, 1);
+    EXPECT_EQ(master->metrics(ModbusPriority::Alarm).dispatched, 1);
+    EXPECT_EQ(polls.dispatched, 2);
+    EXPECT_EQ(polls.queueDepth, 0);
+    EXPECT_GE(controls.maxWait, 50ms);
+    EXPECT_GE(polls.maxWait, controls.maxWait);
+    EXPECT_GE(polls.totalWait, polls.maxWait);
+}
+
+TEST_F(ModBusBusMasterPty, Shutdown) {
+    auto timedOut = master->submit(
+        ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters, 0, 1));
+    utils::ignore_result(request());
+    auto queued = master->submit(
+        ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters, 0, 1));
+    EXPECT_EQ(master->metrics(ModbusPriority::Poll).queueDepth, 1);
+
+    // Transaction on the bus runs to its end, the queued one is failed
+    master.reset();
+    try {
+        utils::ignore_result(timedOut.get());
+        FAIL() << "Device did not answer";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::Timeout);
+    }
+    try {
+        utils::ignore_result(queued.get());
+        FAIL() << "Queued transaction was not failed";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::ConnectionClosed);
+    }
+}
@@ -0,0 +1,114 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusChangeDetector.hpp"
+#include "MB/modbusClient.hpp"
+#include "MB/modbusDataStore.hpp"
+#include "MB/modbusException.hpp"
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace MB;
+
+class ModBusChangeDetector : public ::testing::Test {
+  protected:
+    ModbusDataStore store{16, 0, 64, 0};
+    ModbusClient client{[this](const ModbusRequest &request) {
+        return ModbusResponse::fromRaw(
+            store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+    }};
+
+    // Holding registers 0-40 are one block of two chunks, coils the other one
+    const ModbusPollPlan plan{{{1, utils::HoldingRegisters, 0, 1},
+                               {1, utils::HoldingRegisters, 1, 2},
+                               {1, utils::HoldingRegisters, 3, 30},
+                               {1, utils::HoldingRegisters, 40, 1},
+                               {1, utils::OutputCoils, 4, 1}}};
+    ModbusChangeDetector detector{plan};
+
+    void set(uint16_t address, uint16_t value) {
+        store.write(utils::HoldingRegisters, address, {ModbusCell::initReg(value)});
+    }
+
+    std::vector<std::size_t> scan() {
+        return detector.update(client.executeAll(plan.requests()));
+    }
+};
+
+TEST_F(ModBusChangeDetector, Changes) {
+    std::vector<std::pair<std::size_t, std::vector<ModbusCell>>> reports;
+    detector.subscribe([&](std::size_t tag, const std::vector<ModbusCell> &values) {
+        reports.emplace_back(tag, values);
+    });
+
+    // The first scan reports everything
+    EXPECT_EQ(scan(), (std::vector<std::size_t>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(reports.size(), 5);
+    EXPECT_TRUE(scan().empty());
+
+    set(40, 7);
+    reports.clear();
+    EXPECT_EQ(scan(), (std::vector<std::size_t>{3}));
+    ASSERT_EQ(reports.size(), 1);
+    EXPECT_EQ(reports[0].second[0].reg(), 7);
+
+    // Change in the middle of the long tag
+    set(20, 1);
+    EXPECT_EQ(scan(), (std::vector<std::size_t>{2}));
+
+    store.write(utils::OutputCoils, 4, {ModbusCell::initCoil(true)});
+    reports.clear();
+    EXPECT_EQ(scan(), (std::vector<std::size_t>{4}));
+    ASSERT_EQ(reports.size(), 1);
+    EXPECT_TRUE(reports[0].second[0].isCoil());
+    EXPECT_TRUE(reports[0].second[0].coil());
+
+    detector.reset();
+    EXPECT_EQ(scan().size(), 5);
+}
+
+TEST_F(ModBusChangeDetector, Deadbands) {
+    detector.setDeadband(0, {ModbusDeadband::Absolute, 5});
+    detector.setDeadband(1, {ModbusDeadband::Percent, 10, true});
+
+    // -1000 as int32_t
+    set(0, 100);
+    set(1, 0xFFFF);
+    set(2, 0xFC18);
+    EXPECT_EQ(scan().size(), 5);
+
+    // Changes are accumulated since the last report
+    set(0, 103);
+    EXPECT_TRUE(scan().empty());
+    set(0, 106);
+    EXPECT_EQ(scan(), (std::vector<std::size_t>{0}));
+    set(0, 102);
+    EXPECT_TRUE(scan().empty());
+
+    // -1050 and then -1101
+    set(2, 0xFBE6);
+    EXPECT_TRUE(scan().empty());
+    set(2, 0xFBB3);
+    EXPECT_EQ(scan(), (std::vector<std::size_t>{1}));
+
+    EXPECT_THROW(detector.setDeadband(2, {ModbusDeadband::Absolute, 1}),
+                 std::invalid_argument);
+    EXPECT_THROW(detector.setDeadband(4, {ModbusDeadband::Absolute, 1}),
+                 std::invalid_argument);
+    EXPECT_THROW(detector.setDeadband(0, {ModbusDeadband::Absolute, -1}),
+                 std::invalid_argument);
+}
+
+TEST_F(ModBusChangeDetector, MismatchedResponses) {
+    EXPECT_THROW(utils::ignore_result(detector.update({})), ModbusException);
+
+    auto responses = client.executeAll(plan.requests());
+    std::swap(responses[0], responses[1]);
+    EXPECT_THROW(utils::ignore_result(detector.update(responses)), ModbusException);
+
+    // Failed update does not change anything
+    EXPECT_EQ(scan().size(), 5);
+}
@@ -0,0 +1,142 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusCircuitBreaker.hpp"
+#include "MB/modbusClient.hpp"
+#include "MB/modbusDataStore.hpp"
+#include "MB/modbusException.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+using State = ModbusCircuitBreaker::State;
+
+TEST(ModbusCircuitBreaker, StateMachine) {
+    ModbusCircuitBreaker breaker({3, 1s, 8s, 0});
+    std::vector<State> changes;
+    breaker.setListener([&](uint8_t, State state) { changes.push_back(state); });
+
+    const auto start = ModbusCircuitBreaker::Clock::time_point();
+    EXPECT_TRUE(breaker.allow(1, start));
+
+    breaker.failure(1, utils::Timeout, 100ms, start);
+    EXPECT_EQ(breaker.state(1), State::Suspect);
+    // Exception response is an answer
+    breaker.failure(1, utils::IllegalDataAddress, 10ms, start);
+    EXPECT_EQ(breaker.state(1), State::Healthy);
+
+    for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(breaker.allow(1, start));
+        breaker.failure(1, utils::ConnectionClosed, 100ms, start);
+    }
+    EXPECT_EQ(breaker.state(1), State::Offline);
+    EXPECT_EQ(changes, (std::vector<State>{State::Suspect, State::Healthy,
+                                           State::Suspect, State::Offline}));
+
+    // Probes after 1, 2, 4, 8 and 8 seconds
+    auto now = start;
+    for (const auto backoff : {1s, 2s, 4s, 8s, 8s}) {
+        EXPECT_FALSE(breaker.allow(1, now + backoff - 1ms));
+        EXPECT_TRUE(breaker.allow(1, now + backoff));
+        // Only one probe at a time
+        EXPECT_FALSE(breaker.allow(1, now + backoff));
+        now += backoff;
+        breaker.failure(1, utils::Timeout, 100ms, now);
+    }
+
+    const auto device = breaker.device(1);
+    ASSERT_TRUE(device.has_value());
+    EXPECT_EQ(device->rejected, 10);
+    EXPECT_EQ(device->reclaimed, 1000ms);
+
+    EXPECT_TRUE(breaker.allow(1, now + 8s));
+    breaker.success(1);
+    EXPECT_EQ(breaker.state(1), State::Healthy);
+    EXPECT_TRUE(breaker.allow(1, now + 8s));
+
+    const auto metrics = breaker.metrics();
+    EXPECT_EQ(metrics.rejected, 10);
+    EXPECT_EQ(metrics.probes, 6);
+    EXPECT_EQ(metrics.trips, 1);
+    EXPECT_EQ(metrics.recoveries, 1);
+    EXPECT_EQ(metrics.reclaimed, 1000ms);
+
+    // Other devices are not affected
+    EXPECT_EQ(breaker.state(2), State::Healthy);
+    EXPECT_FALSE(breaker.device(2).has_value());
+}
+
+TEST(ModbusCircuitBreaker, Jitter) {
+    ModbusCircuitBreaker breaker({1, 10s, 60s, 0.5}, 7);
+    const auto start = ModbusCircuitBreaker::Clock::time_point();
+
+    for (uint8_t slave = 1; slave <= 10; slave++)
+        breaker.failure(slave, utils::Timeout, 100ms, start);
+
+    // Probes are spread over 5 - 15 seconds
+    std::size_t probes = 0;
+    for (uint8_t slave = 1; slave <= 10; slave++) {
+        EXPECT_FALSE(breaker.allow(slave, start + 5s - 1ms));
+        EXPECT_TRUE(breaker.allow(slave, start + 15s));
+        probes += breaker.device(slave)->nextProbe <= start + 10s;
+    }
+    EXPECT_GT(probes, 0);
+    EXPECT_LT(probes, 10);
+
+    // Released probe may be sent again
+    breaker.release(1);
+    EXPECT_TRUE(breaker.allow(1, start + 15s));
+
+    EXPECT_THROW(ModbusCircuitBreaker({0, 1s, 8s, 0}), std::invalid_argument);
+    EXPECT_THROW(ModbusCircuitBreaker({1, 9s, 8s, 0}), std::invalid_argument);
+    EXPECT_THROW(ModbusCircuitBreaker({1, 1s, 8s, 1.5}), std::invalid_argument);
+}
+
+TEST(ModbusCircuitBreaker, Client) {
+    ModbusDataStore store{0, 0, 16, 0};
+    bool online        = false;
+    std::size_t frames = 0;
+    ModbusClient client([&](const ModbusRequest &request) {
+        frames++;
+        if (!online && request.slaveID() == 2)
+            throw ModbusException(utils::Timeout, request.slaveID(),
+                                  request.functionCode());
+        return ModbusResponse::fromRaw(
+            store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+    });
+
+    auto breaker = std::make_shared<ModbusCircuitBreaker>(
+        ModbusCircuitBreaker::Settings{2, 1ms, 1ms, 0});
+    client.setCircuitBreaker(breaker);
+
+    for (int i = 0; i < 2; i++)
+        EXPECT_THROW(client.readHoldingRegisters(2, 0, 1), ModbusException);
+    EXPECT_EQ(breaker->state(2), State::Offline);
+
+    // Offline device is rejected without the transaction
+    frames = 0;
+    try {
+        utils::ignore_result(client.readHoldingRegisters(2, 0, 1));
+        ADD_FAILURE();
+    } catch (const ModbusException &exception) {
+        EXPECT_EQ(exception.getErrorCode(), utils::GatewayTargetDeviceFailedToRespond);
+    }
+    EXPECT_EQ(frames, 0);
+    EXPECT_GT(breaker->metrics().reclaimed.count(), 0);
+    EXPECT_EQ(client.readHoldingRegisters(1, 0, 1).size(), 1);
+
+    // The probe brings the device back
+    online = true;
+    std::this_thread::sleep_for(2ms);
+    EXPECT_EQ(client.readHoldingRegisters(2, 0, 1).size(), 1);
+    EXPECT_EQ(breaker->state(2), State::Healthy);
+    EXPECT_EQ(breaker->metrics().recoveries, 1);
+}
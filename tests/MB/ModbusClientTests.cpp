@@ -0,0 +1,257 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusClient.hpp"
+#include "MB/modbusDataStore.hpp"
+#include "MB/modbusException.hpp"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace MB;
+
+class ModBusClient : public ::testing::Test {
+  protected:
+    ModbusDataStore store{32, 8, 64, 8};
+    std::vector<ModbusRequest> sent;
+
+    // Client talks to the data store through raw frames, as over the wire
+    ModbusClient client{[this](const ModbusRequest &request) {
+        sent.push_back(request);
+        const auto raw = request.toRaw();
+        try {
+            return ModbusResponse::fromRaw(
+                store.handle(ModbusRequest::fromRaw(raw)).toRaw());
+        } catch (const ModbusException &ex) {
+            throw ModbusException(ex.toRaw());
+        }
+    }};
+};
+
+TEST_F(ModBusClient, Registers) {
+    client.writeRegisters(1, 10, {1, 2, 3});
+    client.writeRegister(1, 13, 4);
+
+    EXPECT_EQ(client.readHoldingRegisters(1, 10, 4), (std::vector<uint16_t>{1, 2, 3, 4}));
+
+    store.write(utils::InputRegisters, 2, {ModbusCell::initReg(42)});
+    EXPECT_EQ(client.readInputRegisters(1, 2, 1), (std::vector<uint16_t>{42}));
+}
+
+TEST_F(ModBusClient, Coils) {
+    client.writeCoils(1, 3, {true, false, true});
+    client.writeCoil(1, 6, true);
+
+    // Response is padded to the whole byte, only requested coils are returned
+    EXPECT_EQ(client.readCoils(1, 3, 4), (std::vector<bool>{true, false, true, true}));
+    EXPECT_EQ(client.readInputContacts(1, 0, 2), (std::vector<bool>{false, false}));
+}
+
+TEST_F(ModBusClient, ReadWriteRegisters) {
+    client.writeRegisters(1, 0, {100, 200});
+
+    const auto values = client.readWriteRegisters(1, 0, 3, 1, {7, 8});
+
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(sent.back().functionCode(), utils::ReadWriteMultipleRegisters);
+    EXPECT_EQ(values, (std::vector<uint16_t>{100, 7, 8}));
+}
+
+TEST_F(ModBusClient, MaskWriteRegister) {
+    client.writeRegister(1, 5, 0x0F0F);
+
+    client.setRegisterBits(1, 5, 0x8001);
+    client.clearRegisterBits(1, 5, 0x000E);
+    client.maskWriteRegister(1, 5, 0xFF00, 0x0042);
+
+    // Every change is a single transaction
+    ASSERT_EQ(sent.size(), 4);
+    EXPECT_EQ(sent.back().functionCode(), utils::MaskWriteRegister);
+    EXPECT_EQ(client.readHoldingRegisters(1, 5, 1), (std::vector<uint16_t>{0x8F42}));
+}
+
+TEST_F(ModBusClient, ReadFIFOQueue) {
+    store.addFifo(100);
+    EXPECT_TRUE(client.readFIFOQueue(1, 100).empty());
+
+    store.pushFifo(100, 0x01B8);
+    store.pushFifo(100, 0x1284);
+    EXPECT_EQ(client.readFIFOQueue(1, 100), (std::vector<uint16_t>{0x01B8, 0x1284}));
+    EXPECT_TRUE(client.readFIFOQueue(1, 100).empty());
+}
+
+TEST_F(ModBusClient, FileRecords) {
+    store.addFile(3, 2000);
+
+    client.writeFileRecords(1, {{3, 10, 2, {0x1111, 0x2222}}});
+    const auto records = client.readFileRecords(1, {{3, 9, 3, {}}, {3, 11, 1, {}}});
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].fileNumber, 3);
+    EXPECT_EQ(records[0].data, (std::vector<uint16_t>{0, 0x1111, 0x2222}));
+    EXPECT_EQ(records[1].data, (std::vector<uint16_t>{0x2222}));
+}
+
+TEST_F(ModBusClient, PipelinedFileTransfer) {
+    store.addFile(3, 2000);
+    std::vector<std::size_t> batches;
+
+    // Pipeline records the size of each batch and then loops back
+    ModbusClient pipelined(
+        [this](const ModbusRequest &request) {
+            return store.handle(ModbusRequest::fromRaw(request.toRaw()));
+        },
+        [&](const std::vector<ModbusRequest> &requests) {
+            batches.push_back(requests.size());
+            std::vector<ModbusResponse> responses;
+            for (const auto &request : requests)
+                responses.push_back(ModbusResponse::fromRaw(
+                    store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw()));
+            return responses;
+        });
+
+    std::vector<uint16_t> data(1500);
+    for (std::size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<uint16_t>(i * 7);
+
+    pipelined.writeFile(1, 3, 200, data);
+    EXPECT_EQ(pipelined.readFile(1, 3, 200, data.size()), data);
+
+    // 122 records per write and 121 per read, each transfer is a single batch
+    EXPECT_EQ(batches, (std::vector<std::size_t>{13, 13}));
+
+    // Last record of the file is 9999, transfers continue into the next file
+    store.addFile(4, 10000);
+    store.addFile(5, 10000);
+    store.addFile(6, 10);
+    data.resize(10005);
+    pipelined.writeFile(1, 4, 9998, data);
+    EXPECT_EQ(pipelined.readFile(1, 4, 9998, data.size()), data);
+    EXPECT_EQ(pipelined.readFile(1, 6, 0, 3),
+              (std::vector<uint16_t>(data.end() - 3, data.end())));
+
+    // There is no file after 0xFFFF
+    EXPECT_THROW(utils::ignore_result(pipelined.readFile(1, 0xFFFF, 9999, 2)),
+                 ModbusException);
+    EXPECT_THROW(pipelined.writeFile(1, 0xFFFF, 9999, {1, 2}), ModbusException);
+}
+
+TEST(ModbusClientChunks, PipelinedRanges) {
+    ModbusDataStore store(5000, 0, 0, 2000);
+    std::vector<std::vector<ModbusRequest>> batches;
+
+    ModbusClient client(
+        [&](const ModbusRequest &request) {
+            batches.push_back({request});
+            return ModbusResponse::fromRaw(
+                store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+        },
+        [&](const std::vector<ModbusRequest> &requests) {
+            batches.push_back(requests);
+            std::vector<ModbusResponse> responses;
+            for (const auto &request : requests)
+                responses.push_back(ModbusResponse::fromRaw(
+                    store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw()));
+            return responses;
+        });
+
+    std::vector<ModbusCell> registers;
+    for (uint16_t i = 0; i < 1024; i++)
+        registers.push_back(ModbusCell::initReg(static_cast<uint16_t>(i * 3)));
+    store.write(utils::InputRegisters, 0x100, registers);
+
+    // 8 * 125 + 24 registers, in a single batch
+    const auto values = client.read(1, utils::ReadAnalogInputRegisters, 0x100, 1024);
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches[0].size(), 9);
+    EXPECT_EQ(batches[0][8].registerAddress(), 0x100 + 1000);
+    EXPECT_EQ(batches[0][8].numberOfRegisters(), 24);
+    ASSERT_EQ(values.size(), 1024);
+    for (std::size_t i = 0; i < values.size(); i++)
+        EXPECT_EQ(values[i].reg(), registers[i].reg());
+
+    // Coils are written by 1968 and read by 2000
+    std::vector<bool> coils(4001);
+    for (std::size_t i = 0; i < coils.size(); i++)
+        coils[i] = i % 3 == 0;
+    batches.clear();
+    client.writeCoils(1, 7, coils);
+    EXPECT_EQ(client.readCoils(1, 7, 4001), coils);
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0].size(), 3);
+    EXPECT_EQ(batches[1].size(), 3);
+    EXPECT_EQ(batches[1][2].numberOfRegisters(), 1);
+
+    // Single write functions send one value per request
+    batches.clear();
+    client.write(1, utils::WriteSingleDiscreteOutputCoil, 0,
+                 {ModbusCell::initCoil(true), ModbusCell::initCoil(true)});
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches[0].size(), 2);
+    EXPECT_EQ(client.readCoils(1, 0, 2), (std::vector<bool>{true, true}));
+
+    // Single chunk does not need the pipeline
+    batches.clear();
+    utils::ignore_result(client.readInputRegisters(1, 0, 125));
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches[0].size(), 1);
+
+    EXPECT_THROW(utils::ignore_result(
+                     client.read(1, utils::ReadAnalogInputRegisters, 0xFFFF, 2)),
+                 ModbusException);
+    EXPECT_THROW(utils::ignore_result(
+                     client.read(1, utils::WriteSingleAnalogOutputRegister, 0, 1)),
+                 ModbusException);
+    EXPECT_THROW(client.write(1, utils::ReadDiscreteOutputCoils, 0,
+                              {ModbusCell::initCoil(true)}),
+                 ModbusException);
+}
+
+TEST_F(ModBusClient, DeviceIdentification) {
+    std::map<uint8_t, std::string> objects = {{deviceId::VendorName, "Vendor"},
+                                              {deviceId::ProductCode, "PC-1"},
+                                              {deviceId::MajorMinorRevision, "1.0"}};
+    // Extended objects need more than one response
+    for (int id = 0x80; id < 0x90; id++)
+        objects[static_cast<uint8_t>(id)] = std::string(40, 'x');
+    store.setDeviceObjects(objects);
+
+    const auto identification =
+        client.readDeviceIdentification(1, deviceId::Extended, deviceId::VendorName);
+    EXPECT_EQ(identification.objects, objects);
+    EXPECT_FALSE(identification.moreFollows);
+    EXPECT_GT(sent.size(), 1);
+
+    sent.clear();
+    ModbusDeviceIdCache cache;
+    for (int i = 0; i < 3; i++) {
+        const auto cached =
+            cache.get("loopback", 1, [&] { return client.readDeviceIdentification(1); });
+        EXPECT_EQ(cached.object(deviceId::ProductCode), "PC-1");
+    }
+    EXPECT_EQ(sent.size(), 1);
+}
+
+TEST_F(ModBusClient, ExceptionResponse) {
+    try {
+        utils::ignore_result(client.readHoldingRegisters(4, 60, 10));
+        FAIL() << "Read outside the table";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::IllegalDataAddress);
+        EXPECT_EQ(ex.slaveID(), 4);
+    }
+}
+
+TEST_F(ModBusClient, MismatchedResponse) {
+    ModbusClient wrongSlave([](const ModbusRequest &request) {
+        return ModbusResponse(request.slaveID() + 1, request.functionCode(), 0, 1,
+                              {ModbusCell::initReg(0)});
+    });
+
+    try {
+        utils::ignore_result(wrongSlave.readHoldingRegisters(1, 0, 1));
+        FAIL() << "Response of other slave was accepted";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::ProtocolError);
+    }
+}
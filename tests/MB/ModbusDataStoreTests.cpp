@@ -0,0 +1,211 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusDataStore.hpp"
+#include "MB/modbusException.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+
+class ModBusDataStore : public ::testing::Test {
+  protected:
+    ModbusDataStore store{16, 16, 32, 8};
+
+    // Request goes through the codec, as it would come from the master
+    ModbusResponse handle(const ModbusRequest &request) {
+        const auto parsed = ModbusRequest::fromRaw(request.toRaw());
+        return ModbusResponse::fromRaw(store.handle(parsed).toRaw());
+    }
+};
+
+TEST_F(ModBusDataStore, ReadsAndWrites) {
+    utils::ignore_result(
+        handle(ModbusRequest(1, utils::WriteMultipleAnalogOutputHoldingRegisters, 4, 3,
+                             {ModbusCell::initReg(10), ModbusCell::initReg(20),
+                              ModbusCell::initReg(30)})));
+    utils::ignore_result(handle(ModbusRequest(1, utils::WriteSingleDiscreteOutputCoil, 9,
+                                              1, {ModbusCell::initCoil(true)})));
+    store.write(utils::InputRegisters, 0, {ModbusCell::initReg(7)});
+
+    const auto registers =
+        handle(ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters, 3, 4));
+    ASSERT_EQ(registers.registerValues().size(), 4);
+    EXPECT_EQ(registers.registerValues()[0].reg(), 0);
+    EXPECT_EQ(registers.registerValues()[1].reg(), 10);
+    EXPECT_EQ(registers.registerValues()[3].reg(), 30);
+
+    const auto coils = handle(ModbusRequest(1, utils::ReadDiscreteOutputCoils, 8, 3));
+    EXPECT_FALSE(coils.registerValues()[0].coil());
+    EXPECT_TRUE(coils.registerValues()[1].coil());
+
+    const auto input = handle(ModbusRequest(1, utils::ReadAnalogInputRegisters, 0, 1));
+    EXPECT_EQ(input.registerValues()[0].reg(), 7);
+}
+
+TEST_F(ModBusDataStore, ReadWriteMultipleRegisters) {
+    store.write(utils::HoldingRegisters, 0,
+                {ModbusCell::initReg(1), ModbusCell::initReg(2)});
+
+    ModbusRequest request(5, utils::ReadWriteMultipleRegisters, 0, 3,
+                          {ModbusCell::initReg(0xAA), ModbusCell::initReg(0xBB)});
+    request.setWriteAddress(1);
+
+    // Write is applied before the read
+    const auto response = handle(request);
+    EXPECT_EQ(response.slaveID(), 5);
+    EXPECT_EQ(response.functionCode(), utils::ReadWriteMultipleRegisters);
+    ASSERT_EQ(response.registerValues().size(), 3);
+    EXPECT_EQ(response.registerValues()[0].reg(), 1);
+    EXPECT_EQ(response.registerValues()[1].reg(), 0xAA);
+    EXPECT_EQ(response.registerValues()[2].reg(), 0xBB);
+}
+
+TEST_F(ModBusDataStore, MaskWriteRegister) {
+    // Example from the specification: 0x12 & 0xF2 | 0x25 & ~0xF2 = 0x17
+    store.write(utils::HoldingRegisters, 4, {ModbusCell::initReg(0x12)});
+
+    const auto response =
+        handle(ModbusRequest(1, utils::MaskWriteRegister, 4, 1,
+                             {ModbusCell::initReg(0x00F2), ModbusCell::initReg(0x0025)}));
+    EXPECT_EQ(response.registerAddress(), 4);
+    EXPECT_EQ(response.registerValues()[1].reg(), 0x0025);
+    EXPECT_EQ(store.read(utils::HoldingRegisters, 4, 1)[0].reg(), 0x17);
+
+    EXPECT_THROW(utils::ignore_result(store.handle(ModbusRequest(
+                     1, utils::MaskWriteRegister, 32, 1,
+                     {ModbusCell::initReg(0), ModbusCell::initReg(0)}))),
+                 ModbusException);
+}
+
+TEST_F(ModBusDataStore, ReadFIFOQueue) {
+    store.addFifo(0x04DE, 64);
+    for (uint16_t i = 0; i < 40; i++)
+        EXPECT_TRUE(store.pushFifo(0x04DE, i));
+
+    // Queue is drained by at most 31 values
+    const auto first = handle(ModbusRequest(1, utils::ReadFIFOQueue, 0x04DE));
+    ASSERT_EQ(first.numberOfRegisters(), 31);
+    EXPECT_EQ(first.registerValues()[0].reg(), 0);
+    EXPECT_EQ(first.registerValues()[30].reg(), 30);
+
+    const auto second = handle(ModbusRequest(1, utils::ReadFIFOQueue, 0x04DE));
+    ASSERT_EQ(second.numberOfRegisters(), 9);
+    EXPECT_EQ(second.registerValues()[0].reg(), 31);
+    EXPECT_EQ(store.fifoSize(0x04DE), 0);
+
+    const auto empty = handle(ModbusRequest(1, utils::ReadFIFOQueue, 0x04DE));
+    EXPECT_EQ(empty.numberOfRegisters(), 0);
+
+    try {
+        const ModbusRequest request(1, utils::ReadFIFOQueue, 0x04DF);
+        utils::ignore_result(store.handle(request));
+        FAIL() << "Read of not registered queue";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::IllegalDataAddress);
+    }
+}
+
+TEST_F(ModBusDataStore, FileRecords) {
+    store.addFile(4, 16);
+
+    ModbusRequest write(1, utils::WriteFileRecord);
+    write.setFileRecords({{4, 7, 3, {0x06AF, 0x04BE, 0x100D}}, {4, 0, 1, {0x0001}}});
+    EXPECT_EQ(handle(write).fileRecords(), write.fileRecords());
+
+    ModbusRequest read(1, utils::ReadFileRecord);
+    read.setFileRecords({{4, 6, 3, {}}, {4, 0, 1, {}}});
+    const auto records = handle(read).fileRecords();
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].data, (std::vector<uint16_t>{0, 0x06AF, 0x04BE}));
+    EXPECT_EQ(records[1].data, (std::vector<uint16_t>{1}));
+
+    // Nothing is written if any sub-request is outside of the file
+    write.setFileRecords({{4, 0, 1, {0xAAAA}}, {4, 15, 2, {1, 2}}});
+    EXPECT_THROW(utils::ignore_result(store.handle(write)), ModbusException);
+    EXPECT_EQ(store.file(4)[0], 1);
+
+    read.setFileRecords({{5, 0, 1, {}}});
+    EXPECT_THROW(utils::ignore_result(store.handle(read)), ModbusException);
+}
+
+TEST_F(ModBusDataStore, DeviceIdentification) {
+    store.setDeviceObjects({{deviceId::VendorName, "Vendor"},
+                            {deviceId::ProductCode, "PC-1"},
+                            {deviceId::MajorMinorRevision, "1.0"}});
+
+    ModbusRequest request(1, utils::ReadDeviceIdentification);
+    request.setDeviceIdentification(deviceId::Basic, 0);
+    const auto response = handle(request);
+    EXPECT_EQ(response.deviceIdentification().objects.size(), 3);
+    EXPECT_EQ(response.deviceIdentification().object(deviceId::ProductCode), "PC-1");
+
+    request.setDeviceIdentification(deviceId::Specific, deviceId::VendorUrl);
+    try {
+        utils::ignore_result(store.handle(request));
+        FAIL() << "Object does not exist";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::IllegalDataAddress);
+    }
+}
+
+TEST_F(ModBusDataStore, Exceptions) {
+    try {
+        utils::ignore_result(
+            store.handle(ModbusRequest(3, utils::ReadAnalogInputRegisters, 6, 4)));
+        FAIL() << "Read outside the table";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::IllegalDataAddress);
+        EXPECT_EQ(ex.slaveID(), 3);
+        EXPECT_EQ(ex.functionCode(), utils::ReadAnalogInputRegisters);
+    }
+
+    try {
+        const ModbusRequest request(3, utils::ReadAnalogOutputHoldingRegisters, 0, 126);
+        utils::ignore_result(store.handle(request));
+        FAIL() << "Too many registers";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::IllegalDataValue);
+    }
+
+    // Failed read does not apply the write
+    ModbusRequest request(3, utils::ReadWriteMultipleRegisters, 30, 4,
+                          {ModbusCell::initReg(9)});
+    request.setWriteAddress(0);
+    EXPECT_THROW(utils::ignore_result(store.handle(request)), ModbusException);
+    EXPECT_EQ(store.read(utils::HoldingRegisters, 0, 1)[0].reg(), 0);
+
+    EXPECT_THROW(utils::ignore_result(store.read(utils::OutputCoils, 15, 2)),
+                 ModbusException);
+}
+
+TEST_F(ModBusDataStore, AtomicReadWrite) {
+    // Writer keeps both registers equal, readers must never see them torn
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+
+    std::thread reader([&] {
+        while (!stop) {
+            ModbusRequest request(1, utils::ReadWriteMultipleRegisters, 0, 2,
+                                  {ModbusCell::initReg(0)});
+            request.setWriteAddress(10);
+            const auto values = store.handle(request).registerValues();
+            if (values[0].reg() != values[1].reg())
+                torn++;
+        }
+    });
+
+    for (uint16_t i = 0; i < 2000; i++) {
+        const ModbusRequest write(1, utils::WriteMultipleAnalogOutputHoldingRegisters, 0,
+                                  2, {ModbusCell::initReg(i), ModbusCell::initReg(i)});
+        utils::ignore_result(store.handle(write));
+    }
+
+    stop = true;
+    reader.join();
+    EXPECT_EQ(torn, 0);
+}
@@ -0,0 +1,147 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusDeviceIdentification.hpp"
+#include "MB/modbusException.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+
+namespace {
+const std::map<uint8_t, std::string> objects = {
+    {deviceId::VendorName, "Company identification"},
+    {deviceId::ProductCode, "Product code"},
+    {deviceId::MajorMinorRevision, "V2.11"},
+    {deviceId::ModelName, "Model"},
+};
+} // namespace
+
+TEST(ModbusDeviceIdentification, Encoding) {
+    ModbusDeviceIdentification request;
+    request.readCode = deviceId::Regular;
+    request.objectId = deviceId::ProductCode;
+
+    std::vector<uint8_t> raw;
+    deviceId::encodeRequest(raw, request);
+    EXPECT_EQ(raw, (std::vector<uint8_t>{0x0E, 0x02, 0x01}));
+    EXPECT_EQ(deviceId::decodeRequest(raw.data(), raw.size()), request);
+
+    const auto response = deviceId::respond(objects, deviceId::Basic, 0);
+    raw.clear();
+    deviceId::encodeResponse(raw, response);
+    EXPECT_EQ(raw.size(), 6 + 3 * 2 + 22 + 12 + 5);
+
+    std::size_t consumed = 0;
+    EXPECT_EQ(deviceId::decodeResponse(raw.data(), raw.size(), consumed), response);
+    EXPECT_EQ(consumed, raw.size());
+
+    // Object longer than the rest of the response
+    raw[7] = 0x30;
+    EXPECT_THROW(deviceId::decodeResponse(raw.data(), raw.size(), consumed),
+                 ModbusException);
+}
+
+TEST(ModbusDeviceIdentification, Respond) {
+    const auto basic = deviceId::respond(objects, deviceId::Basic, 0);
+    EXPECT_EQ(basic.objects.size(), 3);
+    EXPECT_FALSE(basic.moreFollows);
+    // Regular objects are present, individual access is supported
+    EXPECT_EQ(basic.conformityLevel, 0x82);
+
+    const auto regular = deviceId::respond(objects, deviceId::Regular, 0);
+    EXPECT_EQ(regular.object(deviceId::ModelName), "Model");
+
+    // Unknown object restarts the stream
+    EXPECT_EQ(deviceId::respond(objects, deviceId::Regular, 0x04).objects, objects);
+
+    const auto specific = deviceId::respond(objects, deviceId::Specific, 0x02);
+    ASSERT_EQ(specific.objects.size(), 1);
+    EXPECT_EQ(specific.object(0x02), "V2.11");
+
+    EXPECT_THROW(deviceId::respond(objects, deviceId::Specific, 0x04), ModbusException);
+    EXPECT_THROW(deviceId::respond(objects, 0x05, 0), ModbusException);
+}
+
+TEST(ModbusDeviceIdentification, MoreFollows) {
+    auto big = objects;
+    for (uint8_t id = 0x80; id < 0x88; id++)
+        big[id] = std::string(60, static_cast<char>('a' + (id - 0x80)));
+
+    const auto first = deviceId::respond(big, deviceId::Extended, 0);
+    ASSERT_TRUE(first.moreFollows);
+    EXPECT_EQ(first.conformityLevel, 0x83);
+
+    std::vector<uint8_t> raw;
+    EXPECT_NO_THROW(deviceId::encodeResponse(raw, first));
+
+    // Continuation returns every object exactly once
+    auto received = first.objects;
+    auto next     = first;
+    while (next.moreFollows) {
+        next = deviceId::respond(big, deviceId::Extended, next.objectId);
+        EXPECT_EQ(received.count(next.objects.begin()->first), 0);
+        received.insert(next.objects.begin(), next.objects.end());
+    }
+    EXPECT_EQ(received, big);
+}
+
+TEST(ModbusDeviceIdentification, Cache) {
+    ModbusDeviceIdCache cache;
+    std::atomic<int> fetches{0};
+
+    const auto fetch = [&] {
+        fetches++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return deviceId::respond(objects, deviceId::Basic, 0);
+    };
+
+    // Concurrent requests for one device wait for a single fetch
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+        threads.emplace_back([&] {
+            EXPECT_EQ(cache.get("10.0.0.5:502", 1, fetch).object(deviceId::ProductCode),
+                      "Product code");
+        });
+    for (auto &thread : threads)
+        thread.join();
+    EXPECT_EQ(fetches, 1);
+
+    // Other unit of the same endpoint is another device
+    utils::ignore_result(cache.get("10.0.0.5:502", 2, fetch));
+    EXPECT_EQ(fetches, 2);
+    EXPECT_TRUE(cache.find("10.0.0.5:502", 1).has_value());
+    EXPECT_FALSE(cache.find("10.0.0.6:502", 1).has_value());
+
+    cache.invalidate("10.0.0.5:502");
+    EXPECT_EQ(cache.size(), 0);
+
+    // Failures are not cached
+    EXPECT_THROW(utils::ignore_result(cache.get(
+                     "/dev/ttyUSB0", 7,
+                     []() -> ModbusDeviceIdentification {
+                         throw ModbusException(utils::Timeout);
+                     })),
+                 ModbusException);
+    EXPECT_EQ(cache.size(), 0);
+    utils::ignore_result(cache.get("/dev/ttyUSB0", 7, fetch));
+    EXPECT_EQ(cache.size(), 1);
+
+    // Failed fetch does not drop the newer one, started after invalidation
+    EXPECT_THROW(utils::ignore_result(cache.get(
+                     "/dev/ttyUSB0", 8,
+                     [&]() -> ModbusDeviceIdentification {
+                         cache.invalidate("/dev/ttyUSB0", 8);
+                         utils::ignore_result(cache.get("/dev/ttyUSB0", 8, fetch));
+                         throw ModbusException(utils::Timeout);
+                     })),
+                 ModbusException);
+    EXPECT_TRUE(cache.find("/dev/ttyUSB0", 8).has_value());
+}
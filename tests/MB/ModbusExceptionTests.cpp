@@ -15,3 +15,12 @@ TEST(ModbusException, Other) {
     EXPECT_EQ(MB::ModbusException({0x0A, 0x82, 0x02}).functionCode(),
               MB::utils::ReadDiscreteInputContacts);
 }
+
+TEST(ModbusException, ToRaw) {
+    const MB::ModbusException ex(MB::utils::IllegalDataAddress, 0x0A,
+                                 MB::utils::ReadDiscreteOutputCoils);
+    const std::vector<uint8_t> raw = {0x0A, 0x81, 0x02};
+
+    EXPECT_EQ(ex.toRaw(), raw);
+    EXPECT_EQ(MB::ModbusException(ex.toRaw()).getErrorCode(), MB::utils::IllegalDataAddress);
+}
@@ -0,0 +1,70 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusFairQueue.hpp"
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace MB;
+
+namespace {
+// Client ids of the popped items, in order
+std::string drain(ModbusFairQueue<char> &queue) {
+    std::string order;
+    while (const auto item = queue.pop())
+        order.push_back(*item);
+    return order;
+}
+} // namespace
+
+TEST(ModbusFairQueue, RoundRobin) {
+    ModbusFairQueue<char> queue(10, 4);
+    for (int i = 0; i < 4; i++)
+        EXPECT_TRUE(queue.push(1, 'a', 10));
+    // Over the limit of the client
+    EXPECT_FALSE(queue.push(1, 'a', 10));
+    EXPECT_TRUE(queue.push(2, 'b', 10));
+    EXPECT_TRUE(queue.push(3, 'c', 10));
+    EXPECT_EQ(queue.size(), 6);
+    EXPECT_EQ(queue.size(1), 4);
+
+    // Clients that came later do not wait for the whole queue of the first one
+    EXPECT_EQ(drain(queue), "abcaaa");
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.size(1), 0);
+
+    EXPECT_THROW(ModbusFairQueue<char>(0, 1), std::invalid_argument);
+    EXPECT_THROW(queue.setLimit(0), std::invalid_argument);
+}
+
+TEST(ModbusFairQueue, SharesAndCosts) {
+    ModbusFairQueue<char> queue(10, 16);
+    queue.setShare(1, 2);
+    EXPECT_EQ(queue.share(1), 2);
+    EXPECT_EQ(queue.share(2), 1);
+    EXPECT_THROW(queue.setShare(2, 0), std::invalid_argument);
+
+    for (int i = 0; i < 6; i++) {
+        queue.push(1, 'a', 10);
+        queue.push(2, 'b', 10);
+    }
+    EXPECT_EQ(drain(queue), "aabaabaabbbb");
+
+    // Expensive item waits, until enough deficit is saved
+    queue.removeClient(1);
+    queue.push(1, 'a', 25);
+    for (int i = 0; i < 4; i++)
+        queue.push(2, 'b', 10);
+    EXPECT_EQ(drain(queue), "bbabb");
+
+    // Find gives access to queued items
+    queue.push(1, 'a', 1);
+    auto *found = queue.find([](char item) { return item == 'a'; });
+    ASSERT_NE(found, nullptr);
+    *found = 'x';
+    EXPECT_EQ(queue.find([](char item) { return item == 'a'; }), nullptr);
+    EXPECT_EQ(drain(queue), "x");
+}
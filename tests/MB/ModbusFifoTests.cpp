@@ -0,0 +1,62 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusException.hpp"
+#include "MB/modbusFifo.hpp"
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace MB;
+
+TEST(ModbusFifo, Drain) {
+    ModbusFifo fifo(4);
+
+    EXPECT_TRUE(fifo.empty());
+    EXPECT_TRUE(fifo.read().empty());
+
+    fifo.push(1);
+    fifo.push(2);
+    EXPECT_EQ(fifo.read(), (std::vector<uint16_t>{1, 2}));
+    EXPECT_TRUE(fifo.empty());
+
+    // Ring buffer wraps around
+    for (uint16_t i = 3; i <= 6; i++)
+        EXPECT_TRUE(fifo.push(i));
+    EXPECT_EQ(fifo.read(), (std::vector<uint16_t>{3, 4, 5, 6}));
+}
+
+TEST(ModbusFifo, Overwrite) {
+    ModbusFifo fifo(3);
+
+    for (uint16_t i = 0; i < 3; i++)
+        EXPECT_TRUE(fifo.push(i));
+    EXPECT_FALSE(fifo.push(3));
+    EXPECT_FALSE(fifo.push(4));
+
+    EXPECT_EQ(fifo.overwritten(), 2);
+    EXPECT_EQ(fifo.read(), (std::vector<uint16_t>{2, 3, 4}));
+}
+
+TEST(ModbusFifo, ReadLimit) {
+    ModbusFifo draining(100);
+    for (uint16_t i = 0; i < 40; i++)
+        draining.push(i);
+
+    EXPECT_EQ(draining.read().size(), ModbusFifo::MaxReadCount);
+    EXPECT_EQ(draining.size(), 40 - ModbusFifo::MaxReadCount);
+
+    // Without consuming, values stay and too long queue cannot be read
+    ModbusFifo keeping(100, false);
+    keeping.push(7);
+    EXPECT_EQ(keeping.read(), (std::vector<uint16_t>{7}));
+    EXPECT_EQ(keeping.size(), 1);
+
+    for (uint16_t i = 0; i < ModbusFifo::MaxReadCount; i++)
+        keeping.push(i);
+    EXPECT_THROW(utils::ignore_result(keeping.read()), ModbusException);
+
+    EXPECT_THROW(ModbusFifo(0), std::invalid_argument);
+}
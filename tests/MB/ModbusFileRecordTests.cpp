@@ -0,0 +1,117 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusException.hpp"
+#include "MB/modbusFileRecord.hpp"
+#include "gtest/gtest.h"
+
+#include <numeric>
+#include <vector>
+
+using namespace MB;
+
+TEST(ModbusFileRecord, ReadRequest) {
+    const std::vector<ModbusFileRecord> records = {{4, 1, 2, {}}, {3, 9, 2, {}}};
+
+    std::vector<uint8_t> raw;
+    fileRecord::encodeReadRequest(raw, records);
+    EXPECT_EQ(raw, (std::vector<uint8_t>{0x0E, 0x06, 0x00, 0x04, 0x00, 0x01, 0x00, 0x02,
+                                         0x06, 0x00, 0x03, 0x00, 0x09, 0x00, 0x02}));
+    EXPECT_EQ(fileRecord::decodeReadRequest(raw.data(), raw.size()), records);
+
+    // Byte count is not a multiple of sub-request size
+    raw[0] = 0x0D;
+    EXPECT_THROW(fileRecord::decodeReadRequest(raw.data(), raw.size()), ModbusException);
+
+    // Unknown reference type
+    raw[0] = 0x0E;
+    raw[8] = 0x07;
+    EXPECT_THROW(fileRecord::decodeReadRequest(raw.data(), raw.size()), ModbusException);
+
+    // 36 sub-requests do not fit in single request
+    std::vector<ModbusFileRecord> tooMany(36, {1, 0, 1, {}});
+    EXPECT_THROW(fileRecord::encodeReadRequest(raw, tooMany), ModbusException);
+}
+
+TEST(ModbusFileRecord, ReadResponse) {
+    const std::vector<uint8_t> raw = {0x0C, 0x05, 0x06, 0x0D, 0xFE, 0x00, 0x20,
+                                      0x05, 0x06, 0x33, 0xCD, 0x00, 0x40};
+
+    const auto records = fileRecord::decodeReadResponse(raw.data(), raw.size());
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].data, (std::vector<uint16_t>{0x0DFE, 0x0020}));
+    EXPECT_EQ(records[1].data, (std::vector<uint16_t>{0x33CD, 0x0040}));
+
+    std::vector<uint8_t> encoded;
+    fileRecord::encodeReadResponse(encoded, records);
+    EXPECT_EQ(encoded, raw);
+
+    // Sub-response longer than the whole response
+    auto invalid = raw;
+    invalid[7]   = 0x07;
+    EXPECT_THROW(fileRecord::decodeReadResponse(invalid.data(), invalid.size()),
+                 ModbusException);
+}
+
+TEST(ModbusFileRecord, Write) {
+    const std::vector<ModbusFileRecord> records = {
+        {4, 7, 3, {0x06AF, 0x04BE, 0x100D}}, {5, 0, 1, {0x0001}}};
+
+    std::vector<uint8_t> raw;
+    fileRecord::encodeWrite(raw, records);
+    EXPECT_EQ(raw.size(), 1 + fileRecord::writeSize(records));
+    EXPECT_EQ(fileRecord::decodeWrite(raw.data(), raw.size()), records);
+
+    // Data shorter than record length
+    raw.resize(raw.size() - 2);
+    raw[0] = static_cast<uint8_t>(raw.size() - 1);
+    EXPECT_THROW(fileRecord::decodeWrite(raw.data(), raw.size()), ModbusException);
+}
+
+TEST(ModbusFileRecord, PackRead) {
+    // Single sub-request of 121 records fills the whole response
+    const auto transactions = fileRecord::packRead({{1, 0, 1000, {}}});
+    ASSERT_EQ(transactions.size(), 9);
+    EXPECT_EQ(transactions[0].size(), 1);
+    EXPECT_EQ(transactions[0][0].recordLength, 121);
+    EXPECT_EQ(transactions[1][0].recordNumber, 121);
+    EXPECT_EQ(transactions[8][0].recordLength, 1000 - 8 * 121);
+
+    // Short segments share transactions
+    std::vector<ModbusFileRecord> segments;
+    for (uint16_t file = 1; file <= 20; file++)
+        segments.push_back({file, 0, 10, {}});
+    const auto packed = fileRecord::packRead(segments);
+    ASSERT_EQ(packed.size(), 2);
+    EXPECT_EQ(packed[0].size(), 11);
+    EXPECT_EQ(packed[1].size(), 9);
+
+    for (const auto &records : packed) {
+        EXPECT_LE(fileRecord::readRequestSize(records), fileRecord::MaxReadBytes);
+        EXPECT_LE(fileRecord::readResponseSize(records), fileRecord::MaxReadBytes);
+    }
+}
+
+TEST(ModbusFileRecord, PackWrite) {
+    std::vector<uint16_t> data(1000);
+    std::iota(data.begin(), data.end(), 0);
+
+    const auto transactions =
+        fileRecord::packWrite({{2, 100, static_cast<uint16_t>(data.size()), data}});
+    ASSERT_EQ(transactions.size(), 9);
+
+    std::vector<uint16_t> joined;
+    uint16_t next = 100;
+    for (const auto &records : transactions) {
+        EXPECT_LE(fileRecord::writeSize(records), fileRecord::MaxWriteBytes);
+        for (const auto &record : records) {
+            EXPECT_EQ(record.recordNumber, next);
+            next += record.recordLength;
+            joined.insert(joined.end(), record.data.begin(), record.data.end());
+        }
+    }
+    EXPECT_EQ(joined, data);
+
+    EXPECT_THROW(fileRecord::packWrite({{2, 0, 5, {1, 2}}}), ModbusException);
+}
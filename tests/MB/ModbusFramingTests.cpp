@@ -0,0 +1,98 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusFraming.hpp"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace MB;
+
+class ModBusFraming : public ::testing::Test {
+  protected:
+    // Testing data from https://www.simplymodbus.ca/
+    std::vector<uint8_t> fn3Request  = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87};
+    std::vector<uint8_t> fn16Request = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04,
+                                        0x00, 0x0A, 0x01, 0x02, 0xC6, 0xF0};
+    std::vector<uint8_t> fn3Response = {0x11, 0x03, 0x06, 0xAE, 0x41, 0x56,
+                                        0x52, 0x43, 0x40, 0x49, 0xAD};
+    std::vector<uint8_t> fn16Response  = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x12, 0x98};
+    std::vector<uint8_t> exceptionData = {0x0A, 0x81, 0x02, 0xB0, 0x53};
+    std::vector<uint8_t> fn21Data      = {0x11, 0x15, 0x0D, 0x06, 0x00, 0x04,
+                                          0x00, 0x07, 0x00, 0x03, 0x06, 0xAF,
+                                          0x04, 0xBE, 0x10, 0x0D, 0xDB, 0xC7};
+    std::vector<uint8_t> fn22Data      = {0x11, 0x16, 0x00, 0x04, 0x00,
+                                          0xF2, 0x00, 0x25, 0x66, 0xE2};
+    std::vector<uint8_t> fn24Request   = {0x01, 0x18, 0x04, 0xDE, 0x03, 0x47};
+    std::vector<uint8_t> fn24Response  = {0x01, 0x18, 0x00, 0x06, 0x00, 0x02,
+                                          0x01, 0xB8, 0x12, 0x84, 0x19, 0x18};
+    std::vector<uint8_t> fn23Request   = {0x11, 0x17, 0x00, 0x03, 0x00, 0x06, 0x00,
+                                          0x0E, 0x00, 0x03, 0x06, 0x00, 0xFF, 0x00,
+                                          0xFF, 0x00, 0xFF, 0x4B, 0x54};
+    std::vector<uint8_t> fn23Response  = {0x11, 0x17, 0x0C, 0x00, 0xFE, 0x0A,
+                                          0xCD, 0x00, 0x01, 0x00, 0x03, 0x00,
+                                          0x0D, 0x00, 0xFF, 0x0D, 0x75};
+};
+
+TEST_F(ModBusFraming, RtuRequestLength) {
+    EXPECT_EQ(framing::rtuRequestLength(fn3Request.data(), 1), 2);
+    EXPECT_EQ(framing::rtuRequestLength(fn3Request.data(), 2), fn3Request.size());
+    EXPECT_EQ(framing::rtuRequestLength(fn3Request.data(), fn3Request.size()),
+              fn3Request.size());
+
+    // Byte count is needed to know the length
+    EXPECT_EQ(framing::rtuRequestLength(fn16Request.data(), 4), 7);
+    EXPECT_EQ(framing::rtuRequestLength(fn16Request.data(), 7), fn16Request.size());
+
+    EXPECT_EQ(framing::rtuRequestLength(fn21Data.data(), 2), 3);
+    EXPECT_EQ(framing::rtuRequestLength(fn21Data.data(), 3), fn21Data.size());
+    EXPECT_EQ(framing::rtuRequestLength(fn22Data.data(), 2), fn22Data.size());
+    EXPECT_EQ(framing::rtuRequestLength(fn24Request.data(), 2), fn24Request.size());
+    EXPECT_EQ(framing::rtuRequestLength(fn23Request.data(), 2), 11);
+    EXPECT_EQ(framing::rtuRequestLength(fn23Request.data(), 11), fn23Request.size());
+
+    const std::vector<uint8_t> unknown = {0x11, 0x64};
+    EXPECT_FALSE(framing::rtuRequestLength(unknown.data(), unknown.size()).has_value());
+}
+
+TEST_F(ModBusFraming, RtuResponseLength) {
+    EXPECT_EQ(framing::rtuResponseLength(fn3Response.data(), 2), 3);
+    EXPECT_EQ(framing::rtuResponseLength(fn3Response.data(), 3), fn3Response.size());
+    EXPECT_EQ(framing::rtuResponseLength(fn16Response.data(), 2), fn16Response.size());
+    EXPECT_EQ(framing::rtuResponseLength(exceptionData.data(), 2), exceptionData.size());
+    EXPECT_EQ(framing::rtuResponseLength(fn21Data.data(), 3), fn21Data.size());
+    EXPECT_EQ(framing::rtuResponseLength(fn22Data.data(), 2), fn22Data.size());
+    EXPECT_EQ(framing::rtuResponseLength(fn23Response.data(), 3), fn23Response.size());
+
+    // FIFO byte count is 16 bit
+    EXPECT_EQ(framing::rtuResponseLength(fn24Response.data(), 3), 4);
+    EXPECT_EQ(framing::rtuResponseLength(fn24Response.data(), 4), fn24Response.size());
+    const std::vector<uint8_t> tooLong = {0x01, 0x18, 0x00, 0x42};
+    EXPECT_FALSE(framing::rtuResponseLength(tooLong.data(), tooLong.size()).has_value());
+
+    // Device identification objects are walked one by one
+    const std::vector<uint8_t> deviceId = {0x01, 0x2B, 0x0E, 0x01, 0x01, 0x00, 0x00, 0x02,
+                                           0x00, 0x03, 'A',  'B',  'C',  0x01, 0x00};
+    EXPECT_EQ(framing::rtuRequestLength(deviceId.data(), 2), 7);
+    EXPECT_EQ(framing::rtuResponseLength(deviceId.data(), 7), 8);
+    EXPECT_EQ(framing::rtuResponseLength(deviceId.data(), 8), 10);
+    EXPECT_EQ(framing::rtuResponseLength(deviceId.data(), 10), 15);
+    EXPECT_EQ(framing::rtuResponseLength(deviceId.data(), 15), deviceId.size() + 2);
+}
+
+TEST_F(ModBusFraming, MbapLength) {
+    const std::vector<uint8_t> frame = {0x00, 0x01, 0x00, 0x00, 0x00, 0x06,
+                                        0x11, 0x03, 0x00, 0x6B, 0x00, 0x03};
+
+    EXPECT_EQ(framing::mbapFrameLength(frame.data(), 0), framing::MBAPHeaderSize);
+    EXPECT_EQ(framing::mbapFrameLength(frame.data(), 6), frame.size());
+
+    auto invalidProtocol = frame;
+    invalidProtocol[3]   = 0x01;
+    EXPECT_FALSE(framing::mbapFrameLength(invalidProtocol.data(), 6).has_value());
+
+    auto invalidLength = frame;
+    invalidLength[4]   = 0x01;
+    EXPECT_FALSE(framing::mbapFrameLength(invalidLength.data(), 6).has_value());
+}
@@ -164,3 +164,21 @@ TEST_F(ModBusFunctional, RequestToResponse) {
     ASSERT_EQ(request.numberOfRegisters(), response.numberOfRegisters());
     ASSERT_EQ(request.registerAddress(), response.registerAddress());
 }
+
+TEST_F(ModBusFunctional, Broadcast) {
+    const auto broadcast = ModbusRequest(utils::BroadcastSlaveID,
+                                         utils::WriteSingleAnalogOutputRegister, 10, 1,
+                                         {ModbusCell::initReg(0x1234)});
+    const auto request   = ModbusRequest(1, utils::WriteSingleAnalogOutputRegister, 10, 1,
+                                         {ModbusCell::initReg(0x1234)});
+
+    ASSERT_TRUE(broadcast.isBroadcast());
+    ASSERT_FALSE(request.isBroadcast());
+
+    ASSERT_TRUE(utils::isBroadcastable(utils::WriteSingleDiscreteOutputCoil));
+    ASSERT_TRUE(utils::isBroadcastable(utils::WriteSingleAnalogOutputRegister));
+    ASSERT_TRUE(utils::isBroadcastable(utils::WriteMultipleDiscreteOutputCoils));
+    ASSERT_TRUE(utils::isBroadcastable(utils::WriteMultipleAnalogOutputHoldingRegisters));
+    ASSERT_FALSE(utils::isBroadcastable(utils::ReadAnalogOutputHoldingRegisters));
+    ASSERT_FALSE(utils::isBroadcastable(utils::ReadDiscreteInputContacts));
+}
@@ -0,0 +1,353 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusDataStore.hpp"
+#include "MB/modbusException.hpp"
+#include "MB/modbusGateway.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+namespace {
+std::vector<uint8_t> mbap(uint16_t transactionId, const ModbusRequest &request) {
+    const auto pdu = request.toRaw();
+    std::vector<uint8_t> frame;
+    utils::pushUint16(frame, transactionId);
+    utils::pushUint16(frame, 0x0000);
+    utils::pushUint16(frame, static_cast<uint16_t>(pdu.size()));
+    frame.insert(frame.end(), pdu.begin(), pdu.end());
+    return frame;
+}
+} // namespace
+
+class ModBusGateway : public ::testing::Test {
+  protected:
+    ModbusDataStore first{0, 0, 16, 0};
+    ModbusDataStore second{0, 0, 16, 0};
+    std::atomic<int> broadcasts = 0;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    // Responses by transaction id
+    std::map<uint16_t, std::vector<uint8_t>> replies;
+
+    ModbusGateway::Reply reply() {
+        return [this](std::vector<uint8_t> frame) {
+            std::lock_guard lock{mutex};
+            replies[utils::bigEndianConv(&frame[0])] = std::move(frame);
+            cond.notify_all();
+        };
+    }
+
+    std::vector<uint8_t> await(uint16_t transactionId) {
+        std::unique_lock lock{mutex};
+        EXPECT_TRUE(
+            cond.wait_for(lock, 5s, [&] { return replies.count(transactionId) != 0; }));
+        return replies[transactionId];
+    }
+
+    // Like devices on the bus, that do not answer broadcasts
+    static ModbusGateway::Transaction line(ModbusDataStore &store,
+                                           std::chrono::milliseconds delay) {
+        return [&store, delay](const ModbusRequest &request) {
+            std::this_thread::sleep_for(delay);
+            if (request.slaveID() == 3 || request.isBroadcast())
+                throw ModbusException(utils::Timeout, request.slaveID(),
+                                      request.functionCode());
+            return ModbusResponse::fromRaw(
+                store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+        };
+    }
+
+    ModbusGateway::Broadcast sender(ModbusDataStore &store) {
+        return [this, &store](const ModbusRequest &request) {
+            utils::ignore_result(store.handle(ModbusRequest::fromRaw(request.toRaw())));
+            broadcasts++;
+        };
+    }
+};
+
+TEST_F(ModBusGateway, Routing) {
+    ModbusGateway gateway;
+    gateway.addLine(line(first, 0ms), {1, 3});
+    gateway.addLine(line(second, 20ms), {2});
+    second.write(utils::HoldingRegisters, 0, {ModbusCell::initReg(0x0B0B)});
+
+    const ModbusRequest read1(1, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    const ModbusRequest read2(2, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+
+    // Slow line does not hold up the other one
+    gateway.handle(mbap(0x0200, read2), reply());
+    gateway.handle(mbap(0x0201, read2), reply());
+    gateway.handle(mbap(0x0100, read1), reply());
+    EXPECT_EQ(await(0x0100), (std::vector<uint8_t>{0x01, 0x00, 0x00, 0x00, 0x00, 0x05,
+                                                   0x01, 0x03, 0x02, 0x00, 0x00}));
+    EXPECT_EQ(await(0x0201), (std::vector<uint8_t>{0x02, 0x01, 0x00, 0x00, 0x00, 0x05,
+                                                   0x02, 0x03, 0x02, 0x0B, 0x0B}));
+    EXPECT_EQ(replies.count(0x0200), 1);
+
+    // Device that did not answer, and unit without line
+    gateway.handle(mbap(0x0300, ModbusRequest(3, utils::ReadAnalogOutputHoldingRegisters,
+                                              0, 1)),
+                   reply());
+    EXPECT_EQ(await(0x0300), (std::vector<uint8_t>{0x03, 0x00, 0x00, 0x00, 0x00, 0x03,
+                                                   0x03, 0x83, 0x11}));
+    gateway.handle(mbap(0x0400, ModbusRequest(4, utils::ReadAnalogOutputHoldingRegisters,
+                                              0, 1)),
+                   reply());
+    EXPECT_EQ(await(0x0400), (std::vector<uint8_t>{0x04, 0x00, 0x00, 0x00, 0x00, 0x03,
+                                                   0x04, 0x83, 0x10}));
+
+    // Exception response of the device is forwarded
+    gateway.handle(mbap(0x0500, ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters,
+                                              100, 1)),
+                   reply());
+    EXPECT_EQ(await(0x0500)[8], utils::IllegalDataAddress);
+
+    const auto metrics = gateway.metrics(1);
+    EXPECT_EQ(metrics.requests, 2);
+    EXPECT_EQ(metrics.maxQueueDepth, 2);
+    EXPECT_EQ(metrics.queueDepth, 0);
+    EXPECT_GE(metrics.maxLatency, 40ms);
+    EXPECT_GE(metrics.totalLatency, 60ms);
+    EXPECT_EQ(gateway.metrics(0).failures, 1);
+    EXPECT_EQ(gateway.lines(), 2);
+}
+
+TEST_F(ModBusGateway, BroadcastAndErrors) {
+    ModbusGateway gateway;
+    gateway.addLine(line(first, 0ms), {1}, sender(first));
+    gateway.addLine(line(second, 0ms), {2}, sender(second));
+    // Line without broadcast function
+    ModbusDataStore third{0, 0, 16, 0};
+    gateway.addLine(line(third, 0ms), {4});
+    const ModbusRequest write(0, utils::WriteSingleAnalogOutputRegister, 5, 1,
+                              {ModbusCell::initReg(7)});
+
+    // Unit 0 is the gateway itself
+    gateway.handle(mbap(0x0000, write), reply());
+    EXPECT_EQ(await(0x0000), (std::vector<uint8_t>{0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+                                                   0x00, 0x86, 0x10}));
+
+    gateway.setBroadcast(true);
+    gateway.handle(mbap(0x0001, write), reply());
+    gateway.handle(mbap(0x0002, ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters,
+                                              5, 1)),
+                   reply());
+    gateway.handle(mbap(0x0003, ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters,
+                                              5, 1)),
+                   reply());
+    EXPECT_EQ(await(0x0002).back(), 7);
+    EXPECT_EQ(await(0x0003).back(), 7);
+    EXPECT_EQ(broadcasts, 2);
+    EXPECT_EQ(replies.count(0x0001), 0);
+    // Broadcast did not wait for response, that never comes
+    EXPECT_EQ(gateway.metrics(0).requests, 2);
+    EXPECT_EQ(gateway.metrics(0).failures, 0);
+    EXPECT_EQ(gateway.metrics(1).failures, 0);
+    EXPECT_EQ(gateway.metrics(2).requests, 0);
+    EXPECT_EQ(third.read(utils::HoldingRegisters, 5, 1)[0].reg(), 0);
+
+    // Not MBAP frames
+    auto frame = mbap(0x0004, ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters));
+    frame[3]   = 0x01;
+    EXPECT_THROW(gateway.handle(frame, reply()), ModbusException);
+    frame.resize(6);
+    EXPECT_THROW(gateway.handle(frame, reply()), ModbusException);
+
+    EXPECT_THROW(gateway.addLine(line(first, 0ms), {2}),
+                 std::invalid_argument);
+    EXPECT_THROW(gateway.addLine(line(first, 0ms), {0}),
+                 std::invalid_argument);
+    EXPECT_THROW(gateway.addLine(line(first, 0ms), {5, 5}),
+                 std::invalid_argument);
+    EXPECT_EQ(gateway.lines(), 3);
+}
+
+TEST_F(ModBusGateway, Coalescing) {
+    std::mutex busMutex;
+    std::condition_variable busCond;
+    bool released    = false;
+    int transactions = 0;
+
+    ModbusGateway gateway;
+    gateway.addLine(
+        [&](const ModbusRequest &request) {
+            std::unique_lock lock{busMutex};
+            transactions++;
+            // The first transaction stays on the bus, until the rest is queued
+            busCond.wait(lock, [&] { return released; });
+            return ModbusResponse::fromRaw(
+                first.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+        },
+        {1, 2});
+    gateway.setCoalescing(1, true);
+
+    const ModbusRequest read(1, utils::ReadAnalogOutputHoldingRegisters, 0, 2);
+    gateway.handle(mbap(0x0100, read), reply());
+    while ([&] {
+        std::lock_guard lock{busMutex};
+        return transactions == 0;
+    }())
+        std::this_thread::yield();
+
+    // Attached to the one on the bus, and to the queued one
+    gateway.handle(mbap(0x0101, read), reply());
+    gateway.handle(mbap(0x0102, ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters,
+                                              0, 3)),
+                   reply());
+    gateway.handle(mbap(0x0103, ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters,
+                                              0, 3)),
+                   reply());
+    // Writes and units without coalescing are never attached
+    gateway.handle(mbap(0x0104, ModbusRequest(1, utils::WriteSingleAnalogOutputRegister,
+                                              0, 1, {ModbusCell::initReg(1)})),
+                   reply());
+    gateway.handle(mbap(0x0200, ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters,
+                                              0, 2)),
+                   reply());
+    gateway.handle(mbap(0x0201, ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters,
+                                              0, 2)),
+                   reply());
+
+    {
+        std::lock_guard lock{busMutex};
+        released = true;
+    }
+    busCond.notify_all();
+
+    for (const uint16_t id : {0x0100, 0x0101, 0x0102, 0x0103, 0x0104, 0x0200, 0x0201})
+        EXPECT_EQ(await(id)[1], id & 0xFF);
+    EXPECT_EQ(replies[0x0100].size(), 6 + 2 + 1 + 4);
+    EXPECT_EQ(std::vector<uint8_t>(replies[0x0100].begin() + 2, replies[0x0100].end()),
+              std::vector<uint8_t>(replies[0x0101].begin() + 2, replies[0x0101].end()));
+
+    EXPECT_EQ(transactions, 5);
+    const auto metrics = gateway.metrics(0);
+    EXPECT_EQ(metrics.coalesced, 2);
+    EXPECT_EQ(metrics.requests, 7);
+    EXPECT_EQ(metrics.maxQueueDepth, 7);
+}
+
+TEST_F(ModBusGateway, Fairness) {
+    std::mutex busMutex;
+    std::condition_variable busCond;
+    bool released = false;
+    std::vector<uint16_t> order;
+    ModbusDataStore store{0, 0, 256, 0};
+
+    ModbusGateway gateway;
+    gateway.addLine(
+        [&](const ModbusRequest &request) {
+            std::unique_lock lock{busMutex};
+            order.push_back(request.registerAddress());
+            busCond.wait(lock, [&] { return released; });
+            return ModbusResponse::fromRaw(
+                store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+        },
+        {1});
+    gateway.setClientQueueLimit(2);
+    EXPECT_THROW(gateway.setShare(1, 0), std::invalid_argument);
+
+    // Large reads, so that each takes the whole quantum of the client
+    const auto read = [](uint16_t address) {
+        return ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters, address, 100);
+    };
+    gateway.handle(mbap(0x0100, read(0)), reply(), 1);
+    while ([&] {
+        std::lock_guard lock{busMutex};
+        return order.empty();
+    }())
+        std::this_thread::yield();
+
+    // Client 1 floods the line, and goes over its limit
+    gateway.handle(mbap(0x0101, read(1)), reply(), 1);
+    gateway.handle(mbap(0x0102, read(2)), reply(), 1);
+    gateway.handle(mbap(0x0103, read(3)), reply(), 1);
+    EXPECT_EQ(await(0x0103), (std::vector<uint8_t>{0x01, 0x03, 0x00, 0x00, 0x00, 0x03,
+                                                   0x01, 0x83, 0x06}));
+    gateway.handle(mbap(0x0200, read(10)), reply(), 2);
+
+    {
+        std::lock_guard lock{busMutex};
+        released = true;
+    }
+    busCond.notify_all();
+
+    for (const uint16_t id : {0x0100, 0x0101, 0x0102, 0x0200})
+        EXPECT_EQ(await(id)[7], utils::ReadAnalogOutputHoldingRegisters);
+    // Client 2 did not wait for the whole queue of client 1
+    EXPECT_EQ(order, (std::vector<uint16_t>{0, 1, 10, 2}));
+
+    const auto metrics = gateway.metrics(0);
+    EXPECT_EQ(metrics.rejected, 1);
+    EXPECT_EQ(metrics.requests, 4);
+    EXPECT_EQ(metrics.maxQueueDepth, 4);
+}
+
+TEST_F(ModBusGateway, Shedding) {
+    std::mutex busMutex;
+    std::condition_variable busCond;
+    bool released    = false;
+    int transactions = 0;
+
+    ModbusGateway gateway;
+    gateway.addLine(
+        [&](const ModbusRequest &request) {
+            std::unique_lock lock{busMutex};
+            transactions++;
+            busCond.wait(lock, [&] { return released; });
+            return ModbusResponse::fromRaw(
+                first.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+        },
+        {1, 2});
+    gateway.setCoalescing(1, true);
+    gateway.setAdmission(0, {2, ModbusAdmission::Clock::duration::zero()});
+    EXPECT_THROW(gateway.setAdmission(1, {}), std::out_of_range);
+
+    const ModbusRequest read(1, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    gateway.handle(mbap(0x0100, read), reply());
+    while ([&] {
+        std::lock_guard lock{busMutex};
+        return transactions == 0;
+    }())
+        std::this_thread::yield();
+
+    gateway.handle(mbap(0x0200, ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters,
+                                              0, 1)),
+                   reply());
+    // Two transactions are queued, the new one is shed right away
+    gateway.handle(mbap(0x0201, ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters,
+                                              1, 1)),
+                   reply());
+    EXPECT_EQ(await(0x0201), (std::vector<uint8_t>{0x02, 0x01, 0x00, 0x00, 0x00, 0x03,
+                                                   0x02, 0x83, 0x06}));
+    // Coalesced read adds no bus time
+    gateway.handle(mbap(0x0101, read), reply());
+
+    {
+        std::lock_guard lock{busMutex};
+        released = true;
+    }
+    busCond.notify_all();
+
+    for (const uint16_t id : {0x0100, 0x0101, 0x0200})
+        EXPECT_EQ(await(id)[7], utils::ReadAnalogOutputHoldingRegisters);
+
+    const auto metrics = gateway.metrics(0);
+    EXPECT_EQ(metrics.shed, 1);
+    EXPECT_EQ(metrics.requests, 3);
+    EXPECT_EQ(transactions, 2);
+    EXPECT_GT(metrics.serviceTime, ModbusGateway::Clock::duration::zero());
+}
@@ -0,0 +1,124 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusClient.hpp"
+#include "MB/modbusDataStore.hpp"
+#include "MB/modbusException.hpp"
+#include "MB/modbusPollPlan.hpp"
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace MB;
+
+TEST(ModbusPollPlan, OverlappingTags) {
+    const ModbusPollPlan plan({{1, utils::HoldingRegisters, 11, 3},
+                               {1, utils::HoldingRegisters, 10, 2},
+                               {1, utils::HoldingRegisters, 14, 1},
+                               {1, utils::HoldingRegisters, 12, 1}});
+
+    ASSERT_EQ(plan.transactions(), 1);
+    EXPECT_EQ(plan.requests()[0].functionCode(), utils::ReadAnalogOutputHoldingRegisters);
+    EXPECT_EQ(plan.requests()[0].registerAddress(), 10);
+    EXPECT_EQ(plan.requests()[0].numberOfRegisters(), 5);
+    EXPECT_EQ(plan.placement(0).offset, 1);
+    EXPECT_EQ(plan.placement(3).offset, 2);
+    EXPECT_EQ(plan.wireBytes(), 20 + 5 * 2);
+}
+
+TEST(ModbusPollPlan, GapCost) {
+    // Gap of 9 registers costs 18 bytes, less than a transaction
+    EXPECT_EQ(ModbusPollPlan({{1, utils::InputRegisters, 0, 1},
+                              {1, utils::InputRegisters, 10, 1}})
+                  .transactions(),
+              1);
+    // Gap of 11 registers costs more
+    EXPECT_EQ(ModbusPollPlan({{1, utils::InputRegisters, 0, 1},
+                              {1, utils::InputRegisters, 12, 1}})
+                  .transactions(),
+              2);
+    // Coils are packed, so much wider gaps are read
+    EXPECT_EQ(ModbusPollPlan({{1, utils::OutputCoils, 0, 1},
+                              {1, utils::OutputCoils, 150, 1}})
+                  .transactions(),
+              1);
+
+    // Overhead is configured per device
+    ModbusDeviceLimits tcp;
+    tcp.transactionOverhead = 40;
+    EXPECT_EQ(ModbusPollPlan({{1, utils::InputRegisters, 0, 1},
+                              {1, utils::InputRegisters, 12, 1}},
+                             {{1, tcp}})
+                  .transactions(),
+              1);
+}
+
+TEST(ModbusPollPlan, DeviceLimits) {
+    ModbusDeviceLimits limits;
+    limits.maxRegisters = 10;
+    limits.forbidden    = {{utils::HoldingRegisters, 5, 1}};
+
+    const std::vector<ModbusTag> tags = {{1, utils::InputRegisters, 0, 5},
+                                         {1, utils::InputRegisters, 6, 5},
+                                         {1, utils::HoldingRegisters, 0, 1},
+                                         {1, utils::HoldingRegisters, 8, 1},
+                                         {2, utils::HoldingRegisters, 0, 1},
+                                         {2, utils::HoldingRegisters, 8, 1}};
+    const ModbusPollPlan plan(tags, {{1, limits}});
+
+    // Block size limit splits input registers, forbidden gap splits holding
+    // registers of slave 1 only
+    ASSERT_EQ(plan.transactions(), 5);
+    EXPECT_EQ(plan.requests()[0].registerAddress(), 0);
+    EXPECT_EQ(plan.requests()[0].numberOfRegisters(), 1);
+    EXPECT_EQ(plan.requests()[1].registerAddress(), 8);
+    EXPECT_EQ(plan.requests()[2].functionCode(), utils::ReadAnalogInputRegisters);
+    EXPECT_EQ(plan.requests()[3].numberOfRegisters(), 5);
+    EXPECT_EQ(plan.requests()[4].slaveID(), 2);
+    EXPECT_EQ(plan.requests()[4].numberOfRegisters(), 9);
+    EXPECT_EQ(plan.placement(5).request, 4);
+    EXPECT_EQ(plan.placement(5).offset, 8);
+
+    EXPECT_THROW(ModbusPollPlan({{1, utils::InputRegisters, 0, 11}}, {{1, limits}}),
+                 std::invalid_argument);
+    EXPECT_THROW(ModbusPollPlan({{1, utils::InputRegisters, 0xFFFF, 2}}),
+                 std::invalid_argument);
+    EXPECT_THROW(ModbusPollPlan({{1, utils::InputRegisters, 0, 0}}),
+                 std::invalid_argument);
+}
+
+TEST(ModbusPollPlan, Poll) {
+    ModbusDataStore store(32, 32, 32, 32);
+    store.write(utils::HoldingRegisters, 3,
+                {ModbusCell::initReg(30), ModbusCell::initReg(40),
+                 ModbusCell::initReg(50)});
+    store.write(utils::OutputCoils, 9, {ModbusCell::initCoil(true)});
+
+    std::size_t transactions = 0;
+    ModbusClient client([&](const ModbusRequest &request) {
+        transactions++;
+        return ModbusResponse::fromRaw(
+            store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+    });
+
+    const ModbusPollPlan plan({{1, utils::HoldingRegisters, 5, 1},
+                               {1, utils::OutputCoils, 9, 1},
+                               {1, utils::HoldingRegisters, 3, 2},
+                               {1, utils::OutputCoils, 0, 2}});
+    const auto values = client.poll(plan);
+
+    EXPECT_EQ(transactions, 2);
+    ASSERT_EQ(values.size(), 4);
+    ASSERT_EQ(values[0].size(), 1);
+    EXPECT_EQ(values[0][0].reg(), 50);
+    EXPECT_TRUE(values[1][0].coil());
+    ASSERT_EQ(values[2].size(), 2);
+    EXPECT_EQ(values[2][0].reg(), 30);
+    EXPECT_EQ(values[2][1].reg(), 40);
+    EXPECT_FALSE(values[3][1].coil());
+
+    // Responses must match the requests
+    EXPECT_THROW(utils::ignore_result(plan.values({})), ModbusException);
+}
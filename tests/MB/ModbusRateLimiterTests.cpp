@@ -0,0 +1,132 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusRateLimiter.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+namespace {
+const auto Start = ModbusRateLimiter::Clock::time_point() + 1h;
+} // namespace
+
+TEST(ModbusRateLimiter, Bucket) {
+    // 100 tokens per second, 2 at once
+    ModbusRateLimiter::Bucket bucket(100, 2);
+    EXPECT_EQ(bucket.take(1, Start, 0ms), 0ms);
+    EXPECT_EQ(bucket.take(1, Start, 0ms), 0ms);
+    EXPECT_FALSE(bucket.take(1, Start, 0ms).has_value());
+    EXPECT_EQ(bucket.take(1, Start, 50ms), 10ms);
+    // Rejected take does not use tokens
+    EXPECT_FALSE(bucket.take(5, Start, 20ms).has_value());
+    EXPECT_EQ(bucket.take(1, Start + 25ms, 0ms), 0ms);
+
+    // Refills up to the burst only
+    EXPECT_EQ(bucket.take(2, Start + 1s, 0ms), 0ms);
+    EXPECT_FALSE(bucket.take(1, Start + 1s, 0ms).has_value());
+    bucket.refund(1);
+    EXPECT_EQ(bucket.take(1, Start + 1s, 0ms), 0ms);
+
+    // Takes over the burst wait for the full bucket
+    ModbusRateLimiter::Bucket small(100, 2);
+    EXPECT_EQ(small.take(5, Start, 0ms), 0ms);
+    EXPECT_FALSE(small.take(1, Start, 0ms).has_value());
+    EXPECT_EQ(small.take(5, Start, 1s), 20ms);
+    small.refund(5);
+    EXPECT_EQ(small.take(2, Start, 50ms), 20ms);
+
+        ModbusRateLimiter::Bucket unlimited;
+    EXPECT_EQ(unlimited.take(1e6, Start, 0ms), 0ms);
+
+    EXPECT_THROW(ModbusRateLimiter::Bucket(-1, 1), std::invalid_argument);
+    EXPECT_THROW(ModbusRateLimiter::Bucket(1, 0.5), std::invalid_argument);
+}
+
+TEST(ModbusRateLimiter, Limits) {
+    ModbusRateLimiter::Settings settings;
+    settings.connection = {10, 2, 0, 125};
+    settings.source     = {0, 1, 1000, 250};
+    settings.maxDelay   = 100ms;
+    ModbusRateLimiter limiter(settings);
+
+    const ModbusRequest read(1, utils::ReadAnalogOutputHoldingRegisters, 0, 125);
+    auto first  = limiter.connect(0x7F000001);
+    auto second = limiter.connect(0x7F000001);
+    auto other  = limiter.connect(0x7F000002);
+
+    // Connections of the same address share its registers
+    EXPECT_EQ(first->acquire(read, Start), 0ms);
+    EXPECT_EQ(second->acquire(read, Start), 0ms);
+    EXPECT_FALSE(first->acquire(read, Start).has_value());
+    EXPECT_EQ(other->acquire(read, Start), 0ms);
+
+    // Requests of the connection
+    const ModbusRequest write(1, utils::WriteSingleAnalogOutputRegister, 0, 1,
+                              {ModbusCell::initReg(1)});
+    EXPECT_EQ(other->acquire(write, Start), 0ms);
+    EXPECT_EQ(other->acquire(write, Start), 100ms);
+    EXPECT_FALSE(other->acquire(write, Start).has_value());
+
+    const auto metrics = limiter.metrics();
+    EXPECT_EQ(metrics.admitted, 5);
+    EXPECT_EQ(metrics.delayed, 1);
+    EXPECT_EQ(metrics.rejected, 2);
+    EXPECT_EQ(metrics.totalDelay, 100ms);
+
+    // Read and write of 246 registers is over the default burst of 125
+    ModbusRateLimiter::Settings words;
+    words.connection.registersPerSecond = 1000;
+    auto client = ModbusRateLimiter(words).connect(0x7F000001);
+    const ModbusRequest readWrite(1, utils::ReadWriteMultipleRegisters, 0, 125,
+                                  std::vector<ModbusCell>(121, ModbusCell::initReg(1)));
+    EXPECT_EQ(client->acquire(readWrite, Start), 0ms);
+
+        settings.maxDelay = -1ms;
+    EXPECT_THROW(ModbusRateLimiter{settings}, std::invalid_argument);
+}
+
+TEST(ModbusRateLimiter, Registers) {
+    EXPECT_EQ(ModbusRateLimiter::registers(
+                  ModbusRequest(1, utils::ReadDiscreteOutputCoils, 0, 2000)),
+              125);
+    EXPECT_EQ(ModbusRateLimiter::registers(
+                  ModbusRequest(1, utils::ReadAnalogInputRegisters, 0, 10)),
+              10);
+    EXPECT_EQ(ModbusRateLimiter::registers(ModbusRequest(
+                  1, utils::ReadWriteMultipleRegisters, 0, 4,
+                  {ModbusCell::initReg(1), ModbusCell::initReg(2)})),
+              6);
+}
+
+TEST(ModbusRateLimiter, Concurrent) {
+    ModbusRateLimiter::Settings settings;
+    settings.source = {1000, 100, 0, 125};
+    ModbusRateLimiter limiter(settings);
+
+    // Exactly the burst is admitted, whatever the interleaving
+    const ModbusRequest read(1, utils::ReadAnalogInputRegisters, 0, 1);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&limiter, &read]() {
+            auto client = limiter.connect(1, Start);
+            for (int j = 0; j < 100; j++)
+                utils::ignore_result(client->acquire(read, Start));
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(limiter.metrics().admitted, 100);
+    EXPECT_EQ(limiter.metrics().rejected, 300);
+
+    // Reconnecting does not give tokens back, until they refill
+    EXPECT_FALSE(limiter.connect(1, Start)->acquire(read, Start).has_value());
+    EXPECT_EQ(limiter.connect(1, Start + 1s)->acquire(read, Start + 1s), 0ms);
+}
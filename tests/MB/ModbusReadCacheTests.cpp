@@ -0,0 +1,210 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusClient.hpp"
+#include "MB/modbusDataStore.hpp"
+#include "MB/modbusReadCache.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+namespace {
+std::vector<ModbusCell> registers(uint16_t first, std::size_t count) {
+    std::vector<ModbusCell> values;
+    for (std::size_t i = 0; i < count; i++)
+        values.push_back(ModbusCell::initReg(static_cast<uint16_t>(first + i)));
+    return values;
+}
+
+using RangeTuple = std::tuple<uint16_t, std::size_t, ModbusReadCache::Clock::duration>;
+
+std::vector<RangeTuple> ranges(const ModbusReadCache &cache) {
+    std::vector<RangeTuple> result;
+    for (const auto &range : cache.ranges(1, utils::HoldingRegisters))
+        result.emplace_back(range.address, range.count, range.ttl);
+    return result;
+}
+} // namespace
+
+TEST(ModbusReadCache, Lookup) {
+    ModbusReadCache cache;
+    const auto start = ModbusReadCache::Clock::time_point();
+    cache.setTtl(1, utils::HoldingRegisters, 50, 100, 1s);
+    // Overrides the middle of the previous range
+    cache.setTtl(1, utils::HoldingRegisters, 100, 10, 100ms);
+
+    // Values outside of the ranges are not stored
+    cache.store(1, utils::HoldingRegisters, 40, registers(40, 120), cache.generation(),
+                start);
+    EXPECT_FALSE(cache.lookup(1, utils::HoldingRegisters, 45, 10, start).has_value());
+
+    // Across page boundaries
+    const auto values = cache.lookup(1, utils::HoldingRegisters, 50, 100, start + 50ms);
+    ASSERT_TRUE(values.has_value());
+    EXPECT_EQ(values->size(), 100);
+    EXPECT_EQ((*values)[0].reg(), 50);
+    EXPECT_EQ((*values)[99].reg(), 149);
+
+    EXPECT_TRUE(cache.lookup(1, utils::HoldingRegisters, 50, 50, start + 500ms));
+    EXPECT_FALSE(cache.lookup(1, utils::HoldingRegisters, 50, 60, start + 500ms));
+    EXPECT_FALSE(cache.lookup(1, utils::HoldingRegisters, 50, 1, start + 1s));
+
+    // Other devices and tables
+    EXPECT_FALSE(cache.lookup(2, utils::HoldingRegisters, 50, 1, start));
+    EXPECT_FALSE(cache.lookup(1, utils::InputRegisters, 50, 1, start));
+
+    const auto metrics = cache.metrics();
+    EXPECT_EQ(metrics.hits, 2);
+    EXPECT_EQ(metrics.misses, 5);
+
+    EXPECT_THROW(cache.setTtl(1, utils::HoldingRegisters, 0xFFFF, 2, 1s),
+                 std::invalid_argument);
+}
+
+TEST(ModbusReadCache, Ranges) {
+    ModbusReadCache cache;
+    cache.setTtl(1, utils::HoldingRegisters, 50, 100, 1s);
+    // Setting the same range again replaces it
+    for (int i = 0; i < 100; i++)
+        cache.setTtl(1, utils::HoldingRegisters, 100, 10, 100ms);
+    EXPECT_EQ(ranges(cache), (std::vector<RangeTuple>{
+                                 {50, 50, 1s}, {100, 10, 100ms}, {110, 40, 1s}}));
+
+    cache.setTtl(1, utils::HoldingRegisters, 40, 80, 2s);
+    EXPECT_EQ(ranges(cache), (std::vector<RangeTuple>{{40, 80, 2s}, {120, 30, 1s}}));
+
+    // Zero TTL leaves no range behind
+    cache.setTtl(1, utils::HoldingRegisters, 60, 70, 0s);
+    EXPECT_EQ(ranges(cache), (std::vector<RangeTuple>{{40, 20, 2s}, {130, 20, 1s}}));
+    cache.setTtl(1, utils::HoldingRegisters, 0, 0x10000, 0s);
+    EXPECT_TRUE(ranges(cache).empty());
+}
+
+TEST(ModbusReadCache, Invalidation) {
+    ModbusReadCache cache;
+    const auto start = ModbusReadCache::Clock::time_point();
+    for (const uint8_t slave : {1, 2}) {
+        cache.setTtl(slave, utils::HoldingRegisters, 0, 16, 1s);
+        cache.store(slave, utils::HoldingRegisters, 0, registers(0, 16),
+                    cache.generation(), start);
+    }
+
+    cache.invalidate(ModbusRequest(1, utils::WriteSingleAnalogOutputRegister, 3, 1,
+                                   {ModbusCell::initReg(7)}));
+    EXPECT_FALSE(cache.lookup(1, utils::HoldingRegisters, 0, 4, start));
+    EXPECT_TRUE(cache.lookup(1, utils::HoldingRegisters, 4, 12, start));
+    EXPECT_TRUE(cache.lookup(2, utils::HoldingRegisters, 0, 16, start));
+
+    // Write part of ReadWriteMultipleRegisters
+    ModbusRequest readWrite(1, utils::ReadWriteMultipleRegisters, 0, 1, registers(0, 2));
+    readWrite.setWriteAddress(10);
+    cache.invalidate(readWrite);
+    EXPECT_TRUE(cache.lookup(1, utils::HoldingRegisters, 4, 6, start));
+    EXPECT_FALSE(cache.lookup(1, utils::HoldingRegisters, 11, 1, start));
+
+    // Reads and other tables do not invalidate
+    cache.invalidate(ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters, 0, 16));
+    cache.invalidate(ModbusRequest(2, utils::WriteSingleDiscreteOutputCoil, 0, 1,
+                                   {ModbusCell::initCoil(true)}));
+    EXPECT_TRUE(cache.lookup(2, utils::HoldingRegisters, 0, 16, start));
+
+    // Broadcast invalidates all devices
+    cache.invalidate(ModbusRequest(0, utils::WriteMultipleAnalogOutputHoldingRegisters,
+                                   14, 2, registers(0, 2)));
+    EXPECT_FALSE(cache.lookup(2, utils::HoldingRegisters, 15, 1, start));
+    EXPECT_EQ(cache.metrics().invalidations, 3);
+
+    cache.clear();
+    EXPECT_FALSE(cache.lookup(2, utils::HoldingRegisters, 0, 1, start));
+}
+
+TEST(ModbusReadCache, WriteDuringRead) {
+    ModbusReadCache cache;
+    const auto start = ModbusReadCache::Clock::time_point();
+    cache.setTtl(1, utils::HoldingRegisters, 0, 200, 1s);
+
+    // Write lands while the read is on the wire, its page keeps no values
+    const auto generation = cache.generation();
+    cache.invalidate(ModbusRequest(1, utils::WriteSingleAnalogOutputRegister, 3, 1,
+                                   {ModbusCell::initReg(7)}));
+    cache.store(1, utils::HoldingRegisters, 0, registers(0, 200), generation, start);
+    EXPECT_FALSE(cache.lookup(1, utils::HoldingRegisters, 0, 1, start));
+    EXPECT_TRUE(cache.lookup(1, utils::HoldingRegisters, 64, 136, start));
+    EXPECT_EQ(cache.metrics().invalidations, 0);
+
+    const auto beforeClear = cache.generation();
+    cache.clear();
+    cache.store(1, utils::HoldingRegisters, 0, registers(0, 200), beforeClear, start);
+    EXPECT_FALSE(cache.lookup(1, utils::HoldingRegisters, 64, 1, start));
+}
+
+TEST(ModbusReadCache, Client) {
+    ModbusDataStore store{16, 0, 200, 0};
+    std::size_t frames = 0;
+    ModbusClient client([&](const ModbusRequest &request) {
+        frames++;
+        return ModbusResponse::fromRaw(
+            store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+    });
+
+    auto cache = std::make_shared<ModbusReadCache>();
+    cache->setTtl(1, utils::HoldingRegisters, 0, 200, 1h);
+    cache->setTtl(1, utils::OutputCoils, 0, 16, 1h);
+    client.setReadCache(cache);
+
+    store.write(utils::HoldingRegisters, 130, {ModbusCell::initReg(5)});
+    EXPECT_EQ(client.readHoldingRegisters(1, 0, 200)[130], 5);
+    EXPECT_EQ(frames, 2);
+    EXPECT_EQ(client.readHoldingRegisters(1, 120, 20)[10], 5);
+    EXPECT_EQ(frames, 2);
+
+    // Write through the client makes the next read go to the device
+    client.writeRegister(1, 130, 6);
+    EXPECT_EQ(client.readHoldingRegisters(1, 120, 20)[10], 6);
+    EXPECT_EQ(frames, 4);
+
+    store.write(utils::OutputCoils, 3, {ModbusCell::initCoil(true)});
+    EXPECT_TRUE(client.readCoils(1, 0, 8)[3]);
+    EXPECT_TRUE(client.readCoils(1, 2, 4)[1]);
+    EXPECT_EQ(frames, 5);
+
+    EXPECT_EQ(cache->metrics().hits, 2);
+}
+
+TEST(ModbusReadCache, ClientWriteDuringRead) {
+    ModbusDataStore store{0, 0, 16, 0};
+    const auto transaction = [&store](const ModbusRequest &request) {
+        return ModbusResponse::fromRaw(
+            store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+    };
+    auto cache = std::make_shared<ModbusReadCache>();
+    cache->setTtl(1, utils::HoldingRegisters, 0, 16, 1h);
+
+    ModbusClient writer(transaction);
+    writer.setReadCache(cache);
+
+    // Device answers the read, then write of the other client goes through,
+    // before the response gets back to the reader
+    bool interleave = true;
+    ModbusClient reader([&](const ModbusRequest &request) {
+        auto response = transaction(request);
+        if (std::exchange(interleave, false))
+            writer.writeRegister(1, 3, 9);
+        return response;
+    });
+    reader.setReadCache(cache);
+
+    EXPECT_EQ(reader.readHoldingRegisters(1, 0, 8)[3], 0);
+    EXPECT_EQ(reader.readHoldingRegisters(1, 0, 8)[3], 9);
+    EXPECT_EQ(reader.readHoldingRegisters(1, 0, 8)[3], 9);
+    EXPECT_EQ(cache->metrics().hits, 1);
+}
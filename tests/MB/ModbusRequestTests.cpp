@@ -2,6 +2,7 @@
 // Copyright (c) 2020 Mateusz Mazur aka Mazurel
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
+#include "MB/modbusException.hpp"
 #include "MB/modbusRequest.hpp"
 #include "gtest/gtest.h"
 
@@ -22,6 +23,14 @@ class ModBusRequest : public ::testing::Test {
         fn15Data = {0x11, 0x0F, 0x00, 0x13, 0x00, 0x0A, 0x02, 0xCD, 0x01, 0xBF, 0x0B};
         fn16Data = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04,
                     0x00, 0x0A, 0x01, 0x02, 0xC6, 0xF0};
+        fn22Data = {0x11, 0x16, 0x00, 0x04, 0x00, 0xF2, 0x00, 0x25, 0x66, 0xE2};
+        fn20Data = {0x11, 0x14, 0x0E, 0x06, 0x00, 0x04, 0x00, 0x01, 0x00, 0x02,
+                    0x06, 0x00, 0x03, 0x00, 0x09, 0x00, 0x02, 0xF9, 0x38};
+        fn21Data = {0x11, 0x15, 0x0D, 0x06, 0x00, 0x04, 0x00, 0x07, 0x00,
+                    0x03, 0x06, 0xAF, 0x04, 0xBE, 0x10, 0x0D, 0xDB, 0xC7};
+        fn23Data = {0x11, 0x17, 0x00, 0x03, 0x00, 0x06, 0x00, 0x0E, 0x00, 0x03,
+                    0x06, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x4B, 0x54};
+        fn24Data = {0x01, 0x18, 0x04, 0xDE, 0x03, 0x47};
     }
 
     virtual void TearDown() {}
@@ -34,6 +43,11 @@ class ModBusRequest : public ::testing::Test {
     std::vector<uint8_t> fn6Data;
     std::vector<uint8_t> fn15Data;
     std::vector<uint8_t> fn16Data;
+    std::vector<uint8_t> fn20Data;
+    std::vector<uint8_t> fn21Data;
+    std::vector<uint8_t> fn22Data;
+    std::vector<uint8_t> fn23Data;
+    std::vector<uint8_t> fn24Data;
 };
 
 TEST_F(ModBusRequest, CRC) {
@@ -129,6 +143,118 @@ TEST_F(ModBusRequest, Function16) {
     EXPECT_EQ(0x0102, com.registerValues()[1].reg());
 }
 
+TEST_F(ModBusRequest, Function20) {
+    ModbusRequest com = ModbusRequest::fromRawCRC(fn20Data);
+
+    EXPECT_EQ(0x11, com.slaveID());
+    EXPECT_EQ(0x14, com.functionCode());
+    EXPECT_EQ(utils::FileRecord, com.functionType());
+    EXPECT_EQ(2, com.numberOfRegisters());
+    ASSERT_EQ(2, com.fileRecords().size());
+    EXPECT_EQ(4, com.fileRecords()[0].fileNumber);
+    EXPECT_EQ(1, com.fileRecords()[0].recordNumber);
+    EXPECT_EQ(2, com.fileRecords()[0].recordLength);
+    EXPECT_EQ(9, com.fileRecords()[1].recordNumber);
+
+    auto copy = com;
+    EXPECT_EQ(copy.fileRecords(), com.fileRecords());
+}
+
+TEST_F(ModBusRequest, Function21) {
+    ModbusRequest com = ModbusRequest::fromRawCRC(fn21Data);
+
+    EXPECT_EQ(0x15, com.functionCode());
+    ASSERT_EQ(1, com.fileRecords().size());
+    EXPECT_EQ(4, com.fileRecords()[0].fileNumber);
+    EXPECT_EQ(7, com.fileRecords()[0].recordNumber);
+    EXPECT_EQ((std::vector<uint16_t>{0x06AF, 0x04BE, 0x100D}), com.fileRecords()[0].data);
+}
+
+TEST_F(ModBusRequest, Function22) {
+    ModbusRequest com = ModbusRequest::fromRawCRC(fn22Data);
+
+    EXPECT_EQ(0x11, com.slaveID());
+    EXPECT_EQ(0x16, com.functionCode());
+    EXPECT_EQ(utils::MaskWrite, com.functionType());
+    EXPECT_EQ(0x04, com.registerAddress());
+    EXPECT_EQ(1, com.numberOfRegisters());
+    ASSERT_EQ(2, com.registerValues().size());
+    EXPECT_EQ(0x00F2, com.registerValues()[0].reg());
+    EXPECT_EQ(0x0025, com.registerValues()[1].reg());
+
+    auto truncated = fn22Data;
+    truncated.resize(6);
+    EXPECT_THROW(ModbusRequest::fromRaw(truncated), ModbusException);
+}
+
+TEST_F(ModBusRequest, Function23) {
+    ModbusRequest com = ModbusRequest::fromRawCRC(fn23Data);
+
+    EXPECT_EQ(0x11, com.slaveID());
+    EXPECT_EQ(0x17, com.functionCode());
+    EXPECT_EQ(utils::ReadWrite, com.functionType());
+    EXPECT_EQ(0x03, com.registerAddress());
+    EXPECT_EQ(0x06, com.numberOfRegisters());
+    EXPECT_EQ(0x0E, com.writeRegisterAddress());
+    ASSERT_EQ(3, com.registerValues().size());
+    EXPECT_EQ(0x00FF, com.registerValues()[2].reg());
+
+    // Read quantity does not change written values
+    com.setRegistersNumber(10);
+    EXPECT_EQ(3, com.registerValues().size());
+
+    auto copy = com;
+    EXPECT_EQ(0x0E, copy.writeRegisterAddress());
+
+    auto invalidByteCount = fn23Data;
+    invalidByteCount[10]  = 0x04;
+    EXPECT_THROW(ModbusRequest::fromRaw(invalidByteCount), ModbusException);
+
+    // Quantities over the limits are not encoded
+    const auto errorOf = [](uint16_t readCount, std::size_t writeCount) {
+        const ModbusRequest request(
+            1, utils::ReadWriteMultipleRegisters, 0, readCount,
+            std::vector<ModbusCell>(writeCount, ModbusCell::initReg(1)));
+        try {
+            utils::ignore_result(request.toRaw());
+        } catch (const ModbusException &ex) {
+            return ex.getErrorCode();
+        }
+        return static_cast<utils::MBErrorCode>(0);
+    };
+    EXPECT_EQ(errorOf(125, 121), static_cast<utils::MBErrorCode>(0));
+    EXPECT_EQ(errorOf(126, 1), utils::NumberOfRegistersInvalid);
+    EXPECT_EQ(errorOf(0, 1), utils::NumberOfRegistersInvalid);
+    EXPECT_EQ(errorOf(1, 122), utils::NumberOfValuesInvalid);
+    EXPECT_EQ(errorOf(1, 128), utils::NumberOfValuesInvalid);
+    EXPECT_EQ(errorOf(1, 0), utils::NumberOfValuesInvalid);
+}
+
+TEST_F(ModBusRequest, Function24) {
+    ModbusRequest com = ModbusRequest::fromRawCRC(fn24Data);
+
+    EXPECT_EQ(0x01, com.slaveID());
+    EXPECT_EQ(0x18, com.functionCode());
+    EXPECT_EQ(utils::ReadFIFO, com.functionType());
+    EXPECT_EQ(0x04DE, com.registerAddress());
+    EXPECT_EQ(0, com.numberOfRegisters());
+}
+
+TEST_F(ModBusRequest, Function43) {
+    const std::vector<uint8_t> raw = {0x01, 0x2B, 0x0E, 0x01, 0x00, 0x70, 0x77};
+    ModbusRequest com = ModbusRequest::fromRawCRC(raw);
+
+    EXPECT_EQ(0x01, com.slaveID());
+    EXPECT_EQ(utils::ReadDeviceIdentification, com.functionCode());
+    EXPECT_EQ(utils::DeviceIdentification, com.functionType());
+    EXPECT_EQ(0x01, com.deviceIdentification().readCode);
+    EXPECT_EQ(0x00, com.deviceIdentification().objectId);
+    EXPECT_EQ(std::vector<uint8_t>(raw.begin(), raw.end() - 2), com.toRaw());
+
+    // Other MEI types are not supported
+    EXPECT_THROW(ModbusRequest::fromRaw({0x01, 0x2B, 0x0D, 0x01, 0x00}), ModbusException);
+}
+
 TEST_F(ModBusRequest, RawTest) {
     auto eq = [](const std::vector<uint8_t> &dataA,
                  const std::vector<uint8_t> &dataB) -> bool {
@@ -150,6 +276,11 @@ TEST_F(ModBusRequest, RawTest) {
     EXPECT_TRUE(eq(fn6Data, ModbusRequest::fromRaw(fn6Data).toRaw()));
     EXPECT_TRUE(eq(fn15Data, ModbusRequest::fromRaw(fn15Data).toRaw()));
     EXPECT_TRUE(eq(fn16Data, ModbusRequest::fromRaw(fn16Data).toRaw()));
+    EXPECT_TRUE(eq(fn20Data, ModbusRequest::fromRaw(fn20Data).toRaw()));
+    EXPECT_TRUE(eq(fn21Data, ModbusRequest::fromRaw(fn21Data).toRaw()));
+    EXPECT_TRUE(eq(fn22Data, ModbusRequest::fromRaw(fn22Data).toRaw()));
+    EXPECT_TRUE(eq(fn23Data, ModbusRequest::fromRaw(fn23Data).toRaw()));
+    EXPECT_TRUE(eq(fn24Data, ModbusRequest::fromRaw(fn24Data).toRaw()));
 }
 
 TEST_F(ModBusRequest, ConstructorsCheck) {
@@ -162,3 +293,16 @@ TEST_F(ModBusRequest, ConstructorsCheck) {
     EXPECT_TRUE(com.registerAddress() == com2.registerAddress());
     EXPECT_TRUE(com.numberOfRegisters() == com2.numberOfRegisters());
 }
+
+TEST_F(ModBusRequest, QuantityLimits) {
+    EXPECT_NO_THROW(utils::ignore_result(
+        ModbusRequest(1, utils::ReadAnalogInputRegisters, 0, 125).toRaw()));
+    EXPECT_THROW(utils::ignore_result(
+                     ModbusRequest(1, utils::ReadAnalogInputRegisters, 0, 126).toRaw()),
+                 ModbusException);
+    EXPECT_NO_THROW(utils::ignore_result(
+        ModbusRequest(1, utils::ReadDiscreteOutputCoils, 0, 2000).toRaw()));
+    EXPECT_THROW(utils::ignore_result(
+                     ModbusRequest(1, utils::ReadDiscreteOutputCoils, 0, 2001).toRaw()),
+                 ModbusException);
+}
@@ -21,6 +21,15 @@ class ModBusResponse : public ::testing::Test {
         fn6Data  = {0x11, 0x06, 0x00, 0x01, 0x00, 0x03, 0x9A, 0x9B};
         fn15Data = {0x11, 0x0F, 0x00, 0x13, 0x00, 0x0A, 0x26, 0x99};
         fn16Data = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x12, 0x98};
+        fn22Data = {0x11, 0x16, 0x00, 0x04, 0x00, 0xF2, 0x00, 0x25, 0x66, 0xE2};
+        fn20Data = {0x11, 0x14, 0x0C, 0x05, 0x06, 0x0D, 0xFE, 0x00,
+                    0x20, 0x05, 0x06, 0x33, 0xCD, 0x00, 0x40, 0x69, 0xAD};
+        fn21Data = {0x11, 0x15, 0x0D, 0x06, 0x00, 0x04, 0x00, 0x07, 0x00,
+                    0x03, 0x06, 0xAF, 0x04, 0xBE, 0x10, 0x0D, 0xDB, 0xC7};
+        fn23Data = {0x11, 0x17, 0x0C, 0x00, 0xFE, 0x0A, 0xCD, 0x00, 0x01,
+                    0x00, 0x03, 0x00, 0x0D, 0x00, 0xFF, 0x0D, 0x75};
+        fn24Data = {0x01, 0x18, 0x00, 0x06, 0x00, 0x02,
+                    0x01, 0xB8, 0x12, 0x84, 0x19, 0x18};
     }
 
     virtual void TearDown() {}
@@ -33,6 +42,11 @@ class ModBusResponse : public ::testing::Test {
     std::vector<uint8_t> fn6Data;
     std::vector<uint8_t> fn15Data;
     std::vector<uint8_t> fn16Data;
+    std::vector<uint8_t> fn20Data;
+    std::vector<uint8_t> fn21Data;
+    std::vector<uint8_t> fn22Data;
+    std::vector<uint8_t> fn23Data;
+    std::vector<uint8_t> fn24Data;
 };
 
 TEST_F(ModBusResponse, CRC) {
@@ -126,6 +140,99 @@ TEST_F(ModBusResponse, Function16) {
     EXPECT_EQ(0x02, com.numberOfRegisters());
 }
 
+TEST_F(ModBusResponse, Function20) {
+    ModbusResponse com = ModbusResponse::fromRawCRC(fn20Data);
+
+    EXPECT_EQ(0x11, com.slaveID());
+    EXPECT_EQ(0x14, com.functionCode());
+    EXPECT_EQ(utils::FileRecord, com.functionType());
+    ASSERT_EQ(2, com.fileRecords().size());
+    EXPECT_EQ((std::vector<uint16_t>{0x0DFE, 0x0020}), com.fileRecords()[0].data);
+    EXPECT_EQ((std::vector<uint16_t>{0x33CD, 0x0040}), com.fileRecords()[1].data);
+}
+
+TEST_F(ModBusResponse, Function21) {
+    ModbusResponse com = ModbusResponse::fromRawCRC(fn21Data);
+
+    // Response is the echo of the request
+    const auto request = ModbusRequest::fromRawCRC(fn21Data);
+    EXPECT_EQ(com.fileRecords(), request.fileRecords());
+    EXPECT_EQ(ModbusResponse::from(request).toRaw(), request.toRaw());
+}
+
+TEST_F(ModBusResponse, Function22) {
+    ModbusResponse com = ModbusResponse::fromRawCRC(fn22Data);
+
+    EXPECT_EQ(0x11, com.slaveID());
+    EXPECT_EQ(0x16, com.functionCode());
+    EXPECT_EQ(utils::MaskWrite, com.functionType());
+    EXPECT_EQ(0x04, com.registerAddress());
+    EXPECT_EQ(1, com.numberOfRegisters());
+    ASSERT_EQ(2, com.registerValues().size());
+    EXPECT_EQ(0x00F2, com.registerValues()[0].reg());
+    EXPECT_EQ(0x0025, com.registerValues()[1].reg());
+
+    auto truncated = fn22Data;
+    truncated.resize(6);
+    EXPECT_THROW(ModbusResponse::fromRaw(truncated), ModbusException);
+}
+
+TEST_F(ModBusResponse, Function23) {
+    ModbusResponse com = ModbusResponse::fromRawCRC(fn23Data);
+
+    EXPECT_EQ(0x11, com.slaveID());
+    EXPECT_EQ(0x17, com.functionCode());
+    EXPECT_EQ(0x06, com.numberOfRegisters());
+    EXPECT_TRUE(com.registerValues()[0].isReg());
+    EXPECT_EQ(0x00FE, com.registerValues()[0].reg());
+    EXPECT_EQ(0x00FF, com.registerValues()[5].reg());
+}
+
+TEST_F(ModBusResponse, Function24) {
+    ModbusResponse com = ModbusResponse::fromRawCRC(fn24Data);
+
+    EXPECT_EQ(0x01, com.slaveID());
+    EXPECT_EQ(0x18, com.functionCode());
+    EXPECT_EQ(utils::ReadFIFO, com.functionType());
+    EXPECT_EQ(2, com.numberOfRegisters());
+    EXPECT_EQ(0x01B8, com.registerValues()[0].reg());
+    EXPECT_EQ(0x1284, com.registerValues()[1].reg());
+
+    // Empty queue
+    const std::vector<uint8_t> empty = {0x01, 0x18, 0x00, 0x02, 0x00, 0x00};
+    EXPECT_EQ(0, ModbusResponse::fromRaw(empty).numberOfRegisters());
+    EXPECT_EQ(empty, ModbusResponse::fromRaw(empty).toRaw());
+
+    // Byte count does not match FIFO count
+    auto invalid = fn24Data;
+    invalid[3]   = 0x08;
+    EXPECT_THROW(ModbusResponse::fromRaw(invalid), ModbusException);
+
+    ModbusResponse tooLong(0x01, utils::ReadFIFOQueue, 0, 32,
+                           std::vector<ModbusCell>(32, ModbusCell::initReg(0)));
+    EXPECT_THROW(utils::ignore_result(tooLong.toRaw()), ModbusException);
+}
+
+TEST_F(ModBusResponse, Function43) {
+    // Example from the specification: "Company identification", "Product code "
+    // and "V2.11"
+    const std::vector<uint8_t> raw = {
+        0x01, 0x2B, 0x0E, 0x01, 0x01, 0x00, 0x00, 0x03, 0x00, 0x16, 0x43, 0x6F,
+        0x6D, 0x70, 0x61, 0x6E, 0x79, 0x20, 0x69, 0x64, 0x65, 0x6E, 0x74, 0x69,
+        0x66, 0x69, 0x63, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x01, 0x0D, 0x50, 0x72,
+        0x6F, 0x64, 0x75, 0x63, 0x74, 0x20, 0x63, 0x6F, 0x64, 0x65, 0x20, 0x02,
+        0x05, 0x56, 0x32, 0x2E, 0x31, 0x31, 0x4B, 0x7F};
+
+    ModbusResponse com = ModbusResponse::fromRawCRC(raw);
+    EXPECT_EQ(utils::ReadDeviceIdentification, com.functionCode());
+    EXPECT_EQ(3, com.numberOfRegisters());
+    EXPECT_EQ(0x01, com.deviceIdentification().conformityLevel);
+    EXPECT_FALSE(com.deviceIdentification().moreFollows);
+    EXPECT_EQ("Company identification", com.deviceIdentification().object(0x00));
+    EXPECT_EQ("V2.11", com.deviceIdentification().object(0x02));
+    EXPECT_EQ(std::vector<uint8_t>(raw.begin(), raw.end() - 2), com.toRaw());
+}
+
 TEST_F(ModBusResponse, RawTest) {
     auto eq = [](const std::vector<uint8_t> &dataA,
                  const std::vector<uint8_t> &dataB) -> bool {
@@ -147,6 +254,11 @@ TEST_F(ModBusResponse, RawTest) {
     EXPECT_TRUE(eq(fn6Data, ModbusResponse::fromRaw(fn6Data).toRaw()));
     EXPECT_TRUE(eq(fn15Data, ModbusResponse::fromRaw(fn15Data).toRaw()));
     EXPECT_TRUE(eq(fn16Data, ModbusResponse::fromRaw(fn16Data).toRaw()));
+    EXPECT_TRUE(eq(fn20Data, ModbusResponse::fromRaw(fn20Data).toRaw()));
+    EXPECT_TRUE(eq(fn21Data, ModbusResponse::fromRaw(fn21Data).toRaw()));
+    EXPECT_TRUE(eq(fn22Data, ModbusResponse::fromRaw(fn22Data).toRaw()));
+    EXPECT_TRUE(eq(fn23Data, ModbusResponse::fromRaw(fn23Data).toRaw()));
+    EXPECT_TRUE(eq(fn24Data, ModbusResponse::fromRaw(fn24Data).toRaw()));
 }
 
 TEST_F(ModBusResponse, ConstructorsCheck) {
@@ -0,0 +1,125 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusException.hpp"
+#include "MB/modbusScanScheduler.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+class ModBusScanScheduler : public ::testing::Test {
+  protected:
+    // Scans move the clock to simulate their duration
+    ModbusScanScheduler::Clock::time_point now{};
+    ModbusScanScheduler scheduler{1ms, [this] { return now; }};
+
+    void runUntil(std::chrono::milliseconds end) {
+        while (now < ModbusScanScheduler::Clock::time_point(end)) {
+            now += 1ms;
+            utils::ignore_result(scheduler.runDue());
+        }
+    }
+};
+
+TEST_F(ModBusScanScheduler, Periodic) {
+    std::vector<ModbusScanScheduler::Clock::duration> starts;
+    const auto id = scheduler.add({10ms, 0ms, 5ms, [&] {
+                                       starts.push_back(now.time_since_epoch());
+                                       now += 2ms;
+                                   }});
+
+    runUntil(50ms);
+
+    // Scans do not drift, even though each of them takes time
+    EXPECT_EQ(starts, (std::vector<ModbusScanScheduler::Clock::duration>{5ms, 15ms, 25ms,
+                                                                          35ms, 45ms}));
+    const auto &stats = scheduler.statistics(id);
+    EXPECT_EQ(stats.scans, 5);
+    EXPECT_EQ(stats.lastScanTime, 2ms);
+    EXPECT_EQ(stats.totalScanTime, 10ms);
+    EXPECT_EQ(stats.maxJitter, 0ms);
+    EXPECT_EQ(stats.overruns, 0);
+    EXPECT_EQ(stats.late, 0);
+}
+
+TEST_F(ModBusScanScheduler, Overrun) {
+    auto duration = 25ms;
+    const auto id = scheduler.add({10ms, 20ms, 10ms, [&] { now += duration; }});
+
+    // Scan started at 10 ms ends at 35 ms, starts at 20 and 30 ms are skipped
+    runUntil(10ms);
+    const auto &stats = scheduler.statistics(id);
+    EXPECT_EQ(stats.scans, 1);
+    EXPECT_EQ(stats.overruns, 1);
+    EXPECT_EQ(stats.skipped, 2);
+    EXPECT_EQ(stats.late, 1);
+    EXPECT_EQ(stats.maxScanTime, 25ms);
+
+    duration = 1ms;
+    runUntil(39ms);
+    EXPECT_EQ(stats.scans, 1);
+    runUntil(40ms);
+    EXPECT_EQ(stats.scans, 2);
+    EXPECT_EQ(stats.overruns, 1);
+    EXPECT_EQ(stats.late, 1);
+}
+
+TEST_F(ModBusScanScheduler, FailuresAndRemoval) {
+    std::size_t scans = 0;
+    ModbusScanScheduler::GroupId id = 0;
+    id = scheduler.add({5ms, 0ms, 5ms, [&] {
+                            if (++scans == 3)
+                                scheduler.remove(id);
+                            throw ModbusException(utils::Timeout);
+                        }});
+    const auto other = scheduler.add({5ms, 0ms, 5ms, [] {}});
+
+    runUntil(10ms);
+    EXPECT_EQ(scheduler.statistics(id).failures, 2);
+
+    // Group removes itself in its third scan
+    runUntil(100ms);
+    EXPECT_EQ(scans, 3);
+    EXPECT_EQ(scheduler.size(), 1);
+    EXPECT_THROW(utils::ignore_result(scheduler.statistics(id)), std::out_of_range);
+    EXPECT_EQ(scheduler.statistics(other).scans, 20);
+
+    EXPECT_TRUE(scheduler.remove(other));
+    EXPECT_FALSE(scheduler.remove(other));
+    EXPECT_THROW(scheduler.add({0ms, 0ms, 0ms, [] {}}), std::invalid_argument);
+
+    // Exceptions that are not std::exception are failures as well
+    const auto odd = scheduler.add({5ms, 0ms, 5ms, [] { throw 42; }});
+    runUntil(110ms);
+    EXPECT_EQ(scheduler.statistics(odd).failures, 2);
+    EXPECT_TRUE(scheduler.remove(odd));
+    EXPECT_EQ(scheduler.size(), 0);
+}
+
+TEST_F(ModBusScanScheduler, ManyGroups) {
+    constexpr std::size_t Groups = 20000;
+    constexpr auto End           = 10000;
+
+    std::vector<std::size_t> scans(Groups);
+    std::vector<ModbusScanScheduler::GroupId> ids;
+    for (std::size_t i = 0; i < Groups; i++) {
+        const std::chrono::milliseconds period(10 + (i * 37) % 990);
+        const std::chrono::milliseconds phase(1 + i % 500);
+        ids.push_back(scheduler.add({period, 0ms, phase, [&scans, i] { scans[i]++; }}));
+    }
+
+    runUntil(std::chrono::milliseconds(End));
+
+    for (std::size_t i = 0; i < Groups; i++) {
+        const std::size_t period = 10 + (i * 37) % 990;
+        const std::size_t phase  = 1 + i % 500;
+        ASSERT_EQ(scans[i], (End - phase) / period + 1) << "Group " << i;
+        ASSERT_EQ(scheduler.statistics(ids[i]).maxJitter, 0ms);
+    }
+}
@@ -0,0 +1,137 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/crc.hpp"
+#include "MB/modbusSniffer.hpp"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace MB;
+
+class ModBusSniffer : public ::testing::Test {
+  protected:
+    // Testing data from https://www.simplymodbus.ca/
+    std::vector<uint8_t> fn3Request  = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87};
+    std::vector<uint8_t> fn3Response = {0x11, 0x03, 0x06, 0xAE, 0x41, 0x56,
+                                        0x52, 0x43, 0x40, 0x49, 0xAD};
+    std::vector<uint8_t> fn16Request = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04,
+                                        0x00, 0x0A, 0x01, 0x02, 0xC6, 0xF0};
+    std::vector<uint8_t> fn16Response = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x12, 0x98};
+    std::vector<uint8_t> fn6Echo      = withCRC({0x11, 0x06, 0x00, 0x01, 0x00, 0x03});
+    std::vector<uint8_t> fn1Exception = {0x0A, 0x81, 0x02, 0xB0, 0x53};
+
+    std::vector<ModbusSniffer::Transaction> transactions;
+    ModbusSniffer sniffer;
+
+    ModBusSniffer()
+        : sniffer([this](const ModbusSniffer::Transaction &t) { transactions.push_back(t); }) {
+    }
+
+    static std::vector<uint8_t> withCRC(std::vector<uint8_t> data) {
+        const auto crc = CRC::calculateCRC(data);
+        data.push_back(static_cast<uint8_t>(crc & 0xFF));
+        data.push_back(static_cast<uint8_t>(crc >> 8));
+        return data;
+    }
+
+    static std::vector<uint8_t> join(std::initializer_list<std::vector<uint8_t>> frames) {
+        std::vector<uint8_t> result;
+        for (const auto &frame : frames)
+            result.insert(result.end(), frame.begin(), frame.end());
+        return result;
+    }
+};
+
+TEST_F(ModBusSniffer, PairsRequestsWithResponses) {
+    sniffer.feed(join({fn3Request, fn3Response, fn16Request, fn16Response}));
+
+    ASSERT_EQ(transactions.size(), 2);
+    EXPECT_EQ(transactions[0].request->raw(), fn3Request);
+    EXPECT_EQ(transactions[0].response->raw(), fn3Response);
+    EXPECT_EQ(transactions[1].request->raw(), fn16Request);
+    EXPECT_EQ(transactions[1].response->raw(), fn16Response);
+
+    const auto request  = transactions[0].decodeRequest();
+    const auto response = transactions[0].decodeResponse();
+    EXPECT_EQ(request.numberOfRegisters(), 3);
+    EXPECT_EQ(response.registerValues().size(), 3);
+    EXPECT_EQ(response.registerValues()[0].reg(), 0xAE41);
+
+    EXPECT_EQ(sniffer.statistics().frames, 4);
+    EXPECT_EQ(sniffer.statistics().discardedBytes, 0);
+}
+
+TEST_F(ModBusSniffer, EchoedSingleWrite) {
+    // Request and response are the same bytes
+    sniffer.feed(join({fn6Echo, fn6Echo, fn6Echo}));
+    sniffer.finish();
+
+    ASSERT_EQ(transactions.size(), 2);
+    EXPECT_TRUE(transactions[0].response.has_value());
+    EXPECT_TRUE(transactions[1].request.has_value());
+    EXPECT_FALSE(transactions[1].response.has_value());
+}
+
+TEST_F(ModBusSniffer, ExceptionResponse) {
+    auto request = withCRC({0x0A, 0x01, 0x04, 0xA1, 0x00, 0x01});
+    sniffer.feed(join({request, fn1Exception}));
+
+    ASSERT_EQ(transactions.size(), 1);
+    EXPECT_EQ(transactions[0].request->raw(), request);
+    try {
+        utils::ignore_result(transactions[0].decodeResponse());
+        FAIL() << "Exception response was decoded";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::IllegalDataAddress);
+    }
+}
+
+TEST_F(ModBusSniffer, ResynchronizesAfterNoise) {
+    const std::vector<uint8_t> noise = {0xFF, 0x11, 0x03, 0x12, 0x00, 0xF8, 0x11, 0x10};
+    // Decoder starts in the middle of the response
+    std::vector<uint8_t> partial(fn3Response.begin() + 4, fn3Response.end());
+
+    sniffer.feed(join({partial, noise, fn3Request, fn3Response, noise, fn16Request,
+                       fn16Response}));
+
+    ASSERT_EQ(transactions.size(), 2);
+    EXPECT_EQ(transactions[0].request->raw(), fn3Request);
+    EXPECT_EQ(transactions[0].response->raw(), fn3Response);
+    EXPECT_EQ(transactions[1].request->raw(), fn16Request);
+    EXPECT_EQ(transactions[1].response->raw(), fn16Response);
+    EXPECT_EQ(sniffer.statistics().discardedBytes, partial.size() + 2 * noise.size());
+}
+
+TEST_F(ModBusSniffer, ByteByByte) {
+    const auto stream = join({fn3Request, fn3Response, fn16Request, fn16Response});
+    const auto start  = ModbusSniffer::Timestamp{};
+
+    for (std::size_t i = 0; i < stream.size(); i++)
+        sniffer.feed(&stream[i], 1, start + std::chrono::milliseconds(i));
+
+    ASSERT_EQ(transactions.size(), 2);
+    EXPECT_EQ(transactions[0].request->timestamp, start);
+    EXPECT_EQ(transactions[0].response->timestamp,
+              start + std::chrono::milliseconds(fn3Request.size()));
+    EXPECT_EQ(transactions[1].response->raw(), fn16Response);
+}
+
+TEST_F(ModBusSniffer, UnansweredAndOrphans) {
+    auto broadcast = withCRC({0x00, 0x06, 0x00, 0x01, 0x00, 0x03});
+
+    sniffer.feed(join({fn3Response, broadcast, fn3Request, fn16Request, fn16Response}));
+
+    ASSERT_EQ(transactions.size(), 4);
+    // Response without its request
+    EXPECT_FALSE(transactions[0].request.has_value());
+    EXPECT_EQ(transactions[0].response->raw(), fn3Response);
+    // Broadcast is never answered
+    EXPECT_EQ(transactions[1].request->raw(), broadcast);
+    EXPECT_FALSE(transactions[1].response.has_value());
+    // Slave did not answer
+    EXPECT_EQ(transactions[2].request->raw(), fn3Request);
+    EXPECT_FALSE(transactions[2].response.has_value());
+    EXPECT_EQ(transactions[3].response->raw(), fn16Response);
+}
@@ -0,0 +1,111 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusTimerWheel.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+class ModBusTimerWheel : public ::testing::Test {
+  protected:
+    const ModbusTimerWheel::Clock::time_point start{};
+    ModbusTimerWheel wheel{1ms, start};
+    std::vector<std::size_t> expired;
+
+    void advance(std::chrono::milliseconds now) {
+        wheel.advance(start + now,
+                      [this](std::size_t payload) { expired.push_back(payload); });
+    }
+};
+
+TEST_F(ModBusTimerWheel, Levels) {
+    wheel.schedule(start + 5ms, 1);
+    wheel.schedule(start + 300ms, 2);
+    wheel.schedule(start + 70000ms, 3);
+    // Deadlines are rounded up to the whole tick
+    wheel.schedule(start + 4500us, 4);
+    EXPECT_EQ(wheel.size(), 4);
+
+    advance(4ms);
+    EXPECT_TRUE(expired.empty());
+    advance(5ms);
+    EXPECT_EQ(expired.size(), 2);
+    advance(299ms);
+    EXPECT_EQ(expired.size(), 2);
+    advance(300ms);
+    EXPECT_EQ(expired.back(), 2);
+    advance(69999ms);
+    EXPECT_EQ(expired.size(), 3);
+    advance(70000ms);
+    EXPECT_EQ(expired.back(), 3);
+    EXPECT_TRUE(wheel.empty());
+
+    // Deadline from the past expires with the next tick
+    wheel.schedule(start, 5);
+    advance(70000ms);
+    EXPECT_EQ(expired.size(), 4);
+    advance(70001ms);
+    EXPECT_EQ(expired.back(), 5);
+}
+
+TEST_F(ModBusTimerWheel, Cancel) {
+    const auto first  = wheel.schedule(start + 10ms, 1);
+    const auto second = wheel.schedule(start + 10ms, 2);
+    EXPECT_TRUE(wheel.cancel(first));
+    EXPECT_FALSE(wheel.cancel(first));
+
+    // Node is reused, but the old id stays invalid
+    const auto third = wheel.schedule(start + 1000ms, 3);
+    EXPECT_FALSE(wheel.cancel(first));
+
+    advance(10ms);
+    EXPECT_EQ(expired, (std::vector<std::size_t>{2}));
+    EXPECT_FALSE(wheel.cancel(second));
+    EXPECT_TRUE(wheel.cancel(third));
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST_F(ModBusTimerWheel, RescheduleFromCallback) {
+    std::size_t count = 0;
+    std::function<void(std::size_t)> periodic = [&](std::size_t) {
+        count++;
+        wheel.schedule(wheel.now() + 7ms, 0);
+    };
+    wheel.schedule(start + 7ms, 0);
+
+    wheel.advance(start + 700ms, periodic);
+    EXPECT_EQ(count, 100);
+    EXPECT_EQ(wheel.size(), 1);
+}
+
+TEST_F(ModBusTimerWheel, ExpiresOnTime) {
+    // Deterministic pseudo random deadlines over all levels
+    uint32_t seed = 1;
+    const auto random = [&seed](uint32_t max) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % max;
+    };
+
+    std::vector<std::chrono::milliseconds> deadlines;
+    for (std::size_t i = 0; i < 5000; i++) {
+        deadlines.emplace_back(1 + random(1 << 20));
+        wheel.schedule(start + deadlines.back(), i);
+    }
+
+    std::size_t fired = 0;
+    std::chrono::milliseconds now(0);
+    while (!wheel.empty()) {
+        now += std::chrono::milliseconds(1 + random(5000));
+        wheel.advance(start + now, [&](std::size_t payload) {
+            EXPECT_EQ(wheel.now(), start + deadlines[payload]);
+            fired++;
+        });
+    }
+    EXPECT_EQ(fired, deadlines.size());
+}
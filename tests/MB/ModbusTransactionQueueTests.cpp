@@ -0,0 +1,102 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusTransactionQueue.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+class ModBusTransactionQueue : public ::testing::Test {
+  protected:
+    using Clock = ModbusTransactionQueue::Clock;
+
+    ModBusTransactionQueue()
+        : poll(1, utils::ReadAnalogOutputHoldingRegisters, 0, 10),
+          write(1, utils::WriteSingleAnalogOutputRegister, 0, 1,
+                {ModbusCell::initReg(1)}) {}
+
+    virtual void SetUp() { start = Clock::now(); }
+
+    Clock::time_point start;
+    ModbusRequest poll;
+    ModbusRequest write;
+};
+
+TEST_F(ModBusTransactionQueue, HighestPriorityFirst) {
+    ModbusTransactionQueue queue;
+
+    auto _ = queue.push(poll, ModbusPriority::Poll, start);
+    _      = queue.push(poll, ModbusPriority::Alarm, start + 1ms);
+    _      = queue.push(write, ModbusPriority::Control, start + 2ms);
+
+    EXPECT_EQ(queue.size(), 3);
+    EXPECT_EQ(queue.pop(start + 3ms)->priority, ModbusPriority::Control);
+    EXPECT_EQ(queue.pop(start + 3ms)->priority, ModbusPriority::Alarm);
+    EXPECT_EQ(queue.pop(start + 3ms)->priority, ModbusPriority::Poll);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop(start + 3ms).has_value());
+}
+
+TEST_F(ModBusTransactionQueue, FifoInsideClass) {
+    ModbusTransactionQueue queue;
+
+    auto _ = queue.push(ModbusRequest(1, utils::ReadAnalogInputRegisters, 0, 1),
+                        ModbusPriority::Poll, start);
+    _      = queue.push(ModbusRequest(2, utils::ReadAnalogInputRegisters, 0, 1),
+                        ModbusPriority::Poll, start + 1ms);
+
+    EXPECT_EQ(queue.pop(start + 2ms)->request.slaveID(), 1);
+    EXPECT_EQ(queue.pop(start + 2ms)->request.slaveID(), 2);
+}
+
+TEST_F(ModBusTransactionQueue, AgingPreventsStarvation) {
+    ModbusTransactionQueue queue;
+    queue.setAgingStep(100ms);
+
+    auto _ = queue.push(poll, ModbusPriority::Poll, start);
+
+    // Constant stream of control writes
+    for (auto i = 1; i <= 5; i++)
+        _ = queue.push(write, ModbusPriority::Control, start + i * 50ms);
+
+    // Poll waited only one aging step, it is not yet on the control level
+    EXPECT_EQ(queue.pop(start + 100ms)->priority, ModbusPriority::Control);
+    // After two aging steps, it is older than any control write
+    EXPECT_EQ(queue.pop(start + 200ms)->priority, ModbusPriority::Poll);
+    EXPECT_EQ(queue.pop(start + 200ms)->priority, ModbusPriority::Control);
+}
+
+TEST_F(ModBusTransactionQueue, Metrics) {
+    ModbusTransactionQueue queue;
+
+    auto _ = queue.push(poll, ModbusPriority::Poll, start);
+    _      = queue.push(poll, ModbusPriority::Poll, start + 10ms);
+
+    EXPECT_EQ(queue.metrics(ModbusPriority::Poll).queueDepth, 2);
+    EXPECT_EQ(queue.metrics(ModbusPriority::Control).queueDepth, 0);
+
+    queue.pop(start + 30ms);
+    queue.pop(start + 30ms);
+
+    const auto &metrics = queue.metrics(ModbusPriority::Poll);
+    EXPECT_EQ(metrics.queueDepth, 0);
+    EXPECT_EQ(metrics.dispatched, 2);
+    EXPECT_EQ(metrics.totalWait, 50ms);
+    EXPECT_EQ(metrics.maxWait, 30ms);
+}
+
+TEST_F(ModBusTransactionQueue, PromiseIsKept) {
+    ModbusTransactionQueue queue;
+
+    auto future      = queue.push(poll, ModbusPriority::Poll, start);
+    auto transaction = queue.pop(start);
+
+    transaction->promise.set_value(ModbusResponse(1, utils::ReadAnalogOutputHoldingRegisters,
+                                                  0, 1, {ModbusCell::initReg(7)}));
+
+    EXPECT_EQ(future.get().registerValues()[0].reg(), 7);
+}
@@ -0,0 +1,220 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusException.hpp"
+#include "MB/modbusUnitServer.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+namespace {
+std::vector<uint8_t> mbap(uint16_t transactionId, const ModbusRequest &request) {
+    const auto pdu = request.toRaw();
+    std::vector<uint8_t> frame;
+    utils::pushUint16(frame, transactionId);
+    utils::pushUint16(frame, 0x0000);
+    utils::pushUint16(frame, static_cast<uint16_t>(pdu.size()));
+    frame.insert(frame.end(), pdu.begin(), pdu.end());
+    return frame;
+}
+
+utils::MBErrorCode errorOf(const ModbusUnitServer &server, const ModbusRequest &request) {
+    try {
+        utils::ignore_result(server.handle(request));
+    } catch (const ModbusException &exception) {
+        return exception.getErrorCode();
+    }
+    return static_cast<utils::MBErrorCode>(0);
+}
+} // namespace
+
+TEST(ModbusUnitServer, Units) {
+    ModbusUnitServer server;
+    for (uint8_t unitId = 1; unitId <= ModbusUnitServer::MaxUnitId; unitId++) {
+        server.addUnit(unitId, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+        server.store(unitId)->write(utils::HoldingRegisters, 0,
+                                    {ModbusCell::initReg(unitId)});
+    }
+    EXPECT_EQ(server.units(), 247);
+
+    const ModbusRequest read(200, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    EXPECT_EQ(server.handle(read).registerValues()[0].reg(), 200);
+
+    // Handler overrides the store, and empty one restores it
+    server.setHandler(200, [](const ModbusRequest &request) {
+        return ModbusResponse(request.slaveID(), request.functionCode(), 0, 1,
+                              {ModbusCell::initReg(0xBEEF)});
+    });
+    EXPECT_EQ(server.handle(read).registerValues()[0].reg(), 0xBEEF);
+    server.setHandler(200, nullptr);
+    EXPECT_EQ(server.handle(read).registerValues()[0].reg(), 200);
+    EXPECT_EQ(server.units(), 247);
+
+    // Unit with handler only, that fails
+    server.removeUnit(100);
+    server.setHandler(100, [](const ModbusRequest &) -> ModbusResponse {
+        throw std::runtime_error("Backend is not available");
+    });
+    EXPECT_EQ(errorOf(server, ModbusRequest(100, utils::ReadAnalogOutputHoldingRegisters,
+                                            0, 1)),
+              utils::SlaveDeviceFailure);
+
+    server.removeUnit(5);
+    EXPECT_FALSE(server.hasUnit(5));
+    EXPECT_EQ(server.units(), 246);
+    EXPECT_EQ(errorOf(server, ModbusRequest(5, utils::ReadAnalogOutputHoldingRegisters,
+                                            0, 1)),
+              utils::GatewayTargetDeviceFailedToRespond);
+    EXPECT_EQ(errorOf(server, ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters,
+                                            10, 1)),
+              utils::IllegalDataAddress);
+
+    EXPECT_THROW(server.addUnit(248, std::make_shared<ModbusDataStore>(0, 0, 1, 0)),
+                 std::invalid_argument);
+    EXPECT_THROW(server.addUnit(1, nullptr), std::invalid_argument);
+}
+
+TEST(ModbusUnitServer, Frames) {
+    ModbusUnitServer server;
+    server.addUnit(1, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+    server.addUnit(2, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+    const ModbusRequest write(0, utils::WriteSingleAnalogOutputRegister, 3, 1,
+                              {ModbusCell::initReg(7)});
+
+    // Unit 0 is the server itself, and is answered
+    EXPECT_EQ(server.handleFrame(mbap(0x0001, write)),
+              (std::vector<uint8_t>{0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x86,
+                                    0x11}));
+    server.addUnit(0, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+    EXPECT_EQ(server.handleFrame(mbap(0x0001, write))->size(), 12);
+    EXPECT_EQ(server.store(1)->read(utils::HoldingRegisters, 3, 1)[0].reg(), 0);
+
+    // Broadcast is executed by all units, and not answered
+    server.setBroadcast(true);
+    EXPECT_FALSE(server.handleFrame(mbap(0x0002, write)).has_value());
+    EXPECT_EQ(server.store(1)->read(utils::HoldingRegisters, 3, 1)[0].reg(), 7);
+    EXPECT_EQ(server.store(2)->read(utils::HoldingRegisters, 3, 1)[0].reg(), 7);
+
+    const auto read = [](uint8_t unitId) {
+        return ModbusRequest(unitId, utils::ReadAnalogOutputHoldingRegisters, 3, 1);
+    };
+    EXPECT_EQ(server.handleFrame(mbap(0x0102, read(2))),
+              (std::vector<uint8_t>{0x01, 0x02, 0x00, 0x00, 0x00, 0x05, 0x02, 0x03, 0x02,
+                                    0x00, 0x07}));
+    EXPECT_EQ(server.handleFrame(mbap(0x0103, read(9))),
+              (std::vector<uint8_t>{0x01, 0x03, 0x00, 0x00, 0x00, 0x03, 0x09, 0x83,
+                                    0x11}));
+
+    auto frame = mbap(0x0104, ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters));
+    frame[5]++;
+    EXPECT_THROW(utils::ignore_result(server.handleFrame(frame)), ModbusException);
+}
+
+TEST(ModbusUnitServer, Offloading) {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool released = false;
+
+    ModbusUnitServer server;
+    server.addUnit(1, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+    server.setHandler(2, [&](const ModbusRequest &request) {
+        std::unique_lock lock{mutex};
+        cond.wait(lock, [&] { return released; });
+        return ModbusResponse(request.slaveID(), request.functionCode(), 0, 1,
+                              {ModbusCell::initReg(2)});
+    });
+    server.setOffloaded(2, true);
+    server.setWorkerPool(std::make_shared<ModbusWorkerPool>(2));
+
+    std::vector<std::vector<uint8_t>> responses;
+    const auto completion = [&](std::optional<std::vector<uint8_t>> response) {
+        std::lock_guard lock{mutex};
+        if (response)
+            responses.push_back(std::move(*response));
+        cond.notify_all();
+    };
+
+    // Slow unit does not hold up the inline one
+    server.dispatch(mbap(0x0200, ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters,
+                                               0, 1)),
+                    completion);
+    server.dispatch(mbap(0x0100, ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters,
+                                               0, 1)),
+                    completion);
+    {
+        std::lock_guard lock{mutex};
+        ASSERT_EQ(responses.size(), 1);
+        EXPECT_EQ(responses[0][6], 1);
+        released = true;
+    }
+    cond.notify_all();
+
+    std::unique_lock lock{mutex};
+    ASSERT_TRUE(cond.wait_for(lock, 5s, [&] { return responses.size() == 2; }));
+    EXPECT_EQ(responses[1][6], 2);
+    EXPECT_EQ(responses[1].back(), 2);
+}
+
+TEST(ModbusUnitServer, Admission) {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool released = false;
+
+    ModbusUnitServer server;
+    server.setHandler(2, [&](const ModbusRequest &request) {
+        std::unique_lock lock{mutex};
+        cond.wait(lock, [&] { return released; });
+        return ModbusResponse(request.slaveID(), request.functionCode(), 0, 1,
+                              {ModbusCell::initReg(2)});
+    });
+    server.setOffloaded(2, true);
+    server.setWorkerPool(std::make_shared<ModbusWorkerPool>(2));
+    server.setAdmission(2, {2, 0s});
+
+    std::vector<std::vector<uint8_t>> responses;
+    const auto completion = [&](std::optional<std::vector<uint8_t>> response) {
+        std::lock_guard lock{mutex};
+        responses.push_back(std::move(*response));
+        cond.notify_all();
+    };
+    const auto request = [](uint16_t transactionId) {
+        return mbap(transactionId,
+                    ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters, 0, 1));
+    };
+
+    // Third request does not fit into the queue of the strand
+    for (uint16_t id = 1; id <= 3; id++)
+        server.dispatch(request(id), completion);
+    {
+        std::lock_guard lock{mutex};
+        ASSERT_EQ(responses.size(), 1);
+        EXPECT_EQ(responses[0], (std::vector<uint8_t>{0x00, 0x03, 0x00, 0x00, 0x00, 0x03,
+                                                      0x02, 0x83, 0x06}));
+        released = true;
+    }
+    cond.notify_all();
+    {
+        std::unique_lock lock{mutex};
+        ASSERT_TRUE(cond.wait_for(lock, 5s, [&] { return responses.size() == 3; }));
+    }
+
+    // Queue is empty again
+    server.dispatch(request(4), completion);
+    std::unique_lock lock{mutex};
+    ASSERT_TRUE(cond.wait_for(lock, 5s, [&] { return responses.size() == 4; }));
+    EXPECT_EQ(responses[3].back(), 2);
+
+    const auto metrics = server.admissionMetrics(2);
+    EXPECT_EQ(metrics.admitted, 3);
+    EXPECT_EQ(metrics.shed, 1);
+    EXPECT_THROW(server.setAdmission(248, {}), std::invalid_argument);
+}
@@ -0,0 +1,71 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusWorkerPool.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+TEST(ModbusWorkerPool, Strands) {
+    std::mutex mutex;
+    std::map<ModbusWorkerPool::StrandId, std::vector<int>> order;
+    std::atomic<int> running[3] = {0, 0, 0};
+    std::atomic<bool> overlapped = false;
+
+    {
+        ModbusWorkerPool pool(4);
+        EXPECT_EQ(pool.threads(), 4);
+        for (int i = 0; i < 100; i++) {
+            const auto strand = static_cast<ModbusWorkerPool::StrandId>(i % 3);
+            pool.post(strand, [&, strand, i]() {
+                if (running[strand]++ != 0)
+                    overlapped = true;
+                {
+                    std::lock_guard lock{mutex};
+                    order[strand].push_back(i);
+                }
+                running[strand]--;
+                if (i == 50)
+                    throw std::runtime_error("Ignored by the pool");
+            });
+        }
+        // Destructor runs queued tasks
+    }
+
+    EXPECT_FALSE(overlapped);
+    for (const auto &[strand, tasks] : order) {
+        EXPECT_EQ(tasks.size(), strand == 0 ? 34 : 33);
+        EXPECT_TRUE(std::is_sorted(tasks.begin(), tasks.end()));
+    }
+    EXPECT_THROW(ModbusWorkerPool(0), std::invalid_argument);
+}
+
+TEST(ModbusWorkerPool, Parallel) {
+    std::mutex mutex;
+    std::condition_variable cond;
+    int started = 0;
+
+    ModbusWorkerPool pool(2);
+    // Each task waits for the other one, so they have to run at the same time
+    const auto task = [&]() {
+        std::unique_lock lock{mutex};
+        started++;
+        cond.notify_all();
+        EXPECT_TRUE(cond.wait_for(lock, 5s, [&] { return started == 2; }));
+    };
+    pool.post(1, task);
+    pool.post(2, task);
+
+    std::unique_lock lock{mutex};
+    EXPECT_TRUE(cond.wait_for(lock, 5s, [&] { return started == 2; }));
+}
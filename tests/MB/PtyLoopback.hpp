@@ -0,0 +1,59 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "MB/modbusException.hpp"
+#include "gtest/gtest.h"
+
+// Pseudo terminal, that stands in for the serial port - connection opens its
+// slave side, and the test plays the other end of the line on the master side
+class PtyLoopback : public ::testing::Test {
+  protected:
+    int device = -1;
+    std::string path;
+
+    virtual void SetUp() {
+        device = ::posix_openpt(O_RDWR | O_NOCTTY);
+        ASSERT_NE(device, -1);
+        ASSERT_EQ(::grantpt(device), 0);
+        ASSERT_EQ(::unlockpt(device), 0);
+        path = ::ptsname(device);
+    }
+
+    virtual void TearDown() {
+        if (device != -1)
+            ::close(device);
+    }
+
+    void write(const std::vector<uint8_t> &data) const {
+        ASSERT_EQ(::write(device, data.data(), data.size()),
+                  static_cast<ssize_t>(data.size()));
+    }
+
+    // ASCII frame sent by the connection, up to LF
+    std::vector<uint8_t> readLine() const {
+        std::vector<uint8_t> line;
+        while (line.empty() || line.back() != '\n') {
+            pollfd pfd = {device, POLLIN, 0};
+            if (::poll(&pfd, 1, 1000) != 1)
+                throw MB::ModbusException(MB::utils::Timeout);
+
+            uint8_t byte;
+            if (::read(device, &byte, 1) != 1)
+                throw MB::ModbusException(MB::utils::ConnectionClosed);
+            line.push_back(byte);
+        }
+        return line;
+    }
+};
@@ -0,0 +1,261 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/TCP/connection.hpp"
+#include "MB/TCP/gateway.hpp"
+#include "MB/modbusDataStore.hpp"
+#include "TCPLoopback.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+
+class ConnectionLoopback : public TCPLoopback {
+  protected:
+    TCP::Connection accept() { return TCP::Connection(acceptFd()); }
+};
+
+TEST_F(ConnectionLoopback, Transaction) {
+    auto client = TCP::Connection::with("127.0.0.1", port);
+    auto server = accept();
+    client.setMessageId(0x0102);
+
+    const auto raw =
+        client.sendRequest(ModbusRequest(0x11, utils::ReadAnalogInputRegisters, 0x08, 1));
+    EXPECT_EQ(raw, std::vector<uint8_t>({0x01, 0x02, 0x00, 0x00, 0x00, 0x06, 0x11, 0x04,
+                                         0x00, 0x08, 0x00, 0x01}));
+
+    const auto request = server.awaitRequest();
+    EXPECT_EQ(server.getMessageId(), 0x0102);
+    EXPECT_EQ(request.registerAddress(), 0x08);
+
+    server.sendResponse(ModbusResponse(0x11, utils::ReadAnalogInputRegisters, 0x08, 1,
+                                       {ModbusCell::initReg(0x000A)}));
+
+    const auto response = client.awaitResponse();
+    EXPECT_EQ(response.registerValues()[0].reg(), 0x000A);
+}
+
+TEST_F(ConnectionLoopback, PipeliningOutOfOrder) {
+    auto client = TCP::Connection::with("127.0.0.1", port);
+    auto server = accept();
+    client.setMessageId(0xFFFF);
+
+    std::thread standIn([&server]() {
+        std::vector<uint8_t> stream;
+        std::vector<uint16_t> ids;
+        for (auto i = 0; i < 3; i++) {
+            utils::ignore_result(server.awaitRequest());
+            ids.push_back(server.getMessageId());
+        }
+
+        // Answer in reverse order, all responses in one segment
+        for (auto i = 2; i >= 0; i--) {
+            const std::vector<uint8_t> pdu = {0x11, 0x04, 0x02, 0x00,
+                                              static_cast<uint8_t>(i)};
+            utils::pushUint16(stream, ids[i]);
+            stream.insert(stream.end(), {0x00, 0x00, 0x00, 0x05});
+            stream.insert(stream.end(), pdu.begin(), pdu.end());
+        }
+        sendRaw(server.getSockfd(), stream);
+    });
+
+    const ModbusRequest request(0x11, utils::ReadAnalogInputRegisters, 0x08, 1);
+    const auto responses = client.pipelineRequests({request, request, request});
+    standIn.join();
+
+    ASSERT_EQ(responses.size(), 3);
+    for (auto i = 0; i < 3; i++)
+        EXPECT_EQ(responses[i].registerValues()[0].reg(), i);
+
+    // Message ID wrapped around
+    EXPECT_EQ(client.getMessageId(), 0x0002);
+}
+
+TEST_F(ConnectionLoopback, UnitZero) {
+    auto client = TCP::Connection::with("127.0.0.1", port);
+    auto server = accept();
+
+    // Device that takes unit 0 as its own answers it, as any other request
+    std::thread standIn([&server]() {
+        for (uint16_t i = 0; i < 3; i++) {
+            const auto request = server.awaitRequest();
+            EXPECT_FALSE(server.sendResponse(ModbusResponse(request.slaveID(),
+                                                            request.functionCode(), 0, 1,
+                                                            {ModbusCell::initReg(i)}))
+                             .empty());
+        }
+    });
+
+    const ModbusRequest read(0x11, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    const ModbusRequest write(0, utils::WriteSingleAnalogOutputRegister, 0, 1,
+                              {ModbusCell::initReg(7)});
+    const auto responses = client.pipelineRequests({read, write, read}, 1);
+    standIn.join();
+
+    // Answer to the broadcast is not taken for the response to the last read
+    ASSERT_EQ(responses.size(), 3);
+    EXPECT_EQ(responses[0].registerValues()[0].reg(), 0);
+    EXPECT_EQ(responses[2].registerValues()[0].reg(), 2);
+}
+
+TEST_F(ConnectionLoopback, PipeliningLateResponses) {
+    auto client = TCP::Connection::with("127.0.0.1", port);
+    auto server = accept();
+    client.setTimeout(100);
+
+    const ModbusRequest request(0x11, utils::ReadAnalogInputRegisters, 0x08, 1);
+    const auto respond = [&server](uint16_t messageId, uint16_t value) {
+        server.setMessageId(messageId);
+        server.sendResponse(ModbusResponse(0x11, utils::ReadAnalogInputRegisters, 0x08,
+                                           1, {ModbusCell::initReg(value)}));
+    };
+
+    client.sendRequest(request);
+    EXPECT_THROW(utils::ignore_result(client.awaitResponse()), ModbusException);
+
+    // Late response to the request that timed out comes amid the pipelined ones
+    respond(0, 0x00EE);
+    respond(1, 1);
+    respond(2, 2);
+    const auto responses = client.pipelineRequests({request, request});
+    ASSERT_EQ(responses.size(), 2);
+    EXPECT_EQ(responses[1].registerValues()[0].reg(), 2);
+
+    // Pipeline that timed out does not give its IDs to the next request
+    EXPECT_THROW(utils::ignore_result(client.pipelineRequests({request})),
+                 ModbusException);
+    respond(3, 0x00EE);
+    client.sendRequest(request);
+    respond(4, 4);
+    EXPECT_EQ(client.awaitResponse().registerValues()[0].reg(), 4);
+}
+
+TEST_F(ConnectionLoopback, AdaptiveTimeout) {
+    auto client = TCP::Connection::with("127.0.0.1", port);
+    auto server = accept();
+    client.setTimeout(5000);
+    client.setAdaptiveTimeouts(std::make_shared<ModbusAdaptiveTimeouts>());
+
+    const ModbusRequest request(0x11, utils::ReadAnalogInputRegisters, 0x08, 1);
+    client.sendRequest(request);
+    utils::ignore_result(server.awaitRequest());
+    server.sendResponse(ModbusResponse(0x11, utils::ReadAnalogInputRegisters, 0x08, 1,
+                                       {ModbusCell::initReg(0x000A)}));
+    utils::ignore_result(client.awaitResponse());
+    EXPECT_EQ(client.getAdaptiveTimeouts()->estimate(0x11)->samples, 1);
+
+    // Loopback answers fast, so silent device fails much sooner than the fixed
+    // timeout
+    client.sendRequest(request);
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(utils::ignore_result(client.awaitResponse()), ModbusException);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_EQ(client.getAdaptiveTimeouts()->estimate(0x11)->timeouts, 1);
+
+    // Late response to the request that timed out is neither sampled, nor taken
+    // for the response to the next one
+    const auto answer = [&server](uint16_t value) {
+        utils::ignore_result(server.awaitRequest());
+        server.sendResponse(ModbusResponse(0x11, utils::ReadAnalogInputRegisters, 0x08,
+                                           1, {ModbusCell::initReg(value)}));
+    };
+    answer(0x000B);
+    client.sendRequest(request);
+    answer(0x000C);
+    EXPECT_EQ(client.awaitResponse().registerValues()[0].reg(), 0x000C);
+    EXPECT_EQ(client.getAdaptiveTimeouts()->estimate(0x11)->samples, 2);
+}
+
+TEST_F(ConnectionLoopback, AdaptiveTimeoutMoved) {
+    auto client = TCP::Connection::with("127.0.0.1", port);
+    auto server = accept();
+    client.setTimeout(5000);
+    client.setAdaptiveTimeouts(std::make_shared<ModbusAdaptiveTimeouts>());
+
+    // Request in flight is sampled for its slave by the connection it moved to
+    client.sendRequest(ModbusRequest(0x11, utils::ReadAnalogInputRegisters, 0x08, 1));
+    TCP::Connection moved(std::move(client));
+    utils::ignore_result(server.awaitRequest());
+    server.sendResponse(ModbusResponse(0x11, utils::ReadAnalogInputRegisters, 0x08, 1,
+                                       {ModbusCell::initReg(0x000A)}));
+    utils::ignore_result(moved.awaitResponse());
+
+    const auto estimate = moved.getAdaptiveTimeouts()->estimate(0x11);
+    ASSERT_TRUE(estimate.has_value());
+    EXPECT_EQ(estimate->samples, 1);
+    EXPECT_LT(estimate->smoothed, std::chrono::seconds(1));
+}
+
+TEST_F(ConnectionLoopback, Gateway) {
+    ModbusDataStore store{0, 0, 16, 0};
+    store.write(utils::HoldingRegisters, 0, {ModbusCell::initReg(0x0A0A)});
+
+    ModbusGateway engine;
+    engine.addLine(
+        [&store](const ModbusRequest &request) {
+            return ModbusResponse::fromRaw(
+                store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+        },
+        {0x11});
+
+    TCP::Gateway gateway(engine);
+    auto client = TCP::Connection::with("127.0.0.1", port);
+    gateway.serve(accept());
+    client.setMessageId(0x1234);
+
+    // Transaction ids of pipelined requests are kept
+    const ModbusRequest request(0x11, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    const auto responses = client.pipelineRequests({request, request, request});
+    ASSERT_EQ(responses.size(), 3);
+    EXPECT_EQ(responses[2].registerValues()[0].reg(), 0x0A0A);
+
+    // Unit without line
+    client.sendRequest(
+        ModbusRequest(0x12, utils::ReadAnalogOutputHoldingRegisters, 0, 1));
+    EXPECT_THROW(utils::ignore_result(client.awaitResponse()), ModbusException);
+    EXPECT_EQ(gateway.sessions(), 1);
+    EXPECT_EQ(engine.metrics(0).requests, 3);
+}
+
+TEST_F(ConnectionLoopback, GatewayRateLimit) {
+    ModbusDataStore store{0, 0, 16, 0};
+    ModbusGateway engine;
+    engine.addLine(
+        [&store](const ModbusRequest &request) {
+            return ModbusResponse::fromRaw(
+                store.handle(ModbusRequest::fromRaw(request.toRaw())).toRaw());
+        },
+        {0x11});
+
+    ModbusRateLimiter::Settings settings;
+    settings.connection = {1, 2, 0, 125};
+    auto limiter        = std::make_shared<ModbusRateLimiter>(settings);
+
+    TCP::Gateway gateway(engine);
+    gateway.setRateLimiter(limiter);
+    auto client = TCP::Connection::with("127.0.0.1", port);
+    gateway.serve(accept());
+
+    // Burst of the connection, then requests are rejected
+    const ModbusRequest request(0x11, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    for (int i = 0; i < 2; i++) {
+        client.sendRequest(request);
+        EXPECT_NO_THROW(utils::ignore_result(client.awaitResponse()));
+    }
+    client.sendRequest(request);
+    try {
+        utils::ignore_result(client.awaitResponse());
+        FAIL() << "Request over the limit was handled";
+    } catch (const ModbusException &exception) {
+        EXPECT_EQ(exception.getErrorCode(), utils::SlaveDeviceBusy);
+    }
+
+    EXPECT_EQ(limiter->metrics().rejected, 1);
+    EXPECT_EQ(engine.metrics(0).requests, 2);
+}
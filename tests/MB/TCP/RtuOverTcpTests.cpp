@@ -0,0 +1,160 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/TCP/rtuOverTcp.hpp"
+#include "TCPLoopback.hpp"
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+using namespace MB;
+
+class RtuOverTcpLoopback : public TCPLoopback {
+  protected:
+    TCP::RtuOverTcp accept() { return TCP::RtuOverTcp(acceptFd()); }
+};
+
+TEST_F(RtuOverTcpLoopback, Transaction) {
+    auto client = TCP::RtuOverTcp::with("127.0.0.1", port);
+    auto device = accept();
+
+    const auto raw = client.sendRequest(
+        ModbusRequest(0x11, utils::ReadAnalogOutputHoldingRegisters, 0x6B, 3));
+    // Testing data from https://www.simplymodbus.ca/
+    EXPECT_EQ(raw, std::vector<uint8_t>({0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87}));
+
+    const auto request = device.awaitRequest();
+    EXPECT_EQ(request.slaveID(), 0x11);
+    EXPECT_EQ(request.registerAddress(), 0x6B);
+    EXPECT_EQ(request.numberOfRegisters(), 3);
+
+    device.sendResponse(ModbusResponse(0x11, utils::ReadAnalogOutputHoldingRegisters, 0x6B,
+                                       3,
+                                       {ModbusCell::initReg(0xAE41),
+                                        ModbusCell::initReg(0x5652),
+                                        ModbusCell::initReg(0x4340)}));
+
+    const auto response = client.awaitResponse();
+    EXPECT_EQ(response.numberOfRegisters(), 3);
+    EXPECT_EQ(response.registerValues()[0].reg(), 0xAE41);
+    EXPECT_EQ(response.registerValues()[2].reg(), 0x4340);
+}
+
+TEST_F(RtuOverTcpLoopback, PipeliningAndReassembly) {
+    auto client = TCP::RtuOverTcp::with("127.0.0.1", port);
+    auto device = accept();
+
+    std::thread standIn([&device]() {
+        utils::ignore_result(device.awaitRequest());
+        utils::ignore_result(device.awaitRequest());
+
+        // Both responses, cut in the middle of the first one
+        const std::vector<uint8_t> fn3  = {0x11, 0x03, 0x06, 0xAE, 0x41, 0x56,
+                                           0x52, 0x43, 0x40, 0x49, 0xAD};
+        const std::vector<uint8_t> fn16 = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x12, 0x98};
+        std::vector<uint8_t> stream = fn3;
+        stream.insert(stream.end(), fn16.begin(), fn16.end());
+
+        sendRaw(device.getSockfd(), std::vector<uint8_t>(stream.begin(), stream.begin() + 4));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        sendRaw(device.getSockfd(), std::vector<uint8_t>(stream.begin() + 4, stream.end()));
+    });
+
+    const auto responses = client.pipelineRequests(
+        {ModbusRequest(0x11, utils::ReadAnalogOutputHoldingRegisters, 0x6B, 3),
+         ModbusRequest(0x11, utils::WriteMultipleAnalogOutputHoldingRegisters, 0x01, 2,
+                       {ModbusCell::initReg(0x000A), ModbusCell::initReg(0x0102)})});
+    standIn.join();
+
+    ASSERT_EQ(responses.size(), 2);
+    EXPECT_EQ(responses[0].registerValues()[1].reg(), 0x5652);
+    EXPECT_EQ(responses[1].functionCode(), utils::WriteMultipleAnalogOutputHoldingRegisters);
+    EXPECT_EQ(responses[1].numberOfRegisters(), 2);
+}
+
+TEST_F(RtuOverTcpLoopback, ExceptionResponse) {
+    auto client = TCP::RtuOverTcp::with("127.0.0.1", port);
+    auto device = accept();
+
+    client.sendRequest(ModbusRequest(0x0A, utils::ReadDiscreteOutputCoils, 0x1000, 1));
+    utils::ignore_result(device.awaitRequest());
+    sendRaw(device.getSockfd(), {0x0A, 0x81, 0x02, 0xB0, 0x53});
+
+    try {
+        auto _ = client.awaitResponse();
+        FAIL() << "Exception response was not detected";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::IllegalDataAddress);
+        EXPECT_EQ(ex.slaveID(), 0x0A);
+    }
+}
+
+TEST_F(RtuOverTcpLoopback, InvalidCRC) {
+    auto client = TCP::RtuOverTcp::with("127.0.0.1", port);
+    auto device = accept();
+
+    client.sendRequest(ModbusRequest(0x11, utils::WriteSingleAnalogOutputRegister, 0x01, 1,
+                                     {ModbusCell::initReg(0x03)}));
+    utils::ignore_result(device.awaitRequest());
+    sendRaw(device.getSockfd(), {0x11, 0x06, 0x00, 0x01, 0x00, 0x03, 0x9A, 0x00});
+
+    try {
+        auto _ = client.awaitResponse();
+        FAIL() << "Invalid CRC was not detected";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::InvalidCRC);
+    }
+}
+
+TEST_F(RtuOverTcpLoopback, Timeout) {
+    auto client = TCP::RtuOverTcp::with("127.0.0.1", port);
+    auto device = accept();
+    client.setTimeout(20);
+
+    client.sendRequest(ModbusRequest(0x11, utils::ReadAnalogInputRegisters, 0x08, 1));
+
+    try {
+        auto _ = client.awaitResponse();
+        FAIL() << "Response should not arrive";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(ex.getErrorCode(), utils::Timeout);
+    }
+}
+
+TEST_F(RtuOverTcpLoopback, LateResponses) {
+    auto client = TCP::RtuOverTcp::with("127.0.0.1", port);
+    auto device = accept();
+    client.setTimeout(100);
+
+    const ModbusRequest read(0x11, utils::ReadAnalogInputRegisters, 0x08, 1);
+    const ModbusRequest write(0x11, utils::WriteSingleAnalogOutputRegister, 0x01, 1,
+                              {ModbusCell::initReg(0x03)});
+    const ModbusResponse lateRead(0x11, utils::ReadAnalogInputRegisters, 0x08, 1,
+                                  {ModbusCell::initReg(0x00EE)});
+
+    client.sendRequest(read);
+    EXPECT_THROW(utils::ignore_result(client.awaitResponse()), ModbusException);
+
+    // Late response to the read is not taken for the response to the write
+    device.sendResponse(lateRead);
+    device.sendResponse(ModbusResponse::from(write));
+    client.sendRequest(write);
+    EXPECT_EQ(client.awaitResponse().functionCode(),
+              utils::WriteSingleAnalogOutputRegister);
+
+    // Nor in the pipeline
+    device.sendResponse(lateRead);
+    device.sendResponse(ModbusResponse::from(write));
+    EXPECT_EQ(client.pipelineRequests({write}).size(), 1);
+
+    // Pipeline that has failed leaves nothing of its responses behind
+    const auto response = device.sendResponse(ModbusResponse::from(write));
+    sendRaw(device.getSockfd(), std::vector<uint8_t>(response.begin(), response.end() - 3));
+    EXPECT_THROW(utils::ignore_result(client.pipelineRequests({write, write})),
+                 ModbusException);
+    device.sendResponse(ModbusResponse::from(write));
+    client.sendRequest(write);
+    EXPECT_EQ(client.awaitResponse().registerValues()[0].reg(), 0x03);
+}
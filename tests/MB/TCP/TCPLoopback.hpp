@@ -0,0 +1,48 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+// Listening socket on the loopback interface, that stands in for remote device
+class TCPLoopback : public ::testing::Test {
+  protected:
+    int listener = -1;
+    int port     = 0;
+
+    virtual void SetUp() {
+        listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_NE(listener, -1);
+
+        sockaddr_in address     = {};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = ::htonl(INADDR_LOOPBACK);
+        address.sin_port        = 0;
+        socklen_t length        = sizeof(address);
+
+        ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr *>(&address), length), 0);
+        ASSERT_EQ(::listen(listener, 1), 0);
+        ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length),
+                  0);
+        port = ::ntohs(address.sin_port);
+    }
+
+    virtual void TearDown() { ::close(listener); }
+
+    int acceptFd() { return ::accept(listener, nullptr, nullptr); }
+
+    static void sendRaw(int sockfd, const std::vector<uint8_t> &data) {
+        ASSERT_EQ(::send(sockfd, data.data(), data.size(), 0),
+                  static_cast<ssize_t>(data.size()));
+    }
+};
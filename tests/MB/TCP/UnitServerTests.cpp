@@ -0,0 +1,178 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2024 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/TCP/connection.hpp"
+#include "MB/TCP/unitServer.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+TEST(TCPUnitServer, EventLoop) {
+    ModbusUnitServer units;
+    for (uint8_t unitId = 1; unitId <= 10; unitId++) {
+        units.addUnit(unitId, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+        units.store(unitId)->write(utils::HoldingRegisters, 0,
+                                   {ModbusCell::initReg(unitId)});
+    }
+
+    TCP::UnitServer server(units, 0);
+    server.setIdleTimeout(10s);
+    std::thread loop([&server]() { server.run(); });
+
+    // Many masters, all units served from one thread
+    std::vector<TCP::Connection> clients;
+    for (int i = 0; i < 3; i++)
+        clients.push_back(TCP::Connection::with("127.0.0.1", server.port()));
+    for (uint8_t unitId = 1; unitId <= 10; unitId++) {
+        auto &client = clients[unitId % clients.size()];
+        client.sendRequest(
+            ModbusRequest(unitId, utils::ReadAnalogOutputHoldingRegisters, 0, 1));
+        EXPECT_EQ(client.awaitResponse().registerValues()[0].reg(), unitId);
+    }
+
+    // Pipelined requests, one of them to the unit that is not hosted
+    const std::vector<ModbusRequest> requests = {
+        ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters, 0, 1),
+        ModbusRequest(2, utils::WriteSingleAnalogOutputRegister, 1, 1,
+                      {ModbusCell::initReg(5)}),
+        ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters, 0, 2),
+    };
+    const auto responses = clients[0].pipelineRequests(requests);
+    EXPECT_EQ(responses[2].registerValues()[1].reg(), 5);
+
+    clients[1].sendRequest(
+        ModbusRequest(50, utils::ReadAnalogOutputHoldingRegisters, 0, 1));
+    try {
+        utils::ignore_result(clients[1].awaitResponse());
+        FAIL() << "Unit that is not hosted answered";
+    } catch (const ModbusException &exception) {
+        EXPECT_EQ(exception.getErrorCode(), utils::GatewayTargetDeviceFailedToRespond);
+    }
+
+    EXPECT_EQ(server.connections(), 3);
+    clients.pop_back();
+    while (server.connections() != 2)
+        std::this_thread::sleep_for(1ms);
+
+    server.stop();
+    loop.join();
+    EXPECT_EQ(server.requests(), 14);
+}
+
+TEST(TCPUnitServer, Offloading) {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool released = false;
+
+    ModbusUnitServer units;
+    units.addUnit(1, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+    units.store(1)->write(utils::HoldingRegisters, 0, {ModbusCell::initReg(1)});
+    // Slow backend, blocks until released
+    units.setHandler(2, [&](const ModbusRequest &request) {
+        std::unique_lock lock{mutex};
+        cond.wait(lock, [&] { return released; });
+        return ModbusResponse(request.slaveID(), request.functionCode(), 0, 1,
+                              {ModbusCell::initReg(2)});
+    });
+    units.setOffloaded(2, true);
+    units.setWorkerPool(std::make_shared<ModbusWorkerPool>(2));
+
+    TCP::UnitServer server(units, 0);
+    std::thread loop([&server]() { server.run(); });
+
+    auto slow = TCP::Connection::with("127.0.0.1", server.port());
+    auto fast = TCP::Connection::with("127.0.0.1", server.port());
+    slow.sendRequest(ModbusRequest(2, utils::ReadAnalogOutputHoldingRegisters, 0, 1));
+    fast.sendRequest(ModbusRequest(1, utils::ReadAnalogOutputHoldingRegisters, 0, 1));
+    EXPECT_EQ(fast.awaitResponse().registerValues()[0].reg(), 1);
+
+    {
+        std::lock_guard lock{mutex};
+        released = true;
+    }
+    cond.notify_all();
+    EXPECT_EQ(slow.awaitResponse().registerValues()[0].reg(), 2);
+
+    server.stop();
+    loop.join();
+    EXPECT_EQ(server.requests(), 2);
+}
+
+TEST(TCPUnitServer, RateLimit) {
+    ModbusUnitServer units;
+    units.addUnit(1, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+
+    ModbusRateLimiter::Settings settings;
+    settings.connection = {1, 2, 0, 125};
+    auto limiter        = std::make_shared<ModbusRateLimiter>(settings);
+
+    TCP::UnitServer server(units, 0);
+    server.setRateLimiter(limiter);
+    std::thread loop([&server]() { server.run(); });
+
+    // Burst of the connection, then requests are rejected
+    auto client = TCP::Connection::with("127.0.0.1", server.port());
+    const ModbusRequest request(1, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    for (int i = 0; i < 2; i++) {
+        client.sendRequest(request);
+        EXPECT_NO_THROW(utils::ignore_result(client.awaitResponse()));
+    }
+    client.sendRequest(request);
+    try {
+        utils::ignore_result(client.awaitResponse());
+        FAIL() << "Request over the limit was handled";
+    } catch (const ModbusException &exception) {
+        EXPECT_EQ(exception.getErrorCode(), utils::SlaveDeviceBusy);
+    }
+
+    server.stop();
+    loop.join();
+    EXPECT_EQ(limiter->metrics().rejected, 1);
+    EXPECT_EQ(server.requests(), 2);
+}
+
+TEST(TCPUnitServer, RateLimitDelay) {
+    ModbusUnitServer units;
+    units.addUnit(1, std::make_shared<ModbusDataStore>(0, 0, 4, 0));
+
+    // Bursts of two requests, then one per 50ms
+    ModbusRateLimiter::Settings settings;
+    settings.connection = {20, 2, 0, 125};
+    settings.maxDelay   = 1s;
+    auto limiter        = std::make_shared<ModbusRateLimiter>(settings);
+
+    TCP::UnitServer server(units, 0);
+    server.setRateLimiter(limiter);
+    std::thread loop([&server]() { server.run(); });
+
+    // Deferred requests are answered in order, once their time comes
+    auto client = TCP::Connection::with("127.0.0.1", server.port());
+    client.setTimeout(5000);
+    const ModbusRequest request(1, utils::ReadAnalogOutputHoldingRegisters, 0, 1);
+    const auto start     = std::chrono::steady_clock::now();
+    const auto responses = client.pipelineRequests({request, request, request, request});
+    EXPECT_EQ(responses.size(), 4);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 90ms);
+    EXPECT_EQ(limiter->metrics().delayed, 2);
+
+    // Other masters are served, while the request waits
+    auto other = TCP::Connection::with("127.0.0.1", server.port());
+    client.sendRequest(request);
+    other.sendRequest(request);
+    EXPECT_NO_THROW(utils::ignore_result(other.awaitResponse()));
+    EXPECT_NO_THROW(utils::ignore_result(client.awaitResponse()));
+
+    server.stop();
+    loop.join();
+    EXPECT_EQ(limiter->metrics().rejected, 0);
+    EXPECT_EQ(server.requests(), 6);
+}